@@ -19,6 +19,7 @@
 #   HAVE_GETHOSTNAME
 #   HAVE_GETPID
 #   HAVE_JN
+#   HAVE_LINUX_PERF_EVENT_H
 #   HAVE_RAND_R
 #   HAVE_SYS_RESOURCE_H
 #   HAVE_SYS_TIME_H
@@ -54,6 +55,8 @@ CHECK_CXX_SYMBOL_EXISTS("getpid" "unistd.h" HAVE_GETPID)
 
 CHECK_CXX_SYMBOL_EXISTS("rand_r" "stdlib.h" HAVE_RAND_R)
 
+CHECK_INCLUDE_FILE_CXX("linux/perf_event.h" HAVE_LINUX_PERF_EVENT_H)
+
 #
 # Do we have the Bessel function jn?
 #
@@ -109,6 +109,7 @@ FILE(WRITE ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/print_info.cmake
 #    parameter_gui  - ${_description_string} component 'parameter_gui'
 #
 #    test           - run a minimal set of tests
+#    benchmarks     - run the kernel benchmarks, results in JSON format
 #
 #    setup_tests    - set up testsuite subprojects
 #    regen_tests    - rerun configure stage in every testsuite subproject
@@ -296,6 +296,11 @@ namespace internal
      * elements, otherwise work in serial. Copies the data from source to
      * destination and then calls destructor on the source. If the optional
      * argument is set to true, the source is left untouched instead.
+     *
+     * The parallel call uses a static partition of the range (see
+     * parallel::apply_to_static_subranges()), since the destination is
+     * usually newly allocated memory whose pages are placed close to the
+     * thread that first writes to them.
      */
     AlignedVectorMove (T *source_begin,
                        T *source_end,
@@ -311,7 +316,7 @@ namespace internal
       if (size < minimum_parallel_grain_size)
         apply_to_subrange (0, size);
       else
-        apply_parallel (0, size, minimum_parallel_grain_size);
+        apply_parallel_static (0, size, minimum_parallel_grain_size);
     }
 
     /**
@@ -360,7 +365,8 @@ namespace internal
   public:
     /**
      * Constructor. Issues a parallel call if there are sufficiently many
-     * elements, otherwise work in serial.
+     * elements, otherwise work in serial. As in AlignedVectorMove, the
+     * range is partitioned statically.
      */
     AlignedVectorSet (const std::size_t size,
                       const T &element,
@@ -389,7 +395,7 @@ namespace internal
       if (size < minimum_parallel_grain_size)
         apply_to_subrange (0, size);
       else
-        apply_parallel (0, size, minimum_parallel_grain_size);
+        apply_parallel_static (0, size, minimum_parallel_grain_size);
     }
 
   private:
@@ -0,0 +1,296 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __deal2__hardware_counters_h
+#define __deal2__hardware_counters_h
+
+#include <deal.II/base/config.h>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace internal
+{
+  namespace HardwareCounters
+  {
+    /**
+     * Whether hardware counter instrumentation is switched on. Kept in a
+     * variable of its own so that HardwareCounters::is_enabled() can be
+     * inlined into the instrumented loops.
+     */
+    extern bool enabled;
+  }
+}
+
+
+
+/**
+ * An optional instrumentation layer that records hardware performance
+ * counters (processor cycles, instructions, last level cache references and
+ * misses, and optionally floating point operations) for named regions of a
+ * program, and prints a roofline summary of these regions, i.e., the
+ * achieved floating point rate and memory bandwidth as well as the
+ * arithmetic intensity, which tells whether a region is limited by the
+ * memory bandwidth or by the floating point throughput of the machine.
+ *
+ * The counters are read through the Linux <code>perf_event_open</code>
+ * system call, so no external library is needed. On other systems, or if
+ * the kernel does not allow access to the counters (see
+ * <code>/proc/sys/kernel/perf_event_paranoid</code>), only the wall time of
+ * the regions is measured, and the rates in the summary are computed from
+ * the model numbers of floating point operations and bytes given by the
+ * instrumented regions.
+ *
+ * The instrumentation is switched off by default, in which case the only
+ * cost of an instrumented region is the check of a boolean variable. It is
+ * switched on by calling enable(), or by setting the environment variable
+ * <code>DEAL_II_HARDWARE_COUNTERS</code> to a nonzero value before the
+ * program starts; in the latter case, the summary is printed to
+ * <code>std::cout</code> at the end of the program.
+ *
+ * The following functions of the library are instrumented: SparseMatrix::vmult,
+ * MatrixFree::cell_loop, WorkStream::run and DataOut::build_patches. In
+ * addition, every section of a TimerOutput object is recorded as a region
+ * with the name of the section while the instrumentation is enabled. Own
+ * regions can be instrumented with objects of the Scope class:
+ * @code
+ *   {
+ *     HardwareCounters::Scope scope ("my kernel", 2.*n, 3.*n*sizeof(double));
+ *     for (unsigned int i=0; i<n; ++i)
+ *       z[i] = a*x[i] + y[i];
+ *   }
+ * @endcode
+ *
+ * <h3>Floating point operations and memory transfer</h3>
+ *
+ * Processors do not have a portable counter for floating point operations.
+ * If the environment variable <code>DEAL_II_PERF_FLOP_EVENT</code> is set to
+ * the hexadecimal code of a raw event of the processor (e.g., the code of
+ * <code>FP_ARITH_INST_RETIRED.SCALAR_DOUBLE</code> on recent Intel
+ * processors), that event is used for the floating point operations;
+ * otherwise, the number of operations given to the Scope class is used. The
+ * memory transfer is estimated as the number of last level cache misses
+ * times a cache line size of 64 bytes if the counters are available, and by
+ * the model number of bytes otherwise.
+ *
+ * If the peak floating point rate and memory bandwidth of the machine are
+ * given to set_machine_peaks(), or in the environment variables
+ * <code>DEAL_II_PEAK_GFLOPS</code> and <code>DEAL_II_PEAK_BANDWIDTH</code>
+ * (in GB/s), the summary also states whether each region is memory or
+ * compute bound and which fraction of the roofline limit it achieves.
+ *
+ * <h3>Threads</h3>
+ *
+ * The counters are opened per thread, and those of the worker threads of
+ * the task scheduler are opened when the threads start working while the
+ * instrumentation is enabled. A region entered outside of tasks, e.g. on
+ * the main thread of the program, counts the events of all threads, so
+ * that the counters of functions like WorkStream::run() or
+ * SparseMatrix::vmult() include the work of the tasks they spawn. A region
+ * entered inside a task, e.g. a TimerOutput section in the worker function
+ * of WorkStream::run(), only counts the events of its own thread, since
+ * other tasks execute other regions at the same time. If a region is
+ * entered inside a task and left outside, or vice versa, only its wall time
+ * and model numbers are recorded. All functions of this namespace can be
+ * called concurrently from several threads.
+ *
+ * @ingroup utilities
+ */
+namespace HardwareCounters
+{
+  /**
+   * The events recorded.
+   */
+  enum Event
+  {
+    cycles,
+    instructions,
+    cache_references,
+    cache_misses,
+    floating_point_operations,
+    n_events
+  };
+
+  /**
+   * A snapshot of the counters and the wall time. The counters are the sums
+   * over all threads if @p all_threads is true, and those of the present
+   * thread otherwise, see the documentation of this namespace. Counters
+   * that are not available are zero.
+   */
+  struct Sample
+  {
+    double             wall_time;
+    unsigned long long counts[n_events];
+    bool               all_threads;
+  };
+
+  /**
+   * The data accumulated for a region: the number of times it was executed,
+   * the wall time spent in it, the sums of the counters, and the sums of
+   * the model numbers of floating point operations and bytes transferred.
+   */
+  struct RegionData
+  {
+    /**
+     * Constructor. Sets all fields to zero.
+     */
+    RegionData ();
+
+    unsigned long long n_calls;
+    double             wall_time;
+    unsigned long long counts[n_events];
+    double             model_flops;
+    double             model_bytes;
+  };
+
+  /**
+   * Switch the instrumentation on. If @p print_summary_at_exit is true, the
+   * summary of all regions is printed to <code>std::cout</code> at the end
+   * of the program.
+   */
+  void enable (const bool print_summary_at_exit = true);
+
+  /**
+   * Switch the instrumentation off. The data recorded so far is kept.
+   */
+  void disable ();
+
+  /**
+   * Return whether the instrumentation is switched on.
+   */
+  bool is_enabled ();
+
+  /**
+   * Return whether @p event can be counted on the present thread.
+   */
+  bool counter_available (const Event event);
+
+  /**
+   * Return the present values of the counters, summed over all threads if
+   * this function is not called inside a task.
+   */
+  Sample read ();
+
+  /**
+   * Add the difference between two samples taken at the beginning and the
+   * end of a region to the data of the region with the given name, along
+   * with the model numbers of floating point operations and bytes
+   * transferred in this execution of the region. The counters are only
+   * added if both samples cover the same threads.
+   */
+  void add_sample (const std::string &region,
+                   const Sample      &start,
+                   const Sample      &end,
+                   const double       model_flops = 0.,
+                   const double       model_bytes = 0.);
+
+  /**
+   * Set the peak floating point rate in GFlop/s and the peak memory
+   * bandwidth in GB/s of the machine, which are used to classify the
+   * regions in the summary.
+   */
+  void set_machine_peaks (const double peak_gflops,
+                          const double peak_bandwidth);
+
+  /**
+   * Return the data recorded for all regions so far.
+   */
+  std::map<std::string, RegionData> get_region_data ();
+
+  /**
+   * Print a table of the regions recorded so far with the number of calls,
+   * the wall time, the instructions per cycle, the floating point rate, the
+   * memory bandwidth, and the arithmetic intensity.
+   */
+  void print_summary (std::ostream &out);
+
+  /**
+   * Delete the data of all regions.
+   */
+  void reset ();
+
+  /**
+   * A class that records the counters for a region of code from its
+   * construction to its destruction if the instrumentation is enabled, and
+   * does nothing otherwise.
+   */
+  class Scope
+  {
+  public:
+    /**
+     * Constructor. Takes the name of the region and the model numbers of
+     * floating point operations and bytes transferred in it. The name must
+     * stay valid until the destructor has run, which is usually the case
+     * for string literals.
+     */
+    Scope (const char  *region,
+           const double model_flops = 0.,
+           const double model_bytes = 0.);
+
+    /**
+     * Destructor. Adds the sample to the data of the region.
+     */
+    ~Scope ();
+
+  private:
+    const char  *region;
+    const bool   active;
+    const double model_flops;
+    const double model_bytes;
+    Sample       start;
+  };
+
+
+
+  inline
+  bool is_enabled ()
+  {
+    return internal::HardwareCounters::enabled;
+  }
+
+
+
+  inline
+  Scope::Scope (const char  *region,
+                const double model_flops,
+                const double model_bytes)
+    :
+    region (region),
+    active (is_enabled()),
+    model_flops (model_flops),
+    model_bytes (model_bytes)
+  {
+    if (active)
+      start = read();
+  }
+
+
+
+  inline
+  Scope::~Scope ()
+  {
+    if (active)
+      add_sample (region, start, read(), model_flops, model_bytes);
+  }
+}
+
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,633 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __deal2__memory_arena_h
+#define __deal2__memory_arena_h
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/exceptions.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+/**
+ * A memory arena for short-lived scratch arrays, for example the arrays a
+ * worker function of WorkStream or MeshWorker needs while it works on one
+ * cell. Memory is handed out by incrementing an offset into a large block,
+ * which is much cheaper than a call to <code>malloc</code>, and is only
+ * given back all at once, either by reset() or by release() to a position
+ * obtained before with get_position(). If the present block is too small
+ * for a request, a new and larger block is allocated from the heap. As soon
+ * as the arena is empty again, all blocks are merged into one large enough
+ * for all of them, so that a loop that needs about the same amount of
+ * scratch memory for each of its items does not allocate any memory from
+ * the heap after its first few items.
+ *
+ * Memory from an arena can be used directly, through the ArenaAllocator
+ * class for standard containers, or through the ArenaArray class for
+ * temporary arrays in a function. A typical use in an assembly loop looks
+ * as follows:
+ * @code
+ *   struct ScratchData
+ *   {
+ *     ...
+ *     MemoryArena arena;
+ *   };
+ *
+ *   void local_assemble (const Iterator &cell,
+ *                        ScratchData    &scratch,
+ *                        CopyData       &copy_data)
+ *   {
+ *     scratch.arena.reset ();
+ *     std::vector<double, ArenaAllocator<double> >
+ *       coefficient_values (ArenaAllocator<double> (scratch.arena));
+ *     coefficient_values.resize (n_q_points);
+ *     ...
+ *   }
+ * @endcode
+ * Since WorkStream creates the ScratchData objects of the threads as
+ * copies of the sample object and the copy constructor of this class
+ * creates an empty arena of its own, every thread works on its own arena.
+ * The memory of a container that uses an ArenaAllocator is only given back
+ * to the arena with its next reset, so such containers must not live
+ * longer than until then.
+ *
+ * In addition, every thread has an arena of its own returned by
+ * thread_local_arena(), which the library uses through ArenaArray for
+ * temporary arrays whose size is not known in advance, for example in
+ * FEValuesBase::get_function_values() for elements with many degrees of
+ * freedom.
+ *
+ * @note An arena must only be used by one thread at a time.
+ *
+ * @ingroup memory
+ */
+class MemoryArena
+{
+public:
+  /**
+   * A position in the arena, as returned by get_position().
+   */
+  struct Position
+  {
+    unsigned int block;
+    std::size_t  offset;
+  };
+
+  /**
+   * Constructor. The first block is allocated with the given size when the
+   * first memory is requested, where sizes below 4 kB are increased to
+   * 4 kB.
+   */
+  MemoryArena (const std::size_t initial_block_size = 0);
+
+  /**
+   * Copy constructor. Creates an empty arena with the same initial block
+   * size as the given one, rather than a copy of its memory. This allows
+   * to use arenas as members of objects that are copied for each thread
+   * such as the ScratchData objects of WorkStream.
+   */
+  MemoryArena (const MemoryArena &arena);
+
+  /**
+   * Destructor. Frees all blocks.
+   */
+  ~MemoryArena ();
+
+  /**
+   * Return a pointer to @p n_bytes bytes of memory whose address is a
+   * multiple of @p alignment, which must be a power of two. The memory is
+   * not initialized.
+   */
+  void *allocate (const std::size_t n_bytes,
+                  const std::size_t alignment = 64);
+
+  /**
+   * Return the present position of the arena, i.e., the position at which
+   * the next memory will be handed out.
+   */
+  Position get_position () const;
+
+  /**
+   * Give back all memory handed out since @p position was obtained from
+   * get_position(). This must happen in the reverse order of the calls to
+   * get_position().
+   */
+  void release (const Position &position);
+
+  /**
+   * Give back all memory handed out so far. If the arena consists of more
+   * than one block, the blocks are merged into one.
+   */
+  void reset ();
+
+  /**
+   * Return the memory consumption of the blocks of this arena in bytes.
+   */
+  std::size_t memory_consumption () const;
+
+  /**
+   * Return the number of blocks allocated from the heap since this arena
+   * was created.
+   */
+  std::size_t n_heap_allocations () const;
+
+  /**
+   * Return the arena of the present thread.
+   */
+  static MemoryArena &thread_local_arena ();
+
+private:
+  /**
+   * Merge all blocks into one if there is more than one.
+   */
+  void merge_blocks ();
+
+  /**
+   * The blocks of the arena as pairs of a pointer and a size. Blocks are
+   * used in the order in which they are stored.
+   */
+  std::vector<std::pair<char *, std::size_t> > blocks;
+
+  /**
+   * The present position.
+   */
+  Position position;
+
+  /**
+   * The size of the first block.
+   */
+  const std::size_t initial_block_size;
+
+  /**
+   * The number of blocks allocated so far.
+   */
+  std::size_t n_allocations;
+
+  /**
+   * Arenas can not be assigned.
+   */
+  MemoryArena &operator= (const MemoryArena &);
+};
+
+
+
+/**
+ * An allocator for standard containers that takes its memory from a
+ * MemoryArena. Memory is not given back by the allocator but only with the
+ * next reset of the arena. All copies of an allocator use the same arena.
+ *
+ * @ingroup memory
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+  typedef T              value_type;
+  typedef T             *pointer;
+  typedef const T       *const_pointer;
+  typedef T             &reference;
+  typedef const T       &const_reference;
+  typedef std::size_t    size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef ArenaAllocator<U> other;
+  };
+
+  /**
+   * Constructor. Takes memory from the given arena, which must live longer
+   * than all containers using this allocator. There is deliberately no
+   * default for the arena: the library releases parts of the arena of the
+   * present thread whenever a temporary ArenaArray goes out of scope, which
+   * would pull the memory from under a container that allocated from this
+   * arena in the meantime.
+   */
+  ArenaAllocator (MemoryArena &arena);
+
+  /**
+   * Conversion from an allocator for another type.
+   */
+  template <typename U>
+  ArenaAllocator (const ArenaAllocator<U> &allocator);
+
+  pointer allocate (const size_type n,
+                    const void     *hint = 0);
+
+  void deallocate (pointer, size_type);
+
+  size_type max_size () const;
+
+  void construct (pointer p, const T &value);
+
+  void destroy (pointer p);
+
+  pointer address (reference x) const;
+
+  const_pointer address (const_reference x) const;
+
+  /**
+   * The arena memory is taken from.
+   */
+  MemoryArena *arena;
+};
+
+
+template <typename T, typename U>
+bool operator == (const ArenaAllocator<T> &a1,
+                  const ArenaAllocator<U> &a2);
+
+template <typename T, typename U>
+bool operator != (const ArenaAllocator<T> &a1,
+                  const ArenaAllocator<U> &a2);
+
+
+
+/**
+ * A temporary array in a MemoryArena, by default the one of the present
+ * thread. The memory is given back to the arena when the array is
+ * destroyed. Arrays must therefore be destroyed in the reverse order of
+ * their creation, which is the case for local variables of a function.
+ *
+ * @ingroup memory
+ */
+template <typename T>
+class ArenaArray
+{
+public:
+  /**
+   * Constructor. Creates an array of @p size default-initialized elements,
+   * which means that elements of built-in types are not initialized.
+   */
+  ArenaArray (const std::size_t size,
+              MemoryArena      &arena = MemoryArena::thread_local_arena());
+
+  /**
+   * Destructor. Destroys the elements and gives the memory back to the
+   * arena.
+   */
+  ~ArenaArray ();
+
+  /**
+   * Access to an element.
+   */
+  T &operator [] (const std::size_t i);
+
+  /**
+   * Access to an element.
+   */
+  const T &operator [] (const std::size_t i) const;
+
+  /**
+   * Return the number of elements.
+   */
+  std::size_t size () const;
+
+  /**
+   * Pointer to the first element.
+   */
+  T *begin ();
+
+  /**
+   * Pointer to the first element.
+   */
+  const T *begin () const;
+
+  /**
+   * Pointer to one past the last element.
+   */
+  T *end ();
+
+  /**
+   * Pointer to one past the last element.
+   */
+  const T *end () const;
+
+private:
+  MemoryArena                &arena;
+  const MemoryArena::Position position;
+  const std::size_t           n_elements;
+  T                          *elements;
+
+  /**
+   * Arrays can not be copied.
+   */
+  ArenaArray (const ArenaArray &);
+  ArenaArray &operator= (const ArenaArray &);
+};
+
+
+/* -------------------- inline and template functions ------------------- */
+
+#ifndef DOXYGEN
+
+inline
+MemoryArena::Position
+MemoryArena::get_position () const
+{
+  return position;
+}
+
+
+
+inline
+void *
+MemoryArena::allocate (const std::size_t n_bytes,
+                       const std::size_t alignment)
+{
+  Assert (alignment > 0 && (alignment & (alignment-1)) == 0,
+          ExcMessage ("The alignment must be a power of two."));
+
+  // try the present block and then the following ones, if any, before
+  // allocating a new one
+  while (position.block < blocks.size())
+    {
+      char *const block_start = blocks[position.block].first;
+      const std::size_t address
+        = reinterpret_cast<std::size_t>(block_start) + position.offset;
+      const std::size_t start
+        = position.offset + ((alignment - address % alignment) % alignment);
+      if (start + n_bytes <= blocks[position.block].second)
+        {
+          position.offset = start + n_bytes;
+          return block_start + start;
+        }
+      ++position.block;
+      position.offset = 0;
+    }
+
+  const std::size_t last_size = (blocks.size() > 0 ?
+                                 blocks.back().second :
+                                 initial_block_size/2);
+  const std::size_t size = std::max (2*last_size, n_bytes + alignment);
+  blocks.push_back (std::make_pair (static_cast<char *>(::operator new (size)),
+                                    size));
+  ++n_allocations;
+  position.block = blocks.size()-1;
+  position.offset = 0;
+  return allocate (n_bytes, alignment);
+}
+
+
+
+inline
+void
+MemoryArena::release (const Position &new_position)
+{
+  Assert (new_position.block < position.block ||
+          (new_position.block == position.block &&
+           new_position.offset <= position.offset),
+          ExcMessage ("Memory of an arena must be released in the reverse "
+                      "order in which it was obtained."));
+  position = new_position;
+  if (position.block == 0 && position.offset == 0 && blocks.size() > 1)
+    merge_blocks ();
+}
+
+
+
+inline
+void
+MemoryArena::reset ()
+{
+  position.block = 0;
+  position.offset = 0;
+  if (blocks.size() > 1)
+    merge_blocks ();
+}
+
+
+
+template <typename T>
+inline
+ArenaAllocator<T>::ArenaAllocator (MemoryArena &arena)
+  :
+  arena (&arena)
+{}
+
+
+
+template <typename T>
+template <typename U>
+inline
+ArenaAllocator<T>::ArenaAllocator (const ArenaAllocator<U> &allocator)
+  :
+  arena (allocator.arena)
+{}
+
+
+
+template <typename T>
+inline
+typename ArenaAllocator<T>::pointer
+ArenaAllocator<T>::allocate (const size_type n,
+                             const void *)
+{
+  return static_cast<pointer>(arena->allocate (n * sizeof(T),
+                                               sizeof(T) < 64 ? 16 : 64));
+}
+
+
+
+template <typename T>
+inline
+void
+ArenaAllocator<T>::deallocate (pointer, size_type)
+{}
+
+
+
+template <typename T>
+inline
+typename ArenaAllocator<T>::size_type
+ArenaAllocator<T>::max_size () const
+{
+  return std::numeric_limits<size_type>::max() / sizeof(T);
+}
+
+
+
+template <typename T>
+inline
+void
+ArenaAllocator<T>::construct (pointer p, const T &value)
+{
+  new (static_cast<void *>(p)) T(value);
+}
+
+
+
+template <typename T>
+inline
+void
+ArenaAllocator<T>::destroy (pointer p)
+{
+  p->~T();
+}
+
+
+
+template <typename T>
+inline
+typename ArenaAllocator<T>::pointer
+ArenaAllocator<T>::address (reference x) const
+{
+  return &x;
+}
+
+
+
+template <typename T>
+inline
+typename ArenaAllocator<T>::const_pointer
+ArenaAllocator<T>::address (const_reference x) const
+{
+  return &x;
+}
+
+
+
+template <typename T, typename U>
+inline
+bool operator == (const ArenaAllocator<T> &a1,
+                  const ArenaAllocator<U> &a2)
+{
+  return a1.arena == a2.arena;
+}
+
+
+
+template <typename T, typename U>
+inline
+bool operator != (const ArenaAllocator<T> &a1,
+                  const ArenaAllocator<U> &a2)
+{
+  return a1.arena != a2.arena;
+}
+
+
+
+template <typename T>
+inline
+ArenaArray<T>::ArenaArray (const std::size_t size,
+                           MemoryArena      &arena)
+  :
+  arena (arena),
+  position (arena.get_position()),
+  n_elements (size),
+  elements (static_cast<T *>(arena.allocate (size * sizeof(T),
+                                             sizeof(T) < 64 ? 16 : 64)))
+{
+  for (std::size_t i=0; i<n_elements; ++i)
+    new (static_cast<void *>(elements+i)) T;
+}
+
+
+
+template <typename T>
+inline
+ArenaArray<T>::~ArenaArray ()
+{
+  for (std::size_t i=0; i<n_elements; ++i)
+    elements[i].~T();
+  arena.release (position);
+}
+
+
+
+template <typename T>
+inline
+T &
+ArenaArray<T>::operator [] (const std::size_t i)
+{
+  AssertIndexRange (i, n_elements);
+  return elements[i];
+}
+
+
+
+template <typename T>
+inline
+const T &
+ArenaArray<T>::operator [] (const std::size_t i) const
+{
+  AssertIndexRange (i, n_elements);
+  return elements[i];
+}
+
+
+
+template <typename T>
+inline
+std::size_t
+ArenaArray<T>::size () const
+{
+  return n_elements;
+}
+
+
+
+template <typename T>
+inline
+T *
+ArenaArray<T>::begin ()
+{
+  return elements;
+}
+
+
+
+template <typename T>
+inline
+const T *
+ArenaArray<T>::begin () const
+{
+  return elements;
+}
+
+
+
+template <typename T>
+inline
+T *
+ArenaArray<T>::end ()
+{
+  return elements + n_elements;
+}
+
+
+
+template <typename T>
+inline
+const T *
+ArenaArray<T>::end () const
+{
+  return elements + n_elements;
+}
+
+#endif // DOXYGEN
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -0,0 +1,347 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __deal2__memory_profiler_h
+#define __deal2__memory_profiler_h
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/smartpointer.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/std_cxx11/bind.h>
+#include <deal.II/base/std_cxx11/function.h>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace internal
+{
+  namespace MemoryProfiler
+  {
+    /**
+     * Whether memory profiling is switched on. Kept in a variable of its
+     * own so that MemoryProfiler::is_enabled() can be inlined.
+     */
+    extern bool enabled;
+
+    /**
+     * Return the memory consumption of the given object.
+     */
+    template <class T>
+    std::size_t memory_consumption_of (const SmartPointer<const T> &object)
+    {
+      return dealii::MemoryConsumption::memory_consumption (*object);
+    }
+  }
+}
+
+
+
+/**
+ * A facility to find out which phase of a program needs how much memory.
+ * For every phase, i.e., every section of a TimerOutput object or region
+ * instrumented with a Scope object, it records how much the peak resident
+ * memory of the process (<code>VmHWM</code> in
+ * <code>/proc/self/status</code>, as returned by
+ * Utilities::System::get_memory_stats()) grew while the phase was active,
+ * and the peak and the present resident memory (<code>VmRSS</code>) at its
+ * end. In addition, the memory_consumption() of the objects registered
+ * with register_object() is recorded for a phase whenever
+ * sample_objects() is called for it, or at the end of every phase if this
+ * was requested when calling enable(). The phase in which the peak memory
+ * grows the most is the one that pushes a program over the memory of the
+ * machine.
+ *
+ * The profiling is switched off by default, in which case the only cost
+ * of a phase is the check of a boolean variable. It is switched on by
+ * calling enable(), or by setting the environment variable
+ * <code>DEAL_II_MEMORY_PROFILE</code> to a nonzero value before the
+ * program starts; in the latter case, the report is printed to
+ * <code>std::cout</code> at the end of the program. A typical use looks as
+ * follows:
+ * @code
+ *   MemoryProfiler::enable (false);
+ *   MemoryProfiler::register_object ("Triangulation", triangulation);
+ *   MemoryProfiler::register_object ("DoFHandler", dof_handler);
+ *   MemoryProfiler::register_object ("System matrix", system_matrix);
+ *
+ *   {
+ *     TimerOutput::Scope timer_section (timer, "Setup");
+ *     setup_system ();
+ *     MemoryProfiler::sample_objects ("Setup");
+ *   }
+ *   ...
+ *   MemoryProfiler::print_report (std::cout, MPI_COMM_WORLD);
+ *
+ *   MemoryProfiler::unregister_object ("System matrix");
+ *   MemoryProfiler::unregister_object ("DoFHandler");
+ *   MemoryProfiler::unregister_object ("Triangulation");
+ * @endcode
+ * The registered objects are subscribed to, so they have to be
+ * unregistered before they are destroyed, typically at the end of the
+ * function or in the destructor of the class that owns them.
+ *
+ * Reading the memory statistics of the process requires reading a file
+ * of the <code>/proc</code> file system at the beginning and end of every
+ * phase. This is too expensive for phases that are entered millions of
+ * times, but negligible for the phases of a typical program such as setup,
+ * assembly and solution. Computing the memory consumption of the
+ * registered objects may take longer, since it has to walk through all of
+ * their data, which is why it is only done on request: either by calling
+ * sample_objects(), or for every phase by passing true as the second
+ * argument of enable(). In the latter case, the objects are sampled at the
+ * end of every phase, after the memory statistics of the phase have been
+ * recorded and without holding the lock of the profiler, so that other
+ * threads can finish their phases in the meantime.
+ *
+ * @note The statistics of the operating system are those of the whole
+ * process. If phases are active on several threads at the same time, each
+ * of them is attributed the growth of the memory of all threads. The
+ * memory statistics are only available on Linux and are zero elsewhere.
+ *
+ * @ingroup utilities
+ */
+namespace MemoryProfiler
+{
+  /**
+   * The data recorded for a phase. All memory sizes of the operating system
+   * are in kB, as reported by Utilities::System::get_memory_stats(), and
+   * the memory consumption of objects in bytes.
+   */
+  struct PhaseData
+  {
+    /**
+     * Constructor. Sets all fields to zero.
+     */
+    PhaseData ();
+
+    /**
+     * The number of times the phase was executed.
+     */
+    unsigned long long n_calls;
+
+    /**
+     * The largest growth of the peak resident memory during one execution
+     * of the phase.
+     */
+    unsigned long int  max_hwm_increase;
+
+    /**
+     * The peak resident memory at the end of the last execution of the
+     * phase.
+     */
+    unsigned long int  hwm;
+
+    /**
+     * The largest resident memory at the end of an execution of the phase.
+     */
+    unsigned long int  max_rss;
+
+    /**
+     * The largest memory consumption of each of the registered objects
+     * recorded by sample_objects() for the phase.
+     */
+    std::map<std::string, std::size_t> object_memory;
+  };
+
+  /**
+   * Switch the profiling on. If @p print_report_at_exit is true, the report
+   * of all phases is printed to <code>std::cout</code> at the end of the
+   * program. If @p sample_objects_at_end_of_phase is true, the memory
+   * consumption of the registered objects is recorded at the end of every
+   * phase, as if sample_objects() was called for it. This makes every
+   * phase as expensive as computing the memory consumption of all
+   * registered objects, so it should only be used for coarse phases.
+   */
+  void enable (const bool print_report_at_exit = true,
+               const bool sample_objects_at_end_of_phase = false);
+
+  /**
+   * Switch the profiling off. The data recorded so far is kept.
+   */
+  void disable ();
+
+  /**
+   * Return whether the profiling is switched on.
+   */
+  bool is_enabled ();
+
+  /**
+   * Register a function that returns the memory consumption of an object
+   * in bytes under the given name. If an object of this name is already
+   * registered, it is replaced.
+   */
+  void register_object (const std::string                            &name,
+                        const std_cxx11::function<std::size_t ()> &memory_consumption);
+
+  /**
+   * Register an object whose memory consumption, as computed by
+   * MemoryConsumption::memory_consumption(), is recorded by
+   * sample_objects(). This works for all classes derived from Subscriptor
+   * with a <code>memory_consumption()</code> member function such as
+   * Triangulation, DoFHandler and SparseMatrix. The object is subscribed
+   * to until it is unregistered, so destroying it while it is still
+   * registered is an error that is detected in debug mode. Objects of
+   * other classes can be registered by passing a function that computes
+   * their memory consumption to the previous function. For example, a
+   * MatrixFree object, which is not derived from Subscriptor, is registered
+   * by
+   * @code
+   *   MemoryProfiler::register_object
+   *     ("MatrixFree",
+   *      std_cxx11::bind (&MatrixFree<dim>::memory_consumption,
+   *                       std_cxx11::cref (matrix_free)));
+   * @endcode
+   * Since the object is not subscribed to in this case, nothing detects
+   * that it is destroyed while still registered, and it has to be
+   * unregistered before.
+   */
+  template <class T>
+  void register_object (const std::string &name,
+                        const T           &object);
+
+  /**
+   * Remove the object with the given name from the registered objects. The
+   * data recorded for it so far is kept.
+   */
+  void unregister_object (const std::string &name);
+
+  /**
+   * Record the present memory consumption of all registered objects for the
+   * phase of the given name, typically at the end of the phase. For every
+   * object, the largest of the values recorded for the phase is kept.
+   */
+  void sample_objects (const std::string &phase);
+
+  /**
+   * Return the present memory statistics of the process.
+   */
+  Utilities::System::MemoryStats read ();
+
+  /**
+   * Add an execution of the phase with the given name, with the memory
+   * statistics at its beginning and end, to the data of the phase. If the
+   * objects are to be sampled at the end of every phase, also call
+   * sample_objects() for the phase.
+   */
+  void add_sample (const std::string                    &phase,
+                   const Utilities::System::MemoryStats &start,
+                   const Utilities::System::MemoryStats &end);
+
+  /**
+   * Return the data recorded for all phases so far.
+   */
+  std::map<std::string, PhaseData> get_phase_data ();
+
+  /**
+   * Print a table of the phases recorded so far with the number of calls,
+   * the growth of the peak memory, the peak and the present memory at the
+   * end of the phase, and the memory consumption of the registered objects.
+   */
+  void print_report (std::ostream &out);
+
+  /**
+   * Like the previous function, but print the maximum of every number over
+   * all processes of the given communicator, and in addition the sum of
+   * the peak memory of all processes. This function is collective: it must
+   * be called on all processes of the communicator. The processes may have
+   * recorded different phases and objects; those that a process has not
+   * recorded count as zero on it. The report is only printed on the
+   * process with rank zero.
+   */
+  void print_report (std::ostream   &out,
+                     const MPI_Comm &mpi_communicator);
+
+  /**
+   * Delete the data of all phases. The registered objects stay registered.
+   */
+  void reset ();
+
+  /**
+   * A class that records a phase from its construction to its destruction
+   * if the profiling is enabled, and does nothing otherwise.
+   */
+  class Scope
+  {
+  public:
+    /**
+     * Constructor. Takes the name of the phase, which must stay valid until
+     * the destructor has run.
+     */
+    Scope (const char *phase);
+
+    /**
+     * Destructor. Adds the sample to the data of the phase.
+     */
+    ~Scope ();
+
+  private:
+    const char                     *phase;
+    const bool                      active;
+    Utilities::System::MemoryStats  start;
+  };
+
+
+
+  inline
+  bool is_enabled ()
+  {
+    return internal::MemoryProfiler::enabled;
+  }
+
+
+
+  template <class T>
+  inline
+  void register_object (const std::string &name,
+                        const T           &object)
+  {
+    register_object (name,
+                     std_cxx11::function<std::size_t ()>
+                     (std_cxx11::bind (&internal::MemoryProfiler::memory_consumption_of<T>,
+                                       SmartPointer<const T> (&object,
+                                                              "MemoryProfiler"))));
+  }
+
+
+
+  inline
+  Scope::Scope (const char *phase)
+    :
+    phase (phase),
+    active (is_enabled())
+  {
+    if (active)
+      start = read();
+  }
+
+
+
+  inline
+  Scope::~Scope ()
+  {
+    if (active)
+      add_sample (phase, start, read());
+  }
+}
+
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -27,6 +27,11 @@
 #  ifndef MPI_SEEK_SET
 #    error "The buildsystem included an insufficient mpi.h header that does not export MPI_SEEK_SET"
 #  endif
+// MPI-3 allows processes on the same node to access each other's memory
+// through shared memory windows
+#  if defined(DEAL_II_WITH_MPI) && defined(MPI_VERSION) && (MPI_VERSION >= 3)
+#    define DEAL_II_MPI_WITH_SHARED_MEMORY
+#  endif
 
 #else
 // without MPI, we would still like to use
@@ -44,6 +44,23 @@ DEAL_II_NAMESPACE_OPEN
  * multithread_info.n_threads();
  * </code>
  *
+ * <h3>Thread affinity</h3>
+ *
+ * By default, the operating system is free to move the threads of the
+ * program between the processor cores. On machines with several sockets,
+ * each with its own memory, this destroys the locality of data that was
+ * initialized by a particular thread (see
+ * parallel::apply_to_static_subranges()). The function
+ * set_thread_affinity() binds every thread of the task scheduler to one
+ * core, either filling the cores in the order the operating system numbers
+ * them (compact_thread_affinity) or distributing consecutive threads over
+ * the sockets of the machine (scatter_thread_affinity). The affinity can
+ * also be selected by setting the environment variable
+ * <code>DEAL_II_THREAD_AFFINITY</code> to <code>compact</code> or
+ * <code>scatter</code>. Binding threads is currently only implemented on
+ * Linux, and only the cores the process is allowed to run on (for example
+ * as set by the MPI launcher) are used.
+ *
  * @ingroup threads
  * @author Thomas Richter, Wolfgang Bangerth, 2000
  */
@@ -148,6 +165,43 @@ public:
    * avoid using the interface that is not thread-safe.
    */
   bool is_running_single_threaded();
+
+  /**
+   * The ways in which threads can be bound to processor cores.
+   */
+  enum ThreadAffinity
+  {
+    /**
+     * Do not bind threads, and let the operating system decide where they
+     * run.
+     */
+    no_thread_affinity,
+    /**
+     * Bind the threads to consecutive cores in the numbering of the
+     * operating system.
+     */
+    compact_thread_affinity,
+    /**
+     * Bind consecutive threads to cores on different sockets, so that the
+     * memory bandwidth of all sockets is used even if there are fewer
+     * threads than cores.
+     */
+    scatter_thread_affinity
+  };
+
+  /**
+   * Bind the calling thread and all threads of the task scheduler to
+   * processor cores as described by @p affinity. Threads that have already
+   * been bound stay bound if @p affinity is no_thread_affinity.
+   */
+  void set_thread_affinity (const ThreadAffinity affinity);
+
+  /**
+   * Return the affinity set by set_thread_affinity() or the environment
+   * variable <code>DEAL_II_THREAD_AFFINITY</code>.
+   */
+  ThreadAffinity get_thread_affinity () const;
+
   /**
    * Exception
    */
@@ -171,6 +225,11 @@ private:
    * variable representing the maximum number of threads
    */
   unsigned int n_max_threads;
+
+  /**
+   * The affinity set by set_thread_affinity().
+   */
+  ThreadAffinity thread_affinity;
 };
 
 
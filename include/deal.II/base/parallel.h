@@ -27,6 +27,7 @@
 #include <deal.II/base/std_cxx11/function.h>
 
 #include <cstddef>
+#include <vector>
 
 #ifdef DEAL_II_WITH_THREADS
 #  include <tbb/parallel_for.h>
@@ -36,12 +37,57 @@
 #endif
 
 
-//TODO[WB]: allow calling functions to pass along a tbb::affinity_partitioner object to ensure that subsequent calls use the same cache lines
-
 DEAL_II_NAMESPACE_OPEN
 
 namespace parallel
 {
+  /**
+   * The ways in which apply_to_subranges(), accumulate_from_subranges() and
+   * ParallelForInteger distribute the work of a loop among threads.
+   */
+  enum PartitioningMode
+  {
+    /**
+     * Let the TBB scheduler split the range and balance the work between
+     * threads dynamically. This is the default.
+     */
+    dynamic_partitioning,
+    /**
+     * Split the range statically as apply_to_static_subranges() does. The
+     * same part of a range is then worked on by the same thread in
+     * consecutive loops as far as the scheduler allows, so that data stays
+     * in the caches and the memory banks of that thread, and the results of
+     * reductions are bitwise reproducible for a fixed number of threads.
+     */
+    static_partitioning
+  };
+
+  /**
+   * Set the partitioning mode used by all subsequent parallel loops. The
+   * initial mode is dynamic_partitioning, unless the environment variable
+   * <code>DEAL_II_PARTITIONING</code> is set to <code>static</code>.
+   */
+  void set_partitioning_mode (const PartitioningMode mode);
+
+  namespace internal
+  {
+    /**
+     * The partitioning mode, stored in a variable of its own so that
+     * get_partitioning_mode() can be inlined.
+     */
+    extern PartitioningMode partitioning_mode;
+  }
+
+  /**
+   * Return the present partitioning mode.
+   */
+  inline
+  PartitioningMode get_partitioning_mode ()
+  {
+    return internal::partitioning_mode;
+  }
+
+
   namespace internal
   {
     /**
@@ -342,6 +388,107 @@ namespace parallel
   }
 
 
+  namespace internal
+  {
+    /**
+     * Return the number of chunks into which apply_to_static_subranges()
+     * splits a range of @p size elements: the number of threads the library
+     * uses, but not more than the number of chunks that have at least
+     * @p grainsize elements, and at least one.
+     */
+    unsigned int n_static_chunks (const std::size_t size,
+                                  const std::size_t grainsize);
+
+#ifdef DEAL_II_WITH_THREADS
+    /**
+     * Call @p f for all chunk indices <code>[0,n_chunks)</code>, possibly
+     * in parallel. The chunks are scheduled with a tbb::affinity_partitioner
+     * that is kept for every number of chunks, so that a chunk with a given
+     * index is executed on the same thread as in earlier calls whenever the
+     * scheduler can honor the recorded affinity. If the partitioner for
+     * this number of chunks is in use by another loop at the same time, the
+     * chunks are scheduled without affinity.
+     */
+    void run_static_chunks (const unsigned int                                    n_chunks,
+                            const std_cxx11::function<void (const unsigned int)> &f);
+
+    /**
+     * Call @p f on the chunk with index @p chunk of the range of @p size
+     * elements starting at @p begin split into @p n_chunks chunks of (almost)
+     * equal size.
+     */
+    template <typename RangeType, typename Function>
+    void apply_to_static_chunk (const unsigned int  chunk,
+                                const unsigned int  n_chunks,
+                                const RangeType    &begin,
+                                const std::size_t   size,
+                                const Function     &f)
+    {
+      const RangeType chunk_begin = begin + chunk * size / n_chunks;
+      const RangeType chunk_end = begin + (chunk + 1) * size / n_chunks;
+      f (chunk_begin, chunk_end);
+    }
+#endif
+  }
+
+
+
+  /**
+   * This function does the same as apply_to_subranges(), but splits the
+   * range <code>[begin,end)</code> statically into as many chunks of equal
+   * size as there are threads (or fewer, if the chunks would be smaller
+   * than @p grainsize). The chunks depend only on the size of the range,
+   * the grain size and the number of threads, and a chunk with a given
+   * index is scheduled on the same thread in all calls as far as the TBB
+   * scheduler allows (see MultithreadInfo::set_thread_affinity() for
+   * binding these threads to processor cores).
+   *
+   * The main use of this function is to initialize memory on NUMA
+   * machines: the operating system places a page of memory close to the
+   * processor that first writes to it, so memory that is initialized with
+   * this function is distributed over the memory banks of the machine in
+   * the same way as the work of later loops over the same range using the
+   * same partition. Vector, SparseMatrix and AlignedVector initialize newly
+   * allocated memory this way.
+   *
+   * Different from apply_to_subranges(), the work is not balanced
+   * dynamically between the threads, so this function should only be used
+   * if the work per element is approximately the same.
+   */
+  template <typename RangeType, typename Function>
+  void apply_to_static_subranges (const RangeType                          &begin,
+                                  const typename identity<RangeType>::type &end,
+                                  const Function                           &f,
+                                  const unsigned int                        grainsize)
+  {
+#ifndef DEAL_II_WITH_THREADS
+    // make sure we don't get compiler
+    // warnings about unused arguments
+    (void) grainsize;
+
+#  ifndef DEAL_II_BIND_NO_CONST_OP_PARENTHESES
+    f (begin, end);
+#  else
+    // work around a problem with MS VC++ where there is no const
+    // operator() in 'Function' if 'Function' is the result of std::bind
+    Function ff = f;
+    ff (begin, end);
+#  endif
+#else
+    const std::size_t size = end - begin;
+    const unsigned int n_chunks = internal::n_static_chunks (size, grainsize);
+    internal::run_static_chunks (n_chunks,
+                                 std_cxx11::bind (&internal::apply_to_static_chunk<RangeType,Function>,
+                                                  std_cxx11::_1,
+                                                  n_chunks,
+                                                  std_cxx11::cref(begin),
+                                                  size,
+                                                  std_cxx11::cref(f)));
+#endif
+  }
+
+
+
   namespace internal
   {
 #ifdef DEAL_II_WITH_THREADS
@@ -453,6 +600,10 @@ namespace parallel
    * subranges to CPU resources than on doing
    * actual work.
    *
+   * If the partitioning mode is static_partitioning (see
+   * set_partitioning_mode()), this function does the same as
+   * apply_to_static_subranges().
+   *
    * For a discussion of the kind of
    * problems to which this function
    * is applicable, see also the
@@ -479,12 +630,15 @@ namespace parallel
     ff (begin, end);
 #  endif
 #else
-    tbb::parallel_for (tbb::blocked_range<RangeType>
-                       (begin, end, grainsize),
-                       std_cxx11::bind (&internal::apply_to_subranges<RangeType,Function>,
-                                        std_cxx11::_1,
-                                        std_cxx11::cref(f)),
-                       tbb::auto_partitioner());
+    if (get_partitioning_mode() == static_partitioning)
+      apply_to_static_subranges (begin, end, f, grainsize);
+    else
+      tbb::parallel_for (tbb::blocked_range<RangeType>
+                         (begin, end, grainsize),
+                         std_cxx11::bind (&internal::apply_to_subranges<RangeType,Function>,
+                                          std_cxx11::_1,
+                                          std_cxx11::cref(f)),
+                         tbb::auto_partitioner());
 #endif
   }
 
@@ -540,6 +694,15 @@ namespace parallel
                          const std::size_t end,
                          const std::size_t minimum_parallel_grain_size) const;
 
+    /**
+     * Same as apply_parallel(), but splits the range statically in the same
+     * way as apply_to_static_subranges(). This is used for initializing
+     * newly allocated memory on NUMA machines.
+     */
+    void apply_parallel_static (const std::size_t begin,
+                                const std::size_t end,
+                                const std::size_t minimum_parallel_grain_size) const;
+
     /**
      * Virtual function for working on subrange to
      * be defined in a derived class.  This
@@ -662,6 +825,45 @@ namespace parallel
        */
       const std_cxx11::function<ResultType (ResultType, ResultType)> reductor;
     };
+
+
+    /**
+     * Call @p f on the chunk with index @p chunk of a static partition as in
+     * apply_to_static_chunk(), and store the result in the respective
+     * element of @p results.
+     */
+    template <typename ResultType, typename RangeType, typename Function>
+    void accumulate_on_static_chunk (const unsigned int       chunk,
+                                     const unsigned int       n_chunks,
+                                     const RangeType         &begin,
+                                     const std::size_t        size,
+                                     const Function          &f,
+                                     std::vector<ResultType> &results)
+    {
+      const RangeType chunk_begin = begin + chunk * size / n_chunks;
+      const RangeType chunk_end = begin + (chunk + 1) * size / n_chunks;
+      results[chunk] = f (chunk_begin, chunk_end);
+    }
+
+
+    /**
+     * Add up the given values pairwise, i.e., in a binary tree that only
+     * depends on the number of values. The argument is overwritten.
+     */
+    template <typename ResultType>
+    ResultType pairwise_sum (std::vector<ResultType> &values)
+    {
+      std::size_t n = values.size();
+      while (n > 1)
+        {
+          for (std::size_t i=0; i<n/2; ++i)
+            values[i] = values[2*i] + values[2*i+1];
+          if (n % 2 == 1)
+            values[n/2] = values[n-1];
+          n = (n+1) / 2;
+        }
+      return values[0];
+    }
 #endif
   }
 
@@ -740,6 +942,11 @@ namespace parallel
    * several times may differ on the order of
    * round-off.
    *
+   * This does not happen if the partitioning mode is static_partitioning
+   * (see set_partitioning_mode()): the range is then split into the same
+   * chunks in every call, and their results are added up in a fixed order,
+   * so that the result is always the same for a given number of threads.
+   *
    * For a discussion of the kind of
    * problems to which this function
    * is applicable, see also the
@@ -766,6 +973,26 @@ namespace parallel
     return ff (begin, end);
 #  endif
 #else
+    if (get_partitioning_mode() == static_partitioning)
+      {
+        // compute the results on the chunks of a static partition and add
+        // them up in a fixed order, so that the result does not depend on
+        // which thread works on which chunk when
+        const std::size_t size = end - begin;
+        const unsigned int n_chunks = internal::n_static_chunks (size, grainsize);
+        std::vector<ResultType> results (n_chunks);
+        internal::run_static_chunks (n_chunks,
+                                     std_cxx11::bind (&internal::accumulate_on_static_chunk
+                                                      <ResultType,RangeType,Function>,
+                                                      std_cxx11::_1,
+                                                      n_chunks,
+                                                      std_cxx11::cref(begin),
+                                                      size,
+                                                      std_cxx11::cref(f),
+                                                      std_cxx11::ref(results)));
+        return internal::pairwise_sum (results);
+      }
+
     internal::ReductionOnSubranges<ResultType,Function>
     reductor (f, std::plus<ResultType>(), 0);
     tbb::parallel_reduce (tbb::blocked_range<RangeType>(begin, end, grainsize),
@@ -876,6 +1103,12 @@ namespace parallel
 
     apply_to_subrange (begin, end);
 #else
+    if (get_partitioning_mode() == static_partitioning)
+      {
+        apply_parallel_static (begin, end, minimum_parallel_grain_size);
+        return;
+      }
+
     internal::ParallelForWrapper worker(*this);
     tbb::parallel_for (tbb::blocked_range<std::size_t>
                        (begin, end, minimum_parallel_grain_size),
@@ -884,6 +1117,29 @@ namespace parallel
 #endif
   }
 
+
+  inline
+  void
+  ParallelForInteger::apply_parallel_static (const std::size_t begin,
+                                             const std::size_t end,
+                                             const std::size_t minimum_parallel_grain_size) const
+  {
+#ifndef DEAL_II_WITH_THREADS
+    // make sure we don't get compiler
+    // warnings about unused arguments
+    (void) minimum_parallel_grain_size;
+
+    apply_to_subrange (begin, end);
+#else
+    apply_to_static_subranges (begin, end,
+                               std_cxx11::bind (&ParallelForInteger::apply_to_subrange,
+                                                this,
+                                                std_cxx11::_1,
+                                                std_cxx11::_2),
+                               minimum_parallel_grain_size);
+#endif
+  }
+
 } // end of namespace parallel
 
 DEAL_II_NAMESPACE_CLOSE
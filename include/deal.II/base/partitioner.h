@@ -22,6 +22,7 @@
 #include <deal.II/base/types.h>
 #include <deal.II/base/utilities.h>
 #include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/std_cxx11/shared_ptr.h>
 
 #include <limits>
 
@@ -59,6 +60,14 @@ namespace Utilities
      * n_ghost_indices). The ghost indices are sorted according to their
      * global index.
      *
+     * Optionally, the partitioner determines which of the processors it
+     * exchanges data with reside on the same shared memory node as the
+     * current processor. For these, parallel::distributed::Vector reads the
+     * ghost values directly from the memory of the owning processor through
+     * an MPI-3 shared memory window, instead of sending them through MPI
+     * messages. See the constructor taking the @p
+     * shared_memory_ghost_exchange argument.
+     *
      *
      * @author Katharina Kormann, Martin Kronbichler, 2010, 2011
      */
@@ -91,6 +100,30 @@ namespace Utilities
                    const IndexSet &ghost_indices_in,
                    const MPI_Comm  communicator_in);
 
+      /**
+       * Same as the previous constructor, but if @p
+       * shared_memory_ghost_exchange is true, additionally find out which of
+       * the processors that own ghost indices of the current processor, or
+       * that have ghost indices owned by it, are on the same shared memory
+       * node (using <code>MPI_Comm_split_type</code>). The ghost values of
+       * parallel::distributed::Vector objects based on this partitioner are
+       * then exchanged through shared memory between these processors, which
+       * saves the copies into and out of MPI message buffers. Data exchange
+       * with processors on other nodes, and the compress() operation, use MPI
+       * messages as before.
+       *
+       * Vectors based on such a partitioner allocate a shared memory window
+       * when they are initialized, which is a collective operation among all
+       * processors on the same node. Thus, these vectors must be created,
+       * initialized, and destroyed on all processors at the same time, which
+       * is the case for the usual ways of using vectors in SPMD programs. The
+       * flag is ignored if MPI does not support version 3 of the standard.
+       */
+      Partitioner (const IndexSet &locally_owned_indices,
+                   const IndexSet &ghost_indices_in,
+                   const MPI_Comm  communicator_in,
+                   const bool      shared_memory_ghost_exchange);
+
       /**
        * Constructor with one index set argument. This
        * constructor creates a distributed layout
@@ -217,7 +250,11 @@ namespace Utilities
        * ghosts that belong to the local
        * range. Similar structure as in an IndexSet,
        * but tailored to be iterated over, and some
-       * indices may be duplicates.
+       * indices may be duplicates. Each entry is a
+       * half-open range [first,second) of
+       * contiguous indices, which allows to pack and
+       * unpack the data of a whole range with one
+       * copy operation.
        */
       const std::vector<std::pair<types::global_dof_index, types::global_dof_index> > &
       import_indices() const;
@@ -278,6 +315,51 @@ namespace Utilities
        */
       const MPI_Comm &get_communicator() const;
 
+      /**
+       * Return whether ghost values are exchanged through shared memory with
+       * processors on the same node, see the constructor with the @p
+       * shared_memory_ghost_exchange argument. This is only the case if the
+       * option was requested, MPI supports it, and there is more than one
+       * processor.
+       */
+      bool use_shared_memory_ghost_exchange () const;
+
+      /**
+       * Return the communicator of all processors on the same shared memory
+       * node as the current one, a subset of get_communicator(). Only
+       * available if use_shared_memory_ghost_exchange() returns true.
+       */
+      const MPI_Comm &get_shared_memory_communicator () const;
+
+      /**
+       * For each entry of ghost_targets(), return the rank of the owning
+       * processor in get_shared_memory_communicator(), or
+       * numbers::invalid_unsigned_int if it is on a different node. Empty
+       * unless use_shared_memory_ghost_exchange() returns true.
+       */
+      const std::vector<unsigned int> &
+      ghost_targets_shared_memory_ranks () const;
+
+      /**
+       * For each entry of ghost_targets() on the same node, return the
+       * position at which the values for the current processor start in the
+       * array of the import indices of the owning processor, which is how
+       * they are laid out in the send buffer of
+       * parallel::distributed::Vector. Undefined for processors on different
+       * nodes.
+       */
+      const std::vector<types::global_dof_index> &
+      ghost_targets_shared_memory_offsets () const;
+
+      /**
+       * For each entry of import_targets(), return the rank of the importing
+       * processor in get_shared_memory_communicator(), or
+       * numbers::invalid_unsigned_int if it is on a different node. Empty
+       * unless use_shared_memory_ghost_exchange() returns true.
+       */
+      const std::vector<unsigned int> &
+      import_targets_shared_memory_ranks () const;
+
       /**
        * Computes the memory consumption of this
        * structure.
@@ -373,6 +455,45 @@ namespace Utilities
        * problem
        */
       const MPI_Comm communicator;
+
+      /**
+       * Whether the exchange of ghost values through shared memory was
+       * requested in the constructor.
+       */
+      const bool shared_memory_ghost_exchange;
+
+      /**
+       * The communicator of the processors on the same node. It is held by a
+       * shared pointer that frees the communicator once the last copy of
+       * this object is gone, and is empty if no shared memory exchange is
+       * done.
+       */
+      std_cxx11::shared_ptr<MPI_Comm> shared_memory_communicator;
+
+      /**
+       * The ranks of the ghost targets on the same node in the shared memory
+       * communicator, see ghost_targets_shared_memory_ranks().
+       */
+      std::vector<unsigned int> ghost_targets_shared_ranks;
+
+      /**
+       * The offsets into the import data of the ghost targets on the same
+       * node, see ghost_targets_shared_memory_offsets().
+       */
+      std::vector<types::global_dof_index> ghost_targets_shared_offsets;
+
+      /**
+       * The ranks of the import targets on the same node in the shared memory
+       * communicator, see import_targets_shared_memory_ranks().
+       */
+      std::vector<unsigned int> import_targets_shared_ranks;
+
+      /**
+       * Find the processors on the same node among the ghost and import
+       * targets and set up the fields above. Called at the end of
+       * set_ghost_indices().
+       */
+      void setup_shared_memory_ghost_exchange ();
     };
 
 
@@ -579,6 +700,52 @@ namespace Utilities
       return communicator;
     }
 
+
+
+    inline
+    bool
+    Partitioner::use_shared_memory_ghost_exchange () const
+    {
+      return shared_memory_communicator.get() != 0;
+    }
+
+
+
+    inline
+    const MPI_Comm &
+    Partitioner::get_shared_memory_communicator () const
+    {
+      Assert (use_shared_memory_ghost_exchange(), ExcNotInitialized());
+      return *shared_memory_communicator;
+    }
+
+
+
+    inline
+    const std::vector<unsigned int> &
+    Partitioner::ghost_targets_shared_memory_ranks () const
+    {
+      return ghost_targets_shared_ranks;
+    }
+
+
+
+    inline
+    const std::vector<types::global_dof_index> &
+    Partitioner::ghost_targets_shared_memory_offsets () const
+    {
+      return ghost_targets_shared_offsets;
+    }
+
+
+
+    inline
+    const std::vector<unsigned int> &
+    Partitioner::import_targets_shared_memory_ranks () const
+    {
+      return import_targets_shared_ranks;
+    }
+
 #endif  // ifndef DOXYGEN
 
   } // end of namespace MPI
@@ -18,7 +18,9 @@
 
 #include <deal.II/base/config.h>
 #include <deal.II/base/conditional_ostream.h>
+#include <deal.II/base/hardware_counters.h>
 #include <deal.II/base/thread_management.h>
+#include <deal.II/base/thread_local_storage.h>
 #include <deal.II/base/utilities.h>
 
 #ifdef DEAL_II_WITH_MPI
@@ -28,6 +30,7 @@
 #include <string>
 #include <list>
 #include <map>
+#include <vector>
 
 DEAL_II_NAMESPACE_OPEN
 
@@ -259,7 +262,6 @@ private:
 
 
 
-//TODO: The following class is not thread-safe
 /**
  * This class can be used to generate formatted output from time
  * measurements of different subsections in a program. It is possible to
@@ -415,6 +417,76 @@ private:
  * See the step-32 and step-40 tutorial programs for this kind of usage
  * of this class.
  *
+ *
+ * <h3>Nested sections, threads and section handles</h3>
+ *
+ * Sections may be entered while other sections are active. Besides the
+ * flat table generated by print_summary(), which adds up all times spent
+ * in a section regardless of where it was entered, the class records a call
+ * tree in which a section entered inside another one is a child of the
+ * latter. The tree is printed by print_tree() and can be written in JSON
+ * format by write_json(), for example for further processing by scripts:
+ * @code
+ *   {
+ *     TimerOutput::Scope timer_section(timer, "Assemble");
+ *     {
+ *       TimerOutput::Scope timer_section(timer, "Cell loop");
+ *       ...
+ *     }
+ *     {
+ *       TimerOutput::Scope timer_section(timer, "Compress");
+ *       ...
+ *     }
+ *   }
+ *   timer.print_tree ();
+ * @endcode
+ *
+ * The sections that are currently active, and the times accumulated in
+ * them, are kept separately for every thread. Several threads may thus be
+ * in the same section at the same time, for example in the worker function
+ * of WorkStream::run(), without contending for a lock. A section entered on
+ * a worker thread is attributed to the root of the tree, since the sections
+ * active on the thread that spawned the work are not known there. Times of
+ * the same section on different threads are added up, so they may exceed
+ * the wall time of the program. A section may also be left by name on a
+ * different thread than the one that entered it, for example when a task
+ * finishes on another worker thread.
+ *
+ * The CPU times in the call tree are those of the threads that were in the
+ * section, as far as the operating system provides them (through
+ * <tt>RUSAGE_THREAD</tt> on Linux). If a section is left on another thread
+ * than the one that entered it, the CPU time of the whole process during
+ * the section is recorded instead. The CPU times shown by print_summary()
+ * and when leaving a section are always those of the whole process
+ * including all worker threads, as for the Timer class.
+ *
+ * Looking up a section by its name requires a string comparison and a
+ * lock. In performance critical places, a section can be registered once
+ * with register_section(), and the returned handle used to enter it, which
+ * does neither.
+ *
+ * If the object was created with an MPI communicator, print_tree() and
+ * write_json() report minimum, average and maximum of the times over all
+ * processes, computed with Utilities::MPI::min_max_avg(). These functions
+ * are then collective, and must be called on all processes of the
+ * communicator.
+ *
+ * With an MPI communicator, entering and leaving a section on the thread
+ * that created the object are collective operations as well: entering a
+ * section places a barrier, and leaving it adds up the CPU times and takes
+ * the maximum of the wall times over all processes for print_summary().
+ * Sections entered and left on other threads, for example in the worker
+ * function of WorkStream::run(), do not communicate, since the number of
+ * times they are entered may differ between processes. print_summary()
+ * then reports the times of the present process for them.
+ *
+ * While the instrumentation of the HardwareCounters namespace is enabled,
+ * every section is also recorded as a region of that namespace with the
+ * name of the section, so that the roofline summary printed by
+ * HardwareCounters::print_summary() contains the sections of all
+ * TimerOutput objects. In the same way, every section is recorded as a phase
+ * of the MemoryProfiler namespace while memory profiling is enabled.
+ *
  * @ingroup utilities
  * @author M. Kronbichler, 2009.
  */
@@ -435,6 +507,13 @@ public:
      */
     Scope(dealii::TimerOutput &timer_, const std::string &section_name);
 
+    /**
+     * Enter the section with the given handle, obtained from
+     * TimerOutput::register_section(). Exit automatically when calling
+     * stop() or destructor runs.
+     */
+    Scope(dealii::TimerOutput &timer_, const unsigned int section);
+
     /**
      * Destructor calls stop()
      */
@@ -586,12 +665,33 @@ public:
    */
   void enter_section (const std::string &section_name);
 
+  /**
+   * Register a section with the given name, without entering it, and
+   * return a handle that can be passed to enter_subsection() or to the
+   * constructor of the Scope class. Entering a section through its handle
+   * avoids looking up the name. If the section already exists, its handle
+   * is returned. Handles stay valid until the object is destroyed, also
+   * across calls to reset().
+   */
+  unsigned int register_section (const std::string &section_name);
+
+  /**
+   * Open the section with the given handle, obtained from
+   * register_section(). This is the same as calling enter_subsection()
+   * with the name of the section, but does not need to look up the name.
+   */
+  void enter_subsection (const unsigned int section);
+
   //TODO: make some of these functions DEPRECATED (I would keep enter/exit_section)
 
   /**
    * Leave a section. If no name is given,
-   * the last section that was entered is
-   * left.
+   * the last section that was entered on
+   * the current thread is left. Otherwise,
+   * the named section is left on the
+   * current thread if it is active there,
+   * and else on the thread that entered
+   * it.
    */
   void leave_subsection (const std::string &section_name = std::string());
 
@@ -607,6 +707,30 @@ public:
    */
   void print_summary () const;
 
+  /**
+   * Print the call tree of the sections, in which sections entered while
+   * another section was active appear indented below the latter, with the
+   * number of calls and the times spent in them. CPU times are shown if the
+   * object was created with TimerOutput::cpu_times, and wall times
+   * otherwise. If the object was
+   * created with an MPI communicator, minimum, average and maximum of the
+   * times over all processes are shown, and the function must be called on
+   * all processes.
+   */
+  void print_tree () const;
+
+  /**
+   * Write the call tree of the sections to the given stream in JSON
+   * format. Every node contains the name of the section, the number of
+   * calls, the number of threads that entered it, minimum, average and
+   * maximum of the CPU and wall times over all MPI processes (all three
+   * are the same without an MPI communicator), and the list of its
+   * children. If the object was created with an MPI communicator, the
+   * function must be called on all processes, and output is only written
+   * on the first one.
+   */
+  void write_json (std::ostream &stream) const;
+
   /**
    * By calling this function, all output
    * can be disabled. This function
@@ -658,23 +782,139 @@ private:
   Timer              timer_all;
 
   /**
-   * A structure that groups all
-   * information that we collect
-   * about each of the sections.
+   * The names of all sections registered so far. The handle of a section
+   * is its index in this array.
+   */
+  std::vector<std::string> section_names;
+
+  /**
+   * A map from the names of the sections to their handles.
    */
-  struct Section
+  std::map<std::string, unsigned int> section_handles;
+
+  /**
+   * A node of the call tree. Every node corresponds to a section entered
+   * with a particular set of enclosing sections.
+   */
+  struct TreeNode
   {
-    Timer  timer;
-    double total_cpu_time;
-    double total_wall_time;
+    /**
+     * Constructor.
+     */
+    TreeNode (const unsigned int section);
+
+    /**
+     * The handle of the section.
+     */
+    unsigned int section;
+
+    /**
+     * Pairs of section handles and indices of the nodes of the sections
+     * entered while this one was active.
+     */
+    std::vector<std::pair<unsigned int,unsigned int> > children;
+
+    /**
+     * Number of times this node was entered, and the CPU time of the
+     * threads in it and the wall time spent in it on the present process.
+     */
     unsigned int n_calls;
+    double       cpu_time;
+    double       wall_time;
+
+    /**
+     * The CPU and wall time as reported by print_summary(). The CPU time is
+     * that of the whole process while the section was active. If the
+     * object was created with an MPI communicator, these are the sum of CPU
+     * times and the maximum of the wall times over all processes.
+     */
+    double       summary_cpu_time;
+    double       summary_wall_time;
+  };
+
+  /**
+   * A section that is currently active, with the CPU time of the process
+   * and of the thread and the wall time when it was entered. If hardware
+   * counters were enabled at that time, the section is also recorded as a
+   * region of the HardwareCounters namespace, starting with the given
+   * counter values, and likewise as a phase of the MemoryProfiler namespace
+   * if that was enabled.
+   */
+  struct ActiveSection
+  {
+    unsigned int                   node;
+    double                         cpu_start;
+    double                         thread_cpu_start;
+    double                         wall_start;
+    bool                           record_counters;
+    HardwareCounters::Sample       counters_start;
+    bool                           record_memory;
+    Utilities::System::MemoryStats memory_start;
+  };
+
+  /**
+   * The information kept for every thread: the call tree, with the root
+   * node at index zero, and the stack of active sections.
+   */
+  struct ThreadData
+  {
+    /**
+     * Constructor. Creates the root node.
+     */
+    ThreadData ();
+
+    std::vector<TreeNode>      nodes;
+    std::vector<ActiveSection> active_sections;
+
+    /**
+     * Whether this object has been added to TimerOutput::threads.
+     */
+    bool                       registered;
+
+    /**
+     * A mutex for the data above. It is only contended if another thread
+     * leaves a section entered on this thread, or generates output.
+     */
+    Threads::Mutex             mutex;
   };
 
   /**
-   * A list of all the sections and
-   * their information.
+   * The data of all threads that have used this object. Declared mutable
+   * since we need to loop over the data of all threads when generating
+   * output.
    */
-  std::map<std::string, Section> sections;
+  mutable Threads::ThreadLocalStorage<ThreadData> thread_data;
+
+  /**
+   * Pointers to the data of all threads that have used this object, in the
+   * order in which they first did so. Access is guarded by the mutex of
+   * this class.
+   */
+  std::vector<ThreadData *> threads;
+
+  /**
+   * Return the data of the calling thread, and register it in the
+   * threads array on first use.
+   */
+  ThreadData &get_thread_data ();
+
+  /**
+   * Leave the section at the given position of the stack of active
+   * sections of the given thread, whose mutex must be held by the caller.
+   * @p same_thread indicates whether this is the thread that entered the
+   * section.
+   */
+  void leave_active_section (ThreadData        &data,
+                             const unsigned int position,
+                             const bool         same_thread);
+
+  /**
+   * Add up the call trees of all threads, and return a map from the path
+   * of every node, i.e., the names of the enclosing sections and the
+   * section itself separated by a special character, to the accumulated
+   * number of calls, number of threads, CPU and wall time.
+   */
+  std::map<std::string, std::vector<double> > collect_call_tree () const;
 
   /**
    * The stream object to which we
@@ -690,29 +930,24 @@ private:
   bool output_is_enabled;
 
   /**
-   * A list of the sections that
-   * have been entered and not
-   * exited. The list is kept in
-   * the order in which sections
-   * have been entered, but
-   * elements may be removed in the
-   * middle if an argument is given
-   * to the exit_section()
-   * function.
+   * mpi communicator
    */
-  std::list<std::string> active_sections;
+  MPI_Comm            mpi_communicator;
 
   /**
-   * mpi communicator
+   * The id of the thread that created this object, as returned by
+   * Threads::this_thread_id(). Only this thread takes part in the
+   * collective operations on @p mpi_communicator when entering and leaving
+   * sections.
    */
-  MPI_Comm            mpi_communicator;
+  const unsigned int  creator_thread;
 
   /**
-   * A lock that makes sure that this
-   * class gives reasonable results even
-   * when used with several threads.
+   * A lock that protects the list of
+   * section names and the output
+   * stream.
    */
-  Threads::Mutex mutex;
+  mutable Threads::Mutex mutex;
 };
 
 
@@ -782,6 +1017,14 @@ TimerOutput::Scope::Scope(dealii::TimerOutput &timer_, const std::string &sectio
   timer.enter_section(section_name);
 }
 
+inline
+TimerOutput::Scope::Scope(dealii::TimerOutput &timer_, const unsigned int section)
+  :
+  timer(timer_), in(true)
+{
+  timer.enter_subsection(section);
+}
+
 inline
 TimerOutput::Scope::~Scope()
 {
@@ -19,6 +19,7 @@
 
 #include <deal.II/base/config.h>
 #include <deal.II/base/graph_coloring.h>
+#include <deal.II/base/hardware_counters.h>
 #include <deal.II/base/multithread_info.h>
 #include <deal.II/base/thread_management.h>
 #include <deal.II/base/template_constraints.h>
@@ -29,7 +30,9 @@
 
 #ifdef DEAL_II_WITH_THREADS
 #  include <deal.II/base/thread_management.h>
+#  include <tbb/atomic.h>
 #  include <tbb/pipeline.h>
+#  include <tbb/task.h>
 #endif
 
 #include <vector>
@@ -125,6 +128,13 @@ DEAL_II_NAMESPACE_OPEN
  * are considered unused and may be re-used for the next invokation of
  * the worker function, on this or another thread.
  *
+ * Since ScratchData and CopyData objects are re-used, their members that
+ * are only re-sized, rather than re-created, for each item do not allocate
+ * memory once the first items have been processed. Temporary arrays whose
+ * size differs from item to item can be taken from a MemoryArena that is
+ * a member of the ScratchData object and that the worker function resets
+ * at its beginning; see there for an example.
+ *
  * The functions in this namespace only really work in parallel when
  * multithread mode was selected during deal.II configuration. Otherwise they
  * simply work on each item sequentially.
@@ -1320,12 +1330,280 @@ namespace WorkStream
       };
     }
 
+
+    /**
+     * A namespace for the implementation of WorkStream::run_as_task_graph().
+     * Every item becomes a task that is started as soon as the items of
+     * earlier colors it conflicts with have been finished, rather than
+     * after all items of the previous color have been finished.
+     */
+    namespace TaskGraph
+    {
+      /**
+       * A class that runs the worker and copier on the items of a graph
+       * of dependencies as computed by make_dependencies(), starting
+       * every item as a TBB task as soon as all of its predecessors are
+       * done.
+       */
+      template <typename Iterator,
+                typename ScratchData,
+                typename CopyData>
+      class Executor
+      {
+      public:
+        /**
+         * Constructor.
+         */
+        Executor (const std::vector<const Iterator *>           &items,
+                  const std::vector<std::vector<unsigned int> > &successors,
+                  const std::vector<unsigned int>               &n_predecessors,
+                  const std_cxx11::function<void (const Iterator &,
+                                                  ScratchData &,
+                                                  CopyData &)> &worker,
+                  const std_cxx11::function<void (const CopyData &)> &copier,
+                  const ScratchData                             &sample_scratch_data,
+                  const CopyData                                &sample_copy_data)
+          :
+          items (items),
+          successors (successors),
+          n_pending_predecessors (n_predecessors.size()),
+          worker (worker),
+          copier (copier),
+          sample_scratch_data (sample_scratch_data),
+          sample_copy_data (sample_copy_data)
+        {
+          for (unsigned int i=0; i<n_predecessors.size(); ++i)
+            n_pending_predecessors[i] = n_predecessors[i];
+        }
+
+
+        /**
+         * Start the items without predecessors and wait until all items
+         * are done.
+         */
+        void run ()
+        {
+          tbb::empty_task *root = new (tbb::task::allocate_root()) tbb::empty_task;
+          root->set_ref_count (1);
+          for (unsigned int item=0; item<items.size(); ++item)
+            if (n_pending_predecessors[item] == 0)
+              spawn (item, *root);
+          root->wait_for_all ();
+          tbb::task::destroy (*root);
+        }
+
+      private:
+        /**
+         * The task for one item.
+         */
+        class ItemTask : public tbb::task
+        {
+        public:
+          ItemTask (Executor           &executor,
+                    const unsigned int  item,
+                    tbb::task          &root)
+            :
+            executor (executor),
+            item (item),
+            root (root)
+          {}
+
+          virtual tbb::task *execute ()
+          {
+            executor.work_on (item, root);
+            return 0;
+          }
+
+        private:
+          Executor           &executor;
+          const unsigned int  item;
+          tbb::task          &root;
+        };
+
+
+        /**
+         * Create a task for the given item as a child of @p root and
+         * spawn it.
+         */
+        void spawn (const unsigned int item,
+                    tbb::task         &root)
+        {
+          tbb::task &task
+            = *new (tbb::task::allocate_additional_child_of (root))
+            ItemTask (*this, item, root);
+          tbb::task::spawn (task);
+        }
+
+
+        /**
+         * Run the worker and the copier on the given item and then start
+         * all items that were only waiting for this one.
+         */
+        void work_on (const unsigned int item,
+                      tbb::task         &root)
+        {
+          // find an unused scratch and copy data object of this thread, or
+          // create one, as in ParallelFor::Worker. a worker may itself wait
+          // for tasks and the thread may therefore start another item in
+          // the meantime, so the objects can not simply be thread-local
+          ScratchData *scratch_data = 0;
+          CopyData    *copy_data    = 0;
+          {
+            ScratchAndCopyDataList &scratch_and_copy_data_list = data.get();
+
+            for (typename ScratchAndCopyDataList::iterator
+                 p = scratch_and_copy_data_list.begin();
+                 p != scratch_and_copy_data_list.end(); ++p)
+              if (p->currently_in_use == false)
+                {
+                  scratch_data = p->scratch_data.get();
+                  copy_data    = p->copy_data.get();
+                  p->currently_in_use = true;
+                  break;
+                }
+
+            if (scratch_data == 0)
+              {
+                Assert (copy_data==0, ExcInternalError());
+                scratch_data = new ScratchData(sample_scratch_data);
+                copy_data    = new CopyData(sample_copy_data);
+
+                typename ScratchAndCopyDataList::value_type
+                new_scratch_object (scratch_data, copy_data, true);
+                scratch_and_copy_data_list.push_back (new_scratch_object);
+              }
+          }
+
+          try
+            {
+              if (worker)
+                worker (*items[item], *scratch_data, *copy_data);
+              if (copier)
+                copier (*copy_data);
+            }
+          catch (const std::exception &exc)
+            {
+              Threads::internal::handle_std_exception (exc);
+            }
+          catch (...)
+            {
+              Threads::internal::handle_unknown_exception ();
+            }
+
+          {
+            ScratchAndCopyDataList &scratch_and_copy_data_list = data.get();
+
+            for (typename ScratchAndCopyDataList::iterator p =
+                   scratch_and_copy_data_list.begin();
+                 p != scratch_and_copy_data_list.end(); ++p)
+              if (p->scratch_data.get() == scratch_data)
+                {
+                  Assert(p->currently_in_use == true, ExcInternalError());
+                  p->currently_in_use = false;
+                }
+          }
+
+          // the last predecessor to finish starts the successor
+          for (unsigned int i=0; i<successors[item].size(); ++i)
+            if (--n_pending_predecessors[successors[item][i]] == 0)
+              spawn (successors[item][i], root);
+        }
+
+
+        typedef
+        typename Implementation3::IteratorRangeToItemStream<Iterator,ScratchData,CopyData>::ItemType::ScratchAndCopyDataList
+        ScratchAndCopyDataList;
+
+        const std::vector<const Iterator *>           &items;
+        const std::vector<std::vector<unsigned int> > &successors;
+
+        /**
+         * The number of predecessors of each item that have not been
+         * finished yet.
+         */
+        std::vector<tbb::atomic<unsigned int> >        n_pending_predecessors;
+
+        Threads::ThreadLocalStorage<ScratchAndCopyDataList> data;
+
+        const std_cxx11::function<void (const Iterator &,
+                                        ScratchData &,
+                                        CopyData &)> worker;
+        const std_cxx11::function<void (const CopyData &)> copier;
+
+        const ScratchData    &sample_scratch_data;
+        const CopyData       &sample_copy_data;
+      };
+    }
+
   }
 
 
 #endif // DEAL_II_WITH_THREADS
 
 
+  namespace internal
+  {
+    namespace TaskGraph
+    {
+      /**
+       * Number the items color by color and compute, for every item, the
+       * items that must wait for it. For every conflict index, an item
+       * depends on the item that last wrote to this index, which results in
+       * a chain of items through every conflict index in the order of the
+       * colors. The number of items each item waits for is returned in
+       * @p n_predecessors.
+       */
+      template <typename Iterator>
+      void
+      make_dependencies (const std::vector<std::vector<Iterator> > &colored_iterators,
+                         const std_cxx11::function<std::vector<types::global_dof_index> (const Iterator &)> &get_conflict_indices,
+                         std::vector<const Iterator *>             &items,
+                         std::vector<std::vector<unsigned int> >    &successors,
+                         std::vector<unsigned int>                  &n_predecessors)
+      {
+        items.clear ();
+        for (unsigned int color=0; color<colored_iterators.size(); ++color)
+          for (typename std::vector<Iterator>::const_iterator
+               p = colored_iterators[color].begin();
+               p != colored_iterators[color].end(); ++p)
+            items.push_back (&*p);
+
+        successors.clear ();
+        successors.resize (items.size());
+        n_predecessors.clear ();
+        n_predecessors.resize (items.size(), 0);
+
+        std::vector<unsigned int> last_item;
+        for (unsigned int item=0; item<items.size(); ++item)
+          {
+            const std::vector<types::global_dof_index> conflict_indices
+              = get_conflict_indices (*items[item]);
+            for (unsigned int i=0; i<conflict_indices.size(); ++i)
+              {
+                const types::global_dof_index index = conflict_indices[i];
+                if (index >= last_item.size())
+                  last_item.resize (index+1, numbers::invalid_unsigned_int);
+
+                // add an edge unless the same edge was already added for
+                // another index shared with the same item, in which case
+                // it is the last one in the list of successors
+                const unsigned int predecessor = last_item[index];
+                if (predecessor != numbers::invalid_unsigned_int &&
+                    predecessor != item &&
+                    (successors[predecessor].size() == 0 ||
+                     successors[predecessor].back() != item))
+                  {
+                    successors[predecessor].push_back (item);
+                    ++n_predecessors[item];
+                  }
+                last_item[index] = item;
+              }
+          }
+      }
+    }
+  }
+
+
   /**
    * This is one of two main functions of the WorkStream concept, doing work as
    * described in the introduction to this namespace. It corresponds to
@@ -1438,6 +1716,8 @@ namespace WorkStream
     if (!(begin != end))
       return;
 
+    HardwareCounters::Scope counter_scope ("WorkStream::run");
+
     // we want to use TBB if we have support and if it is not disabled at
     // runtime:
 #ifdef DEAL_II_WITH_THREADS
@@ -1544,6 +1824,8 @@ namespace WorkStream
             ExcMessage ("The chunk_size must be at least one."));
     (void)chunk_size; // removes -Wunused-parameter warning in optimized mode
 
+    HardwareCounters::Scope counter_scope ("WorkStream::run");
+
     // we want to use TBB if we have support and if it is not disabled at
     // runtime:
 #ifdef DEAL_II_WITH_THREADS
@@ -1639,6 +1921,90 @@ namespace WorkStream
 
 
 
+  /**
+   * A variant of the run() function for colored iterators that does not
+   * wait for all items of one color to be done before starting the items
+   * of the next color. Instead, every item becomes a task that is started
+   * as soon as all items of earlier colors it conflicts with are done,
+   * where two items conflict if the function @p get_conflict_indices
+   * returns a common index for them. This is the function that was used to
+   * compute the coloring with GraphColoring::make_graph_coloring(). Since
+   * the items in the last part of one color can then be worked on together
+   * with those of the next color that do not depend on them, threads do not
+   * sit idle at the end of every color, which matters if the colors are
+   * small or their items take differing amounts of time.
+   *
+   * The worker and the copier are called one after the other on the same
+   * thread for every item, and two items that conflict are worked on in
+   * the order of their colors, so the copier may write into global objects
+   * without a lock as in the run() function.
+   *
+   * Setting up the graph calls @p get_conflict_indices once for every item
+   * and takes memory proportional to the number of items plus the largest
+   * conflict index.
+   *
+   * @note This function does not take the @p queue_length and
+   * @p chunk_size arguments of run(): every item is a task of its own,
+   * and each thread creates as many ScratchData and CopyData objects as it
+   * works on items at the same time, usually just one.
+   */
+  template <typename Worker,
+            typename Copier,
+            typename Iterator,
+            typename ScratchData,
+            typename CopyData>
+  void
+  run_as_task_graph (const std::vector<std::vector<Iterator> > &colored_iterators,
+                     const std_cxx11::function<std::vector<types::global_dof_index> (const typename identity<Iterator>::type &)> &get_conflict_indices,
+                     Worker                                     worker,
+                     Copier                                     copier,
+                     const ScratchData                         &sample_scratch_data,
+                     const CopyData                            &sample_copy_data)
+  {
+#ifdef DEAL_II_WITH_THREADS
+    if (multithread_info.n_threads()==1)
+#endif
+      {
+        // there is no need for the graph with one thread, so do exactly
+        // what run() does
+        (void)get_conflict_indices;
+        run (colored_iterators, worker, copier,
+             sample_scratch_data, sample_copy_data);
+      }
+#ifdef DEAL_II_WITH_THREADS
+    else
+      {
+        HardwareCounters::Scope counter_scope ("WorkStream::run");
+
+        std::vector<const Iterator *>           items;
+        std::vector<std::vector<unsigned int> > successors;
+        std::vector<unsigned int>               n_predecessors;
+        internal::TaskGraph::make_dependencies (colored_iterators,
+                                                get_conflict_indices,
+                                                items, successors,
+                                                n_predecessors);
+
+        // convert the worker and copier into function objects, which are
+        // empty if they are zero function pointers
+        const std_cxx11::function<void (const Iterator &, ScratchData &, CopyData &)>
+        worker_function = worker;
+        const std_cxx11::function<void (const CopyData &)> copier_function = copier;
+        Assert (worker_function || copier_function,
+                ExcMessage ("It makes no sense to call this function with "
+                            "empty functions for both the worker and the "
+                            "copier!"));
+
+        internal::TaskGraph::Executor<Iterator,ScratchData,CopyData>
+        executor (items, successors, n_predecessors,
+                  worker_function, copier_function,
+                  sample_scratch_data, sample_copy_data);
+        executor.run ();
+      }
+#endif
+  }
+
+
+
 
 
   /**
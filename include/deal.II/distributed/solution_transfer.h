@@ -98,6 +98,21 @@ namespace parallel
     @endcode
      *
      *
+     * <h3>Transferring many vectors</h3>
+     *
+     * All vectors given to prepare_for_coarsening_and_refinement() or
+     * prepare_serialization() are stored in one record per cell that is
+     * filled in a single pass over the cells. On cells that are neither
+     * coarsened nor refined, the degree of freedom indices of a cell are
+     * looked up only once for all vectors, so that the cost of the transfer
+     * is dominated by the amount of data rather than the number of vectors.
+     * The data is attached to the cells of the p4est forest with a fixed
+     * size per cell, namely get_data_size() times the number of vectors. To
+     * halve this size when transferring many vectors, e.g. old time steps or
+     * history variables, the values can be stored in single precision, see
+     * the constructor. This of course introduces a relative error of the
+     * order of the single precision roundoff into the transferred vectors.
+     *
      * <h3>Interaction with hanging nodes</h3>
      *
      * In essence, this class implements the same steps as does
@@ -115,9 +130,16 @@ namespace parallel
     public:
       /**
        * Constructor, takes the current DoFHandler
-       * as argument.
+       * as argument. If @p store_in_single_precision
+       * is true, the values of the vectors are
+       * stored as <tt>float</tt> while being
+       * transferred, which halves the amount of
+       * data attached to the cells. Objects used for
+       * serialization and deserialization must use
+       * the same setting.
        */
-      SolutionTransfer(const DH &dof);
+      SolutionTransfer(const DH   &dof,
+                       const bool  store_in_single_precision = false);
       /**
        * Destructor.
        */
@@ -170,7 +192,7 @@ namespace parallel
 
       /**
        * Return the size in bytes that need
-       * to be stored per cell.
+       * to be stored per cell and vector.
        */
       unsigned int get_data_size() const;
 
@@ -230,6 +252,13 @@ namespace parallel
        */
       std::vector<const VECTOR *> input_vectors;
 
+      /**
+       * Whether the values are stored in
+       * single precision while being
+       * transferred.
+       */
+      const bool store_in_single_precision;
+
       /**
        * The offset that the
        * Triangulation has assigned
@@ -252,6 +281,17 @@ namespace parallel
                          const typename Triangulation<dim,dim>::CellStatus status,
                          void *data);
 
+      /**
+       * Write the values of all input
+       * vectors on @p cell into @p data,
+       * converted to @p Number. Used by
+       * pack_callback().
+       */
+      template <typename Number>
+      void pack_values(const typename DH::cell_iterator &cell,
+                       const typename Triangulation<dim,dim>::CellStatus status,
+                       void *data) const;
+
       /**
        * A callback function used
        * to unpack the data on the
@@ -266,6 +306,18 @@ namespace parallel
                            const void *data,
                            std::vector<VECTOR *> &all_out);
 
+      /**
+       * Read the values of all vectors on
+       * @p cell, stored as @p Number, from
+       * @p data and write them into @p
+       * all_out. Used by unpack_callback().
+       */
+      template <typename Number>
+      void unpack_values(const typename DH::cell_iterator &cell,
+                         const typename Triangulation<dim,dim>::CellStatus status,
+                         const void *data,
+                         std::vector<VECTOR *> &all_out) const;
+
 
       /**
        *
@@ -21,6 +21,7 @@
 #include <deal.II/base/subscriptor.h>
 #include <deal.II/base/smartpointer.h>
 #include <deal.II/base/template_constraints.h>
+#include <deal.II/base/mpi.h>
 #include <deal.II/grid/tria.h>
 
 #include <deal.II/base/std_cxx11/function.h>
@@ -696,6 +697,93 @@ namespace parallel
                                                               const CellStatus,
                                                               const void *)> &unpack_callback);
 
+      /**
+       * A combiner for boost::signals2 signals that returns the sum of the
+       * values returned by all connected slots. It is used for the
+       * cell_weight signal, so that several objects can each add the cost
+       * they incur on a cell.
+       */
+      template <typename T>
+      struct CellWeightSum
+      {
+        typedef T result_type;
+
+        template <typename InputIterator>
+        T operator() (InputIterator first,
+                      InputIterator last) const
+        {
+          T sum = T();
+          for (; first != last; ++first)
+            sum += *first;
+          return sum;
+        }
+      };
+
+      /**
+       * Signals that are triggered when the mesh is partitioned between the
+       * processors.
+       */
+      struct PartitionSignals
+      {
+        /**
+         * This signal is triggered for every locally owned cell before the
+         * mesh is partitioned in execute_coarsening_and_refinement() and
+         * repartition(), and is used to determine the computational cost of
+         * the cell. Each cell has a base weight of 1000, to which the sum of
+         * the values returned by all connected slots is added. p4est then
+         * distributes the cells such that each processor has approximately
+         * the same sum of weights, rather than the same number of cells. If
+         * no slot is connected, all cells have the same weight.
+         *
+         * The CellStatus argument has the same meaning as for the callbacks
+         * of register_data_attach(): for a cell with status CELL_REFINE, the
+         * returned weight is used for each of its future children, and for a
+         * cell with status CELL_COARSEN the signal is called on the parent
+         * whose children are about to be coarsened away.
+         *
+         * Since the partitioning is a collective operation, slots need to be
+         * connected to this signal either on all processors or on none.
+         */
+        boost::signals2::signal<unsigned int (const cell_iterator &,
+                                              const CellStatus),
+                                CellWeightSum<unsigned int> > cell_weight;
+      };
+
+      /**
+       * Signals for the partitioning of the mesh.
+       */
+      mutable PartitionSignals partition_signals;
+
+      /**
+       * Redistribute the active cells between processors without refining or
+       * coarsening the mesh, using the weights returned by the
+       * PartitionSignals::cell_weight signal. This is useful if the cost of
+       * cells has changed without a change of the mesh, for example when the
+       * polynomial degree of some cells is changed in an hp computation.
+       *
+       * Data registered with register_data_attach() before calling this
+       * function is transferred to the new owners of the cells, and can be
+       * retrieved with notify_ready_to_unpack() afterwards, with all cells
+       * having status CELL_PERSIST. Refinement and coarsening flags must not
+       * be set when calling this function.
+       *
+       * This is a collective operation.
+       */
+      void repartition ();
+
+      /**
+       * Return the minimum, maximum, and average load over all processors
+       * after the most recent partitioning in
+       * execute_coarsening_and_refinement() or repartition(), together with
+       * the processors on which the minimum and maximum occur. The load of a
+       * processor is the sum of the weights of its cells as described for
+       * PartitionSignals::cell_weight, so the ratio of the maximum and the
+       * average measures the quality of the load balance. Before the first
+       * refinement, all values are zero.
+       */
+      const Utilities::MPI::MinMaxAvg &
+      get_partition_statistics () const;
+
       /**
        * Returns a permutation vector for the order the coarse cells
        * are handed of to p4est. For example the first element i in
@@ -836,6 +924,12 @@ namespace parallel
        */
       callback_list_t attached_data_pack_callbacks;
 
+      /**
+       * The loads of the processors after the most recent partitioning, see
+       * get_partition_statistics().
+       */
+      Utilities::MPI::MinMaxAvg partition_statistics;
+
 
       /**
        * Two arrays that store which p4est tree corresponds to which
@@ -895,6 +989,21 @@ namespace parallel
        */
       void attach_mesh_data();
 
+      /**
+       * Return the weights of the locally owned cells of the p4est forest,
+       * in the order in which p4est stores them, as determined by the
+       * PartitionSignals::cell_weight signal. The p4est forest may already be
+       * refined and coarsened while the deal.II mesh is not yet.
+       */
+      std::vector<unsigned int> get_cell_weights () const;
+
+      /**
+       * Partition the p4est forest between the processors, using the weights
+       * given by the PartitionSignals::cell_weight signal if any slot is
+       * connected to it, and update the partition statistics.
+       */
+      void partition_forest ();
+
       /**
        * fills a map that, for each vertex, lists all the processors whose
        * subdomains are adjacent to that vertex.  Used by
@@ -843,6 +843,37 @@ namespace DoFRenumbering
                      const unsigned int         level,
                      const std::vector<typename DH::level_cell_iterator> &cell_order);
 
+  /**
+   * Renumber the degrees of freedom cell by cell in the order in which a
+   * Hilbert space filling curve through the bounding box of the mesh visits
+   * the cell centers, and then call cell_wise(). Cells that are close to
+   * each other along the curve are also close in space, so that the degrees
+   * of freedom of neighboring cells end up close to each other in memory,
+   * which improves the cache reuse of matrix-vector products and
+   * assembly loops.
+   *
+   * In contrast to hierarchical(), which yields a z-order (Morton) curve
+   * that follows the refinement hierarchy of the coarse cells, the curve
+   * here is independent of the coarse mesh and does not contain the long
+   * jumps of the z-order curve. The cell centers are quantized to 32 bits
+   * per coordinate in 1d and 2d and to 21 bits in 3d, so cells whose
+   * centers are closer than this resolution are kept in their original
+   * order. The keys of the cells are computed in parallel.
+   */
+  template <class DH>
+  void
+  hilbert_curve (DH &dof_handler);
+
+  /**
+   * Computes the renumbering vector needed by the hilbert_curve()
+   * function. Does not perform the renumbering on the DoFHandler dofs but
+   * returns the renumbering vector.
+   */
+  template <class DH>
+  void
+  compute_hilbert_curve (std::vector<types::global_dof_index> &new_dof_indices,
+                         const DH                             &dof_handler);
+
   /**
    * @}
    */
@@ -363,6 +363,85 @@ namespace FETools
     std::vector<std::vector<FullMatrix<number> > > &matrices,
     const bool isotropic_only = false);
 
+  /**
+   * Set the directory of an on-disk cache for the matrices computed by
+   * compute_embedding_matrices(), compute_face_embedding_matrices() and
+   * compute_projection_matrices(). Computing these matrices for elements of
+   * high degree or with many degrees of freedom may take seconds, and is
+   * repeated every time such an element is constructed. If a cache
+   * directory is set, these functions store their results there, and read
+   * them back instead of recomputing them whenever the same matrices are
+   * requested again, be it in the same or in a later run of a program.
+   *
+   * The matrices are stored in one binary file per element and kind of
+   * matrices. The file name is derived from a hash of a key that consists
+   * of the name of the element, the space dimensions, the size of the
+   * number type, the version of the library, and a fingerprint of the
+   * values of the shape functions of the element in a few points. The key
+   * is also stored in the file and compared upon reading, so that a file
+   * whose key does not match is simply ignored and overwritten.
+   *
+   * The cache is only an optimization: if a file can not be read or
+   * written, for example because the directory does not exist, the
+   * matrices are computed as if no cache was set. Files are written to a
+   * temporary file first and then renamed, so several programs may share
+   * the same cache directory at the same time.
+   *
+   * An empty string, which is the default, disables the cache. The default
+   * can be changed by setting the environment variable
+   * <tt>DEAL_II_FE_MATRIX_CACHE</tt> to the name of a directory.
+   *
+   * The prolongation matrices of FE_Q and related elements, which are
+   * only computed when first requested, are stored in the same cache.
+   *
+   * @note Since most elements compute these matrices in their
+   * constructors, this function needs to be called before the elements are
+   * created.
+   */
+  void set_transfer_matrix_cache_directory (const std::string &directory);
+
+  /**
+   * Return the directory set by set_transfer_matrix_cache_directory(), or
+   * an empty string if the cache for transfer matrices is disabled.
+   */
+  std::string get_transfer_matrix_cache_directory ();
+
+  /**
+   * Return how often matrices have been read from the cache set by
+   * set_transfer_matrix_cache_directory() instead of being computed, since
+   * the start of the program.
+   */
+  unsigned int n_transfer_matrix_cache_hits ();
+
+  /**
+   * Read the matrices that store_cached_transfer_matrices() has stored for
+   * the element @p fe under the name @p kind from the cache set by
+   * set_transfer_matrix_cache_directory(). The matrices must already have
+   * their final size. Return whether they were found; if not, for example
+   * because the cache is disabled, the matrices are left untouched.
+   *
+   * This function and the next one allow elements that compute some of
+   * their transfer matrices themselves, like FE_Q_Base does for its
+   * prolongation matrices, to use the same cache as the functions above.
+   */
+  template <int dim, int spacedim>
+  bool
+  load_cached_transfer_matrices (const FiniteElement<dim,spacedim>       &fe,
+                                 const std::string                       &kind,
+                                 const std::vector<FullMatrix<double> *> &matrices);
+
+  /**
+   * Store the given matrices of the element @p fe under the name @p kind
+   * in the cache set by set_transfer_matrix_cache_directory(), so that
+   * load_cached_transfer_matrices() can read them back. Nothing happens if
+   * the cache is disabled or the file can not be written.
+   */
+  template <int dim, int spacedim>
+  void
+  store_cached_transfer_matrices (const FiniteElement<dim,spacedim>       &fe,
+                                  const std::string                       &kind,
+                                  const std::vector<FullMatrix<double> *> &matrices);
+
   /**
    * Projects scalar data defined in quadrature points to a finite element
    * space on a single cell.
@@ -2484,6 +2484,13 @@ protected:
    */
   SmartPointer<typename Mapping<dim,spacedim>::InternalDataBase,FEValuesBase<dim,spacedim> > fe_data;
 
+  /**
+   * Whether mapping_data describes the present cell. This is not the case
+   * after FEValues::reinit() was called with another FEValues object whose
+   * mapping data was used instead.
+   */
+  bool mapping_data_is_current;
+
   /**
    * Initialize some update flags. Called from the @p initialize functions of
    * derived classes, which are in turn called from their constructors.
@@ -2598,6 +2605,41 @@ public:
    */
   void reinit (const typename Triangulation<dim,spacedim>::cell_iterator &cell);
 
+  /**
+   * Like the reinit() function above, but instead of letting the mapping
+   * compute the quadrature points, Jacobians, JxW values, etc. on @p cell,
+   * copy them from @p other, which must have been reinitialized on the same
+   * cell last. The finite element of this object then computes the values
+   * of its shape functions with the help of the mapping data of @p other.
+   *
+   * hp::FEValues uses this to compute the mapping data of a cell only once
+   * if the cell is visited with several elements of a collection in turn.
+   * It requires that can_reuse_mapping_data() returns true. Since the
+   * mapping data of this object does not describe the present cell
+   * afterwards, transform() can only be called again after a reinit()
+   * without @p other.
+   */
+  template <class DH, bool level_dof_access>
+  void reinit (const TriaIterator<DoFCellAccessor<DH,level_dof_access> > cell,
+               const FEValues<dim,spacedim> &other);
+
+  /**
+   * Like the previous function, but for iterators into a Triangulation
+   * object.
+   */
+  void reinit (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
+               const FEValues<dim,spacedim> &other);
+
+  /**
+   * Return whether @p other can provide the mapping data for the reinit()
+   * functions above on the given cell, i.e. whether @p other was last
+   * reinitialized on @p cell, uses the same mapping and quadrature formula
+   * as this object, and computes at least the mapping data this object
+   * needs.
+   */
+  bool can_reuse_mapping_data (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
+                               const FEValues<dim,spacedim> &other) const;
+
   /**
    * Return a reference to the copy of the quadrature formula stored by this
    * object.
@@ -2643,6 +2685,11 @@ private:
    * independent of the actual type of the cell iterator.
    */
   void do_reinit ();
+
+  /**
+   * Same as above, but use the mapping data of @p other.
+   */
+  void do_reinit (const FEValues<dim,spacedim> &other);
 };
 
 
@@ -87,6 +87,22 @@ namespace internal
      * all finite element indices adjacent to this object have been
      * covered, we write a -1 to indicate the end of the list.
      *
+     * <h4>Compression</h4>
+     *
+     * As for cells (see the internal::hp::DoFLevel class), the DoF indices
+     * of one set are frequently numbered consecutively. Once all indices
+     * have been set, compress_data() replaces each such set by its first
+     * index, and marks the set by storing
+     * <code>numbers::invalid_dof_index-1-fe_index</code> instead of the
+     * finite element index in front of it. This is the same as the binary
+     * complement of <code>fe_index+1</code>; the complement of
+     * <code>fe_index</code> itself can not be used since that of zero is the
+     * marker for the end of the list. Sets with less than two DoFs are never
+     * compressed. Compression also rebuilds the @p dof_offsets array so that
+     * the lists of all objects follow each other in the order of the
+     * objects. uncompress_data() restores the original form, which is
+     * needed to call set_dof_index().
+     *
      * Access to this kind of data, as well as the distinction between
      * cells and objects of lower dimensionality are encoded in the
      * accessor functions, DoFObjects::set_dof_index() and
@@ -238,12 +254,42 @@ namespace internal
                           const unsigned int               fe_index,
                           const unsigned int               obj_level) const;
 
+      /**
+       * Compress the lists of dof indices of all objects. See the general
+       * documentation of this class for more information.
+       *
+       * @param fe_collection The object that can tell us how many degrees
+       * of freedom each of the finite elements has on objects of dimension
+       * @p structdim.
+       */
+      template <int dim, int spacedim>
+      void compress_data (const dealii::hp::FECollection<dim,spacedim> &fe_collection);
+
+      /**
+       * Undo the effect of compress_data().
+       */
+      template <int dim, int spacedim>
+      void uncompress_data (const dealii::hp::FECollection<dim,spacedim> &fe_collection);
+
       /**
        * Determine an estimate for the
        * memory consumption (in bytes)
        * of this object.
        */
       std::size_t memory_consumption () const;
+
+    private:
+      /**
+       * Return the finite element index of the set of dof indices that
+       * starts with the entry @p head of the @p dofs array, and whether the
+       * set has been compressed. @p n_fe_indices is the number of elements
+       * of the finite element collection in use.
+       */
+      static
+      unsigned int
+      decode_fe_index (const types::global_dof_index head,
+                       const unsigned int            n_fe_indices,
+                       bool                          &compressed);
     };
 
 
@@ -287,6 +333,20 @@ namespace internal
     class DoFIndicesOnFaces<1>
     {
     public:
+      /**
+       * Compress the stored dof indices. Since nothing is stored here, this
+       * does nothing.
+       */
+      template <int spacedim>
+      void compress_data (const dealii::hp::FECollection<1,spacedim> &) {}
+
+      /**
+       * Uncompress the stored dof indices. Since nothing is stored here, this
+       * does nothing.
+       */
+      template <int spacedim>
+      void uncompress_data (const dealii::hp::FECollection<1,spacedim> &) {}
+
       /**
        * Determine an estimate for the
        * memory consumption (in bytes)
@@ -310,6 +370,19 @@ namespace internal
        */
       internal::hp::DoFIndicesOnFacesOrEdges<1> lines;
 
+      /**
+       * Compress the dof indices stored on the lines. See the documentation
+       * of the internal::hp::DoFIndicesOnFacesOrEdges class.
+       */
+      template <int spacedim>
+      void compress_data (const dealii::hp::FECollection<2,spacedim> &fe_collection);
+
+      /**
+       * Uncompress the dof indices stored on the lines.
+       */
+      template <int spacedim>
+      void uncompress_data (const dealii::hp::FECollection<2,spacedim> &fe_collection);
+
       /**
        * Determine an estimate for the
        * memory consumption (in bytes)
@@ -339,6 +412,19 @@ namespace internal
        */
       internal::hp::DoFIndicesOnFacesOrEdges<2> quads;
 
+      /**
+       * Compress the dof indices stored on the lines and quads. See the
+       * documentation of the internal::hp::DoFIndicesOnFacesOrEdges class.
+       */
+      template <int spacedim>
+      void compress_data (const dealii::hp::FECollection<3,spacedim> &fe_collection);
+
+      /**
+       * Uncompress the dof indices stored on the lines and quads.
+       */
+      template <int spacedim>
+      void uncompress_data (const dealii::hp::FECollection<3,spacedim> &fe_collection);
+
       /**
        * Determine an estimate for the
        * memory consumption (in bytes)
@@ -350,6 +436,27 @@ namespace internal
 
     // --------------------- inline and template functions ------------------
 
+    template <int structdim>
+    inline
+    unsigned int
+    DoFIndicesOnFacesOrEdges<structdim>::
+    decode_fe_index (const types::global_dof_index head,
+                     const unsigned int            n_fe_indices,
+                     bool                          &compressed)
+    {
+      Assert (head != numbers::invalid_dof_index, ExcInternalError());
+      compressed = (head >= n_fe_indices);
+      if (compressed == false)
+        return head;
+      else
+        {
+          Assert (numbers::invalid_dof_index-1-head < n_fe_indices,
+                  ExcInternalError());
+          return numbers::invalid_dof_index-1-head;
+        }
+    }
+
+
     template <int structdim>
     template <int dim, int spacedim>
     inline
@@ -400,12 +507,18 @@ namespace internal
         {
           Assert (*pointer != numbers::invalid_dof_index,
                   ExcInternalError());
-          if (*pointer == fe_index)
-            return *(pointer + 1 + local_index);
+          bool compressed;
+          const unsigned int this_fe_index
+            = decode_fe_index (*pointer, dof_handler.get_fe().size(), compressed);
+          if (this_fe_index == fe_index)
+            return (compressed == false ?
+                    *(pointer + 1 + local_index) :
+                    *(pointer + 1) + local_index);
           else
-            pointer += static_cast<types::global_dof_index>(
-                         dof_handler.get_fe()[*pointer]
-                         .template n_dofs_per_object<structdim>() + 1);
+            pointer += (compressed == false ?
+                        dof_handler.get_fe()[this_fe_index]
+                        .template n_dofs_per_object<structdim>() + 1 :
+                        2);
         }
     }
 
@@ -462,6 +575,9 @@ namespace internal
         {
           Assert (*pointer != numbers::invalid_dof_index,
                   ExcInternalError());
+          Assert (*pointer < dof_handler.get_fe().size(),
+                  ExcMessage ("This function can no longer be called after "
+                              "compressing the dofs array"));
           if (*pointer == fe_index)
             {
               *(pointer + 1 + local_index) = global_index;
@@ -515,8 +631,13 @@ namespace internal
           else
             {
               ++counter;
-              pointer += dof_handler.get_fe()[*pointer]
-                         .template n_dofs_per_object<structdim>() + 1;
+              bool compressed;
+              const unsigned int this_fe_index
+                = decode_fe_index (*pointer, dof_handler.get_fe().size(), compressed);
+              pointer += (compressed == false ?
+                          dof_handler.get_fe()[this_fe_index]
+                          .template n_dofs_per_object<structdim>() + 1 :
+                          2);
             }
         }
     }
@@ -568,17 +689,18 @@ namespace internal
           Assert (*pointer != numbers::invalid_dof_index,
                   ExcInternalError());
 
-          const unsigned int fe_index = *pointer;
-
-          Assert (fe_index < dof_handler.get_fe().size(),
-                  ExcInternalError());
+          bool compressed;
+          const unsigned int fe_index
+            = decode_fe_index (*pointer, dof_handler.get_fe().size(), compressed);
 
           if (counter == n)
             return fe_index;
 
           ++counter;
-          pointer += dof_handler.get_fe()[fe_index]
-                     .template n_dofs_per_object<structdim>() + 1;
+          pointer += (compressed == false ?
+                      dof_handler.get_fe()[fe_index]
+                      .template n_dofs_per_object<structdim>() + 1 :
+                      2);
         }
     }
 
@@ -629,12 +751,17 @@ namespace internal
           if (*pointer == numbers::invalid_dof_index)
             // end of list reached
             return false;
-          else if (*pointer == fe_index)
+
+          bool compressed;
+          const unsigned int this_fe_index
+            = decode_fe_index (*pointer, dof_handler.get_fe().size(), compressed);
+          if (this_fe_index == fe_index)
             return true;
           else
-            pointer += static_cast<types::global_dof_index>(
-                         dof_handler.get_fe()[*pointer]
-                         .template n_dofs_per_object<structdim>()+1);
+            pointer += (compressed == false ?
+                        dof_handler.get_fe()[this_fe_index]
+                        .template n_dofs_per_object<structdim>() + 1 :
+                        2);
         }
     }
 
@@ -92,7 +92,12 @@ namespace internal
      * is compressed, then we instead store the FE index in binary complement (which
      * we can identify by looking at the sign bit when interpreting the number as a
      * signed one). There are two functions, compress_data() and uncompress_data()
-     * that convert between the two possible representations.
+     * that convert between the two possible representations. The
+     * hp::DoFHandler class compresses the data at the end of
+     * hp::DoFHandler::distribute_dofs() and uncompresses it only for the
+     * duration of hp::DoFHandler::renumber_dofs(). When compressing, the
+     * @p dof_offsets array is rebuilt so that the data of all cells is
+     * again stored contiguously.
      *
      * Note that compression is not always possible. For example, if one renumbered
      * the example above using DoFRenumbering::downstream with $(1,0)^T$ as
@@ -298,6 +303,14 @@ namespace internal
       template <int dim, int spacedim>
       void uncompress_data (const dealii::hp::FECollection<dim,spacedim> &fe_collection);
 
+      /**
+       * Remove the marks of compression from the @p active_fe_indices
+       * array, without touching the arrays of dof indices. This is used
+       * when the dof indices are about to be released but the active FE
+       * indices are to be kept.
+       */
+      void normalize_active_fe_indices ();
+
       /**
        * Make hp::DoFHandler and its auxiliary class a friend since it
        * is the class that needs to create these data structures.
@@ -328,7 +341,7 @@ namespace internal
                           "information for an object on which no such "
                           "information is available"));
 
-      Assert (fe_index == active_fe_indices[obj_index],
+      Assert (fe_index == active_fe_index(obj_index),
               ExcMessage ("FE index does not match that of the present cell"));
 
       // see if the dof_indices array has been compressed for this
@@ -403,7 +416,22 @@ namespace internal
       Assert (obj_index < active_fe_indices.size(),
               ExcIndexRange (obj_index, 0, active_fe_indices.size()));
 
-      active_fe_indices[obj_index] = fe_index;
+      // keep the mark of compression, the dof indices of the cell are
+      // still stored in compressed form
+      if (((signed_active_fe_index_type)active_fe_indices[obj_index]) >= 0)
+        active_fe_indices[obj_index] = fe_index;
+      else
+        active_fe_indices[obj_index] = (active_fe_index_type)~fe_index;
+    }
+
+
+
+    inline
+    void
+    DoFLevel::normalize_active_fe_indices ()
+    {
+      for (unsigned int i=0; i<active_fe_indices.size(); ++i)
+        active_fe_indices[i] = active_fe_index(i);
     }
 
 
@@ -79,6 +79,42 @@ namespace internal
                     const dealii::hp::QCollection<q_dim> &q_collection,
                     const UpdateFlags         update_flags);
 
+      /**
+       * Copy constructor. The new object uses the same collections and
+       * update flags as @p other, but does not share any of the underlying
+       * FEValues objects with it: they are created anew as they are
+       * requested, or by precalculate_fe_values(). This makes copies suitable
+       * as scratch objects for different threads, e.g. in WorkStream::run(),
+       * where each thread needs objects it can reinit() independently.
+       */
+      FEValuesBase (const FEValuesBase<dim,q_dim,FEValues> &other);
+
+      /**
+       * Create the FEValues objects for all the combinations of finite
+       * element, mapping, and quadrature indices that the <tt>reinit()</tt>
+       * functions of the derived classes select by default, i.e., for each
+       * finite element index the mapping and quadrature with the same index
+       * (or the first one if the respective collection has only one
+       * element). Otherwise, these objects are created lazily the first time
+       * a cell with the respective active_fe_index is visited.
+       *
+       * Setting up an FEValues object involves the evaluation of the shape
+       * functions in the quadrature points and the allocation of all its
+       * fields. Calling this function once on a scratch object before an
+       * assembly loop moves this work out of the loop, so that the cost per
+       * cell in the loop is the same as for non-hp FEValues objects.
+       *
+       * Each of these objects keeps track of the last cell it was
+       * reinitialized on, so that the detection of cells that are
+       * translations of the previous one (see CellSimilarity) works for each
+       * finite element index separately, even if the indices of consecutive
+       * cells alternate. For hp::FEValues, if the same cell is visited with
+       * several finite elements of the collection in turn, the data of the
+       * mapping is computed only for the first of them and reused for the
+       * others, provided they use the same mapping and quadrature formula.
+       */
+      void precalculate_fe_values ();
+
       /**
        * Get a reference to the collection of finite element objects used
        * here.
@@ -127,6 +163,12 @@ namespace internal
                         const unsigned int mapping_index,
                         const unsigned int q_index);
 
+      /**
+       * Return a pointer to the @p FEValues object selected by the last call
+       * to select_fe_values(), or a null pointer if there was none yet.
+       */
+      const FEValues *last_selected_fe_values () const;
+
     protected:
       /**
        * A pointer to the collection of finite elements to be used.
@@ -26,8 +26,12 @@
 #include <deal.II/lac/solver_minres.h>
 #include <deal.II/lac/vector_memory.h>
 #include <deal.II/lac/precondition.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/identity_matrix.h>
+#include <deal.II/lac/lapack_full_matrix.h>
 
 #include <cmath>
+#include <vector>
 
 DEAL_II_NAMESPACE_OPEN
 
@@ -227,6 +231,220 @@ protected:
   AdditionalData additional_data;
 };
 
+
+/**
+ * Locally optimal block preconditioned conjugate gradient method (LOBPCG)
+ * by Knyazev for computing several of the smallest (or largest) eigenvalues
+ * and eigenvectors of a symmetric eigenvalue problem $Ax=\lambda x$ or of a
+ * generalized symmetric eigenvalue problem $Ax=\lambda Bx$ with a symmetric
+ * positive definite matrix $B$, such as the mass matrix in modal analysis.
+ *
+ * In each step, the residuals $r_i = Ax_i-\lambda_i Bx_i$ of the current
+ * eigenvector approximations are preconditioned, and the new approximations
+ * are determined by a Rayleigh-Ritz procedure on the space spanned by the
+ * current approximations, the preconditioned residuals, and the previous
+ * search directions. Any preconditioner with a <tt>vmult</tt> function can
+ * be used, e.g. the ones in precondition.h or an approximate inverse of $A$
+ * computed by a multigrid method. Residuals of eigenpairs that have already
+ * converged are no longer included in the search space.
+ *
+ * The small dense eigenvalue problems and the orthogonalization of the
+ * search space are done with LAPACK through LAPACKFullMatrix: the Gram
+ * matrix of the whole block of search vectors is diagonalized and the block
+ * is orthonormalized by scaling its eigenvectors, dropping directions that
+ * are numerically linearly dependent. Thus, the library must be configured
+ * with LAPACK for this class to work.
+ *
+ * The class works on all vector types offering the usual vector space
+ * operations, among them Vector, BlockVector, and
+ * parallel::distributed::Vector. The matrices of the small problems are
+ * replicated on all processors.
+ *
+ * The convergence criterion passed to the SolverControl object is the
+ * largest $l_2$ norm of the residuals $r_i$, where the eigenvectors are
+ * normalized with respect to the $B$ inner product.
+ */
+template <class VECTOR = Vector<double> >
+class EigenLOBPCG : private Solver<VECTOR>
+{
+public:
+  /**
+   * Declare type of container size.
+   */
+  typedef types::global_dof_index size_type;
+
+  /**
+   * Standardized data struct to pipe additional data to the solver.
+   */
+  struct AdditionalData
+  {
+    /**
+     * Constructor. By default, the smallest eigenvalues are computed.
+     */
+    AdditionalData (const bool compute_largest = false)
+      :
+      compute_largest (compute_largest)
+    {}
+
+    /**
+     * Compute the largest eigenvalues instead of the smallest ones.
+     */
+    bool compute_largest;
+  };
+
+  /**
+   * Constructor.
+   */
+  EigenLOBPCG (SolverControl        &cn,
+               VectorMemory<VECTOR> &mem,
+               const AdditionalData &data=AdditionalData());
+
+  /**
+   * Virtual destructor.
+   */
+  virtual ~EigenLOBPCG ();
+
+  /**
+   * Solve the generalized eigenvalue problem $Ax=\lambda Bx$. The number of
+   * eigenpairs computed is the size of @p eigenvectors, whose entries must be
+   * initialized with linearly independent start vectors. After the
+   * iteration, they contain the eigenvectors normalized with respect to the
+   * $B$ inner product, and @p eigenvalues the corresponding eigenvalues in
+   * ascending order (descending if AdditionalData::compute_largest is set).
+   */
+  template <class MATRIX, class MASSMATRIX, class PRECONDITIONER>
+  void
+  solve (const MATRIX         &A,
+         const MASSMATRIX     &B,
+         const PRECONDITIONER &preconditioner,
+         std::vector<double>  &eigenvalues,
+         std::vector<VECTOR>  &eigenvectors);
+
+  /**
+   * Solve the standard eigenvalue problem $Ax=\lambda x$. See the other
+   * solve() function for the meaning of the arguments.
+   */
+  template <class MATRIX, class PRECONDITIONER>
+  void
+  solve (const MATRIX         &A,
+         const PRECONDITIONER &preconditioner,
+         std::vector<double>  &eigenvalues,
+         std::vector<VECTOR>  &eigenvectors);
+
+protected:
+  /**
+   * Flags for execution.
+   */
+  AdditionalData additional_data;
+
+private:
+  /**
+   * Allocate @p n vectors from the vector memory of the solver with the
+   * layout of @p model.
+   */
+  void allocate (std::vector<VECTOR *> &vectors,
+                 const unsigned int     n,
+                 const VECTOR          &model);
+
+  /**
+   * Return the vectors in @p vectors to the vector memory of the solver.
+   */
+  void free (std::vector<VECTOR *> &vectors);
+};
+
+
+
+/**
+ * Thick-restart Lanczos method by Wu and Simon for computing several of the
+ * smallest (or largest) eigenvalues and eigenvectors of a symmetric matrix.
+ *
+ * The method builds a Krylov space of dimension
+ * AdditionalData::n_krylov_vectors by the Lanczos process with full
+ * reorthogonalization, done as a classical block Gram-Schmidt process
+ * applied twice. When the space is full, the Ritz pairs of the wanted end of
+ * the spectrum are computed with LAPACK. If they have not yet converged, the
+ * iteration is restarted with the space spanned by the best Ritz vectors and
+ * the last Lanczos vector, which keeps the information gathered so far.
+ * Thus, the library must be configured with LAPACK for this class to work.
+ *
+ * As opposed to EigenLOBPCG, this method cannot be preconditioned. It works
+ * on the same vector types as EigenLOBPCG.
+ *
+ * The number of iterations reported to the SolverControl object is the
+ * number of restarts, and the convergence criterion is the largest residual
+ * $\|Ax_i-\lambda_i x_i\|$ of the wanted Ritz pairs, estimated from the
+ * projected matrix without additional matrix-vector products.
+ */
+template <class VECTOR = Vector<double> >
+class EigenLanczos : private Solver<VECTOR>
+{
+public:
+  /**
+   * Declare type of container size.
+   */
+  typedef types::global_dof_index size_type;
+
+  /**
+   * Standardized data struct to pipe additional data to the solver.
+   */
+  struct AdditionalData
+  {
+    /**
+     * Constructor. By default, the smallest eigenvalues are computed.
+     */
+    AdditionalData (const unsigned int n_krylov_vectors = 30,
+                    const bool         compute_largest = false)
+      :
+      n_krylov_vectors (n_krylov_vectors),
+      compute_largest (compute_largest)
+    {}
+
+    /**
+     * Maximum dimension of the Krylov space before a restart. This must be
+     * at least the number of wanted eigenpairs plus two.
+     */
+    unsigned int n_krylov_vectors;
+
+    /**
+     * Compute the largest eigenvalues instead of the smallest ones.
+     */
+    bool compute_largest;
+  };
+
+  /**
+   * Constructor.
+   */
+  EigenLanczos (SolverControl        &cn,
+                VectorMemory<VECTOR> &mem,
+                const AdditionalData &data=AdditionalData());
+
+  /**
+   * Virtual destructor.
+   */
+  virtual ~EigenLanczos ();
+
+  /**
+   * Compute eigenpairs of the symmetric matrix @p A. The number of
+   * eigenpairs computed is the size of @p eigenvectors. The sum of the
+   * vectors in @p eigenvectors, which must not be zero, is used as start
+   * vector. After the iteration, @p eigenvectors contains the eigenvectors
+   * normalized in the $l_2$ norm, and @p eigenvalues the corresponding
+   * eigenvalues in ascending order (descending if
+   * AdditionalData::compute_largest is set).
+   */
+  template <class MATRIX>
+  void
+  solve (const MATRIX        &A,
+         std::vector<double> &eigenvalues,
+         std::vector<VECTOR> &eigenvectors);
+
+protected:
+  /**
+   * Flags for execution.
+   */
+  AdditionalData additional_data;
+};
+
 /*@}*/
 //---------------------------------------------------------------------------
 
@@ -444,6 +662,508 @@ EigenInverse<VECTOR>::solve (double       &value,
   // otherwise exit as normal
 }
 
+
+
+//---------------------------------------------------------------------------
+
+namespace internal
+{
+  namespace EigenSolvers
+  {
+    /**
+     * Compute all eigenvalues, in ascending order, and the eigenvectors of
+     * the symmetric matrix @p matrix using LAPACK.
+     */
+    inline
+    void
+    symmetric_eigenpairs (const FullMatrix<double> &matrix,
+                          ::dealii::Vector<double> &eigenvalues,
+                          FullMatrix<double>       &eigenvectors)
+    {
+      LAPACKFullMatrix<double> lapack_matrix (matrix.m());
+      lapack_matrix = matrix;
+      // all eigenvalues are bounded by the l-infinity norm
+      const double bound = 2.*matrix.linfty_norm() + 1.;
+      lapack_matrix.compute_eigenvalues_symmetric (-bound, bound, 0.,
+                                                   eigenvalues, eigenvectors);
+    }
+
+
+
+    /**
+     * Set @p result to the linear combination of the vectors in @p basis
+     * with coefficients given by column @p column of @p coefficients,
+     * starting at vector and row @p first.
+     */
+    template <class VECTOR>
+    void
+    linear_combination (const std::vector<VECTOR *> &basis,
+                        const FullMatrix<double>    &coefficients,
+                        const unsigned int           column,
+                        const unsigned int           first,
+                        VECTOR                      &result)
+    {
+      result = 0;
+      for (unsigned int i=first; i<basis.size(); ++i)
+        result.add (coefficients(i,column), *basis[i]);
+    }
+
+
+
+    /**
+     * Rayleigh-Ritz procedure for the generalized eigenvalue problem
+     * $Ax=\lambda Bx$ on the space spanned by the vectors in @p basis, with
+     * @p basis_A and @p basis_B the products of @p A and @p B with these
+     * vectors. The basis is orthonormalized with respect to the $B$ inner
+     * product by diagonalizing its Gram matrix, dropping directions that are
+     * linearly dependent up to roundoff. On exit, @p ritz_values contains the
+     * Ritz values in ascending order and @p coefficients (one column per Ritz
+     * value) the $B$-normalized Ritz vectors in terms of @p basis.
+     */
+    template <class VECTOR>
+    void
+    rayleigh_ritz (const std::vector<VECTOR *> &basis,
+                   const std::vector<VECTOR *> &basis_A,
+                   const std::vector<VECTOR *> &basis_B,
+                   ::dealii::Vector<double>    &ritz_values,
+                   FullMatrix<double>          &coefficients)
+    {
+      const unsigned int n = basis.size();
+      FullMatrix<double> gram (n, n), projected (n, n);
+      for (unsigned int i=0; i<n; ++i)
+        for (unsigned int j=i; j<n; ++j)
+          {
+            gram(i,j) = 0.5 * (*basis[i] * *basis_B[j] +
+                               *basis[j] * *basis_B[i]);
+            gram(j,i) = gram(i,j);
+            projected(i,j) = 0.5 * (*basis[i] * *basis_A[j] +
+                                    *basis[j] * *basis_A[i]);
+            projected(j,i) = projected(i,j);
+          }
+
+      // scale the Gram matrix to unit diagonal and compute its eigenvalues
+      std::vector<double> scaling (n);
+      for (unsigned int i=0; i<n; ++i)
+        scaling[i] = gram(i,i) > 0 ? 1./std::sqrt(gram(i,i)) : 0.;
+      for (unsigned int i=0; i<n; ++i)
+        for (unsigned int j=0; j<n; ++j)
+          gram(i,j) *= scaling[i] * scaling[j];
+      ::dealii::Vector<double> gram_values;
+      FullMatrix<double> gram_vectors;
+      symmetric_eigenpairs (gram, gram_values, gram_vectors);
+
+      // orthonormal basis of the numerically independent directions
+      const double threshold = 1e-12 * gram_values(gram_values.size()-1);
+      std::vector<unsigned int> kept;
+      for (unsigned int k=0; k<gram_values.size(); ++k)
+        if (gram_values(k) > threshold)
+          kept.push_back (k);
+      FullMatrix<double> transform (n, kept.size());
+      for (unsigned int k=0; k<kept.size(); ++k)
+        for (unsigned int i=0; i<n; ++i)
+          transform(i,k) = scaling[i] * gram_vectors(i,kept[k]) /
+                           std::sqrt(gram_values(kept[k]));
+
+      FullMatrix<double> tmp (n, kept.size()), reduced (kept.size(), kept.size());
+      projected.mmult (tmp, transform);
+      transform.Tmmult (reduced, tmp);
+      FullMatrix<double> reduced_vectors;
+      symmetric_eigenpairs (reduced, ritz_values, reduced_vectors);
+
+      coefficients.reinit (n, ritz_values.size());
+      transform.mmult (coefficients, reduced_vectors);
+    }
+  }
+}
+
+
+
+template <class VECTOR>
+EigenLOBPCG<VECTOR>::EigenLOBPCG (SolverControl        &cn,
+                                  VectorMemory<VECTOR> &mem,
+                                  const AdditionalData &data)
+  :
+  Solver<VECTOR>(cn, mem),
+  additional_data(data)
+{}
+
+
+
+template <class VECTOR>
+EigenLOBPCG<VECTOR>::~EigenLOBPCG ()
+{}
+
+
+
+template <class VECTOR>
+void
+EigenLOBPCG<VECTOR>::allocate (std::vector<VECTOR *> &vectors,
+                               const unsigned int     n,
+                               const VECTOR          &model)
+{
+  vectors.resize (n);
+  for (unsigned int i=0; i<n; ++i)
+    {
+      vectors[i] = this->memory.alloc();
+      vectors[i]->reinit (model);
+    }
+}
+
+
+
+template <class VECTOR>
+void
+EigenLOBPCG<VECTOR>::free (std::vector<VECTOR *> &vectors)
+{
+  for (unsigned int i=0; i<vectors.size(); ++i)
+    this->memory.free (vectors[i]);
+  vectors.clear();
+}
+
+
+
+template <class VECTOR>
+template <class MATRIX, class PRECONDITIONER>
+void
+EigenLOBPCG<VECTOR>::solve (const MATRIX         &A,
+                            const PRECONDITIONER &preconditioner,
+                            std::vector<double>  &eigenvalues,
+                            std::vector<VECTOR>  &eigenvectors)
+{
+  solve (A, IdentityMatrix(A.m()), preconditioner, eigenvalues, eigenvectors);
+}
+
+
+
+template <class VECTOR>
+template <class MATRIX, class MASSMATRIX, class PRECONDITIONER>
+void
+EigenLOBPCG<VECTOR>::solve (const MATRIX         &A,
+                            const MASSMATRIX     &B,
+                            const PRECONDITIONER &preconditioner,
+                            std::vector<double>  &eigenvalues,
+                            std::vector<VECTOR>  &eigenvectors)
+{
+  const unsigned int n_eigenpairs = eigenvectors.size();
+  Assert (n_eigenpairs > 0, ExcMessage ("At least one eigenpair must be "
+                                        "requested"));
+
+  deallog.push("LOBPCG");
+
+  // the current approximations X, the residuals W, and the search
+  // directions P, together with their products with A and B. The second set
+  // receives the updates
+  std::vector<VECTOR *> X, AX, BX, W, AW, BW, P, AP, BP;
+  std::vector<VECTOR *> X_new, AX_new, BX_new, P_new, AP_new, BP_new;
+  allocate (X, n_eigenpairs, eigenvectors[0]);
+  allocate (AX, n_eigenpairs, eigenvectors[0]);
+  allocate (BX, n_eigenpairs, eigenvectors[0]);
+  allocate (W, n_eigenpairs, eigenvectors[0]);
+  allocate (AW, n_eigenpairs, eigenvectors[0]);
+  allocate (BW, n_eigenpairs, eigenvectors[0]);
+  allocate (P, n_eigenpairs, eigenvectors[0]);
+  allocate (AP, n_eigenpairs, eigenvectors[0]);
+  allocate (BP, n_eigenpairs, eigenvectors[0]);
+  allocate (X_new, n_eigenpairs, eigenvectors[0]);
+  allocate (AX_new, n_eigenpairs, eigenvectors[0]);
+  allocate (BX_new, n_eigenpairs, eigenvectors[0]);
+  allocate (P_new, n_eigenpairs, eigenvectors[0]);
+  allocate (AP_new, n_eigenpairs, eigenvectors[0]);
+  allocate (BP_new, n_eigenpairs, eigenvectors[0]);
+
+  for (unsigned int i=0; i<n_eigenpairs; ++i)
+    {
+      *X[i] = eigenvectors[i];
+      A.vmult (*AX[i], *X[i]);
+      B.vmult (*BX[i], *X[i]);
+    }
+
+  std::vector<VECTOR *> basis, basis_A, basis_B;
+  Vector<double> ritz_values;
+  FullMatrix<double> coefficients;
+  std::vector<unsigned int> selected (n_eigenpairs);
+  unsigned int n_directions = 0;
+  std::vector<double> residuals (n_eigenpairs);
+
+  SolverControl::State conv = SolverControl::iterate;
+  for (unsigned int iter=0; conv==SolverControl::iterate; ++iter)
+    {
+      // Rayleigh-Ritz on the span of X, the preconditioned residuals of the
+      // unconverged eigenpairs, and the previous search directions. In the
+      // first step, this only orthonormalizes the start vectors
+      basis = X;
+      basis_A = AX;
+      basis_B = BX;
+      if (iter > 0)
+        {
+          const double tolerance = this->control().tolerance();
+          for (unsigned int i=0; i<n_eigenpairs; ++i)
+            if (residuals[i] > tolerance)
+              {
+                preconditioner.vmult (*AW[i], *W[i]);
+                W[i]->swap (*AW[i]);
+                A.vmult (*AW[i], *W[i]);
+                B.vmult (*BW[i], *W[i]);
+                basis.push_back (W[i]);
+                basis_A.push_back (AW[i]);
+                basis_B.push_back (BW[i]);
+              }
+          for (unsigned int i=0; i<n_directions; ++i)
+            {
+              basis.push_back (P[i]);
+              basis_A.push_back (AP[i]);
+              basis_B.push_back (BP[i]);
+            }
+        }
+      internal::EigenSolvers::rayleigh_ritz (basis, basis_A, basis_B,
+                                             ritz_values, coefficients);
+      AssertThrow (ritz_values.size() >= n_eigenpairs,
+                   ExcMessage ("The start vectors are linearly dependent"));
+
+      for (unsigned int i=0; i<n_eigenpairs; ++i)
+        selected[i] = additional_data.compute_largest ?
+                      ritz_values.size()-1-i : i;
+
+      // update the approximations and, from the second step on, the search
+      // directions, i.e., the components of the update not in the old X
+      for (unsigned int i=0; i<n_eigenpairs; ++i)
+        {
+          internal::EigenSolvers::linear_combination
+          (basis, coefficients, selected[i], 0, *X_new[i]);
+          internal::EigenSolvers::linear_combination
+          (basis_A, coefficients, selected[i], 0, *AX_new[i]);
+          internal::EigenSolvers::linear_combination
+          (basis_B, coefficients, selected[i], 0, *BX_new[i]);
+          if (iter > 0)
+            {
+              internal::EigenSolvers::linear_combination
+              (basis, coefficients, selected[i], n_eigenpairs, *P_new[i]);
+              internal::EigenSolvers::linear_combination
+              (basis_A, coefficients, selected[i], n_eigenpairs, *AP_new[i]);
+              internal::EigenSolvers::linear_combination
+              (basis_B, coefficients, selected[i], n_eigenpairs, *BP_new[i]);
+            }
+        }
+      X.swap (X_new);
+      AX.swap (AX_new);
+      BX.swap (BX_new);
+      if (iter > 0)
+        {
+          P.swap (P_new);
+          AP.swap (AP_new);
+          BP.swap (BP_new);
+          n_directions = n_eigenpairs;
+        }
+
+      // compute the residuals
+      double max_residual = 0;
+      for (unsigned int i=0; i<n_eigenpairs; ++i)
+        {
+          W[i]->equ (1., *AX[i], -ritz_values(selected[i]), *BX[i]);
+          residuals[i] = W[i]->l2_norm();
+          max_residual = std::max (max_residual, residuals[i]);
+        }
+
+      conv = this->control().check (iter, max_residual);
+    }
+
+  eigenvalues.resize (n_eigenpairs);
+  for (unsigned int i=0; i<n_eigenpairs; ++i)
+    {
+      eigenvalues[i] = ritz_values(selected[i]);
+      eigenvectors[i] = *X[i];
+    }
+
+  free (X);
+  free (AX);
+  free (BX);
+  free (W);
+  free (AW);
+  free (BW);
+  free (P);
+  free (AP);
+  free (BP);
+  free (X_new);
+  free (AX_new);
+  free (BX_new);
+  free (P_new);
+  free (AP_new);
+  free (BP_new);
+
+  deallog.pop();
+
+  // in case of failure: throw exception
+  if (this->control().last_check() != SolverControl::success)
+    AssertThrow(false, SolverControl::NoConvergence (this->control().last_step(),
+                                                     this->control().last_value()));
+  // otherwise exit as normal
+}
+
+//---------------------------------------------------------------------------
+
+template <class VECTOR>
+EigenLanczos<VECTOR>::EigenLanczos (SolverControl        &cn,
+                                    VectorMemory<VECTOR> &mem,
+                                    const AdditionalData &data)
+  :
+  Solver<VECTOR>(cn, mem),
+  additional_data(data)
+{}
+
+
+
+template <class VECTOR>
+EigenLanczos<VECTOR>::~EigenLanczos ()
+{}
+
+
+
+template <class VECTOR>
+template <class MATRIX>
+void
+EigenLanczos<VECTOR>::solve (const MATRIX        &A,
+                             std::vector<double> &eigenvalues,
+                             std::vector<VECTOR> &eigenvectors)
+{
+  const unsigned int n_eigenpairs = eigenvectors.size();
+  const unsigned int max_basis = additional_data.n_krylov_vectors;
+  Assert (n_eigenpairs > 0, ExcMessage ("At least one eigenpair must be "
+                                        "requested"));
+  Assert (max_basis >= n_eigenpairs+2,
+          ExcMessage ("The Krylov space must have at least two more vectors "
+                      "than the number of eigenpairs requested"));
+
+  deallog.push("Lanczos");
+
+  // the Lanczos vectors, including the one beyond the current basis, and a
+  // second set for the restart
+  std::vector<VECTOR *> V (max_basis+1), V_new (max_basis);
+  for (unsigned int i=0; i<=max_basis; ++i)
+    {
+      V[i] = this->memory.alloc();
+      V[i]->reinit (eigenvectors[0]);
+    }
+  for (unsigned int i=0; i<max_basis; ++i)
+    {
+      V_new[i] = this->memory.alloc();
+      V_new[i]->reinit (eigenvectors[0]);
+    }
+
+  *V[0] = eigenvectors[0];
+  for (unsigned int i=1; i<n_eigenpairs; ++i)
+    V[0]->add (eigenvectors[i]);
+  const double start_norm = V[0]->l2_norm();
+  AssertThrow (start_norm > 0, ExcMessage ("The start vector is zero"));
+  V[0]->scale (1./start_norm);
+
+  FullMatrix<double> T (max_basis, max_basis);
+  std::vector<double> h (max_basis);
+  Vector<double> ritz_values;
+  FullMatrix<double> ritz_vectors;
+  std::vector<unsigned int> wanted (max_basis);
+  unsigned int n_kept = 0, n_basis = 0;
+  double beta = 0;
+
+  SolverControl::State conv = SolverControl::iterate;
+  for (unsigned int cycle=0; conv==SolverControl::iterate; ++cycle)
+    {
+      // extend the Lanczos basis. Orthogonalize against all previous vectors
+      // by a classical Gram-Schmidt process applied twice, which also
+      // computes the coupling to the kept Ritz vectors after a restart
+      bool breakdown = false;
+      for (n_basis=n_kept; n_basis<max_basis && !breakdown; )
+        {
+          VECTOR &w = *V[n_basis+1];
+          A.vmult (w, *V[n_basis]);
+          const double norm_Av = w.l2_norm();
+          std::fill (h.begin(), h.end(), 0.);
+          for (unsigned int pass=0; pass<2; ++pass)
+            {
+              std::vector<double> h_pass (n_basis+1);
+              for (unsigned int i=0; i<=n_basis; ++i)
+                h_pass[i] = *V[i] * w;
+              for (unsigned int i=0; i<=n_basis; ++i)
+                {
+                  w.add (-h_pass[i], *V[i]);
+                  h[i] += h_pass[i];
+                }
+            }
+          for (unsigned int i=0; i<=n_basis; ++i)
+            T(i,n_basis) = T(n_basis,i) = h[i];
+
+          beta = w.l2_norm();
+          ++n_basis;
+          if (beta <= 1e-12 * norm_Av)
+            breakdown = true;
+          else
+            w.scale (1./beta);
+        }
+      if (breakdown)
+        beta = 0;
+      Assert (n_basis >= n_eigenpairs,
+              ExcMessage ("The Krylov space is invariant with dimension less "
+                          "than the number of requested eigenpairs"));
+
+      // Ritz pairs of the wanted end of the spectrum and estimates of their
+      // residuals
+      FullMatrix<double> T_basis (n_basis, n_basis);
+      for (unsigned int i=0; i<n_basis; ++i)
+        for (unsigned int j=0; j<n_basis; ++j)
+          T_basis(i,j) = T(i,j);
+      internal::EigenSolvers::symmetric_eigenpairs (T_basis, ritz_values,
+                                                    ritz_vectors);
+      for (unsigned int i=0; i<n_basis; ++i)
+        wanted[i] = additional_data.compute_largest ? n_basis-1-i : i;
+
+      double max_residual = 0;
+      for (unsigned int i=0; i<n_eigenpairs; ++i)
+        max_residual = std::max (max_residual,
+                                 beta * std::fabs(ritz_vectors(n_basis-1,
+                                                               wanted[i])));
+      conv = this->control().check (cycle, max_residual);
+      if (conv != SolverControl::iterate)
+        break;
+
+      // thick restart: keep the best Ritz vectors, half way between the
+      // number of wanted ones and the size of the basis, followed by the
+      // last Lanczos vector
+      n_kept = std::min (n_eigenpairs + (n_basis-n_eigenpairs)/2, n_basis-1);
+      for (unsigned int i=0; i<n_kept; ++i)
+        internal::EigenSolvers::linear_combination
+        (std::vector<VECTOR *>(V.begin(), V.begin()+n_basis), ritz_vectors,
+         wanted[i], 0, *V_new[i]);
+      for (unsigned int i=0; i<n_kept; ++i)
+        std::swap (V[i], V_new[i]);
+      std::swap (V[n_kept], V[n_basis]);
+
+      T = 0;
+      for (unsigned int i=0; i<n_kept; ++i)
+        T(i,i) = ritz_values(wanted[i]);
+    }
+
+  eigenvalues.resize (n_eigenpairs);
+  for (unsigned int i=0; i<n_eigenpairs; ++i)
+    {
+      eigenvalues[i] = ritz_values(wanted[i]);
+      internal::EigenSolvers::linear_combination
+      (std::vector<VECTOR *>(V.begin(), V.begin()+n_basis), ritz_vectors,
+       wanted[i], 0, eigenvectors[i]);
+    }
+
+  for (unsigned int i=0; i<V.size(); ++i)
+    this->memory.free (V[i]);
+  for (unsigned int i=0; i<V_new.size(); ++i)
+    this->memory.free (V_new[i]);
+
+  deallog.pop();
+
+  // in case of failure: throw exception
+  if (this->control().last_check() != SolverControl::success)
+    AssertThrow(false, SolverControl::NoConvergence (this->control().last_step(),
+                                                     this->control().last_value()));
+  // otherwise exit as normal
+}
+
 DEAL_II_NAMESPACE_CLOSE
 
 #endif
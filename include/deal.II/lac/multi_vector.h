@@ -0,0 +1,392 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __deal2__multi_vector_h
+#define __deal2__multi_vector_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/base/aligned_vector.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/numbers.h>
+#include <deal.II/lac/vector.h>
+
+#include <vector>
+#include <cmath>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+/*! @addtogroup Vectors
+ *@{
+ */
+
+/**
+ * A set of vectors of the same size stored as one dense block, for use in
+ * algorithms that work on several vectors at once such as block Krylov
+ * solvers, eigenvalue solvers iterating on a subspace, or solvers for several
+ * right hand sides.
+ *
+ * The entries are stored row by row, i.e., the entries of all columns
+ * (vectors) belonging to the same row index are adjacent in memory. This
+ * layout is chosen for the benefit of sparse matrix-vector products: the
+ * function SparseMatrix::vmult() taking MultiVector arguments loads each
+ * matrix entry once and applies it to all columns, and the entries of the
+ * source vector accessed for one matrix entry are contiguous. For 4 to 16
+ * columns, this is several times faster per column than individual
+ * matrix-vector products, since the latter are limited by the memory
+ * bandwidth for loading the matrix.
+ *
+ * Memory is allocated through AlignedVector, so the start of each row is
+ * suitably aligned for vectorized access when the number of columns is a
+ * multiple of the SIMD width.
+ */
+template <typename Number>
+class MultiVector : public Subscriptor
+{
+public:
+  /**
+   * Declare standard types used in all containers.
+   */
+  typedef Number                                            value_type;
+  typedef types::global_dof_index                           size_type;
+  typedef typename numbers::NumberTraits<Number>::real_type real_type;
+
+  /**
+   * Default constructor. Creates an empty object.
+   */
+  MultiVector ();
+
+  /**
+   * Constructor. Create a set of @p n_columns vectors of size @p n_rows,
+   * initialized to zero.
+   */
+  MultiVector (const size_type    n_rows,
+               const unsigned int n_columns);
+
+  /**
+   * Change the dimensions to @p n_rows times @p n_columns. Unless @p
+   * omit_zeroing_entries is set, all entries are set to zero.
+   */
+  void reinit (const size_type    n_rows,
+               const unsigned int n_columns,
+               const bool         omit_zeroing_entries = false);
+
+  /**
+   * Change the dimensions to the ones of @p other. Unless @p
+   * omit_zeroing_entries is set, all entries are set to zero.
+   */
+  template <typename Number2>
+  void reinit (const MultiVector<Number2> &other,
+               const bool                 omit_zeroing_entries = false);
+
+  /**
+   * Swap the contents of this object and @p other.
+   */
+  void swap (MultiVector<Number> &other);
+
+  /**
+   * Set all entries to the scalar @p s.
+   */
+  MultiVector<Number> &operator = (const Number s);
+
+  /**
+   * Return the size of each of the vectors, i.e., the number of rows.
+   */
+  size_type size () const;
+
+  /**
+   * Return the number of vectors, i.e., the number of columns.
+   */
+  unsigned int n_columns () const;
+
+  /**
+   * Read-write access to entry @p column of row @p row.
+   */
+  Number &operator () (const size_type    row,
+                       const unsigned int column);
+
+  /**
+   * Read access to entry @p column of row @p row.
+   */
+  const Number &operator () (const size_type    row,
+                             const unsigned int column) const;
+
+  /**
+   * Pointer to the first entry. The entries of row <tt>i</tt> start at
+   * <tt>begin()+i*n_columns()</tt>.
+   */
+  Number *begin ();
+
+  /**
+   * Pointer to the first entry, constant version.
+   */
+  const Number *begin () const;
+
+  /**
+   * Copy the entries of the vector @p v into column @p column.
+   */
+  template <typename Number2>
+  void set_column (const unsigned int     column,
+                   const Vector<Number2> &v);
+
+  /**
+   * Copy the entries of column @p column into the vector @p v, which is
+   * resized if necessary.
+   */
+  template <typename Number2>
+  void extract_column (const unsigned int column,
+                       Vector<Number2>   &v) const;
+
+  /**
+   * Compute the $l_2$ norms of all columns, stored in @p norms.
+   */
+  void column_l2_norms (std::vector<real_type> &norms) const;
+
+  /**
+   * Determine an estimate for the memory consumption (in bytes) of this
+   * object.
+   */
+  std::size_t memory_consumption () const;
+
+private:
+  /**
+   * The number of rows.
+   */
+  size_type n_rows;
+
+  /**
+   * The number of columns.
+   */
+  unsigned int n_cols;
+
+  /**
+   * The entries, stored row by row.
+   */
+  AlignedVector<Number> values;
+};
+
+/*@}*/
+
+/*----------------------- Inline functions ----------------------------------*/
+
+#ifndef DOXYGEN
+
+template <typename Number>
+inline
+MultiVector<Number>::MultiVector ()
+  :
+  n_rows (0),
+  n_cols (0)
+{}
+
+
+
+template <typename Number>
+inline
+MultiVector<Number>::MultiVector (const size_type    n_rows,
+                                  const unsigned int n_columns)
+  :
+  n_rows (0),
+  n_cols (0)
+{
+  reinit (n_rows, n_columns);
+}
+
+
+
+template <typename Number>
+inline
+void
+MultiVector<Number>::reinit (const size_type    n_rows,
+                             const unsigned int n_columns,
+                             const bool         omit_zeroing_entries)
+{
+  this->n_rows = n_rows;
+  n_cols = n_columns;
+  values.resize_fast (static_cast<std::size_t>(n_rows) * n_columns);
+  if (omit_zeroing_entries == false)
+    values.fill (Number());
+}
+
+
+
+template <typename Number>
+template <typename Number2>
+inline
+void
+MultiVector<Number>::reinit (const MultiVector<Number2> &other,
+                             const bool                 omit_zeroing_entries)
+{
+  reinit (other.size(), other.n_columns(), omit_zeroing_entries);
+}
+
+
+
+template <typename Number>
+inline
+void
+MultiVector<Number>::swap (MultiVector<Number> &other)
+{
+  std::swap (n_rows, other.n_rows);
+  std::swap (n_cols, other.n_cols);
+  values.swap (other.values);
+}
+
+
+
+template <typename Number>
+inline
+MultiVector<Number> &
+MultiVector<Number>::operator = (const Number s)
+{
+  Assert (numbers::is_finite(s), ExcNumberNotFinite());
+  values.fill (s);
+  return *this;
+}
+
+
+
+template <typename Number>
+inline
+typename MultiVector<Number>::size_type
+MultiVector<Number>::size () const
+{
+  return n_rows;
+}
+
+
+
+template <typename Number>
+inline
+unsigned int
+MultiVector<Number>::n_columns () const
+{
+  return n_cols;
+}
+
+
+
+template <typename Number>
+inline
+Number &
+MultiVector<Number>::operator () (const size_type    row,
+                                  const unsigned int column)
+{
+  AssertIndexRange (row, n_rows);
+  AssertIndexRange (column, n_cols);
+  return values[static_cast<std::size_t>(row)*n_cols+column];
+}
+
+
+
+template <typename Number>
+inline
+const Number &
+MultiVector<Number>::operator () (const size_type    row,
+                                  const unsigned int column) const
+{
+  AssertIndexRange (row, n_rows);
+  AssertIndexRange (column, n_cols);
+  return values[static_cast<std::size_t>(row)*n_cols+column];
+}
+
+
+
+template <typename Number>
+inline
+Number *
+MultiVector<Number>::begin ()
+{
+  return values.begin();
+}
+
+
+
+template <typename Number>
+inline
+const Number *
+MultiVector<Number>::begin () const
+{
+  return values.begin();
+}
+
+
+
+template <typename Number>
+template <typename Number2>
+inline
+void
+MultiVector<Number>::set_column (const unsigned int     column,
+                                 const Vector<Number2> &v)
+{
+  AssertDimension (v.size(), n_rows);
+  AssertIndexRange (column, n_cols);
+  Number *entry = values.begin() + column;
+  for (size_type i=0; i<n_rows; ++i, entry += n_cols)
+    *entry = v(i);
+}
+
+
+
+template <typename Number>
+template <typename Number2>
+inline
+void
+MultiVector<Number>::extract_column (const unsigned int column,
+                                     Vector<Number2>   &v) const
+{
+  AssertIndexRange (column, n_cols);
+  if (v.size() != n_rows)
+    v.reinit (n_rows, true);
+  const Number *entry = values.begin() + column;
+  for (size_type i=0; i<n_rows; ++i, entry += n_cols)
+    v(i) = *entry;
+}
+
+
+
+template <typename Number>
+inline
+void
+MultiVector<Number>::column_l2_norms (std::vector<real_type> &norms) const
+{
+  norms.resize (n_cols);
+  std::fill (norms.begin(), norms.end(), real_type());
+  const Number *entry = values.begin();
+  for (size_type i=0; i<n_rows; ++i)
+    for (unsigned int c=0; c<n_cols; ++c, ++entry)
+      norms[c] += numbers::NumberTraits<Number>::abs_square(*entry);
+  for (unsigned int c=0; c<n_cols; ++c)
+    norms[c] = std::sqrt (norms[c]);
+}
+
+
+
+template <typename Number>
+inline
+std::size_t
+MultiVector<Number>::memory_consumption () const
+{
+  return (sizeof(*this) + values.memory_consumption());
+}
+
+#endif // DOXYGEN
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
@@ -453,6 +453,15 @@ namespace parallel
        * update_ghost_values_finish() is invoked, it is mandatory to specify a
        * unique communication channel to each such call, in order to avoid
        * several messages with the same ID that will corrupt this operation.
+       *
+       * If the partitioner exchanges ghost values through shared memory (see
+       * Utilities::MPI::Partitioner::use_shared_memory_ghost_exchange()),
+       * only empty messages are sent to processors on the same node to signal
+       * that the data is ready, and the values are copied from the memory of
+       * the owner in update_ghost_values_finish(). The signal that the data
+       * has been read is sent through the communicator of the node, see
+       * Utilities::MPI::Partitioner::get_shared_memory_communicator(), with
+       * the channel as tag. The channel must then be smaller than 32767.
        */
       void update_ghost_values_start (const unsigned int communication_channel = 0) const;
 
@@ -466,6 +475,27 @@ namespace parallel
        */
       void update_ghost_values_finish () const;
 
+      /**
+       * Give MPI the opportunity to make progress on the communication
+       * initiated by update_ghost_values_start() and compress_start(), by
+       * testing the outstanding requests without waiting for them.
+       *
+       * Most MPI implementations do not have an asynchronous progress thread,
+       * which means that messages, in particular large ones that use a
+       * rendezvous protocol, are only transferred while the process is inside
+       * an MPI call. When the time between a @p _start and the corresponding
+       * @p _finish call is spent in computations only, the communication
+       * does not overlap with these computations but happens in the @p
+       * _finish call. Calling this function every now and then during the
+       * computations, as done by MatrixFree::cell_loop() between chunks of
+       * cells, lets the data exchange proceed in the background.
+       *
+       * It is safe to call this function at any time, also when no
+       * communication has been started. It is thread safe with respect to the
+       * other communication functions of this class.
+       */
+      void poll_communication () const;
+
       /**
        * This method zeros the entries on ghost dofs, but does not touch
        * locally owned DoFs.
@@ -1057,13 +1087,38 @@ namespace parallel
        * machinery, but it does not remove the need for a receive operation to
        * be posted before the data can actually be sent.
        */
-      std::vector<MPI_Request>   compress_requests;
+      mutable std::vector<MPI_Request>   compress_requests;
 
       /**
        * A vector that collects all requests from @p update_ghost_values()
        * operations. This class uses persistent MPI communicators.
        */
       mutable std::vector<MPI_Request>   update_ghost_values_requests;
+
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+      /**
+       * The MPI-3 shared memory window holding @p import_data in case the
+       * partitioner exchanges ghost values through shared memory. The window
+       * is freed by the deleter of the shared pointer. Empty otherwise, in
+       * which case @p import_data is allocated with new[].
+       */
+      std_cxx11::shared_ptr<MPI_Win> import_data_window;
+
+      /**
+       * For each ghost target of the partitioner on the same node, the
+       * position in the import data of the owning processor where the ghost
+       * values of this processor are read from. Null for targets on other
+       * nodes.
+       */
+      std::vector<const Number *> shared_ghost_sources;
+
+      /**
+       * Requests with which processors on the same node tell the owners of
+       * their ghost values that they are done reading them from the shared
+       * memory window, so that the import data may be overwritten again.
+       */
+      mutable std::vector<MPI_Request> shared_memory_done_requests;
+#endif
 #endif
 
       /**
@@ -1079,6 +1134,27 @@ namespace parallel
        */
       void clear_mpi_requests ();
 
+      /**
+       * Free the memory of @p import_data, either with delete[] or by
+       * releasing the shared memory window.
+       */
+      void free_import_data ();
+
+      /**
+       * If the partitioner exchanges ghost values through shared memory,
+       * allocate @p import_data in a shared memory window and find the
+       * locations of the ghost values in the windows of the other processors
+       * on the node. This is a collective operation on the processors of the
+       * node.
+       */
+      void allocate_shared_import_data ();
+
+      /**
+       * Wait until all processors on the same node have read the ghost
+       * values from @p import_data, so that it can be overwritten.
+       */
+      void wait_for_shared_memory_readers () const;
+
       /**
        * A helper function that is used to resize the val array.
        */
@@ -1207,11 +1283,8 @@ namespace parallel
         delete[] val;
       val = 0;
 
-      if (import_data != 0)
-        delete[] import_data;
-      import_data = 0;
-
       clear_mpi_requests();
+      free_import_data();
     }
 
 
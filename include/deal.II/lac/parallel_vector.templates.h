@@ -24,6 +24,8 @@
 #include <deal.II/lac/petsc_parallel_vector.h>
 #include <deal.II/lac/trilinos_vector.h>
 
+#include <cstring>
+
 DEAL_II_NAMESPACE_OPEN
 
 
@@ -32,11 +34,45 @@ namespace parallel
   namespace distributed
   {
 
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+    namespace internal
+    {
+      /**
+       * Deleter for the shared memory window of the import data. Windows
+       * are freed collectively, but only while MPI is still active.
+       */
+      struct FreeWindow
+      {
+        void operator() (MPI_Win *window) const
+        {
+          int finalized = 0;
+          MPI_Finalized (&finalized);
+          if (finalized == 0 && *window != MPI_WIN_NULL)
+            {
+              MPI_Win_unlock_all (*window);
+              MPI_Win_free (window);
+            }
+          delete window;
+        }
+      };
+    }
+#endif
+
+
+
     template <typename Number>
     void
     Vector<Number>::clear_mpi_requests ()
     {
 #ifdef DEAL_II_WITH_MPI
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+      // the processors on the same node might still be reading from our
+      // window, so make sure they are done before releasing the requests
+      wait_for_shared_memory_readers ();
+      for (size_type j=0; j<shared_memory_done_requests.size(); j++)
+        MPI_Request_free(&shared_memory_done_requests[j]);
+      shared_memory_done_requests.clear();
+#endif
       for (size_type j=0; j<compress_requests.size(); j++)
         MPI_Request_free(&compress_requests[j]);
       compress_requests.clear();
@@ -48,6 +84,97 @@ namespace parallel
 
 
 
+    template <typename Number>
+    void
+    Vector<Number>::free_import_data ()
+    {
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+      if (import_data_window.get() != 0)
+        {
+          import_data_window.reset ();
+          shared_ghost_sources.clear ();
+          import_data = 0;
+          return;
+        }
+#endif
+      if (import_data != 0)
+        delete[] import_data;
+      import_data = 0;
+    }
+
+
+
+    template <typename Number>
+    void
+    Vector<Number>::allocate_shared_import_data ()
+    {
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+      const Utilities::MPI::Partitioner &part = *partitioner;
+      if (part.use_shared_memory_ghost_exchange() == false)
+        return;
+
+      Assert (import_data == 0 && import_data_window.get() == 0,
+              ExcInternalError());
+      Number *base_pointer = 0;
+      MPI_Win window;
+      int ierr = MPI_Win_allocate_shared (static_cast<MPI_Aint>(part.n_import_indices())*
+                                          sizeof(Number), sizeof(Number),
+                                          MPI_INFO_NULL,
+                                          part.get_shared_memory_communicator(),
+                                          &base_pointer, &window);
+      AssertThrow (ierr == MPI_SUCCESS, ExcInternalError());
+      import_data_window.reset (new MPI_Win(window), internal::FreeWindow());
+
+      // the processors access the windows with load and store operations,
+      // synchronized by MPI_Win_sync and point-to-point messages, which
+      // requires a passive target epoch for the whole lifetime of the window
+      ierr = MPI_Win_lock_all (MPI_MODE_NOCHECK, window);
+      AssertThrow (ierr == MPI_SUCCESS, ExcInternalError());
+      if (part.n_import_indices() > 0)
+        import_data = base_pointer;
+
+      const std::vector<unsigned int> &shared_ranks =
+        part.ghost_targets_shared_memory_ranks();
+      shared_ghost_sources.resize (shared_ranks.size());
+      for (unsigned int i=0; i<shared_ranks.size(); ++i)
+        if (shared_ranks[i] != numbers::invalid_unsigned_int)
+          {
+            MPI_Aint size;
+            int disp_unit;
+            Number *owner_pointer = 0;
+            ierr = MPI_Win_shared_query (window, shared_ranks[i], &size,
+                                         &disp_unit, &owner_pointer);
+            AssertThrow (ierr == MPI_SUCCESS, ExcInternalError());
+            AssertDimension (disp_unit, static_cast<int>(sizeof(Number)));
+            shared_ghost_sources[i] = owner_pointer +
+                                      part.ghost_targets_shared_memory_offsets()[i];
+          }
+        else
+          shared_ghost_sources[i] = 0;
+#endif
+    }
+
+
+
+    template <typename Number>
+    void
+    Vector<Number>::wait_for_shared_memory_readers () const
+    {
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+      // inactive requests (before the first ghost update) complete
+      // immediately
+      if (shared_memory_done_requests.size() > 0)
+        {
+          int ierr = MPI_Waitall (shared_memory_done_requests.size(),
+                                  &shared_memory_done_requests[0],
+                                  MPI_STATUSES_IGNORE);
+          Assert (ierr == MPI_SUCCESS, ExcInternalError());
+        }
+#endif
+    }
+
+
+
     template <typename Number>
     void
     Vector<Number>::resize_val (const size_type new_alloc_size)
@@ -85,9 +212,7 @@ namespace parallel
       vector_view.reinit (size, val);
 
       // delete previous content in import data
-      if (import_data != 0)
-        delete[] import_data;
-      import_data = 0;
+      free_import_data();
 
       // set partitioner to serial version
       partitioner.reset (new Utilities::MPI::Partitioner (size));
@@ -121,6 +246,9 @@ namespace parallel
                                                partitioner->n_ghost_indices();
           resize_val (new_allocated_size);
           vector_view.reinit (partitioner->local_size(), val);
+
+          free_import_data();
+          allocate_shared_import_data();
         }
       else
         Assert (vector_view.size() == partitioner->local_size(),
@@ -129,16 +257,13 @@ namespace parallel
       if (fast == false)
         this->operator= (Number());
 
-      if (import_data != 0)
-        {
-          delete [] import_data;
-
-          // do not reallocate import_data directly, but only upon request. It
-          // is only used as temporary storage for compress() and
-          // update_ghost_values, and we might have vectors where we never
-          // call these methods and hence do not need to have the storage.
-          import_data = 0;
-        }
+      // do not reallocate import_data directly, but only upon request. It is
+      // only used as temporary storage for compress() and
+      // update_ghost_values, and we might have vectors where we never call
+      // these methods and hence do not need to have the storage. The shared
+      // memory window is kept, though, since it is allocated collectively
+      if (partitioner->use_shared_memory_ghost_exchange() == false)
+        free_import_data();
 
       vector_is_ghosted = false;
     }
@@ -191,16 +316,14 @@ namespace parallel
       // initialize to zero
       this->operator= (Number());
 
-      if (import_data != 0)
-        {
-          delete [] import_data;
-
-          // do not reallocate import_data directly, but only upon request. It
-          // is only used as temporary storage for compress() and
-          // update_ghost_values, and we might have vectors where we never
-          // call these methods and hence do not need to have the storage.
-          import_data = 0;
-        }
+      // do not reallocate import_data directly, but only upon request. It is
+      // only used as temporary storage for compress() and
+      // update_ghost_values, and we might have vectors where we never call
+      // these methods and hence do not need to have the storage. Only the
+      // shared memory window must be set up here, since its allocation is
+      // collective
+      free_import_data();
+      allocate_shared_import_data();
 
       vector_is_ghosted = false;
     }
@@ -330,6 +453,10 @@ namespace parallel
       // make this function thread safe
       Threads::Mutex::ScopedLock lock (mutex);
 
+      // the import data is the receive buffer, so processors on the same
+      // node must be done reading ghost values from it
+      wait_for_shared_memory_readers ();
+
       const size_type n_import_targets = part.import_targets().size();
       const size_type n_ghost_targets  = part.ghost_targets().size();
 
@@ -344,7 +471,7 @@ namespace parallel
           compress_requests.resize (n_import_targets + n_ghost_targets);
 
           // allocate import_data in case it is not set up yet
-          if (import_data == 0)
+          if (import_data == 0 && part.n_import_indices() > 0)
             import_data = new Number[part.n_import_indices()];
           for (size_type i=0; i<n_import_targets; i++)
             {
@@ -443,8 +570,17 @@ namespace parallel
           // the ones already present
           if (operation != dealii::VectorOperation::insert)
             for ( ; my_imports!=part.import_indices().end(); ++my_imports)
-              for (size_type j=my_imports->first; j<my_imports->second; j++)
-                local_element(j) += *read_position++;
+              {
+                // the import indices are stored as ranges of contiguous
+                // indices, so work on plain arrays that the compiler can
+                // vectorize
+                Number *write_position = val + my_imports->first;
+                const size_type chunk_size = my_imports->second - my_imports->first;
+                AssertIndexRange (my_imports->second, part.local_size()+1);
+                for (size_type j=0; j<chunk_size; ++j)
+                  write_position[j] += read_position[j];
+                read_position += chunk_size;
+              }
           else
             for ( ; my_imports!=part.import_indices().end(); ++my_imports)
               for (size_type j=my_imports->first; j<my_imports->second;
@@ -493,6 +629,17 @@ namespace parallel
       const size_type n_import_targets = part.import_targets().size();
       const size_type n_ghost_targets = part.ghost_targets().size();
 
+      // with shared memory, processors on the same node only get an empty
+      // message that signals that the data is ready in the import data of
+      // this processor. they must be done reading the data of the previous
+      // exchange before it can be overwritten
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+      const bool use_shared_memory = part.use_shared_memory_ghost_exchange();
+      wait_for_shared_memory_readers ();
+#else
+      const bool use_shared_memory = false;
+#endif
+
       // Need to send and receive the data. Use non-blocking communication,
       // where it is generally less overhead to first initiate the receive and
       // then actually send the data
@@ -504,9 +651,14 @@ namespace parallel
           update_ghost_values_requests.resize (n_import_targets+n_ghost_targets);
           for (size_type i=0; i<n_ghost_targets; i++)
             {
+              const bool on_node = (use_shared_memory &&
+                                    part.ghost_targets_shared_memory_ranks()[i] !=
+                                    numbers::invalid_unsigned_int);
+
               // allow writing into ghost indices even though we are in a
               // const function
               MPI_Recv_init (const_cast<Number *>(&val[current_index_start]),
+                             on_node ? 0 :
                              part.ghost_targets()[i].second*sizeof(Number),
                              MPI_BYTE,
                              part.ghost_targets()[i].first,
@@ -525,7 +677,11 @@ namespace parallel
           current_index_start = 0;
           for (size_type i=0; i<n_import_targets; i++)
             {
+              const bool on_node = (use_shared_memory &&
+                                    part.import_targets_shared_memory_ranks()[i] !=
+                                    numbers::invalid_unsigned_int);
               MPI_Send_init (&import_data[current_index_start],
+                             on_node ? 0 :
                              part.import_targets()[i].second*sizeof(Number),
                              MPI_BYTE, part.import_targets()[i].first,
                              part.this_mpi_process() +
@@ -535,20 +691,72 @@ namespace parallel
               current_index_start += part.import_targets()[i].second;
             }
           AssertDimension (current_index_start, part.n_import_indices());
+
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+          // set up the messages that signal the owners on the same node that
+          // we are done reading. they are sent through the node communicator,
+          // which carries no other point-to-point messages, so the channel
+          // alone can serve as tag. unlike tags that also contain the rank,
+          // it stays below 32767, the largest tag that every MPI
+          // implementation is required to support, for any number of
+          // processors
+          if (use_shared_memory)
+            {
+              Assert (counter < 32767,
+                      ExcIndexRange (counter, 0, 32767));
+              for (size_type i=0; i<n_ghost_targets; i++)
+                if (part.ghost_targets_shared_memory_ranks()[i] !=
+                    numbers::invalid_unsigned_int)
+                  {
+                    shared_memory_done_requests.push_back (MPI_Request());
+                    MPI_Send_init (0, 0, MPI_BYTE,
+                                   part.ghost_targets_shared_memory_ranks()[i],
+                                   counter,
+                                   part.get_shared_memory_communicator(),
+                                   &shared_memory_done_requests.back());
+                  }
+              for (size_type i=0; i<n_import_targets; i++)
+                if (part.import_targets_shared_memory_ranks()[i] !=
+                    numbers::invalid_unsigned_int)
+                  {
+                    shared_memory_done_requests.push_back (MPI_Request());
+                    MPI_Recv_init (0, 0, MPI_BYTE,
+                                   part.import_targets_shared_memory_ranks()[i],
+                                   counter,
+                                   part.get_shared_memory_communicator(),
+                                   &shared_memory_done_requests.back());
+                  }
+            }
+#endif
         }
 
       // copy the data that is actually to be send to the import_data field
       if (part.n_import_indices() > 0)
         {
           Assert (import_data != 0, ExcInternalError());
+          // the import indices are stored as ranges of contiguous indices,
+          // so copy each of them as a whole
           Number *write_position = import_data;
           std::vector<std::pair<size_type, size_type> >::const_iterator
           my_imports = part.import_indices().begin();
           for ( ; my_imports!=part.import_indices().end(); ++my_imports)
-            for (size_type j=my_imports->first; j<my_imports->second; j++)
-              *write_position++ = local_element(j);
+            {
+              const size_type chunk_size = my_imports->second - my_imports->first;
+              AssertIndexRange (my_imports->second, part.local_size()+1);
+              std::memcpy (write_position, val + my_imports->first,
+                           chunk_size*sizeof(Number));
+              write_position += chunk_size;
+            }
+          AssertDimension (write_position-import_data, part.n_import_indices());
         }
 
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+      // make the new data visible to the other processors before they
+      // receive the message that it is ready
+      if (use_shared_memory)
+        MPI_Win_sync (*import_data_window);
+#endif
+
       AssertDimension (n_import_targets+n_ghost_targets,
                        update_ghost_values_requests.size());
       if (update_ghost_values_requests.size() > 0)
@@ -583,6 +791,31 @@ namespace parallel
                                   &update_ghost_values_requests[0],
                                   MPI_STATUSES_IGNORE);
           Assert (ierr == MPI_SUCCESS, ExcInternalError());
+
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+          // all owners on the same node have signaled that their data is
+          // ready, so copy it from their windows into the ghost range and
+          // tell them when we are done
+          if (partitioner->use_shared_memory_ghost_exchange())
+            {
+              MPI_Win_sync (*import_data_window);
+              const Utilities::MPI::Partitioner &part = *partitioner;
+              Number *ghost_values = const_cast<Number *>(val) + part.local_size();
+              for (size_type i=0; i<part.ghost_targets().size(); ++i)
+                {
+                  if (shared_ghost_sources[i] != 0)
+                    std::memcpy (ghost_values, shared_ghost_sources[i],
+                                 part.ghost_targets()[i].second*sizeof(Number));
+                  ghost_values += part.ghost_targets()[i].second;
+                }
+              if (shared_memory_done_requests.size() > 0)
+                {
+                  ierr = MPI_Startall (shared_memory_done_requests.size(),
+                                       &shared_memory_done_requests[0]);
+                  Assert (ierr == MPI_SUCCESS, ExcInternalError());
+                }
+            }
+#endif
         }
 #endif
       vector_is_ghosted = true;
@@ -590,6 +823,42 @@ namespace parallel
 
 
 
+    template <typename Number>
+    void
+    Vector<Number>::poll_communication () const
+    {
+#ifdef DEAL_II_WITH_MPI
+      if (update_ghost_values_requests.size() == 0 &&
+          compress_requests.size() == 0)
+        return;
+
+      // make this function thread safe
+      Threads::Mutex::ScopedLock lock (mutex);
+
+      // MPI_Testall does not change requests that are still in flight, so
+      // the _finish() functions will wait for them as usual. requests that
+      // have completed or were never started become inactive, for which
+      // MPI_Waitall returns immediately
+      int flag;
+      if (update_ghost_values_requests.size() > 0)
+        {
+          int ierr = MPI_Testall (update_ghost_values_requests.size(),
+                                  &update_ghost_values_requests[0],
+                                  &flag, MPI_STATUSES_IGNORE);
+          Assert (ierr == MPI_SUCCESS, ExcInternalError());
+        }
+      if (compress_requests.size() > 0)
+        {
+          int ierr = MPI_Testall (compress_requests.size(),
+                                  &compress_requests[0],
+                                  &flag, MPI_STATUSES_IGNORE);
+          Assert (ierr == MPI_SUCCESS, ExcInternalError());
+        }
+#endif
+    }
+
+
+
     template <typename Number>
     void
     Vector<Number>::swap (Vector<Number> &v)
@@ -620,6 +889,11 @@ namespace parallel
 
       std::swap (compress_requests, v.compress_requests);
       std::swap (update_ghost_values_requests, v.update_ghost_values_requests);
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+      std::swap (import_data_window, v.import_data_window);
+      std::swap (shared_ghost_sources, v.shared_ghost_sources);
+      std::swap (shared_memory_done_requests, v.shared_memory_done_requests);
+#endif
 #endif
 
       std::swap (partitioner,       v.partitioner);
@@ -903,6 +903,20 @@ private:
  * This class is useful e.g. in multigrid smoother objects, since it is
  * trivially %parallel (assuming that matrix-vector products are %parallel).
  *
+ * The range of eigenvalues the polynomial acts on is estimated by a Lanczos
+ * iteration on the matrix weighted by its diagonal when calling initialize().
+ * Since this estimate costs a few matrix-vector products, it can be skipped
+ * when the preconditioner is rebuilt for a matrix with known spectrum (e.g.
+ * in time stepping, or when only the right hand side changes): query the
+ * estimate with get_eigenvalue_information() and pass it back through
+ * AdditionalData::set_eigenvalue_information() on the next initialization.
+ *
+ * If the matrix is a SparseMatrix and the vector a Vector, the matrix-vector
+ * product and the vector updates of each Chebyshev step are performed in a
+ * single sweep through the data by SparseMatrix::Chebyshev_step(), so that
+ * one application of a polynomial of degree $k$ costs little more than $k$
+ * matrix-vector products.
+ *
  * @author Martin Kronbichler, 2009
  */
 template <class MATRIX=SparseMatrix<double>, class VECTOR=Vector<double> >
@@ -914,6 +928,39 @@ public:
    */
   typedef types::global_dof_index size_type;
 
+  /**
+   * Eigenvalue estimates the Chebyshev polynomial has been set up with. This
+   * can be obtained from an initialized preconditioner through
+   * get_eigenvalue_information() and be reused for initializing another
+   * preconditioner without running the eigenvalue estimation again.
+   */
+  struct EigenvalueInformation
+  {
+    /**
+     * Constructor. Sets all fields to zero, i.e., no estimate available.
+     */
+    EigenvalueInformation ();
+
+    /**
+     * Estimate for the smallest eigenvalue of the matrix weighted by its
+     * diagonal.
+     */
+    double min_eigenvalue_estimate;
+
+    /**
+     * Estimate for the largest eigenvalue of the matrix weighted by its
+     * diagonal, including the safety factor applied after the Lanczos
+     * iteration.
+     */
+    double max_eigenvalue_estimate;
+
+    /**
+     * Number of Lanczos iterations performed to obtain the estimates. Zero if
+     * the estimates were given by the user.
+     */
+    unsigned int n_iterations;
+  };
+
   /**
    * Standardized data struct to pipe additional parameters to the
    * preconditioner.
@@ -928,7 +975,19 @@ public:
                     const bool         nonzero_starting    = false,
                     const unsigned int eig_cg_n_iterations = 8,
                     const double       eig_cg_residual     = 1e-2,
-                    const double       max_eigenvalue      = 1);
+                    const double       max_eigenvalue      = 1,
+                    const double       min_eigenvalue      = 0.,
+                    const double       eig_tolerance       = 0.);
+
+    /**
+     * Set the fields of this structure such that the preconditioner does not
+     * estimate the eigenvalues but uses the ones given in the argument, as
+     * obtained from PreconditionChebyshev::get_eigenvalue_information() of a
+     * previously initialized preconditioner. This sets
+     * eig_cg_n_iterations to zero and fills max_eigenvalue and
+     * min_eigenvalue.
+     */
+    void set_eigenvalue_information (const EigenvalueInformation &info);
 
     /**
      * This determines the degree of the Chebyshev polynomial. The degree of
@@ -963,15 +1022,26 @@ public:
     bool nonzero_starting;
 
     /**
-     * Maximum number of CG iterations performed for finding the maximum
+     * Maximum number of Lanczos iterations performed for finding the maximum
      * eigenvalue. If set to zero, no computations are performed and the
-     * eigenvalues according to the given input are used instead.
+     * eigenvalues according to the given input are used instead. The
+     * iteration may stop earlier, see @p eig_cg_residual and @p
+     * eig_tolerance.
      */
     unsigned int eig_cg_n_iterations;
 
     /**
      * Tolerance for CG iterations performed for finding the maximum
-     * eigenvalue.
+     * eigenvalue. The Lanczos iteration is stopped as soon as the residual
+     * of the equivalent conjugate gradient method, preconditioned by the
+     * diagonal and applied to a system with a constant right hand side of
+     * norm one, falls below this value. This is the same criterion that
+     * stopped the CG iteration of earlier versions of this class, which
+     * ignored the value, though, and always performed @p
+     * eig_cg_n_iterations steps. With the default value of 1e-2, the
+     * estimate therefore often takes fewer iterations and gives a slightly
+     * smaller largest eigenvalue than before. Set this value to zero to get
+     * the fixed number of iterations of earlier versions.
      */
     double eig_cg_residual;
 
@@ -982,6 +1052,23 @@ public:
      */
     double max_eigenvalue;
 
+    /**
+     * Minimum eigenvalue to work with. Only in effect if @p
+     * eig_cg_n_iterations is set to zero. If zero, the minimum eigenvalue is
+     * set to <tt>max_eigenvalue/smoothing_range</tt>.
+     */
+    double min_eigenvalue;
+
+    /**
+     * Relative tolerance for terminating the Lanczos iteration before @p
+     * eig_cg_n_iterations steps: The iteration is stopped as soon as the
+     * estimate for the largest eigenvalue changes by less than this fraction
+     * between two consecutive steps. Since the largest eigenvalue converges
+     * fast, a tolerance of 1e-2 usually stops after a few iterations. The
+     * default value of zero always performs @p eig_cg_n_iterations steps.
+     */
+    double eig_tolerance;
+
     /**
      * Stores the inverse of the diagonal of the underlying matrix.
      */
@@ -998,12 +1085,18 @@ public:
    * can be supplied with the help of the AdditionalData field.
    *
    * This function calculates an estimate of the eigenvalue range of the
-   * matrix weighted by its diagonal using a modified CG iteration in case the
+   * matrix weighted by its diagonal using a Lanczos iteration in case the
    * given number of iterations is positive.
    */
   void initialize (const MATRIX         &matrix,
                    const AdditionalData &additional_data = AdditionalData());
 
+  /**
+   * Return the eigenvalue estimates the Chebyshev polynomial was set up with
+   * in the last call to initialize().
+   */
+  EigenvalueInformation get_eigenvalue_information () const;
+
   /**
    * Computes the action of the preconditioner on <tt>src</tt>, storing the
    * result in <tt>dst</tt>.
@@ -1040,11 +1133,22 @@ private:
    */
   mutable VECTOR update2;
 
+  /**
+   * Internal vector used for the <tt>vmult</tt> operation in case the
+   * matrix-vector product is fused with the vector updates.
+   */
+  mutable VECTOR update3;
+
   /**
    * Stores the additional data provided to the initialize function.
    */
   AdditionalData data;
 
+  /**
+   * Stores the eigenvalue estimates computed or provided in initialize().
+   */
+  EigenvalueInformation eigenvalue_information;
+
   /**
    * Average of the largest and smallest eigenvalue under consideration.
    */
@@ -1711,6 +1815,189 @@ namespace internal
 
       const VECTOR &diagonal_vector;
     };
+
+    // perform one step of the Chebyshev iteration, i.e., compute the
+    // residual with the matrix and update the solution. generic version
+    // running the matrix-vector product and the vector updates one after
+    // the other, updating the solution in place
+    template <typename MATRIX, typename VECTOR>
+    inline
+    void
+    vmult_and_update (const MATRIX &matrix,
+                      const VECTOR &src,
+                      const VECTOR &matrix_diagonal_inverse,
+                      const double  factor1,
+                      const double  factor2,
+                      VECTOR &update1,
+                      VECTOR &update2,
+                      VECTOR *&solution,
+                      VECTOR *&)
+    {
+      matrix.vmult (update2, *solution);
+      vector_updates (src, matrix_diagonal_inverse, false, factor1, factor2,
+                      update1, update2, *solution);
+    }
+
+    // selection for SparseMatrix and deal.II vector: the sparse matrix can
+    // do the matrix-vector product and the updates in one sweep. the new
+    // iterate must go into a separate vector since the old one is still
+    // read, so the two vectors swap their roles in every step
+    template <typename number, typename Number>
+    inline
+    void
+    vmult_and_update (const ::dealii::SparseMatrix<number> &matrix,
+                      const ::dealii::Vector<Number> &src,
+                      const ::dealii::Vector<Number> &matrix_diagonal_inverse,
+                      const double  factor1,
+                      const double  factor2,
+                      ::dealii::Vector<Number> &update1,
+                      ::dealii::Vector<Number> &,
+                      ::dealii::Vector<Number> *&solution,
+                      ::dealii::Vector<Number> *&other)
+    {
+      matrix.Chebyshev_step (*other, update1, *solution, src,
+                             matrix_diagonal_inverse,
+                             static_cast<Number>(factor1),
+                             static_cast<Number>(factor2));
+      std::swap (solution, other);
+    }
+
+    // whether vmult_and_update() alternates between two vectors for the
+    // given types
+    template <typename MATRIX, typename VECTOR>
+    inline
+    bool
+    vmult_and_update_alternates (const MATRIX &,
+                                 const VECTOR &)
+    {
+      return false;
+    }
+
+    template <typename number, typename Number>
+    inline
+    bool
+    vmult_and_update_alternates (const ::dealii::SparseMatrix<number> &,
+                                 const ::dealii::Vector<Number> &)
+    {
+      return true;
+    }
+
+    // estimate the smallest and largest eigenvalue of the matrix weighted by
+    // the inverse of its diagonal, D^{-1} A, by a Lanczos iteration. The
+    // operator is symmetric with respect to the inner product induced by D,
+    // so we carry along both the Lanczos vectors q and their counterparts
+    // p = D q, which avoids forming D itself. Since the Lanczos iteration
+    // is the one underlying the conjugate gradient method for a constant
+    // right hand side of norm one, the residual of CG can be computed from the
+    // tridiagonal matrix, and the iteration stops as soon as it falls below
+    // residual_tolerance. Returns the number of iterations performed.
+    template <typename MATRIX, typename VECTOR>
+    unsigned int
+    lanczos_eigenvalue_estimates (const MATRIX       &matrix,
+                                  const VECTOR       &matrix_diagonal_inverse,
+                                  const unsigned int  max_iterations,
+                                  const double        tolerance,
+                                  const double        residual_tolerance,
+                                  double             &min_eigenvalue,
+                                  double             &max_eigenvalue)
+    {
+      GrowingVectorMemory<VECTOR> memory;
+      typename VectorMemory<VECTOR>::Pointer p (memory), q (memory),
+               p_old (memory), q_old (memory), y (memory), w (memory);
+      p->reinit (matrix_diagonal_inverse, true);
+      q->reinit (matrix_diagonal_inverse, true);
+      p_old->reinit (matrix_diagonal_inverse);
+      q_old->reinit (matrix_diagonal_inverse);
+      y->reinit (matrix_diagonal_inverse, true);
+      w->reinit (matrix_diagonal_inverse, true);
+
+      // start with a vector that consists of ones only, weighted by the
+      // length
+      *p = 1./std::sqrt(static_cast<double>(matrix.m()));
+      *q = *p;
+      q->scale (matrix_diagonal_inverse);
+      double beta = std::sqrt (*p * *q);
+      *p /= beta;
+      *q /= beta;
+
+      // the norm of the right hand side, which is the initial residual of
+      // CG, in the inner product induced by D. its Euclidean norm is one
+      const double initial_residual = beta;
+      beta = 0;
+
+      std::vector<double> diagonal, offdiagonal;
+      min_eigenvalue = max_eigenvalue = 1.;
+      double old_max_eigenvalue = 0;
+      unsigned int it = 0;
+      for ( ; it < max_iterations; ++it)
+        {
+          matrix.vmult (*y, *q);
+          const double alpha = *q * *y;
+          diagonal.push_back (alpha);
+
+          // orthogonalize against the last two Lanczos vectors in the inner
+          // product induced by D
+          y->add (-alpha, *p, -beta, *p_old);
+          *w = *y;
+          w->scale (matrix_diagonal_inverse);
+          const double beta_sqr = *y * *w;
+
+          // compute the eigenvalues of the tridiagonal matrix collected so
+          // far in case we need them for the convergence check or for the
+          // final result. if the new Lanczos vector vanishes, we have found
+          // an invariant subspace and the eigenvalues are exact
+          bool converged = (beta_sqr <= 1e-28 * alpha * alpha);
+
+          // the CG iterate is Q y with T y = initial_residual e_1, and its
+          // residual is the new Lanczos vector times the last entry of y,
+          // which we get by elimination on the tridiagonal matrix
+          if (residual_tolerance > 0 && converged == false)
+            {
+              double pivot = diagonal[0], y_last = initial_residual / pivot;
+              for (unsigned int i=1; i<diagonal.size(); ++i)
+                {
+                  pivot = diagonal[i] - offdiagonal[i-1] * offdiagonal[i-1] / pivot;
+                  y_last = -offdiagonal[i-1] * y_last / pivot;
+                }
+              if (std::abs (y_last) * std::sqrt (*y * *y) < residual_tolerance)
+                converged = true;
+            }
+          if (it+1 == max_iterations || converged ||
+              (tolerance > 0 && it >= 1))
+            {
+              TridiagonalMatrix<double> T (diagonal.size(), true);
+              for (unsigned int i=0; i<diagonal.size(); ++i)
+                {
+                  T(i,i) = diagonal[i];
+                  if (i+1 < diagonal.size())
+                    T(i,i+1) = offdiagonal[i];
+                }
+              T.compute_eigenvalues ();
+              min_eigenvalue = T.eigenvalue (0);
+              max_eigenvalue = T.eigenvalue (T.n()-1);
+              if (tolerance > 0 && it >= 2 &&
+                  std::abs (max_eigenvalue - old_max_eigenvalue) <
+                  tolerance * std::abs (max_eigenvalue))
+                converged = true;
+              old_max_eigenvalue = max_eigenvalue;
+            }
+          if (converged)
+            {
+              ++it;
+              break;
+            }
+
+          beta = std::sqrt (beta_sqr);
+          offdiagonal.push_back (beta);
+          p_old->swap (*p);
+          p->swap (*y);
+          *p /= beta;
+          q_old->swap (*q);
+          q->swap (*w);
+          *q /= beta;
+        }
+      return it;
+    }
   }
 }
 
@@ -1724,14 +2011,43 @@ AdditionalData (const unsigned int degree,
                 const bool         nonzero_starting,
                 const unsigned int eig_cg_n_iterations,
                 const double       eig_cg_residual,
-                const double       max_eigenvalue)
+                const double       max_eigenvalue,
+                const double       min_eigenvalue,
+                const double       eig_tolerance)
   :
   degree  (degree),
   smoothing_range (smoothing_range),
   nonzero_starting (nonzero_starting),
   eig_cg_n_iterations (eig_cg_n_iterations),
   eig_cg_residual (eig_cg_residual),
-  max_eigenvalue (max_eigenvalue)
+  max_eigenvalue (max_eigenvalue),
+  min_eigenvalue (min_eigenvalue),
+  eig_tolerance (eig_tolerance)
+{}
+
+
+
+template <class MATRIX, class VECTOR>
+inline
+void
+PreconditionChebyshev<MATRIX,VECTOR>::AdditionalData::
+set_eigenvalue_information (const EigenvalueInformation &info)
+{
+  eig_cg_n_iterations = 0;
+  max_eigenvalue = info.max_eigenvalue_estimate;
+  min_eigenvalue = info.min_eigenvalue_estimate;
+}
+
+
+
+template <class MATRIX, class VECTOR>
+inline
+PreconditionChebyshev<MATRIX,VECTOR>::EigenvalueInformation::
+EigenvalueInformation ()
+  :
+  min_eigenvalue_estimate (0.),
+  max_eigenvalue_estimate (0.),
+  n_iterations (0)
 {}
 
 
@@ -1763,88 +2079,36 @@ PreconditionChebyshev<MATRIX,VECTOR>::initialize (const MATRIX &matrix,
     }
 
 
-  // calculate largest eigenvalue using a hand-tuned CG iteration on the
-  // matrix weighted by its diagonal. we start with a vector that consists of
-  // ones only, weighted by the length.
+  // calculate largest eigenvalue using a Lanczos iteration on the matrix
+  // weighted by its diagonal
   double max_eigenvalue, min_eigenvalue;
+  unsigned int n_iterations = 0;
   if (data.eig_cg_n_iterations > 0)
     {
       Assert (additional_data.eig_cg_n_iterations > 2,
               ExcMessage ("Need to set at least two iterations to find eigenvalues."));
 
-      // attach stream to SolverCG, run it with log report for eigenvalues
-      std::ostream *old_stream = deallog.has_file() ? &deallog.get_file_stream() :
-                                 static_cast<std::ostream *>(0);
-      if (old_stream)
-        deallog.detach();
-
-      std::ostringstream log_msg;
-      deallog.attach(log_msg);
-
-      // set a very strict tolerance to force at least two iterations
-      ReductionControl control (data.eig_cg_n_iterations, 1e-20, 1e-20);
-      GrowingVectorMemory<VECTOR> memory;
-      VECTOR *rhs = memory.alloc();
-      VECTOR *dummy = memory.alloc();
-      rhs->reinit(data.matrix_diagonal_inverse, true);
-      dummy->reinit(data.matrix_diagonal_inverse);
-      *rhs = 1./std::sqrt(static_cast<double>(matrix.m()));
-
-      typename SolverCG<VECTOR>::AdditionalData cg_data;
-      cg_data.compute_eigenvalues = true;
-      SolverCG<VECTOR> solver (control, memory, cg_data);
-      internal::PreconditionChebyshev::DiagonalPreconditioner<VECTOR>
-      preconditioner(data.matrix_diagonal_inverse);
-      try
-        {
-          solver.solve(matrix, *dummy, *rhs, preconditioner);
-        }
-      catch (SolverControl::NoConvergence &)
-        {
-        }
-      Assert(control.last_step() >= 2,
-             ExcMessage("Could not find eigenvalues"));
-
-      memory.free(dummy);
-      memory.free(rhs);
-
-      // read the log stream: grab the first and last eigenvalue
-      std::string cg_message = log_msg.str();
-      const std::size_t pos = cg_message.find("cg:: ");
-      if (pos != std::string::npos)
-        {
-          cg_message.erase(0, pos+5);
-          std::string first = cg_message;
-
-          if (cg_message.find_first_of(" ") != std::string::npos)
-            first.erase(cg_message.find_first_of(" "), std::string::npos);
-          std::istringstream(first)      >> min_eigenvalue;
+      n_iterations = internal::PreconditionChebyshev::lanczos_eigenvalue_estimates
+                     (matrix, data.matrix_diagonal_inverse,
+                      data.eig_cg_n_iterations, data.eig_tolerance,
+                      data.eig_cg_residual, min_eigenvalue, max_eigenvalue);
 
-          if (cg_message.find_last_of(" ") != std::string::npos)
-            {
-              cg_message.erase(0, cg_message.find_last_of(" ")+1);
-              std::istringstream(cg_message) >> max_eigenvalue;
-            }
-          else max_eigenvalue = min_eigenvalue;
-        }
-      else
-        min_eigenvalue = max_eigenvalue = 1;
-
-      // reset deal.II stream
-      deallog.detach();
-      if (old_stream)
-        deallog.attach(*old_stream);
-
-      // include a safety factor since the CG method will in general not be
-      // converged
+      // include a safety factor since the Lanczos method will in general not
+      // be converged
       max_eigenvalue *= 1.2;
     }
   else
     {
       max_eigenvalue = data.max_eigenvalue;
-      min_eigenvalue = data.max_eigenvalue/data.smoothing_range;
+      min_eigenvalue = (data.min_eigenvalue > 0 ?
+                        data.min_eigenvalue :
+                        data.max_eigenvalue/data.smoothing_range);
     }
 
+  eigenvalue_information.min_eigenvalue_estimate = min_eigenvalue;
+  eigenvalue_information.max_eigenvalue_estimate = max_eigenvalue;
+  eigenvalue_information.n_iterations = n_iterations;
+
   const double alpha = (data.smoothing_range > 1. ?
                         max_eigenvalue / data.smoothing_range :
                         std::min(0.9*max_eigenvalue, min_eigenvalue));
@@ -1853,12 +2117,24 @@ PreconditionChebyshev<MATRIX,VECTOR>::initialize (const MATRIX &matrix,
 
   update1.reinit (data.matrix_diagonal_inverse, true);
   update2.reinit (data.matrix_diagonal_inverse, true);
+  update3.reinit (data.matrix_diagonal_inverse, true);
 
   is_initialized = true;
 }
 
 
 
+template <class MATRIX, class VECTOR>
+inline
+typename PreconditionChebyshev<MATRIX,VECTOR>::EigenvalueInformation
+PreconditionChebyshev<MATRIX,VECTOR>::get_eigenvalue_information () const
+{
+  Assert (is_initialized, ExcMessage("Preconditioner not initialized"));
+  return eigenvalue_information;
+}
+
+
+
 template <class MATRIX, class VECTOR>
 inline
 void
@@ -1866,29 +2142,40 @@ PreconditionChebyshev<MATRIX,VECTOR>::vmult (VECTOR &dst,
                                              const VECTOR &src) const
 {
   Assert (is_initialized, ExcMessage("Preconditioner not initialized"));
+
+  // if the steps alternate between dst and update3, start in the vector
+  // that makes the last iterate end up in dst
+  VECTOR *solution = &dst, *other = &update3;
+  if (data.degree % 2 == 1 &&
+      internal::PreconditionChebyshev::vmult_and_update_alternates
+      (*matrix_ptr, dst))
+    std::swap (solution, other);
+
   double rhok  = delta / theta,  sigma = theta / delta;
   if (data.nonzero_starting && !dst.all_zero())
     {
-      matrix_ptr->vmult (update2, dst);
+      if (solution != &dst)
+        *solution = dst;
+      matrix_ptr->vmult (update2, *solution);
       internal::PreconditionChebyshev::vector_updates
       (src, data.matrix_diagonal_inverse, false, 0., 1./theta, update1,
-       update2, dst);
+       update2, *solution);
     }
   else
     internal::PreconditionChebyshev::vector_updates
     (src, data.matrix_diagonal_inverse, true, 0., 1./theta, update1,
-     update2, dst);
+     update2, *solution);
 
   for (unsigned int k=0; k<data.degree; ++k)
     {
-      matrix_ptr->vmult (update2, dst);
       const double rhokp = 1./(2.*sigma-rhok);
       const double factor1 = rhokp * rhok, factor2 = 2.*rhokp/delta;
       rhok = rhokp;
-      internal::PreconditionChebyshev::vector_updates
-      (src, data.matrix_diagonal_inverse, false, factor1, factor2, update1,
-       update2, dst);
+      internal::PreconditionChebyshev::vmult_and_update
+      (*matrix_ptr, src, data.matrix_diagonal_inverse, factor1, factor2,
+       update1, update2, solution, other);
     }
+  Assert (solution == &dst, ExcInternalError());
 }
 
 
@@ -1936,6 +2223,7 @@ void PreconditionChebyshev<MATRIX,VECTOR>::clear ()
   data.matrix_diagonal_inverse.reinit(0);
   update1.reinit(0);
   update2.reinit(0);
+  update3.reinit(0);
 }
 
 
@@ -27,12 +27,15 @@
 #include <deal.II/lac/full_matrix.h>
 #include <deal.II/lac/lapack_full_matrix.h>
 #include <deal.II/lac/vector.h>
+#include <deal.II/lac/multi_vector.h>
 
 #include <vector>
 #include <cmath>
 
 DEAL_II_NAMESPACE_OPEN
 
+template <typename number> class SparseMatrix;
+
 /*!@addtogroup Solvers */
 /*@{*/
 
@@ -98,6 +101,179 @@ namespace internal
        */
       unsigned int offset;
     };
+
+
+
+    /**
+     * Multiplication of a matrix with several vectors at once, as needed by
+     * the block versions of the GMRES solvers. The general version calls
+     * <tt>A.vmult</tt> for one vector after the other. The specialization
+     * for SparseMatrix and Vector below copies the vectors into a
+     * MultiVector and uses the product of SparseMatrix with MultiVector,
+     * which loads the matrix only once for all vectors.
+     */
+    template <class MATRIX, class VECTOR>
+    class BlockVmult
+    {
+    public:
+      /**
+       * Set <tt>*dst[i] = A *src[i]</tt> for all <tt>i</tt>.
+       */
+      void vmult (const MATRIX                &A,
+                  const std::vector<VECTOR *> &dst,
+                  const std::vector<VECTOR *> &src);
+    };
+
+
+
+    /**
+     * Specialization of BlockVmult for SparseMatrix and Vector.
+     */
+    template <typename number, typename number2>
+    class BlockVmult<dealii::SparseMatrix<number>, dealii::Vector<number2> >
+    {
+    public:
+      /**
+       * Set <tt>*dst[i] = A *src[i]</tt> for all <tt>i</tt>.
+       */
+      void vmult (const dealii::SparseMatrix<number>           &A,
+                  const std::vector<dealii::Vector<number2> *> &dst,
+                  const std::vector<dealii::Vector<number2> *> &src);
+
+    private:
+      /**
+       * The source and destination vectors in the layout of MultiVector,
+       * kept between calls to avoid repeated allocation.
+       */
+      MultiVector<number2> src_block;
+      MultiVector<number2> dst_block;
+    };
+
+
+
+    /**
+     * A subspace $U$ together with its image $C$ under the (preconditioned)
+     * system matrix, where the vectors of $C$ are orthonormal. The GMRES
+     * solvers keep such a subspace across restarts and across calls to
+     * solve() to recycle search directions, see the documentation of
+     * SolverGMRES. The vectors are allocated from the memory pool given to
+     * the constructor, and are owned by this object.
+     */
+    template <class VECTOR>
+    class RecycledSubspace
+    {
+    public:
+      /**
+       * Constructor. Creates an empty subspace.
+       */
+      RecycledSubspace (VectorMemory<VECTOR> &vmem);
+
+      /**
+       * Destructor. Releases all vectors.
+       */
+      ~RecycledSubspace ();
+
+      /**
+       * Release all vectors.
+       */
+      void clear ();
+
+      /**
+       * Return the number of vectors in the subspace.
+       */
+      unsigned int size () const;
+
+      /**
+       * The vectors $U$.
+       */
+      const std::vector<VECTOR *> &u () const;
+
+      /**
+       * The vectors $C$.
+       */
+      const std::vector<VECTOR *> &c () const;
+
+      /**
+       * Add the vector @p u with image @p c. Both vectors are orthogonalized
+       * against the present subspace, and the oldest vector is dropped if
+       * the subspace already holds @p max_size vectors. Ownership of the
+       * vectors, which must have been allocated from the memory pool of
+       * this object, is transferred to this object.
+       */
+      void add (VECTOR            *u,
+                VECTOR            *c,
+                const unsigned int max_size);
+
+      /**
+       * Orthonormalize the vectors $C$ again, applying the same
+       * transformation to $U$. This is needed after the vectors $C$ have
+       * been recomputed for a changed matrix. Vectors that have become
+       * linearly dependent are removed.
+       */
+      void orthonormalize ();
+
+      /**
+       * Minimize the residual @p r over the subspace: since $C$ is
+       * orthonormal, this amounts to adding $UC^Tr$ to @p x and subtracting
+       * $CC^Tr$ from @p r.
+       */
+      void minimize_residual (VECTOR &x,
+                              VECTOR &r) const;
+
+      /**
+       * Orthogonalize @p w against $C$, storing the coefficients in column
+       * @p column of @p b.
+       */
+      void orthogonalize (VECTOR             &w,
+                          FullMatrix<double> &b,
+                          const unsigned int  column) const;
+
+      /**
+       * Subtract $UBy$ from @p x. Search directions whose images were
+       * orthogonalized against $C$ with coefficients $B$ need this
+       * correction.
+       */
+      void subtract (VECTOR                   &x,
+                     const FullMatrix<double> &b,
+                     const dealii::Vector<double> &y) const;
+
+    private:
+      /**
+       * Pool the vectors are obtained from.
+       */
+      VectorMemory<VECTOR> &mem;
+
+      /**
+       * The vectors $U$.
+       */
+      std::vector<VECTOR *> u_vectors;
+
+      /**
+       * The vectors $C$.
+       */
+      std::vector<VECTOR *> c_vectors;
+    };
+
+
+
+    /**
+     * Orthogonalize @p w against the vectors <tt>v[0]</tt> to
+     * <tt>v[n_vectors-1]</tt>, storing the coefficients in column @p column
+     * of @p h, and append the normalized result as new vector
+     * <tt>v[n_vectors]</tt> unless it is linearly dependent on the previous
+     * vectors, judged relative to @p reference_norm. Returns whether the
+     * vector was appended. Used for building the basis of the block
+     * methods.
+     */
+    template <class VECTOR>
+    bool
+    append_to_block_basis (TmpVectors<VECTOR> &v,
+                           unsigned int       &n_vectors,
+                           VECTOR             &w,
+                           const double        reference_norm,
+                           FullMatrix<double> &h,
+                           const unsigned int  column,
+                           const VECTOR       &temp);
   }
 }
 
@@ -147,6 +323,32 @@ namespace internal
  * speed, since a longer basis means minimization over a larger
  * space.
  *
+ * <h3>Recycling of subspaces</h3>
+ *
+ * If AdditionalData::max_n_recycled_vectors is positive, the solver keeps a
+ * subspace $U$ of at most that many vectors together with its image $C$
+ * under the preconditioned matrix across restarts and across calls to
+ * solve(), and minimizes the residual over the sum of $U$ and the Krylov
+ * space as in the GCRO method by de Sturler. This is the same scheme as in
+ * SolverFGMRES, whose documentation describes it in more detail. With left
+ * preconditioning, $C=P^{-1}AU$ and the preconditioned residual is
+ * minimized, with right preconditioning $C=AU$. At the start of every
+ * solve, $C$ is recomputed from $U$ since the matrix or the preconditioner
+ * may have changed. Recycling does not support computing eigenvalue
+ * estimates or using the non-default residual.
+ *
+ * <h3>Multiple right hand sides</h3>
+ *
+ * The solve() function taking vectors of solution and right hand side
+ * vectors runs the block version of the method described in the
+ * documentation of SolverFGMRES, with left or right preconditioning as
+ * selected in AdditionalData. The Arnoldi basis of
+ * <tt>max_n_tmp_vectors-2</tt> vectors is shared between all right hand
+ * sides. If the matrix is a SparseMatrix and the vectors are of type
+ * Vector, the matrix is multiplied with all vectors of a block at once
+ * through MultiVector, which loads the matrix only once per block. The
+ * recycled subspace is not used by the block version.
+ *
  * For the requirements on matrices and vectors in order to work with
  * this class, see the documentation of the Solver base class.
  *
@@ -171,7 +373,8 @@ public:
                     const bool right_preconditioning = false,
                     const bool use_default_residual = true,
                     const bool force_re_orthogonalization = false,
-                    const bool compute_eigenvalues = false);
+                    const bool compute_eigenvalues = false,
+                    const unsigned int max_n_recycled_vectors = 0);
 
     /**
      * Maximum number of temporary vectors. This parameter controls the size
@@ -212,6 +415,12 @@ public:
      * @note Requires LAPACK support.
      */
     bool compute_eigenvalues;
+
+    /**
+     * Maximum number of vectors kept in the recycled subspace between
+     * restarts and between calls to solve(). Zero disables recycling.
+     */
+    unsigned int max_n_recycled_vectors;
   };
 
   /**
@@ -238,6 +447,28 @@ public:
          const VECTOR         &b,
          const PRECONDITIONER &precondition);
 
+  /**
+   * Solve the linear systems $Ax_i=b_i$ for all right hand sides $b_i$ at
+   * once with the block version of the method described in the class
+   * documentation. The vectors in @p x serve as starting values.
+   */
+  template<class MATRIX, class PRECONDITIONER>
+  void
+  solve (const MATRIX              &A,
+         std::vector<VECTOR>       &x,
+         const std::vector<VECTOR> &b,
+         const PRECONDITIONER      &precondition);
+
+  /**
+   * Discard the recycled subspace collected in previous calls to solve().
+   */
+  void clear_recycled_subspace ();
+
+  /**
+   * Return the number of vectors currently held in the recycled subspace.
+   */
+  unsigned int n_recycled_vectors () const;
+
   DeclException1 (ExcTooFewTmpVectors,
                   int,
                   << "The number of temporary vectors you gave ("
@@ -292,6 +523,32 @@ protected:
 
 
 private:
+  /**
+   * Implementation of solve() for the case that a recycled subspace is
+   * used.
+   */
+  template<class MATRIX, class PRECONDITIONER>
+  void
+  solve_with_recycling (const MATRIX         &A,
+                        VECTOR               &x,
+                        const VECTOR         &b,
+                        const PRECONDITIONER &precondition);
+
+  /**
+   * Recompute $C$ from $U$ for the current matrix and preconditioner, and
+   * orthonormalize it. The subspace is discarded if its vectors do not have
+   * the size of @p x.
+   */
+  template<class MATRIX, class PRECONDITIONER>
+  void update_recycled_subspace (const MATRIX         &A,
+                                 const PRECONDITIONER &precondition,
+                                 const VECTOR         &x);
+
+  /**
+   * The recycled subspace.
+   */
+  internal::SolverGMRES::RecycledSubspace<VECTOR> recycled;
+
   /**
    * No copy constructor.
    */
@@ -312,6 +569,43 @@ private:
  * of <tt>2 * SolverFGMRESAdditionalData::max_basis_size+1</tt>
  * auxiliary vectors.
  *
+ * <h3>Recycling of subspaces</h3>
+ *
+ * When a sequence of related linear systems is solved, e.g. in implicit
+ * time stepping or in parameter sweeps, much of the information collected
+ * in one solve is useful for the next one. If
+ * AdditionalData::max_n_recycled_vectors is positive, the solver keeps a
+ * subspace $U$ of that many vectors together with $C=AU$, $C$ having
+ * orthonormal columns, across restarts and across calls to solve(). At the
+ * beginning of each cycle, the residual is minimized over $U$, and the
+ * Arnoldi vectors are orthogonalized against $C$, so that the residual is
+ * minimized over the sum of $U$ and the Krylov space as in the GCRO method
+ * by de Sturler. After each cycle, the correction computed in the cycle is
+ * added to $U$, replacing the oldest vector once the subspace is full.
+ *
+ * Since the matrix may change between two calls to solve(), $C$ is
+ * recomputed from $U$ at the start of every solve, which costs
+ * <tt>max_n_recycled_vectors</tt> matrix-vector products. The subspace is
+ * discarded with clear_recycled_subspace(), which is necessary in particular
+ * when the size of the vectors changes.
+ *
+ * <h3>Multiple right hand sides</h3>
+ *
+ * The solve() function taking vectors of solution and right hand side
+ * vectors runs a block version of the method: all right hand sides share
+ * one Krylov space built from the preconditioned residuals of all systems,
+ * so each system benefits from the search directions of the others. The
+ * number of block steps before a restart is
+ * AdditionalData::max_basis_size divided by the number of right hand sides,
+ * keeping the memory consumption the same as for a single system. Linearly
+ * dependent directions are removed from the block as they appear. The
+ * convergence criterion is applied to the largest residual of all systems.
+ * If the matrix is a SparseMatrix and the vectors are of type Vector, the
+ * matrix is multiplied with all vectors of a block at once through
+ * MultiVector, which loads the matrix only once per block. The same is done
+ * when the images of the recycled subspace are recomputed at the start of
+ * solve(). The recycled subspace is not used by the block version.
+ *
  * Caveat: documentation of this class is not up to date. There are
  * also a few parameters of GMRES we would like to introduce here.
  *
@@ -332,15 +626,23 @@ public:
      * the default residual (cf. class documentation).
      */
     AdditionalData(const unsigned int max_basis_size = 30,
-                   const bool /*use_default_residual*/ = true)
+                   const bool /*use_default_residual*/ = true,
+                   const unsigned int max_n_recycled_vectors = 0)
       :
-      max_basis_size(max_basis_size)
+      max_basis_size(max_basis_size),
+      max_n_recycled_vectors(max_n_recycled_vectors)
     {}
 
     /**
      * Maximum number of tmp vectors.
      */
     unsigned int    max_basis_size;
+
+    /**
+     * Maximum number of vectors kept in the recycled subspace between
+     * restarts and between calls to solve(). Zero disables recycling.
+     */
+    unsigned int    max_n_recycled_vectors;
   };
 
   /**
@@ -357,6 +659,11 @@ public:
   SolverFGMRES (SolverControl        &cn,
                 const AdditionalData &data=AdditionalData());
 
+  /**
+   * Destructor. Releases the vectors of the recycled subspace.
+   */
+  ~SolverFGMRES ();
+
   /**
    * Solve the linear system $Ax=b$ for x.
    */
@@ -367,11 +674,48 @@ public:
          const VECTOR         &b,
          const PRECONDITIONER &precondition);
 
+  /**
+   * Solve the linear systems $Ax_i=b_i$ for all right hand sides $b_i$ at
+   * once with the block version of the method described in the class
+   * documentation. The vectors in @p x serve as starting values.
+   */
+  template<class MATRIX, class PRECONDITIONER>
+  void
+  solve (const MATRIX              &A,
+         std::vector<VECTOR>       &x,
+         const std::vector<VECTOR> &b,
+         const PRECONDITIONER      &precondition);
+
+  /**
+   * Discard the recycled subspace collected in previous calls to solve().
+   */
+  void clear_recycled_subspace ();
+
+  /**
+   * Return the number of vectors currently held in the recycled subspace.
+   */
+  unsigned int n_recycled_vectors () const;
+
 private:
+  /**
+   * Recompute $C=AU$ for the current matrix and orthonormalize $C$,
+   * applying the same transformation to $U$. The subspace is discarded if
+   * its vectors do not have the size of @p x.
+   */
+  template<class MATRIX>
+  void update_recycled_subspace (const MATRIX &A,
+                                 const VECTOR &x);
+
   /**
    * Additional flags.
    */
   AdditionalData additional_data;
+
+  /**
+   * The recycled subspace.
+   */
+  internal::SolverGMRES::RecycledSubspace<VECTOR> recycled;
+
   /**
    * Projected system matrix
    */
@@ -441,122 +785,383 @@ namespace internal
       return *data[i-offset];
     }
 
-    // A comparator for better printing eigenvalues
+    template <class MATRIX, class VECTOR>
     inline
-    bool complex_less_pred(const std::complex<double> &x,
-                           const std::complex<double> &y)
+    void
+    BlockVmult<MATRIX,VECTOR>::vmult (const MATRIX                &A,
+                                      const std::vector<VECTOR *> &dst,
+                                      const std::vector<VECTOR *> &src)
     {
-      return x.real() < y.real() || (x.real() == y.real() && x.imag() < y.imag());
+      AssertDimension (dst.size(), src.size());
+      for (unsigned int i=0; i<src.size(); ++i)
+        A.vmult (*dst[i], *src[i]);
     }
-  }
-}
 
 
 
-template <class VECTOR>
-inline
-SolverGMRES<VECTOR>::AdditionalData::
-AdditionalData (const unsigned int max_n_tmp_vectors,
-                const bool         right_preconditioning,
-                const bool         use_default_residual,
-                const bool         force_re_orthogonalization,
-                const bool         compute_eigenvalues)
-  :
-  max_n_tmp_vectors(max_n_tmp_vectors),
-  right_preconditioning(right_preconditioning),
-  use_default_residual(use_default_residual),
-  force_re_orthogonalization(force_re_orthogonalization),
-  compute_eigenvalues (compute_eigenvalues)
-{}
-
+    template <typename number, typename number2>
+    inline
+    void
+    BlockVmult<dealii::SparseMatrix<number>, dealii::Vector<number2> >::
+    vmult (const dealii::SparseMatrix<number>           &A,
+           const std::vector<dealii::Vector<number2> *> &dst,
+           const std::vector<dealii::Vector<number2> *> &src)
+    {
+      AssertDimension (dst.size(), src.size());
+      if (src.size() == 0)
+        return;
+      if (src.size() == 1)
+        {
+          A.vmult (*dst[0], *src[0]);
+          return;
+        }
 
-template <class VECTOR>
-SolverGMRES<VECTOR>::SolverGMRES (SolverControl        &cn,
-                                  VectorMemory<VECTOR> &mem,
-                                  const AdditionalData &data)
-  :
-  Solver<VECTOR> (cn,mem),
-  additional_data(data)
-{}
+      src_block.reinit (A.n(), src.size(), true);
+      dst_block.reinit (A.m(), src.size(), true);
+      for (unsigned int i=0; i<src.size(); ++i)
+        src_block.set_column (i, *src[i]);
+      A.vmult (dst_block, src_block);
+      for (unsigned int i=0; i<dst.size(); ++i)
+        dst_block.extract_column (i, *dst[i]);
+    }
 
 
 
-template <class VECTOR>
-SolverGMRES<VECTOR>::SolverGMRES (SolverControl        &cn,
-                                  const AdditionalData &data) :
-  Solver<VECTOR> (cn),
-  additional_data(data)
-{}
+    template <class VECTOR>
+    inline
+    RecycledSubspace<VECTOR>::RecycledSubspace (VectorMemory<VECTOR> &vmem)
+      :
+      mem (vmem)
+    {}
 
 
 
-template <class VECTOR>
-inline
-void
-SolverGMRES<VECTOR>::givens_rotation (Vector<double> &h,
-                                      Vector<double> &b,
-                                      Vector<double> &ci,
-                                      Vector<double> &si,
-                                      int     col) const
-{
-  for (int i=0 ; i<col ; i++)
+    template <class VECTOR>
+    inline
+    RecycledSubspace<VECTOR>::~RecycledSubspace ()
     {
-      const double s = si(i);
-      const double c = ci(i);
-      const double dummy = h(i);
-      h(i)   =  c*dummy + s*h(i+1);
-      h(i+1) = -s*dummy + c*h(i+1);
-    };
+      clear ();
+    }
 
-  const double r = 1./std::sqrt(h(col)*h(col) + h(col+1)*h(col+1));
-  si(col) = h(col+1) *r;
-  ci(col) = h(col)   *r;
-  h(col)  =  ci(col)*h(col) + si(col)*h(col+1);
-  b(col+1)= -si(col)*b(col);
-  b(col) *=  ci(col);
-}
 
 
+    template <class VECTOR>
+    inline
+    void
+    RecycledSubspace<VECTOR>::clear ()
+    {
+      for (unsigned int i=0; i<u_vectors.size(); ++i)
+        {
+          mem.free (u_vectors[i]);
+          mem.free (c_vectors[i]);
+        }
+      u_vectors.clear();
+      c_vectors.clear();
+    }
 
-template <class VECTOR>
-inline
-double
-SolverGMRES<VECTOR>::modified_gram_schmidt (const internal::SolverGMRES::TmpVectors<VECTOR> &orthogonal_vectors,
-                                            const unsigned int  dim,
-                                            const unsigned int  accumulated_iterations,
-                                            VECTOR             &vv,
-                                            Vector<double>     &h,
-                                            bool               &re_orthogonalize)
-{
-  const unsigned int inner_iteration = dim - 1;
 
-  // need initial norm for detection of re-orthogonalization, see below
-  double norm_vv_start = 0;
-  if (re_orthogonalize == false && inner_iteration % 5 == 4)
-    norm_vv_start = vv.l2_norm();
 
-  // Orthogonalization
-  for (unsigned int i=0 ; i<dim ; ++i)
+    template <class VECTOR>
+    inline
+    unsigned int
+    RecycledSubspace<VECTOR>::size () const
     {
-      h(i) = vv * orthogonal_vectors[i];
-      vv.add(-h(i), orthogonal_vectors[i]);
-    };
+      return u_vectors.size();
+    }
 
-  // Re-orthogonalization if loss of orthogonality detected. For the test, use
-  // a strategy discussed in C. T. Kelley, Iterative Methods for Linear and
-  // Nonlinear Equations, SIAM, Philadelphia, 1995: Compare the norm of vv
-  // after orthogonalization with its norm when starting the
-  // orthogonalization. If vv became very small (here: less than the square
-  // root of the machine precision times 10), it is almost in the span of the
-  // previous vectors, which indicates loss of precision.
-  if (re_orthogonalize == false && inner_iteration % 5 == 4)
+
+
+    template <class VECTOR>
+    inline
+    const std::vector<VECTOR *> &
+    RecycledSubspace<VECTOR>::u () const
     {
-      const double norm_vv = vv.l2_norm();
-      if (norm_vv > 10. * norm_vv_start *
-          std::sqrt(std::numeric_limits<typename VECTOR::value_type>::epsilon()))
-        return norm_vv;
+      return u_vectors;
+    }
 
-      else
+
+
+    template <class VECTOR>
+    inline
+    const std::vector<VECTOR *> &
+    RecycledSubspace<VECTOR>::c () const
+    {
+      return c_vectors;
+    }
+
+
+
+    template <class VECTOR>
+    inline
+    void
+    RecycledSubspace<VECTOR>::add (VECTOR            *u,
+                                   VECTOR            *c,
+                                   const unsigned int max_size)
+    {
+      const double initial_norm = c->l2_norm();
+      for (unsigned int i=0; i<c_vectors.size(); ++i)
+        {
+          const double factor = *c * *c_vectors[i];
+          c->add (-factor, *c_vectors[i]);
+          u->add (-factor, *u_vectors[i]);
+        }
+      const double norm = c->l2_norm();
+
+      // discard the new direction if it is (numerically) contained in the
+      // present subspace
+      if (max_size == 0 ||
+          !(norm > 1e-10 * initial_norm) || !numbers::is_finite(1./norm))
+        {
+          mem.free (u);
+          mem.free (c);
+          return;
+        }
+
+      *u *= 1./norm;
+      *c *= 1./norm;
+      if (u_vectors.size() >= max_size)
+        {
+          mem.free (u_vectors.front());
+          mem.free (c_vectors.front());
+          u_vectors.erase (u_vectors.begin());
+          c_vectors.erase (c_vectors.begin());
+        }
+      u_vectors.push_back (u);
+      c_vectors.push_back (c);
+    }
+
+
+
+    template <class VECTOR>
+    inline
+    void
+    RecycledSubspace<VECTOR>::orthonormalize ()
+    {
+      std::vector<VECTOR *> old_u, old_c;
+      old_u.swap (u_vectors);
+      old_c.swap (c_vectors);
+      for (unsigned int i=0; i<old_u.size(); ++i)
+        add (old_u[i], old_c[i], old_u.size());
+    }
+
+
+
+    template <class VECTOR>
+    inline
+    void
+    RecycledSubspace<VECTOR>::minimize_residual (VECTOR &x,
+                                                 VECTOR &r) const
+    {
+      for (unsigned int i=0; i<c_vectors.size(); ++i)
+        {
+          const double factor = r * *c_vectors[i];
+          x.add (factor, *u_vectors[i]);
+          r.add (-factor, *c_vectors[i]);
+        }
+    }
+
+
+
+    template <class VECTOR>
+    inline
+    void
+    RecycledSubspace<VECTOR>::orthogonalize (VECTOR             &w,
+                                             FullMatrix<double> &b,
+                                             const unsigned int  column) const
+    {
+      for (unsigned int i=0; i<c_vectors.size(); ++i)
+        {
+          b(i,column) = w * *c_vectors[i];
+          w.add (-b(i,column), *c_vectors[i]);
+        }
+    }
+
+
+
+    template <class VECTOR>
+    inline
+    void
+    RecycledSubspace<VECTOR>::subtract (VECTOR                   &x,
+                                        const FullMatrix<double> &b,
+                                        const dealii::Vector<double> &y) const
+    {
+      for (unsigned int i=0; i<u_vectors.size(); ++i)
+        {
+          double factor = 0;
+          for (unsigned int j=0; j<y.size(); ++j)
+            factor += b(i,j) * y(j);
+          x.add (-factor, *u_vectors[i]);
+        }
+    }
+
+
+
+    template <class VECTOR>
+    inline
+    bool
+    append_to_block_basis (TmpVectors<VECTOR> &v,
+                           unsigned int       &n_vectors,
+                           VECTOR             &w,
+                           const double        reference_norm,
+                           FullMatrix<double> &h,
+                           const unsigned int  column,
+                           const VECTOR       &temp)
+    {
+      for (unsigned int i=0; i<n_vectors; ++i)
+        {
+          h(i,column) = w * v[i];
+          w.add (-h(i,column), v[i]);
+        }
+      const double norm = w.l2_norm();
+      if (!(norm > 1e-12 * reference_norm) || !numbers::is_finite(1./norm))
+        return false;
+
+      h(n_vectors,column) = norm;
+      v(n_vectors,temp).equ (1./norm, w);
+      ++n_vectors;
+      return true;
+    }
+
+
+
+    // A comparator for better printing eigenvalues
+    inline
+    bool complex_less_pred(const std::complex<double> &x,
+                           const std::complex<double> &y)
+    {
+      return x.real() < y.real() || (x.real() == y.real() && x.imag() < y.imag());
+    }
+  }
+}
+
+
+
+template <class VECTOR>
+inline
+SolverGMRES<VECTOR>::AdditionalData::
+AdditionalData (const unsigned int max_n_tmp_vectors,
+                const bool         right_preconditioning,
+                const bool         use_default_residual,
+                const bool         force_re_orthogonalization,
+                const bool         compute_eigenvalues,
+                const unsigned int max_n_recycled_vectors)
+  :
+  max_n_tmp_vectors(max_n_tmp_vectors),
+  right_preconditioning(right_preconditioning),
+  use_default_residual(use_default_residual),
+  force_re_orthogonalization(force_re_orthogonalization),
+  compute_eigenvalues (compute_eigenvalues),
+  max_n_recycled_vectors (max_n_recycled_vectors)
+{}
+
+
+template <class VECTOR>
+SolverGMRES<VECTOR>::SolverGMRES (SolverControl        &cn,
+                                  VectorMemory<VECTOR> &mem,
+                                  const AdditionalData &data)
+  :
+  Solver<VECTOR> (cn,mem),
+  additional_data(data),
+  recycled(this->memory)
+{}
+
+
+
+template <class VECTOR>
+SolverGMRES<VECTOR>::SolverGMRES (SolverControl        &cn,
+                                  const AdditionalData &data) :
+  Solver<VECTOR> (cn),
+  additional_data(data),
+  recycled(this->memory)
+{}
+
+
+
+template <class VECTOR>
+void
+SolverGMRES<VECTOR>::clear_recycled_subspace ()
+{
+  recycled.clear();
+}
+
+
+
+template <class VECTOR>
+unsigned int
+SolverGMRES<VECTOR>::n_recycled_vectors () const
+{
+  return recycled.size();
+}
+
+
+
+template <class VECTOR>
+inline
+void
+SolverGMRES<VECTOR>::givens_rotation (Vector<double> &h,
+                                      Vector<double> &b,
+                                      Vector<double> &ci,
+                                      Vector<double> &si,
+                                      int     col) const
+{
+  for (int i=0 ; i<col ; i++)
+    {
+      const double s = si(i);
+      const double c = ci(i);
+      const double dummy = h(i);
+      h(i)   =  c*dummy + s*h(i+1);
+      h(i+1) = -s*dummy + c*h(i+1);
+    };
+
+  const double r = 1./std::sqrt(h(col)*h(col) + h(col+1)*h(col+1));
+  si(col) = h(col+1) *r;
+  ci(col) = h(col)   *r;
+  h(col)  =  ci(col)*h(col) + si(col)*h(col+1);
+  b(col+1)= -si(col)*b(col);
+  b(col) *=  ci(col);
+}
+
+
+
+template <class VECTOR>
+inline
+double
+SolverGMRES<VECTOR>::modified_gram_schmidt (const internal::SolverGMRES::TmpVectors<VECTOR> &orthogonal_vectors,
+                                            const unsigned int  dim,
+                                            const unsigned int  accumulated_iterations,
+                                            VECTOR             &vv,
+                                            Vector<double>     &h,
+                                            bool               &re_orthogonalize)
+{
+  const unsigned int inner_iteration = dim - 1;
+
+  // need initial norm for detection of re-orthogonalization, see below
+  double norm_vv_start = 0;
+  if (re_orthogonalize == false && inner_iteration % 5 == 4)
+    norm_vv_start = vv.l2_norm();
+
+  // Orthogonalization
+  for (unsigned int i=0 ; i<dim ; ++i)
+    {
+      h(i) = vv * orthogonal_vectors[i];
+      vv.add(-h(i), orthogonal_vectors[i]);
+    };
+
+  // Re-orthogonalization if loss of orthogonality detected. For the test, use
+  // a strategy discussed in C. T. Kelley, Iterative Methods for Linear and
+  // Nonlinear Equations, SIAM, Philadelphia, 1995: Compare the norm of vv
+  // after orthogonalization with its norm when starting the
+  // orthogonalization. If vv became very small (here: less than the square
+  // root of the machine precision times 10), it is almost in the span of the
+  // previous vectors, which indicates loss of precision.
+  if (re_orthogonalize == false && inner_iteration % 5 == 4)
+    {
+      const double norm_vv = vv.l2_norm();
+      if (norm_vv > 10. * norm_vv_start *
+          std::sqrt(std::numeric_limits<typename VECTOR::value_type>::epsilon()))
+        return norm_vv;
+
+      else
         {
           re_orthogonalize = true;
           deallog << "Re-orthogonalization enabled at step "
@@ -592,6 +1197,12 @@ SolverGMRES<VECTOR>::solve (const MATRIX         &A,
 //TODO:[?] Check, why there are two different start residuals.
 //TODO:[GK] Make sure the parameter in the constructor means maximum basis size
 
+  if (additional_data.max_n_recycled_vectors > 0)
+    {
+      solve_with_recycling (A, x, b, precondition);
+      return;
+    }
+
   deallog.push("GMRES");
   const unsigned int n_tmp_vectors = additional_data.max_n_tmp_vectors;
 
@@ -887,6 +1498,378 @@ SolverGMRES<VECTOR>::solve (const MATRIX         &A,
 
 
 
+template<class VECTOR>
+template<class MATRIX, class PRECONDITIONER>
+void
+SolverGMRES<VECTOR>::update_recycled_subspace (const MATRIX         &A,
+                                               const PRECONDITIONER &precondition,
+                                               const VECTOR         &x)
+{
+  if (recycled.size() == 0)
+    return;
+  if (recycled.u()[0]->size() != x.size())
+    {
+      recycled.clear();
+      return;
+    }
+
+  internal::SolverGMRES::BlockVmult<MATRIX,VECTOR> block_vmult;
+  block_vmult.vmult (A, recycled.c(), recycled.u());
+  if (!additional_data.right_preconditioning)
+    {
+      VECTOR *p = this->memory.alloc();
+      p->reinit(x);
+      for (unsigned int i=0; i<recycled.size(); ++i)
+        {
+          precondition.vmult(*p, *recycled.c()[i]);
+          recycled.c()[i]->swap(*p);
+        }
+      this->memory.free(p);
+    }
+  recycled.orthonormalize();
+}
+
+
+
+template<class VECTOR>
+template<class MATRIX, class PRECONDITIONER>
+void
+SolverGMRES<VECTOR>::solve_with_recycling (const MATRIX         &A,
+                                           VECTOR               &x,
+                                           const VECTOR         &b,
+                                           const PRECONDITIONER &precondition)
+{
+  Assert (additional_data.use_default_residual,
+          ExcMessage ("Recycling is only implemented for the default residual"));
+  Assert (!additional_data.compute_eigenvalues,
+          ExcMessage ("Recycling does not support eigenvalue estimates"));
+
+  deallog.push("GMRES");
+
+  SolverControl::State iteration_state = SolverControl::iterate;
+
+  const unsigned int basis_size = additional_data.max_n_tmp_vectors-2;
+  const bool left_precondition = !additional_data.right_preconditioning;
+
+  // Generate an object where basis vectors are stored.
+  internal::SolverGMRES::TmpVectors<VECTOR> v (basis_size+1, this->memory);
+
+  // number of the present iteration; this number is not reset to zero upon a
+  // restart
+  unsigned int accumulated_iterations = 0;
+
+  // coefficients of the images of the basis vectors in the recycled
+  // subspace
+  FullMatrix<double> B;
+
+  // Vectors for projected system
+  Vector<double> projected_rhs;
+  Vector<double> y;
+
+  // the matrix or the preconditioner might have changed since the recycled
+  // subspace was set up
+  update_recycled_subspace (A, precondition, x);
+
+  VECTOR *aux = this->memory.alloc();
+  VECTOR *p = this->memory.alloc();
+  aux->reinit(x);
+  p->reinit(x);
+  do
+    {
+      // the residual of the preconditioned system for left preconditioning,
+      // and of the original one for right preconditioning
+      A.vmult(*p, x);
+      p->sadd(-1., 1., b);
+      if (left_precondition)
+        precondition.vmult(*aux, *p);
+      else
+        aux->swap(*p);
+
+      // minimize the residual over the recycled subspace
+      recycled.minimize_residual (x, *aux);
+
+      const double beta = aux->l2_norm();
+      if (this->control().check(accumulated_iterations,beta)
+          == SolverControl::success)
+        break;
+
+      H.reinit(basis_size+1, basis_size);
+      B.reinit(recycled.size(), basis_size);
+      y.reinit(0);
+      v(0,x).equ(1./beta, *aux);
+
+      for (unsigned int j=0; j<basis_size; ++j)
+        {
+          if (left_precondition)
+            {
+              A.vmult(*p, v[j]);
+              precondition.vmult(*aux, *p);
+            }
+          else
+            {
+              precondition.vmult(*p, v[j]);
+              A.vmult(*aux, *p);
+            }
+
+          // orthogonalize against the recycled subspace, then against the
+          // Arnoldi basis
+          recycled.orthogonalize (*aux, B, j);
+          for (unsigned int i=0; i<=j; ++i)
+            {
+              H(i,j) = *aux * v[i];
+              aux->add(-H(i,j), v[i]);
+            }
+          const double a = aux->l2_norm();
+          H(j+1,j) = a;
+
+          // treat lucky breakdown
+          if (numbers::is_finite(1./a))
+            v(j+1,x).equ(1./a, *aux);
+          else
+            v(j+1,x) = 0.;
+
+          // Compute projected solution
+          H1.reinit(j+2,j+1);
+          projected_rhs.reinit(j+2);
+          y.reinit(j+1);
+          projected_rhs(0) = beta;
+          H1.fill(H);
+          Householder<double> house(H1);
+          const double res = house.least_squares(y, projected_rhs);
+          iteration_state = this->control().check(++accumulated_iterations, res);
+          if (iteration_state != SolverControl::iterate)
+            break;
+        }
+
+      // the correction of this cycle, d = P^{-1}Vy - UBy for right and
+      // d = Vy - UBy for left preconditioning
+      VECTOR *d = this->memory.alloc();
+      d->reinit(x);
+      *p = 0.;
+      for (unsigned int j=0; j<y.size(); ++j)
+        p->add(y(j), v[j]);
+      if (left_precondition)
+        d->swap(*p);
+      else
+        precondition.vmult(*d, *p);
+      recycled.subtract (*d, B, y);
+      x += *d;
+
+      // add the correction to the recycled subspace. its image under the
+      // preconditioned matrix, V H y, comes for free
+      if (y.size() > 0)
+        {
+          VECTOR *c = this->memory.alloc();
+          c->reinit(x);
+          for (unsigned int i=0; i<=y.size(); ++i)
+            {
+              double factor = 0;
+              for (unsigned int j=0; j<y.size(); ++j)
+                factor += H(i,j) * y(j);
+              c->add(factor, v[i]);
+            }
+          recycled.add (d, c, additional_data.max_n_recycled_vectors);
+        }
+      else
+        this->memory.free(d);
+    }
+  while (iteration_state == SolverControl::iterate);
+
+  this->memory.free(aux);
+  this->memory.free(p);
+
+  deallog.pop();
+  // in case of failure: throw exception
+  if (this->control().last_check() != SolverControl::success)
+    AssertThrow(false, SolverControl::NoConvergence (this->control().last_step(),
+                                                     this->control().last_value()));
+}
+
+
+
+template<class VECTOR>
+template<class MATRIX, class PRECONDITIONER>
+void
+SolverGMRES<VECTOR>::solve (const MATRIX              &A,
+                            std::vector<VECTOR>       &x,
+                            const std::vector<VECTOR> &b,
+                            const PRECONDITIONER      &precondition)
+{
+  AssertDimension (x.size(), b.size());
+  if (b.size() == 0)
+    return;
+
+  deallog.push("GMRES");
+
+  SolverControl::State iteration_state = SolverControl::iterate;
+
+  const bool left_precondition = !additional_data.right_preconditioning;
+  const unsigned int n_rhs = b.size();
+  const unsigned int n_block_steps
+    = std::max (1U, (additional_data.max_n_tmp_vectors-2)/n_rhs);
+  const unsigned int max_n_search = n_block_steps * n_rhs;
+
+  // Generate an object where basis vectors are stored.
+  internal::SolverGMRES::TmpVectors<VECTOR> v (max_n_search+n_rhs, this->memory);
+
+  // number of the present iteration; this number is not reset to zero upon a
+  // restart
+  unsigned int accumulated_iterations = 0;
+
+  // projected system matrix and the coefficients of the initial residuals
+  // in the first vectors of the basis
+  FullMatrix<double> Hb, R;
+  FullMatrix<double> Y;
+
+  // Vectors for projected system
+  Vector<double> projected_rhs;
+  Vector<double> y;
+
+  // products of the matrix with several vectors at once, and the vectors
+  // holding them. with right preconditioning, the preconditioned basis
+  // vectors of a block are stored in the second set of vectors
+  internal::SolverGMRES::BlockVmult<MATRIX,VECTOR> block_vmult;
+  std::vector<VECTOR *> images (n_rhs), preconditioned (n_rhs), solutions (n_rhs);
+  for (unsigned int r=0; r<n_rhs; ++r)
+    {
+      images[r] = this->memory.alloc();
+      images[r]->reinit(x[0]);
+      preconditioned[r] = this->memory.alloc();
+      preconditioned[r]->reinit(x[0]);
+      solutions[r] = &x[r];
+    }
+  std::vector<VECTOR *> block_images, block_search;
+
+  // Iteration starts here
+
+  do
+    {
+      Hb.reinit(max_n_search+n_rhs, max_n_search);
+      R.reinit(n_rhs, n_rhs);
+      Y.reinit(0, 0);
+
+      // orthonormalize the (preconditioned) residuals of all systems into
+      // the first block of the basis. residuals that depend linearly on the
+      // previous ones do not extend the basis
+      unsigned int n_vectors = 0, n_search = 0;
+      double res = 0;
+      std::vector<double> residual_norms (n_rhs);
+      block_vmult.vmult(A, images, solutions);
+      for (unsigned int r=0; r<n_rhs; ++r)
+        {
+          images[r]->sadd(-1., 1., b[r]);
+          if (left_precondition)
+            {
+              precondition.vmult(*preconditioned[r], *images[r]);
+              images[r]->swap(*preconditioned[r]);
+            }
+          residual_norms[r] = images[r]->l2_norm();
+          res = std::max (res, residual_norms[r]);
+          internal::SolverGMRES::append_to_block_basis (v, n_vectors, *images[r],
+                                                        residual_norms[r], R, r,
+                                                        x[0]);
+        }
+      if (this->control().check(accumulated_iterations,res)
+          == SolverControl::success)
+        break;
+
+      // the vectors of the present block
+      unsigned int block_begin = 0, block_end = n_vectors;
+      while (block_end > block_begin &&
+             n_search + (block_end-block_begin) <= max_n_search)
+        {
+          // apply the preconditioned matrix to all vectors of the block,
+          // multiplying with the matrix at once
+          const unsigned int block_size = block_end-block_begin;
+          block_images.assign (images.begin(), images.begin()+block_size);
+          block_search.resize (block_size);
+          for (unsigned int i=0; i<block_size; ++i)
+            if (left_precondition)
+              block_search[i] = &v[block_begin+i];
+            else
+              {
+                block_search[i] = preconditioned[i];
+                precondition.vmult(*block_search[i], v[block_begin+i]);
+              }
+          block_vmult.vmult(A, block_images, block_search);
+          for (unsigned int i=0; i<block_size; ++i, ++n_search)
+            {
+              if (left_precondition)
+                {
+                  precondition.vmult(*preconditioned[i], *block_images[i]);
+                  block_images[i]->swap(*preconditioned[i]);
+                }
+              const double norm = block_images[i]->l2_norm();
+              internal::SolverGMRES::append_to_block_basis (v, n_vectors,
+                                                            *block_images[i],
+                                                            norm, Hb, n_search,
+                                                            x[0]);
+            }
+          block_begin = block_end;
+          block_end = n_vectors;
+
+          // Compute projected solution for each right hand side
+          H1.reinit(n_vectors, n_search);
+          H1.fill(Hb);
+          Householder<double> house(H1);
+          Y.reinit(n_search, n_rhs);
+          y.reinit(n_search);
+          projected_rhs.reinit(n_vectors);
+          res = 0;
+          for (unsigned int r=0; r<n_rhs; ++r)
+            {
+              projected_rhs = 0;
+              for (unsigned int i=0; i<R.m() && i<n_vectors; ++i)
+                projected_rhs(i) = R(i,r);
+              res = std::max (res, house.least_squares(y, projected_rhs));
+              for (unsigned int i=0; i<n_search; ++i)
+                Y(i,r) = y(i);
+            }
+          iteration_state = this->control().check(++accumulated_iterations, res);
+          if (iteration_state != SolverControl::iterate)
+            break;
+        }
+
+      // no new search direction could be found, which happens only if the
+      // residuals are zero to round-off
+      if (n_search == 0)
+        iteration_state = this->control().check(++accumulated_iterations, res);
+
+      // Update solution vectors: the search directions are the first
+      // vectors of the basis, to which the preconditioner still needs to be
+      // applied in case of right preconditioning
+      for (unsigned int r=0; r<n_rhs; ++r)
+        if (Y.m() > 0)
+          {
+            VECTOR &update = (left_precondition ? x[r] : *images[0]);
+            if (!left_precondition)
+              update = 0.;
+            for (unsigned int j=0; j<Y.m(); ++j)
+              update.add(Y(j,r), v[j]);
+            if (!left_precondition)
+              {
+                precondition.vmult(*preconditioned[0], update);
+                x[r] += *preconditioned[0];
+              }
+          }
+    }
+  while (iteration_state == SolverControl::iterate);
+
+  for (unsigned int r=0; r<n_rhs; ++r)
+    {
+      this->memory.free(images[r]);
+      this->memory.free(preconditioned[r]);
+    }
+
+  deallog.pop();
+  // in case of failure: throw exception
+  if (this->control().last_check() != SolverControl::success)
+    AssertThrow(false, SolverControl::NoConvergence (this->control().last_step(),
+                                                     this->control().last_value()));
+}
+
+
+
 template<class VECTOR>
 double
 SolverGMRES<VECTOR>::criterion ()
@@ -906,7 +1889,8 @@ SolverFGMRES<VECTOR>::SolverFGMRES (SolverControl        &cn,
                                     const AdditionalData &data)
   :
   Solver<VECTOR> (cn, mem),
-  additional_data(data)
+  additional_data(data),
+  recycled(this->memory)
 {}
 
 
@@ -916,11 +1900,57 @@ SolverFGMRES<VECTOR>::SolverFGMRES (SolverControl        &cn,
                                     const AdditionalData &data)
   :
   Solver<VECTOR> (cn),
-  additional_data(data)
+  additional_data(data),
+  recycled(this->memory)
+{}
+
+
+
+template <class VECTOR>
+SolverFGMRES<VECTOR>::~SolverFGMRES ()
 {}
 
 
 
+template <class VECTOR>
+void
+SolverFGMRES<VECTOR>::clear_recycled_subspace ()
+{
+  recycled.clear();
+}
+
+
+
+template <class VECTOR>
+unsigned int
+SolverFGMRES<VECTOR>::n_recycled_vectors () const
+{
+  return recycled.size();
+}
+
+
+
+template <class VECTOR>
+template <class MATRIX>
+void
+SolverFGMRES<VECTOR>::update_recycled_subspace (const MATRIX &A,
+                                                const VECTOR &x)
+{
+  if (recycled.size() == 0)
+    return;
+  if (recycled.u()[0]->size() != x.size())
+    {
+      recycled.clear();
+      return;
+    }
+
+  internal::SolverGMRES::BlockVmult<MATRIX,VECTOR> block_vmult;
+  block_vmult.vmult (A, recycled.c(), recycled.u());
+  recycled.orthonormalize();
+}
+
+
+
 template<class VECTOR>
 template<class MATRIX, class PRECONDITIONER>
 void
@@ -947,10 +1977,17 @@ SolverFGMRES<VECTOR>::solve (
   // matrix used for the orthogonalization process later
   H.reinit(basis_size+1, basis_size);
 
+  // coefficients of the images of the search directions in the recycled
+  // subspace
+  FullMatrix<double> B;
+
   // Vectors for projected system
   Vector<double> projected_rhs;
   Vector<double> y;
 
+  // the matrix might have changed since the recycled subspace was set up
+  update_recycled_subspace (A, x);
+
   // Iteration starts here
 
   VECTOR *aux = this->memory.alloc();
@@ -960,12 +1997,17 @@ SolverFGMRES<VECTOR>::solve (
       A.vmult(*aux, x);
       aux->sadd(-1., 1., b);
 
+      // minimize the residual over the recycled subspace
+      recycled.minimize_residual (x, *aux);
+
       double beta = aux->l2_norm();
       if (this->control().check(accumulated_iterations,beta)
           == SolverControl::success)
         break;
 
       H.reinit(basis_size+1, basis_size);
+      B.reinit(recycled.size(), basis_size);
+      y.reinit(0);
       double a = beta;
 
       for (unsigned int j=0; j<basis_size; ++j)
@@ -979,6 +2021,9 @@ SolverFGMRES<VECTOR>::solve (
           precondition.vmult(z(j,x), v[j]);
           A.vmult(*aux, z[j]);
 
+          // orthogonalize against the recycled subspace
+          recycled.orthogonalize (*aux, B, j);
+
           // Gram-Schmidt
           for (unsigned int i=0; i<=j; ++i)
             {
@@ -1007,6 +2052,30 @@ SolverFGMRES<VECTOR>::solve (
       for (unsigned int j=0; j<y.size(); ++j)
         x.add(y(j), z[j]);
 
+      // the search directions have components in the recycled subspace that
+      // were projected out of their images: subtract U B y
+      recycled.subtract (x, B, y);
+
+      // add the correction of this cycle, d = Zy - UBy, to the recycled
+      // subspace. its image under the matrix, Ad = V H y, comes for free
+      if (additional_data.max_n_recycled_vectors > 0 && y.size() > 0)
+        {
+          VECTOR *u = this->memory.alloc();
+          VECTOR *c = this->memory.alloc();
+          u->reinit(x);
+          c->reinit(x);
+          for (unsigned int j=0; j<y.size(); ++j)
+            u->add(y(j), z[j]);
+          recycled.subtract (*u, B, y);
+          for (unsigned int i=0; i<=y.size(); ++i)
+            {
+              double factor = 0;
+              for (unsigned int j=0; j<y.size(); ++j)
+                factor += H(i,j) * y(j);
+              c->add(factor, v[i]);
+            }
+          recycled.add (u, c, additional_data.max_n_recycled_vectors);
+        }
     }
   while (iteration_state == SolverControl::iterate);
 
@@ -1019,6 +2088,157 @@ SolverFGMRES<VECTOR>::solve (
                                                      this->control().last_value()));
 }
 
+
+
+template<class VECTOR>
+template<class MATRIX, class PRECONDITIONER>
+void
+SolverFGMRES<VECTOR>::solve (
+  const MATRIX              &A,
+  std::vector<VECTOR>       &x,
+  const std::vector<VECTOR> &b,
+  const PRECONDITIONER      &precondition)
+{
+  AssertDimension (x.size(), b.size());
+  if (b.size() == 0)
+    return;
+
+  deallog.push("FGMRES");
+
+  SolverControl::State iteration_state = SolverControl::iterate;
+
+  const unsigned int n_rhs = b.size();
+  const unsigned int n_block_steps = std::max (1U, additional_data.max_basis_size/n_rhs);
+  const unsigned int max_n_search = n_block_steps * n_rhs;
+
+  // Generate an object where basis vectors are stored.
+  typename internal::SolverGMRES::TmpVectors<VECTOR> v (max_n_search+n_rhs, this->memory);
+  typename internal::SolverGMRES::TmpVectors<VECTOR> z (max_n_search, this->memory);
+
+  // number of the present iteration; this number is not reset to zero upon a
+  // restart
+  unsigned int accumulated_iterations = 0;
+
+  // projected system matrix and the coefficients of the initial residuals
+  // in the first vectors of the basis
+  FullMatrix<double> Hb, R;
+  FullMatrix<double> Y;
+
+  // Vectors for projected system
+  Vector<double> projected_rhs;
+  Vector<double> y;
+
+  // products of the matrix with several vectors at once, and the vectors
+  // holding them
+  internal::SolverGMRES::BlockVmult<MATRIX,VECTOR> block_vmult;
+  std::vector<VECTOR *> images (n_rhs), solutions (n_rhs);
+  std::vector<VECTOR *> block_images, block_search;
+  for (unsigned int r=0; r<n_rhs; ++r)
+    {
+      images[r] = this->memory.alloc();
+      images[r]->reinit(x[0]);
+      solutions[r] = &x[r];
+    }
+
+  // Iteration starts here
+
+  do
+    {
+      Hb.reinit(max_n_search+n_rhs, max_n_search);
+      R.reinit(n_rhs, n_rhs);
+      Y.reinit(0, 0);
+
+      // orthonormalize the residuals of all systems into the first block of
+      // the basis. residuals that depend linearly on the previous ones do
+      // not extend the basis
+      unsigned int n_vectors = 0, n_search = 0;
+      double res = 0;
+      std::vector<double> residual_norms (n_rhs);
+      block_vmult.vmult(A, images, solutions);
+      for (unsigned int r=0; r<n_rhs; ++r)
+        {
+          images[r]->sadd(-1., 1., b[r]);
+          residual_norms[r] = images[r]->l2_norm();
+          res = std::max (res, residual_norms[r]);
+          internal::SolverGMRES::append_to_block_basis (v, n_vectors, *images[r],
+                                                        residual_norms[r], R, r,
+                                                        x[0]);
+        }
+      if (this->control().check(accumulated_iterations,res)
+          == SolverControl::success)
+        break;
+
+      // the vectors of the present block
+      unsigned int block_begin = 0, block_end = n_vectors;
+      while (block_end > block_begin &&
+             n_search + (block_end-block_begin) <= max_n_search)
+        {
+          // precondition all vectors of the block, then multiply them with
+          // the matrix at once
+          const unsigned int block_size = block_end-block_begin;
+          block_images.assign (images.begin(), images.begin()+block_size);
+          block_search.resize (block_size);
+          for (unsigned int i=0; i<block_size; ++i)
+            {
+              block_search[i] = &z(n_search+i,x[0]);
+              precondition.vmult(*block_search[i], v[block_begin+i]);
+            }
+          block_vmult.vmult(A, block_images, block_search);
+          for (unsigned int i=0; i<block_size; ++i, ++n_search)
+            {
+              const double norm = block_images[i]->l2_norm();
+              internal::SolverGMRES::append_to_block_basis (v, n_vectors,
+                                                            *block_images[i],
+                                                            norm, Hb, n_search,
+                                                            x[0]);
+            }
+          block_begin = block_end;
+          block_end = n_vectors;
+
+          // Compute projected solution for each right hand side
+          H1.reinit(n_vectors, n_search);
+          H1.fill(Hb);
+          Householder<double> house(H1);
+          Y.reinit(n_search, n_rhs);
+          y.reinit(n_search);
+          projected_rhs.reinit(n_vectors);
+          res = 0;
+          for (unsigned int r=0; r<n_rhs; ++r)
+            {
+              projected_rhs = 0;
+              for (unsigned int i=0; i<R.m() && i<n_vectors; ++i)
+                projected_rhs(i) = R(i,r);
+              res = std::max (res, house.least_squares(y, projected_rhs));
+              for (unsigned int i=0; i<n_search; ++i)
+                Y(i,r) = y(i);
+            }
+          iteration_state = this->control().check(++accumulated_iterations, res);
+          if (iteration_state != SolverControl::iterate)
+            break;
+        }
+
+      // no new search direction could be found, which happens only if the
+      // residuals are zero to round-off
+      if (n_search == 0)
+        iteration_state = this->control().check(++accumulated_iterations, res);
+
+      // Update solution vectors
+      for (unsigned int r=0; r<n_rhs; ++r)
+        for (unsigned int j=0; j<Y.m(); ++j)
+          x[r].add(Y(j,r), z[j]);
+    }
+  while (iteration_state == SolverControl::iterate);
+
+  for (unsigned int r=0; r<n_rhs; ++r)
+    this->memory.free(images[r]);
+
+  deallog.pop();
+  // in case of failure: throw exception
+  if (this->control().last_check() != SolverControl::success)
+    AssertThrow(false, SolverControl::NoConvergence (this->control().last_step(),
+                                                     this->control().last_value()));
+}
+
 #endif // DOXYGEN
 
 DEAL_II_NAMESPACE_CLOSE
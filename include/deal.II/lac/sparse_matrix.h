@@ -31,6 +31,7 @@ template <typename number> class Vector;
 template <typename number> class FullMatrix;
 template <typename Matrix> class BlockMatrixBase;
 template <typename number> class SparseILU;
+template <typename number> class MultiVector;
 
 #ifdef DEAL_II_WITH_TRILINOS
 namespace TrilinosWrappers
@@ -1137,6 +1138,35 @@ public:
   void Tvmult_add (OutVector &dst,
                    const InVector &src) const;
 
+  /**
+   * Matrix-vector multiplication for several vectors at once: let
+   * <i>dst = M*src</i>, where each column of @p src and @p dst is one
+   * vector. Each entry of the matrix is loaded only once and applied to all
+   * columns, which makes this function considerably faster than calling
+   * vmult() for the columns one at a time, in particular when the number of
+   * columns is between 4 and 16.
+   *
+   * Source and destination must not be the same object.
+   *
+   * @dealiiOperationIsMultithreaded
+   */
+  template <typename somenumber>
+  void vmult (MultiVector<somenumber>       &dst,
+              const MultiVector<somenumber> &src) const;
+
+  /**
+   * Adding matrix-vector multiplication for several vectors at once: add
+   * <i>M*src</i> to <i>dst</i> column by column. See the vmult() function
+   * taking MultiVector arguments.
+   *
+   * Source and destination must not be the same object.
+   *
+   * @dealiiOperationIsMultithreaded
+   */
+  template <typename somenumber>
+  void vmult_add (MultiVector<somenumber>       &dst,
+                  const MultiVector<somenumber> &src) const;
+
   /**
    * Return the square of the norm of the vector $v$ with respect to the norm
    * induced by this matrix, i.e. $\left(v,Mv\right)$. This is useful, e.g. in
@@ -1406,6 +1436,33 @@ public:
   void SSOR_step (Vector<somenumber> &v,
                   const Vector<somenumber> &b,
                   const number        om = 1.) const;
+
+  /**
+   * Do one step of a Chebyshev iteration preconditioned by the diagonal on
+   * the iterate <tt>src</tt> with right hand side <tt>b</tt>, writing the new
+   * iterate into <tt>dst</tt>. For each row $i$, this computes
+   * @f{align*}{
+   *   u_i &\leftarrow \mathrm{factor1}\, u_i + \mathrm{factor2}\,
+   *   d_i \left((A\, \mathrm{src})_i - b_i\right),\\
+   *   \mathrm{dst}_i &= \mathrm{src}_i - u_i,
+   * @f}
+   * where $u$ is the vector <tt>update</tt> holding the previous update and
+   * $d$ is the vector <tt>diagonal_inverse</tt>. If <tt>factor1</tt> is zero,
+   * the old content of <tt>update</tt> is ignored.
+   *
+   * In contrast to a matrix-vector product followed by the vector updates,
+   * this function goes through the matrix and the vectors only once, which
+   * makes it the kernel of choice for PreconditionChebyshev. <tt>dst</tt>
+   * must not be the same vector as <tt>src</tt>.
+   */
+  template <typename somenumber>
+  void Chebyshev_step (Vector<somenumber>       &dst,
+                       Vector<somenumber>       &update,
+                       const Vector<somenumber> &src,
+                       const Vector<somenumber> &b,
+                       const Vector<somenumber> &diagonal_inverse,
+                       const somenumber          factor1,
+                       const somenumber          factor2) const;
 //@}
   /**
    * @name Iterators
@@ -20,12 +20,14 @@
 
 #include <deal.II/base/config.h>
 #include <deal.II/base/template_constraints.h>
+#include <deal.II/base/hardware_counters.h>
 #include <deal.II/base/parallel.h>
 #include <deal.II/base/thread_management.h>
 #include <deal.II/base/utilities.h>
 #include <deal.II/lac/sparse_matrix.h>
 #include <deal.II/lac/trilinos_sparse_matrix.h>
 #include <deal.II/lac/vector.h>
+#include <deal.II/lac/multi_vector.h>
 #include <deal.II/lac/full_matrix.h>
 #include <deal.II/lac/compressed_simple_sparsity_pattern.h>
 #include <deal.II/lac/vector_memory.h>
@@ -136,6 +138,16 @@ namespace internal
     {
       std::memset (dst+begin,0,(end-begin)*sizeof(T));
     }
+
+    template<typename T>
+    void zero_rows (const size_type    begin_row,
+                    const size_type    end_row,
+                    const std::size_t *rowstart,
+                    T                 *dst)
+    {
+      std::memset (dst+rowstart[begin_row], 0,
+                   (rowstart[end_row]-rowstart[begin_row])*sizeof(T));
+    }
   }
 }
 
@@ -216,6 +228,20 @@ SparseMatrix<number>::reinit (const SparsityPattern &sparsity)
         delete[] val;
       val = new number[N];
       max_len = N;
+
+      // the operating system places a page of memory next to the thread
+      // that first writes to it. zero the new memory with a static
+      // partition of the rows, using the grain size of the row-parallel
+      // operations like vmult(), so that on NUMA machines the threads find
+      // their rows in nearby memory
+      parallel::apply_to_static_subranges (0U, m(),
+                                           std_cxx11::bind(&internal::SparseMatrix::template
+                                                           zero_rows<number>,
+                                                           std_cxx11::_1, std_cxx11::_2,
+                                                           cols->rowstart,
+                                                           val),
+                                           internal::SparseMatrix::minimum_parallel_grain_size);
+      return;
     }
 
   *this = 0.;
@@ -469,6 +495,99 @@ namespace internal
             *dst_ptr++ = s;
           }
     }
+
+
+
+    /**
+     * Perform the product of one matrix row with @p n_columns adjacent
+     * columns of a MultiVector. @p src points to the first of these columns
+     * in row zero of the source, and @p dst_ptr to the first of them in the
+     * present row of the destination. The number of columns is a template
+     * parameter so that the sums can be kept in registers. @p stride is the
+     * total number of columns of source and destination.
+     */
+    template <int n_columns, typename number, typename somenumber>
+    inline
+    void vmult_multi_row_fixed (const number       *val_ptr,
+                                const number       *val_end_of_row,
+                                const size_type    *colnum_ptr,
+                                const unsigned int  stride,
+                                const somenumber   *src,
+                                somenumber         *dst_ptr,
+                                const bool          add)
+    {
+      somenumber s[n_columns];
+      for (int c=0; c<n_columns; ++c)
+        s[c] = add ? dst_ptr[c] : somenumber();
+
+      while (val_ptr != val_end_of_row)
+        {
+          const somenumber a = *val_ptr++;
+          const somenumber *src_ptr = src +
+                                      static_cast<std::size_t>(*colnum_ptr++)*stride;
+          for (int c=0; c<n_columns; ++c)
+            s[c] += a * src_ptr[c];
+        }
+
+      for (int c=0; c<n_columns; ++c)
+        dst_ptr[c] = s[c];
+    }
+
+
+
+    /**
+     * Perform a matrix-vector product with all columns of a MultiVector on a
+     * subinterval of the row indices. The outer loop runs over the rows, and
+     * within each row the columns are processed in groups of 16, 8, 4, 2, and
+     * 1 using vmult_multi_row_fixed(). This way, the entries of a row are
+     * loaded from memory only once and are still in cache for all but the
+     * first group.
+     */
+    template <typename number, typename somenumber>
+    void vmult_multi_on_subrange (const size_type     begin_row,
+                                  const size_type     end_row,
+                                  const number       *values,
+                                  const std::size_t  *rowstart,
+                                  const size_type    *colnums,
+                                  const unsigned int  n_columns,
+                                  const somenumber   *src,
+                                  somenumber         *dst,
+                                  const bool          add)
+    {
+      for (size_type row=begin_row; row<end_row; ++row)
+        {
+          const number    *val_ptr        = &values[rowstart[row]];
+          const number    *val_end_of_row = &values[rowstart[row+1]];
+          const size_type *colnum_ptr     = &colnums[rowstart[row]];
+          somenumber      *dst_row        = dst + static_cast<std::size_t>(row)*n_columns;
+
+          unsigned int c = 0;
+          for ( ; c+16<=n_columns; c+=16)
+            vmult_multi_row_fixed<16> (val_ptr, val_end_of_row, colnum_ptr,
+                                       n_columns, src+c, dst_row+c, add);
+          if (c+8 <= n_columns)
+            {
+              vmult_multi_row_fixed<8> (val_ptr, val_end_of_row, colnum_ptr,
+                                        n_columns, src+c, dst_row+c, add);
+              c += 8;
+            }
+          if (c+4 <= n_columns)
+            {
+              vmult_multi_row_fixed<4> (val_ptr, val_end_of_row, colnum_ptr,
+                                        n_columns, src+c, dst_row+c, add);
+              c += 4;
+            }
+          if (c+2 <= n_columns)
+            {
+              vmult_multi_row_fixed<2> (val_ptr, val_end_of_row, colnum_ptr,
+                                        n_columns, src+c, dst_row+c, add);
+              c += 2;
+            }
+          if (c < n_columns)
+            vmult_multi_row_fixed<1> (val_ptr, val_end_of_row, colnum_ptr,
+                                      n_columns, src+c, dst_row+c, add);
+        }
+    }
   }
 }
 
@@ -713,6 +832,22 @@ SparseMatrix<number>::vmult (OutVector &dst,
 
   Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
 
+  // if the instrumentation is switched on, record one multiplication and
+  // one addition per matrix entry, and that each entry and its column
+  // index, the row starts, and both vectors are read once
+  double model_flops = 0, model_bytes = 0;
+  if (HardwareCounters::is_enabled())
+    {
+      const double n_entries = static_cast<double>(n_nonzero_elements());
+      model_flops = 2. * n_entries;
+      model_bytes = (n_entries * (sizeof(number) + sizeof(size_type)) +
+                     (m() + 1.) * sizeof(std::size_t) +
+                     n() * sizeof(typename InVector::value_type) +
+                     m() * sizeof(typename OutVector::value_type));
+    }
+  HardwareCounters::Scope counter_scope ("SparseMatrix::vmult",
+                                         model_flops, model_bytes);
+
   parallel::apply_to_subranges (0U, m(),
                                 std_cxx11::bind (&internal::SparseMatrix::vmult_on_subrange
                                                  <number,InVector,OutVector>,
@@ -728,6 +863,36 @@ SparseMatrix<number>::vmult (OutVector &dst,
 
 
 
+template <typename number>
+template <typename somenumber>
+void
+SparseMatrix<number>::vmult (MultiVector<somenumber>       &dst,
+                             const MultiVector<somenumber> &src) const
+{
+  Assert (cols != 0, ExcNotInitialized());
+  Assert (val != 0, ExcNotInitialized());
+  Assert(m() == dst.size(), ExcDimensionMismatch(m(),dst.size()));
+  Assert(n() == src.size(), ExcDimensionMismatch(n(),src.size()));
+  AssertDimension (dst.n_columns(), src.n_columns());
+
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  parallel::apply_to_subranges (0U, m(),
+                                std_cxx11::bind (&internal::SparseMatrix::vmult_multi_on_subrange
+                                                 <number,somenumber>,
+                                                 std_cxx11::_1, std_cxx11::_2,
+                                                 val,
+                                                 cols->rowstart,
+                                                 cols->colnums,
+                                                 src.n_columns(),
+                                                 src.begin(),
+                                                 dst.begin(),
+                                                 false),
+                                internal::SparseMatrix::minimum_parallel_grain_size);
+}
+
+
+
 template <typename number>
 template <class OutVector, class InVector>
 void
@@ -783,6 +948,36 @@ SparseMatrix<number>::vmult_add (OutVector &dst,
 
 
 
+template <typename number>
+template <typename somenumber>
+void
+SparseMatrix<number>::vmult_add (MultiVector<somenumber>       &dst,
+                                 const MultiVector<somenumber> &src) const
+{
+  Assert (cols != 0, ExcNotInitialized());
+  Assert (val != 0, ExcNotInitialized());
+  Assert(m() == dst.size(), ExcDimensionMismatch(m(),dst.size()));
+  Assert(n() == src.size(), ExcDimensionMismatch(n(),src.size()));
+  AssertDimension (dst.n_columns(), src.n_columns());
+
+  Assert (!PointerComparison::equal(&src, &dst), ExcSourceEqualsDestination());
+
+  parallel::apply_to_subranges (0U, m(),
+                                std_cxx11::bind (&internal::SparseMatrix::vmult_multi_on_subrange
+                                                 <number,somenumber>,
+                                                 std_cxx11::_1, std_cxx11::_2,
+                                                 val,
+                                                 cols->rowstart,
+                                                 cols->colnums,
+                                                 src.n_columns(),
+                                                 src.begin(),
+                                                 dst.begin(),
+                                                 true),
+                                internal::SparseMatrix::minimum_parallel_grain_size);
+}
+
+
+
 template <typename number>
 template <class OutVector, class InVector>
 void
@@ -1752,6 +1947,96 @@ SparseMatrix<number>::SSOR_step (Vector<somenumber> &v,
 
 
 
+namespace internal
+{
+  namespace SparseMatrix
+  {
+    /**
+     * Perform one Chebyshev step, i.e., a vmult followed by the vector
+     * updates of SparseMatrix::Chebyshev_step(), on a subrange of rows.
+     */
+    template <typename number,
+              typename somenumber>
+    void chebyshev_step_on_subrange (const size_type    begin_row,
+                                     const size_type    end_row,
+                                     const number      *values,
+                                     const std::size_t *rowstart,
+                                     const size_type   *colnums,
+                                     const somenumber  *src,
+                                     const somenumber  *b,
+                                     const somenumber  *diagonal_inverse,
+                                     const somenumber   factor1,
+                                     const somenumber   factor2,
+                                     somenumber        *update,
+                                     somenumber        *dst)
+    {
+      const number    *val_ptr    = &values[rowstart[begin_row]];
+      const size_type *colnum_ptr = &colnums[rowstart[begin_row]];
+
+      for (size_type row=begin_row; row<end_row; ++row)
+        {
+          somenumber s = 0.;
+          const number *const val_end_of_row = &values[rowstart[row+1]];
+          while (val_ptr != val_end_of_row)
+            s += *val_ptr++ * src[*colnum_ptr++];
+
+          const somenumber new_update = factor2 * diagonal_inverse[row] *
+                                        (s - b[row]);
+          // do not touch the old update in case factor1 is zero: the vector
+          // might not be initialized yet
+          if (factor1 == somenumber())
+            update[row] = new_update;
+          else
+            update[row] = factor1 * update[row] + new_update;
+          dst[row] = src[row] - update[row];
+        }
+    }
+  }
+}
+
+
+
+template <typename number>
+template <typename somenumber>
+void
+SparseMatrix<number>::Chebyshev_step (Vector<somenumber>       &dst,
+                                      Vector<somenumber>       &update,
+                                      const Vector<somenumber> &src,
+                                      const Vector<somenumber> &b,
+                                      const Vector<somenumber> &diagonal_inverse,
+                                      const somenumber          factor1,
+                                      const somenumber          factor2) const
+{
+  Assert (cols != 0, ExcNotInitialized());
+  Assert (val != 0, ExcNotInitialized());
+  AssertDimension (m(), n());
+  AssertDimension (dst.size(), m());
+  AssertDimension (update.size(), m());
+  AssertDimension (src.size(), m());
+  AssertDimension (b.size(), m());
+  AssertDimension (diagonal_inverse.size(), m());
+
+  Assert (&src != &dst, ExcSourceEqualsDestination());
+
+  parallel::apply_to_subranges (0U, m(),
+                                std_cxx11::bind (&internal::SparseMatrix::chebyshev_step_on_subrange
+                                                 <number,somenumber>,
+                                                 std_cxx11::_1, std_cxx11::_2,
+                                                 val,
+                                                 cols->rowstart,
+                                                 cols->colnums,
+                                                 src.begin(),
+                                                 b.begin(),
+                                                 diagonal_inverse.begin(),
+                                                 factor1,
+                                                 factor2,
+                                                 update.begin(),
+                                                 dst.begin()),
+                                internal::SparseMatrix::minimum_parallel_grain_size);
+}
+
+
+
 template <typename number>
 template <typename somenumber>
 void
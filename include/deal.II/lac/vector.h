@@ -281,6 +281,12 @@ public:
    * If @p fast is false, the vector is filled by zeros. Otherwise, the
    * elements are left an unspecified state.
    *
+   * Newly allocated memory is always set to zero, using the same static
+   * partition of the index range among threads as
+   * parallel::apply_to_static_subranges(). On machines with several memory
+   * banks, this places every part of the vector close to the thread that
+   * works on it in later operations.
+   *
    * This function is virtual in order to allow for derived classes to handle
    * memory separately.
    */
@@ -1027,6 +1033,22 @@ Vector<Number>::~Vector ()
 
 
 
+// declare functions that are implemented in vector.templates.h
+namespace internal
+{
+  namespace Vector
+  {
+    template <typename T, typename U>
+    void copy_vector (const dealii::Vector<T> &src,
+                      dealii::Vector<U>       &dst);
+
+    template <typename T>
+    void first_touch (dealii::Vector<T> &dst);
+  }
+}
+
+
+
 template <typename Number>
 inline
 void Vector<Number>::reinit (const size_type n, const bool fast)
@@ -1045,6 +1067,9 @@ void Vector<Number>::reinit (const size_type n, const bool fast)
       allocate(n);
       Assert (val != 0, ExcOutOfMemory());
       max_vec_size = n;
+      vec_size = n;
+      dealii::internal::Vector::first_touch (*this);
+      return;
     };
   vec_size = n;
   if (fast == false)
@@ -1053,19 +1078,6 @@ void Vector<Number>::reinit (const size_type n, const bool fast)
 
 
 
-// declare function that is implemented in vector.templates.h
-namespace internal
-{
-  namespace Vector
-  {
-    template <typename T, typename U>
-    void copy_vector (const dealii::Vector<T> &src,
-                      dealii::Vector<U>       &dst);
-  }
-}
-
-
-
 template <typename Number>
 inline
 Vector<Number> &
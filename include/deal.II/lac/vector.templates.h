@@ -693,6 +693,35 @@ namespace internal
     }
 
 
+    template <typename T>
+    void zero_subrange (const typename dealii::Vector<T>::size_type begin,
+                        const typename dealii::Vector<T>::size_type end,
+                        dealii::Vector<T> &dst)
+    {
+      std::memset ((dst.begin()+begin),0,(end-begin)*sizeof(T));
+    }
+
+
+    template <typename T>
+    void first_touch (dealii::Vector<T> &dst)
+    {
+      // the operating system places a page of memory next to the thread
+      // that first writes to it, so set the vector to zero with the static
+      // partition that later loops over the vector use
+      const typename dealii::Vector<T>::size_type vec_size = dst.size();
+      if (vec_size>internal::Vector::minimum_parallel_grain_size)
+        parallel::apply_to_static_subranges (0U, vec_size,
+                                             std_cxx11::bind(&internal::Vector::template
+                                                             zero_subrange<T>,
+                                                             std_cxx11::_1,
+                                                             std_cxx11::_2,
+                                                             std_cxx11::ref(dst)),
+                                             internal::Vector::minimum_parallel_grain_size);
+      else if (vec_size > 0)
+        zero_subrange<T> (0U, vec_size, dst);
+    }
+
+
     template <typename T, typename U>
     void copy_vector (const dealii::Vector<T> &src,
                       dealii::Vector<U>       &dst)
@@ -894,6 +923,17 @@ namespace internal
     // same and added pairwise. At the innermost level, eight values are added
     // consecutively in order to better balance multiplications and additions.
 
+#ifdef DEAL_II_WITH_THREADS
+    template <typename Operation, typename Number, typename Number2,
+              typename ResultType, typename size_type>
+    void accumulate_static (const Operation   &op,
+                            const Number      *X,
+                            const Number2     *Y,
+                            const ResultType   power,
+                            const size_type    vec_size,
+                            ResultType        &result);
+#endif
+
     // The code returns the result as the last argument in order to make
     // spawning tasks simpler and use automatic template deduction.
     template <typename Operation, typename Number, typename Number2,
@@ -906,6 +946,20 @@ namespace internal
                      ResultType        &result,
                      const int          depth = -1)
     {
+#ifdef DEAL_II_WITH_THREADS
+      // with static partitioning, the subtrees of the summation are
+      // distributed to the threads in the same way in every call. the order
+      // of the additions is the same as in the code below
+      if (depth == -1 &&
+          parallel::get_partitioning_mode() == parallel::static_partitioning &&
+          multithread_info.n_threads() > 1 &&
+          vec_size > 4 * internal::Vector::minimum_parallel_grain_size)
+        {
+          accumulate_static (op, X, Y, power, vec_size, result);
+          return;
+        }
+#endif
+
       if (vec_size <= 4096)
         {
           // the vector is short enough so we perform the summation. first
@@ -1036,15 +1090,129 @@ namespace internal
           // divisible by 1024.
           const size_type new_size = (vec_size / 4096) * 1024;
           ResultType r0, r1, r2, r3;
-          accumulate (op, X, Y, power, new_size, r0);
-          accumulate (op, X+new_size, Y+new_size, power, new_size, r1);
-          accumulate (op, X+2*new_size, Y+2*new_size, power, new_size, r2);
-          accumulate (op, X+3*new_size, Y+3*new_size, power, vec_size-3*new_size, r3);
+          accumulate (op, X, Y, power, new_size, r0, depth);
+          accumulate (op, X+new_size, Y+new_size, power, new_size, r1, depth);
+          accumulate (op, X+2*new_size, Y+2*new_size, power, new_size, r2, depth);
+          accumulate (op, X+3*new_size, Y+3*new_size, power, vec_size-3*new_size,
+                      r3, depth);
           r0 += r1;
           r2 += r3;
           result = r0 + r2;
         }
     }
+
+
+
+#ifdef DEAL_II_WITH_THREADS
+    // collect the subtrees of the summation tree of accumulate() at the given
+    // number of levels below the root, as pairs of offset and size in the
+    // order in which they are stored in the vector
+    template <typename size_type>
+    void collect_subtrees (const size_type                                 offset,
+                           const size_type                                 vec_size,
+                           const unsigned int                              levels,
+                           std::vector<std::pair<size_type,size_type> > &subtrees)
+    {
+      if (levels == 0 || vec_size <= 4096)
+        {
+          subtrees.push_back (std::make_pair (offset, vec_size));
+          return;
+        }
+
+      const size_type new_size = (vec_size / 4096) * 1024;
+      collect_subtrees (offset, new_size, levels-1, subtrees);
+      collect_subtrees (offset+new_size, new_size, levels-1, subtrees);
+      collect_subtrees (offset+2*new_size, new_size, levels-1, subtrees);
+      collect_subtrees (offset+3*new_size, vec_size-3*new_size, levels-1,
+                        subtrees);
+    }
+
+
+
+    // add up the results of the subtrees in the same way as accumulate()
+    // does. the index of the next subtree to be used is incremented
+    template <typename ResultType, typename size_type>
+    ResultType combine_subtrees (const size_type                vec_size,
+                                 const unsigned int             levels,
+                                 const std::vector<ResultType> &results,
+                                 unsigned int                  &index)
+    {
+      if (levels == 0 || vec_size <= 4096)
+        return results[index++];
+
+      const size_type new_size = (vec_size / 4096) * 1024;
+      ResultType r0 = combine_subtrees (new_size, levels-1, results, index);
+      ResultType r1 = combine_subtrees (new_size, levels-1, results, index);
+      ResultType r2 = combine_subtrees (new_size, levels-1, results, index);
+      ResultType r3 = combine_subtrees (vec_size-3*new_size, levels-1, results,
+                                        index);
+      r0 += r1;
+      r2 += r3;
+      return r0 + r2;
+    }
+
+
+
+    // work on the subtrees that belong to one chunk of the static partition
+    template <typename Operation, typename Number, typename Number2,
+              typename ResultType, typename size_type>
+    void accumulate_on_subtrees (const unsigned int                                  chunk,
+                                 const unsigned int                                  n_chunks,
+                                 const Operation                                    &op,
+                                 const Number                                       *X,
+                                 const Number2                                      *Y,
+                                 const ResultType                                    power,
+                                 const std::vector<std::pair<size_type,size_type> > &subtrees,
+                                 std::vector<ResultType>                            &results)
+    {
+      const unsigned int begin = chunk * subtrees.size() / n_chunks,
+                         end = (chunk + 1) * subtrees.size() / n_chunks;
+      for (unsigned int i=begin; i<end; ++i)
+        accumulate (op, X+subtrees[i].first, Y+subtrees[i].first, power,
+                    subtrees[i].second, results[i], 0);
+    }
+
+
+
+    // the variant of accumulate() for static partitioning: descend into the
+    // summation tree until there are at least as many subtrees as chunks,
+    // let every chunk work on a contiguous set of subtrees, and combine the
+    // results in the same order as accumulate()
+    template <typename Operation, typename Number, typename Number2,
+              typename ResultType, typename size_type>
+    void accumulate_static (const Operation   &op,
+                            const Number      *X,
+                            const Number2     *Y,
+                            const ResultType   power,
+                            const size_type    vec_size,
+                            ResultType        &result)
+    {
+      const unsigned int n_chunks
+        = parallel::internal::n_static_chunks (vec_size,
+                                               internal::Vector::minimum_parallel_grain_size);
+      unsigned int levels = 0;
+      for (unsigned int n_subtrees=1; n_subtrees<n_chunks; n_subtrees *= 4)
+        ++levels;
+
+      std::vector<std::pair<size_type,size_type> > subtrees;
+      collect_subtrees (size_type(0), vec_size, levels, subtrees);
+      const unsigned int n_used_chunks
+        = std::min (n_chunks, static_cast<unsigned int>(subtrees.size()));
+
+      std::vector<ResultType> results (subtrees.size());
+      parallel::internal::run_static_chunks
+      (n_used_chunks,
+       std_cxx11::bind (&accumulate_on_subtrees<Operation,Number,Number2,
+                        ResultType,size_type>,
+                        std_cxx11::_1, n_used_chunks,
+                        std_cxx11::cref(op), X, Y, power,
+                        std_cxx11::cref(subtrees),
+                        std_cxx11::ref(results)));
+
+      unsigned int index = 0;
+      result = combine_subtrees (vec_size, levels, results, index);
+    }
+#endif
   }
 }
 
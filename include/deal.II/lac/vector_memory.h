@@ -21,8 +21,13 @@
 #include <deal.II/base/smartpointer.h>
 #include <deal.II/base/logstream.h>
 #include <deal.II/base/thread_management.h>
+#include <deal.II/base/thread_local_storage.h>
 #include <deal.II/lac/vector.h>
 
+#ifdef DEAL_II_WITH_THREADS
+#  include <tbb/atomic.h>
+#endif
+
 #include <vector>
 #include <iostream>
 
@@ -251,6 +256,16 @@ public:
  * since they are reused, this should be of no concern. Additionally,
  * the destructor of the Pool warns about memory leaks.
  *
+ * In order that threads running independent solvers at the same time do
+ * not compete for the pool, every thread keeps the vectors it has freed
+ * in a cache of its own and takes vectors from there without locking
+ * anything. Only if the cache of the present thread is empty, a vector is
+ * taken from the shared pool, or a new one is created, under a lock. A
+ * cache holds at most #max_n_cached_vectors vectors; if a thread frees
+ * more, the ones it has freed first are given back to the shared pool, so
+ * that other threads can use them. The function get_statistics() tells
+ * how often each of these cases happened.
+ *
  * @author Guido Kanschat, 1999, 2007
  */
 template<class VECTOR = dealii::Vector<double> >
@@ -313,10 +328,69 @@ public:
 
   /**
    * Release all vectors that are
-   * not currently in use.
+   * not currently in use. Vectors
+   * held in the cache of another
+   * thread are released the next
+   * time this thread allocates or
+   * frees a vector of this type.
    */
   static void release_unused_memory ();
 
+  /**
+   * Statistics of all
+   * GrowingVectorMemory objects of
+   * this vector type, as returned
+   * by get_statistics().
+   */
+  struct Statistics
+  {
+    /**
+     * Constructor. Sets all
+     * numbers to zero.
+     */
+    Statistics ();
+
+    /**
+     * Number of calls to alloc()
+     * served from the cache of the
+     * calling thread without a
+     * lock.
+     */
+    std::size_t n_thread_local_hits;
+
+    /**
+     * Number of calls to alloc()
+     * served from the shared pool.
+     */
+    std::size_t n_shared_hits;
+
+    /**
+     * Number of calls to alloc()
+     * that had to create a new
+     * vector.
+     */
+    std::size_t n_misses;
+
+    /**
+     * The largest number of
+     * vectors the pool has held at
+     * the same time.
+     */
+    std::size_t max_n_vectors;
+  };
+
+  /**
+   * Return the statistics of all
+   * objects of this vector type
+   * since the start of the
+   * program. If other threads
+   * allocate vectors of this type
+   * at the same time, some of
+   * these allocations may not be
+   * counted yet.
+   */
+  static Statistics get_statistics ();
+
   /**
    * Memory consumed by this class
    * and all currently allocated
@@ -324,6 +398,13 @@ public:
    */
   virtual std::size_t memory_consumption() const;
 
+  /**
+   * The largest number of free
+   * vectors the cache of a thread
+   * holds.
+   */
+  static const unsigned int max_n_cached_vectors = 16;
+
 private:
   /**
    * Type to enter into the
@@ -334,6 +415,55 @@ private:
    */
   typedef std::pair<bool, VECTOR *> entry_type;
 
+  /**
+   * The vectors a thread has
+   * freed and may take again
+   * without locking the pool,
+   * along with the statistics of
+   * this thread.
+   */
+  struct ThreadCache
+  {
+    /**
+     * Constructor.
+     */
+    ThreadCache ();
+
+    /**
+     * The free vectors of this
+     * thread.
+     */
+    std::vector<VECTOR *> vectors;
+
+    /**
+     * The value of
+     * Pool::generation when the
+     * vectors of this cache were
+     * last released.
+     */
+    unsigned int generation;
+
+    /**
+     * Hits and misses of this
+     * thread. They are only
+     * incremented by the thread
+     * owning the cache, without a
+     * lock, but get_statistics()
+     * reads them from any thread,
+     * so they are atomic if deal.II
+     * is configured with threads.
+     */
+#ifdef DEAL_II_WITH_THREADS
+    tbb::atomic<std::size_t> n_thread_local_hits;
+    tbb::atomic<std::size_t> n_shared_hits;
+    tbb::atomic<std::size_t> n_misses;
+#else
+    std::size_t n_thread_local_hits;
+    std::size_t n_shared_hits;
+    std::size_t n_misses;
+#endif
+  };
+
   /**
    * The class providing the actual
    * storage for the memory pool.
@@ -366,11 +496,36 @@ private:
      * initialization
      */
     void initialize(const size_type size);
+    /**
+     * Delete the vectors in the
+     * given cache. The mutex must
+     * be locked by the caller.
+     */
+    void release_thread_cache (ThreadCache &cache);
     /**
      * Pointer to the storage
-     * object
+     * object. The flag of a vector
+     * is false if it is available
+     * in the shared pool, and true
+     * if it is in use or in the
+     * cache of a thread.
      */
     std::vector<entry_type> *data;
+    /**
+     * The caches of the threads.
+     */
+    Threads::ThreadLocalStorage<ThreadCache> thread_caches;
+    /**
+     * Incremented by
+     * release_unused_memory() to
+     * tell the threads to release
+     * the vectors in their caches.
+     */
+    DEAL_VOLATILE unsigned int generation;
+    /**
+     * The largest size of #data.
+     */
+    std::size_t max_n_vectors;
   };
 
   /**
@@ -383,15 +538,27 @@ private:
    * allocations. Only used for
    * bookkeeping and to generate
    * output at the end of an
-   * object's lifetime.
+   * object's lifetime. Since
+   * several threads may use this
+   * object, this and the next
+   * counter are atomic if deal.II
+   * is configured with threads.
    */
+#ifdef DEAL_II_WITH_THREADS
+  tbb::atomic<size_type> total_alloc;
+#else
   size_type total_alloc;
+#endif
   /**
    * Number of vectors currently
    * allocated in this object; used
    * for detecting memory leaks.
    */
+#ifdef DEAL_II_WITH_THREADS
+  tbb::atomic<size_type> current_alloc;
+#else
   size_type current_alloc;
+#endif
 
   /**
    * A flag controlling the logging
@@ -402,8 +569,8 @@ private:
 
   /**
    * Mutex to synchronise access to
-   * internal data of this object
-   * from multiple threads.
+   * the shared pool from multiple
+   * threads.
    */
   static Threads::Mutex mutex;
 };
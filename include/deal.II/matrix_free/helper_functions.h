@@ -68,6 +68,7 @@ namespace internal
       bool use_multithreading;
       bool use_partition_partition;
       bool use_coloring_only;
+      unsigned int communication_poll_interval;
 
       std::vector<unsigned int> partition_color_blocks_row_index;
       std::vector<unsigned int> partition_color_blocks_data;
@@ -18,6 +18,7 @@
 #define __deal2__matrix_free_h
 
 #include <deal.II/base/exceptions.h>
+#include <deal.II/base/hardware_counters.h>
 #include <deal.II/base/parallel.h>
 #include <deal.II/base/quadrature.h>
 #include <deal.II/base/vectorization.h>
@@ -152,7 +153,8 @@ public:
                     const unsigned int level_mg_handler = numbers::invalid_unsigned_int,
                     const bool                store_plain_indices = true,
                     const bool                initialize_indices = true,
-                    const bool                initialize_mapping = true)
+                    const bool                initialize_mapping = true,
+                    const unsigned int        communication_poll_interval = 64)
       :
       mpi_communicator      (mpi_communicator),
       tasks_parallel_scheme (tasks_parallel_scheme),
@@ -161,7 +163,8 @@ public:
       level_mg_handler      (level_mg_handler),
       store_plain_indices   (store_plain_indices),
       initialize_indices    (initialize_indices),
-      initialize_mapping    (initialize_mapping)
+      initialize_mapping    (initialize_mapping),
+      communication_poll_interval (communication_poll_interval)
     {};
 
     /**
@@ -263,6 +266,20 @@ public:
      * independent cells should be computed).
      */
     bool                initialize_mapping;
+
+    /**
+     * Sets the number of macro cells after which cell_loop() gives MPI the
+     * opportunity to make progress on the ghost exchange of the source
+     * vector and the compress operation of the destination vector, see
+     * parallel::distributed::Vector::poll_communication(). Without such
+     * polling, most MPI implementations only transfer the data when the
+     * loop waits for it, so the communication does not overlap with the
+     * computations on the cells that do not depend on it. Zero disables the
+     * polling. This only affects the loop without threads: with threads,
+     * the communication is finished by a separate task, which makes
+     * progress concurrently to the work on the cells.
+     */
+    unsigned int        communication_poll_interval;
   };
 
   /**
@@ -1972,6 +1989,98 @@ namespace internal
 
 
 
+  template <typename VectorStruct>
+  void poll_communication_block (const VectorStruct &vec,
+                                 internal::bool2type<true>);
+  template <typename VectorStruct>
+  void poll_communication_block (const VectorStruct &,
+                                 internal::bool2type<false>)
+  {}
+
+
+
+  template <typename VectorStruct>
+  inline
+  void poll_communication (const VectorStruct &vec)
+  {
+    poll_communication_block(vec,
+                             internal::bool2type<IsBlockVector<VectorStruct>::value>());
+  }
+
+
+
+  template <typename Number>
+  inline
+  void poll_communication (const parallel::distributed::Vector<Number> &vec)
+  {
+    vec.poll_communication();
+  }
+
+
+
+  template <typename VectorStruct>
+  inline
+  void poll_communication (const std::vector<VectorStruct> &vec)
+  {
+    for (unsigned int comp=0; comp<vec.size(); comp++)
+      poll_communication(vec[comp]);
+  }
+
+
+
+  template <typename VectorStruct>
+  inline
+  void poll_communication (const std::vector<VectorStruct *> &vec)
+  {
+    for (unsigned int comp=0; comp<vec.size(); comp++)
+      poll_communication(*vec[comp]);
+  }
+
+
+
+  template <typename VectorStruct>
+  inline
+  void poll_communication_block (const VectorStruct &vec,
+                                 internal::bool2type<true>)
+  {
+    for (unsigned int i=0; i<vec.n_blocks(); ++i)
+      poll_communication(vec.block(i));
+  }
+
+
+
+  // run the given cell operation on the range of cells [begin,end) in
+  // chunks of poll_interval macro cells, and poll the communication of the
+  // given vector in between (unless poll_interval is zero)
+  template <typename Function, typename MatrixFreeType,
+            typename OutVector, typename InVector, typename PollVector>
+  inline
+  void cell_loop_with_polling (const Function       &cell_operation,
+                               const MatrixFreeType &matrix_free,
+                               OutVector            &dst,
+                               const InVector       &src,
+                               const unsigned int    begin,
+                               const unsigned int    end,
+                               const unsigned int    poll_interval,
+                               const PollVector     &poll_vector)
+  {
+    std::pair<unsigned int,unsigned int> cell_range (begin, end);
+    if (poll_interval == 0)
+      {
+        cell_operation (matrix_free, dst, src, cell_range);
+        return;
+      }
+    for ( ; cell_range.first < end; cell_range.first = cell_range.second)
+      {
+        cell_range.second = std::min (cell_range.first + poll_interval, end);
+        cell_operation (matrix_free, dst, src, cell_range);
+        if (cell_range.second < end)
+          poll_communication (poll_vector);
+      }
+  }
+
+
+
 #ifdef DEAL_II_WITH_THREADS
 
   // This defines the TBB data structures that are needed to schedule the
@@ -2238,6 +2347,8 @@ MatrixFree<dim, Number>::cell_loop
  OutVector       &dst,
  const InVector  &src) const
 {
+  HardwareCounters::Scope counter_scope ("MatrixFree::cell_loop");
+
   // in any case, need to start the ghost import at the beginning
   bool ghosts_were_not_set = internal::update_ghost_values_start (src);
 
@@ -2469,12 +2580,12 @@ MatrixFree<dim, Number>::cell_loop
     {
       std::pair<unsigned int,unsigned int> cell_range;
 
-      // First operate on cells where no ghost data is needed (inner cells)
-      {
-        cell_range.first = 0;
-        cell_range.second = size_info.boundary_cells_start;
-        cell_operation (*this, dst, src, cell_range);
-      }
+      // First operate on cells where no ghost data is needed (inner cells).
+      // In between, let MPI make progress with the import of ghost data
+      internal::cell_loop_with_polling (cell_operation, *this, dst, src,
+                                        0, size_info.boundary_cells_start,
+                                        task_info.communication_poll_interval,
+                                        src);
 
       // before starting operations on cells that contain ghost nodes (outer
       // cells), wait for the MPI commands to finish
@@ -2490,13 +2601,14 @@ MatrixFree<dim, Number>::cell_loop
 
       internal::compress_start(dst);
 
-      // Finally operate on cells where no ghost data is needed (inner cells)
+      // Finally operate on cells where no ghost data is needed (inner cells),
+      // letting MPI make progress with the compress operation in between
       if (size_info.n_macro_cells > size_info.boundary_cells_end)
-        {
-          cell_range.first = size_info.boundary_cells_end;
-          cell_range.second = size_info.n_macro_cells;
-          cell_operation (*this, dst, src, cell_range);
-        }
+        internal::cell_loop_with_polling (cell_operation, *this, dst, src,
+                                          size_info.boundary_cells_end,
+                                          size_info.n_macro_cells,
+                                          task_info.communication_poll_interval,
+                                          dst);
     }
 
   // In every case, we need to finish transfers at the very end
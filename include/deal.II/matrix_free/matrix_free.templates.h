@@ -171,6 +171,8 @@ internal_reinit(const Mapping<dim>                          &mapping,
       else
 #endif
         task_info.use_multithreading = false;
+      task_info.communication_poll_interval =
+        additional_data.communication_poll_interval;
 
       // set dof_indices together with constraint_indicator and
       // constraint_pool_data. It also reorders the way cells are gone through
@@ -301,6 +303,8 @@ internal_reinit(const Mapping<dim>                            &mapping,
       else
 #endif
         task_info.use_multithreading = false;
+      task_info.communication_poll_interval =
+        additional_data.communication_poll_interval;
 
       // set dof_indices together with constraint_indicator and
       // constraint_pool_data. It also reorders the way cells are gone through
@@ -835,6 +839,7 @@ namespace internal
       use_multithreading = false;
       use_partition_partition = false;
       use_coloring_only = false;
+      communication_poll_interval = 0;
       partition_color_blocks_row_index.clear();
       partition_color_blocks_data.clear();
       evens = 0;
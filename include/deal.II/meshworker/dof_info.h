@@ -63,6 +63,13 @@ namespace MeshWorker
    * block structure changes, for instance because of mesh refinement,
    * the DoFInfo class will automatically use the new structures.
    *
+   * The index vectors of this class and the local matrices and vectors
+   * of LocalResults are resized on every cell, but only allocate memory
+   * if they grow, since std::vector::resize() and the reinit() functions
+   * of FullMatrix and Vector keep the memory they have. Once a cell with
+   * the largest number of degrees of freedom has been visited, reinit()
+   * does therefore not allocate memory any more.
+   *
    * @ingroup MeshWorker
    * @author Guido Kanschat, 2009
    */
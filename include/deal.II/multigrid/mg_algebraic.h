@@ -0,0 +1,338 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __deal2__mg_algebraic_h
+#define __deal2__mg_algebraic_h
+
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/base/smartpointer.h>
+#include <deal.II/base/std_cxx11/shared_ptr.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/householder.h>
+#include <deal.II/multigrid/mg_base.h>
+
+#include <vector>
+
+DEAL_II_NAMESPACE_OPEN
+
+/*!@addtogroup mg */
+/*@{*/
+
+/**
+ * Implementation of the MGTransferBase interface for a hierarchy of levels
+ * that is not derived from a mesh, but from the matrix itself as in
+ * PreconditionAMG. The transfer between levels is done with prolongation
+ * matrices given by the user of this class, and restriction is their
+ * transpose.
+ *
+ * The level numbering follows the one of Multigrid: level 0 is the coarsest
+ * level and the prolongation matrix of level <tt>l</tt> maps from level
+ * <tt>l-1</tt> to level <tt>l</tt>.
+ */
+class MGTransferAlgebraic : public MGTransferBase<Vector<double> >
+{
+public:
+  /**
+   * Destructor.
+   */
+  virtual ~MGTransferAlgebraic ();
+
+  /**
+   * Reset the object to the state it had right after construction.
+   */
+  void clear ();
+
+  /**
+   * Set the prolongation matrix from level <tt>to_level-1</tt> to level @p
+   * to_level. The object takes ownership of @p sparsity and @p matrix, and
+   * @p matrix must be based on @p sparsity.
+   */
+  void set_prolongation_matrix (const unsigned int                                to_level,
+                                const std_cxx11::shared_ptr<SparsityPattern>      &sparsity,
+                                const std_cxx11::shared_ptr<SparseMatrix<double> > &matrix);
+
+  /**
+   * Return the prolongation matrix from level <tt>to_level-1</tt> to level
+   * @p to_level.
+   */
+  const SparseMatrix<double> &
+  get_prolongation_matrix (const unsigned int to_level) const;
+
+  virtual void prolongate (const unsigned int    to_level,
+                           Vector<double>       &dst,
+                           const Vector<double> &src) const;
+
+  virtual void restrict_and_add (const unsigned int    from_level,
+                                 Vector<double>       &dst,
+                                 const Vector<double> &src) const;
+
+  /**
+   * Memory used by this object.
+   */
+  std::size_t memory_consumption () const;
+
+private:
+  /**
+   * Sparsity patterns of the prolongation matrices.
+   */
+  std::vector<std_cxx11::shared_ptr<SparsityPattern> > prolongation_sparsities;
+
+  /**
+   * The prolongation matrices, indexed by the level they map to.
+   */
+  std::vector<std_cxx11::shared_ptr<SparseMatrix<double> > > prolongation_matrices;
+};
+
+
+
+/**
+ * Algebraic multigrid preconditioner by smoothed aggregation, implemented
+ * natively on SparseMatrix. This preconditioner is intended for problems on
+ * unstructured meshes for which no hierarchy of meshes is available, and
+ * thus no geometric multigrid, and which are too large for ILU type
+ * preconditioners to be effective. The method follows Vanek, Mandel,
+ * and Brezina, Computing 56 (1996), with the constant vector as the near
+ * null space, and is thus suited for scalar elliptic problems like the
+ * Laplace or the heat equation.
+ *
+ * With the default W-cycle, the number of CG iterations for the Laplace
+ * equation stays bounded under mesh refinement: it is 7 or 8 for all sizes
+ * between 225 and 261121 unknowns in <tt>tests/multigrid/amg_01</tt>. A
+ * V-cycle is cheaper per iteration, but its iteration counts grow by a
+ * few steps with every additional level.
+ *
+ * The hierarchy is built in initialize() as follows, starting with the
+ * given matrix:
+ * <ol>
+ * <li> The unknowns are grouped into aggregates of strongly coupled
+ * unknowns, where $j$ is strongly coupled to $i$ if $|a_{ij}| \geq \theta
+ * \sqrt{|a_{ii}a_{jj}|}$ with $\theta$ given by
+ * AdditionalData::aggregation_threshold. Unknowns without strong couplings,
+ * such as the ones of Dirichlet boundary conditions, are not aggregated.
+ * <li> The tentative prolongation is the piecewise constant interpolation
+ * from the aggregates. It is smoothed by one step of damped Jacobi to get
+ * the prolongation matrix $P$. The damping parameter is scaled by the
+ * inverse of the largest eigenvalue of $D^{-1}A$, which is estimated by a
+ * few steps of the power iteration.
+ * <li> The matrix on the next coarser level is the Galerkin product $P^T A
+ * P$.
+ * </ol>
+ * This is repeated until the number of unknowns is at most
+ * AdditionalData::coarse_size, or the number of levels reaches
+ * AdditionalData::max_levels. The matrix on the coarsest level is solved
+ * exactly by a QR decomposition.
+ *
+ * All steps of the setup are parallelized with threads: the strength of
+ * couplings, the prolongation and the Galerkin products are computed row by
+ * row. The aggregation is done independently on blocks of
+ * AdditionalData::aggregation_block_size consecutive unknowns. The block
+ * size is a parameter rather than derived from the number of threads, so
+ * that the hierarchy does not depend on the latter.
+ *
+ * The preconditioner applies one cycle with SSOR steps for pre- and
+ * postsmoothing. Both the V- and the W-cycle are symmetric and can be used
+ * with SolverCG. The matrix on the finest level is not copied, but
+ * referenced, so it must stay alive and unchanged as long as this object is
+ * in use. The coarse matrices are kept as computed by the Galerkin
+ * products.
+ *
+ * vmult() may be called concurrently from several threads on the same
+ * object: the cycle takes all its temporary vectors from a
+ * GrowingVectorMemory, and does not change the object.
+ */
+class PreconditionAMG : public Subscriptor
+{
+public:
+  /**
+   * Declare type for container size.
+   */
+  typedef types::global_dof_index size_type;
+
+  /**
+   * Parameters for the setup of the multigrid hierarchy and the cycle.
+   */
+  struct AdditionalData
+  {
+    /**
+     * Constructor.
+     */
+    AdditionalData (const double       aggregation_threshold = 1e-4,
+                    const unsigned int smoother_sweeps = 2,
+                    const unsigned int max_levels = 20,
+                    const unsigned int coarse_size = 100,
+                    const double       prolongation_damping = 4./3.,
+                    const bool         w_cycle = true,
+                    const unsigned int aggregation_block_size = 16384);
+
+    /**
+     * Threshold $\theta$ for the strength of couplings used to decide which
+     * unknowns are grouped into an aggregate.
+     */
+    double aggregation_threshold;
+
+    /**
+     * Number of SSOR steps for pre- and postsmoothing on each level.
+     */
+    unsigned int smoother_sweeps;
+
+    /**
+     * Maximum number of levels in the hierarchy, including the finest
+     * level.
+     */
+    unsigned int max_levels;
+
+    /**
+     * Stop coarsening once a level has at most this many unknowns.
+     */
+    unsigned int coarse_size;
+
+    /**
+     * Damping factor for the Jacobi smoothing of the tentative
+     * prolongation, relative to the inverse of the largest eigenvalue of
+     * $D^{-1}A$, which is estimated by the power iteration.
+     */
+    double prolongation_damping;
+
+    /**
+     * Use a W-cycle instead of a V-cycle. The W-cycle visits each coarse
+     * level twice per visit of the next finer one, which is affordable
+     * since aggregation reduces the number of unknowns by a factor of five
+     * or more per level, and keeps the number of iterations independent of
+     * the number of levels.
+     */
+    bool w_cycle;
+
+    /**
+     * Number of consecutive unknowns that are aggregated independently of
+     * the other ones, and thus the granularity of the parallel
+     * aggregation. Couplings between blocks are ignored when building
+     * aggregates, so smaller blocks give more parallelism but somewhat
+     * worse aggregates at the block boundaries.
+     */
+    unsigned int aggregation_block_size;
+  };
+
+  /**
+   * Constructor.
+   */
+  PreconditionAMG ();
+
+  /**
+   * Destructor.
+   */
+  ~PreconditionAMG ();
+
+  /**
+   * Build the multigrid hierarchy for the matrix @p matrix.
+   */
+  void initialize (const SparseMatrix<double> &matrix,
+                   const AdditionalData       &additional_data = AdditionalData());
+
+  /**
+   * Release all memory and return to the state right after construction.
+   */
+  void clear ();
+
+  /**
+   * Apply one multigrid cycle to @p src with zero initial guess.
+   */
+  void vmult (Vector<double>       &dst,
+              const Vector<double> &src) const;
+
+  /**
+   * Apply the transpose of the preconditioner. Since the cycle is
+   * symmetric, this is the same as vmult().
+   */
+  void Tvmult (Vector<double>       &dst,
+               const Vector<double> &src) const;
+
+  /**
+   * Return the number of levels of the hierarchy.
+   */
+  unsigned int n_levels () const;
+
+  /**
+   * Return the matrix on level @p level, where level 0 is the coarsest.
+   */
+  const SparseMatrix<double> &get_level_matrix (const unsigned int level) const;
+
+  /**
+   * Return the ratio of the number of nonzero entries of the matrices on
+   * all levels to the number of nonzero entries of the matrix on the finest
+   * level.
+   */
+  double operator_complexity () const;
+
+  /**
+   * Memory used by this object.
+   */
+  std::size_t memory_consumption () const;
+
+private:
+  /**
+   * Apply one cycle on level @p level with zero initial guess, recursing
+   * to the coarser levels.
+   */
+  void level_cycle (const unsigned int    level,
+                    Vector<double>       &dst,
+                    const Vector<double> &src) const;
+
+  /**
+   * The matrix on the finest level, which is the one given to
+   * initialize().
+   */
+  SmartPointer<const SparseMatrix<double>,PreconditionAMG> fine_matrix;
+
+  /**
+   * Sparsity patterns of the matrices on the coarse levels.
+   */
+  std::vector<std_cxx11::shared_ptr<SparsityPattern> > coarse_sparsities;
+
+  /**
+   * The matrices on the coarse levels, as computed by the Galerkin
+   * products, where index 0 is the coarsest level.
+   */
+  std::vector<std_cxx11::shared_ptr<SparseMatrix<double> > > coarse_matrices;
+
+  /**
+   * The transfer between the levels.
+   */
+  MGTransferAlgebraic mg_transfer;
+
+  /**
+   * QR decomposition of the matrix on the coarsest level.
+   */
+  std_cxx11::shared_ptr<Householder<double> > coarse_solver;
+
+  /**
+   * Number of SSOR steps for pre- and postsmoothing.
+   */
+  unsigned int smoother_sweeps;
+
+  /**
+   * Whether to apply a W-cycle instead of a V-cycle.
+   */
+  bool w_cycle;
+};
+
+/*@}*/
+
+DEAL_II_NAMESPACE_CLOSE
+
+#endif
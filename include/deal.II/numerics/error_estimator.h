@@ -93,15 +93,20 @@ namespace hp
  *  QMidpoint rule will suffice. For higher order elements, it is
  *  necessary to utilize higher order quadrature formulae as well.
  *
- *  We store the contribution of each face in a @p map, as provided by the
- *  C++ standard library, with the iterator pointing to that face being the
- *  key into the map. In fact, we do not store the indicator per face, but
- *  only the integral listed above. When looping the second time over all
- *  cells, we have to sum up the contributions of the faces, multiply them
- *  with $\frac h{24}$ and take the square root. By doing the multiplication
- *  with $h$ in the second loop, we avoid problems to decide with which $h$
- *  to multiply, that of the cell on the one or that of the cell on the other
- *  side of the face.
+ *  We store the contribution of each face in an array indexed by the index
+ *  of the face in the triangulation. In fact, we do not store the indicator
+ *  per face, but only the integral listed above. When looping the second
+ *  time over all cells, we have to sum up the contributions of the faces,
+ *  multiply them with $\frac h{24}$ and take the square root. By doing the
+ *  multiplication with $h$ in the second loop, we avoid problems to decide
+ *  with which $h$ to multiply, that of the cell on the one or that of the
+ *  cell on the other side of the face.
+ *
+ *  The first loop runs in parallel on all available threads. Since each face
+ *  is integrated by exactly one of its adjacent cells, the threads write to
+ *  different entries of the array of face contributions and do not need to
+ *  synchronise, nor do they have to hand their results to a serial stage
+ *  that collects them.
  *
  *  $h$ is taken to be the greatest length of the diagonals of the cell. For
  *  more or less uniform cells without deformed angles, this coincides with
@@ -196,7 +201,7 @@ namespace hp
  *  Since we integrate from the coarse side of the face, we have the mother
  *  face readily at hand and store the result of the integration over that
  *  mother face (being the sum of the integrals along the subfaces) in the
- *  abovementioned map of integrals as well. This consumes some memory more
+ *  abovementioned array of integrals as well. This consumes some memory more
  *  than needed, but makes the summing up of the face contributions to the
  *  cells easier, since then we have the information from all faces of all
  *  cells at hand and need not think about explicitly determining whether
@@ -286,6 +291,16 @@ public:
    * indicator vector must still have a length equal to the number of active
    * cell in the mesh as reported by
    * parallel::distributed::Triangulation::n_locally_owned_active_cells().
+   *
+   * @note If the solution is a parallel::distributed::Vector, it needs to
+   * have been set up with the locally relevant degrees of freedom as ghost
+   * entries, but the ghost values need not be up to date: if the vector does
+   * not have its ghost values imported (see
+   * parallel::distributed::Vector::has_ghost_elements()), this function
+   * calls update_ghost_values() on it and releases the ghost values again
+   * before returning, which saves creating a ghosted copy of the
+   * solution. In that case, the function needs to be called on all
+   * processors at the same time.
    */
   template <typename InputVector, class DH>
   static void estimate (const Mapping<dim, spacedim>      &mapping,
@@ -130,6 +130,20 @@ namespace TrilinosWrappers
  * assemble the <b>same</b> right hand side for <b>every</b> matrix
  * you generate and add together).
  *
+ * The mass and Laplace matrices are assembled in parallel if the library
+ * is configured to use multithreading. The cells are then colored with
+ * GraphColoring::make_graph_coloring() so that cells of the same color do
+ * not share any degrees of freedom (taking into account the constraints),
+ * which allows the local contributions of all cells of one color to be
+ * written into the global matrix at the same time. Computing the coloring
+ * costs about as much as assembling a mass matrix with lowest order
+ * elements on one thread. If you create several matrices on the same
+ * DoFHandler and with the same constraints, you can therefore compute the
+ * coloring once with make_cell_coloring() and pass it to each of the
+ * functions as the optional argument @p colored_cells. The coloring has to
+ * be computed again whenever the mesh, the degrees of freedom or the
+ * constraints change.
+ *
  * If you want to use boundary conditions with the matrices generated
  * by the functions of this class in addition to the ones in a possible
  * constraint matrix, you have to use a function like
@@ -227,6 +241,24 @@ namespace TrilinosWrappers
  */
 namespace MatrixCreator
 {
+  /**
+   * Color the active cells of the given DoFHandler such that no two cells
+   * of the same color share a degree of freedom, taking into account the
+   * given constraints. The result can be passed as the @p colored_cells
+   * argument to the create_mass_matrix() and create_laplace_matrix()
+   * functions, which then do not have to compute the coloring themselves.
+   *
+   * The coloring refers to the cells of @p dof and is only valid as long as
+   * neither the mesh nor the degrees of freedom nor the constraints
+   * change.
+   *
+   * @p DH may be a DoFHandler or an hp::DoFHandler.
+   */
+  template <class DH>
+  std::vector<std::vector<typename DH::active_cell_iterator> >
+  make_cell_coloring (const DH               &dof,
+                      const ConstraintMatrix &constraints);
+
   /**
    * Assemble the mass matrix. If no coefficient is given (i.e., if
    * the pointer to a function object is zero as it is by default),
@@ -241,6 +273,11 @@ namespace MatrixCreator
    * later want to add several such matrices, for example in time
    * dependent settings such as the main loop of step-26.
    *
+   * The optional argument @p colored_cells is a coloring of the active cells
+   * of @p dof as returned by make_cell_coloring() for the same @p
+   * constraints. If it is not given and the assembly runs in parallel, the
+   * coloring is computed by this function.
+   *
    * See the general doc of this class for more information.
    */
   template <int dim, typename number, int spacedim>
@@ -249,7 +286,8 @@ namespace MatrixCreator
                            const Quadrature<dim>    &q,
                            SparseMatrix<number>     &matrix,
                            const Function<spacedim> *const a = 0,
-                           const ConstraintMatrix   &constraints = ConstraintMatrix());
+                           const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                           const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Calls the create_mass_matrix() function, see above, with
@@ -260,7 +298,8 @@ namespace MatrixCreator
                            const Quadrature<dim>    &q,
                            SparseMatrix<number>     &matrix,
                            const Function<spacedim> *const a = 0,
-                           const ConstraintMatrix   &constraints = ConstraintMatrix());
+                           const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                           const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Assemble the mass matrix and a right hand side vector. If no
@@ -287,7 +326,8 @@ namespace MatrixCreator
                            const Function<spacedim> &rhs,
                            Vector<double>           &rhs_vector,
                            const Function<spacedim> *const a = 0,
-                           const ConstraintMatrix   &constraints = ConstraintMatrix());
+                           const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                           const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Calls the create_mass_matrix() function, see above, with
@@ -300,7 +340,8 @@ namespace MatrixCreator
                            const Function<spacedim> &rhs,
                            Vector<double>           &rhs_vector,
                            const Function<spacedim> *const a = 0,
-                           const ConstraintMatrix   &constraints = ConstraintMatrix());
+                           const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                           const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Same function as above, but for hp objects.
@@ -311,7 +352,8 @@ namespace MatrixCreator
                            const hp::QCollection<dim>    &q,
                            SparseMatrix<number>     &matrix,
                            const Function<spacedim> *const a = 0,
-                           const ConstraintMatrix   &constraints = ConstraintMatrix());
+                           const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                           const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Same function as above, but for hp objects.
@@ -321,7 +363,8 @@ namespace MatrixCreator
                            const hp::QCollection<dim>    &q,
                            SparseMatrix<number>     &matrix,
                            const Function<spacedim> *const a = 0,
-                           const ConstraintMatrix   &constraints = ConstraintMatrix());
+                           const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                           const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Same function as above, but for hp objects.
@@ -334,7 +377,8 @@ namespace MatrixCreator
                            const Function<spacedim> &rhs,
                            Vector<double>           &rhs_vector,
                            const Function<spacedim> *const a = 0,
-                           const ConstraintMatrix   &constraints = ConstraintMatrix());
+                           const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                           const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Same function as above, but for hp objects.
@@ -346,7 +390,8 @@ namespace MatrixCreator
                            const Function<spacedim> &rhs,
                            Vector<double>           &rhs_vector,
                            const Function<spacedim> *const a = 0,
-                           const ConstraintMatrix   &constraints = ConstraintMatrix());
+                           const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                           const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
 
   /**
@@ -478,6 +523,11 @@ namespace MatrixCreator
    * later want to add several such matrices, for example in time
    * dependent settings such as the main loop of step-26.
    *
+   * The optional argument @p colored_cells is a coloring of the active cells
+   * of @p dof as returned by make_cell_coloring() for the same @p
+   * constraints. If it is not given and the assembly runs in parallel, the
+   * coloring is computed by this function.
+   *
    * See the general doc of this class for more information.
    */
   template <int dim, int spacedim>
@@ -486,7 +536,8 @@ namespace MatrixCreator
                               const Quadrature<dim>    &q,
                               SparseMatrix<double>     &matrix,
                               const Function<spacedim> *const a = 0,
-                              const ConstraintMatrix   &constraints = ConstraintMatrix());
+                              const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                              const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Calls the create_laplace_matrix() function, see above, with
@@ -497,7 +548,8 @@ namespace MatrixCreator
                               const Quadrature<dim>    &q,
                               SparseMatrix<double>     &matrix,
                               const Function<spacedim> *const a = 0,
-                              const ConstraintMatrix   &constraints = ConstraintMatrix());
+                              const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                              const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Assemble the Laplace matrix and a right hand side vector. If no
@@ -512,6 +564,11 @@ namespace MatrixCreator
    * later want to add several such matrices, for example in time
    * dependent settings such as the main loop of step-26.
    *
+   * The optional argument @p colored_cells is a coloring of the active cells
+   * of @p dof as returned by make_cell_coloring() for the same @p
+   * constraints. If it is not given and the assembly runs in parallel, the
+   * coloring is computed by this function.
+   *
    * See the general doc of this class for more information.
    */
   template <int dim, int spacedim>
@@ -522,7 +579,8 @@ namespace MatrixCreator
                               const Function<spacedim> &rhs,
                               Vector<double>           &rhs_vector,
                               const Function<spacedim> *const a = 0,
-                              const ConstraintMatrix   &constraints = ConstraintMatrix());
+                              const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                              const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Calls the create_laplace_matrix() function, see above, with
@@ -535,7 +593,8 @@ namespace MatrixCreator
                               const Function<spacedim> &rhs,
                               Vector<double>           &rhs_vector,
                               const Function<spacedim> *const a = 0,
-                              const ConstraintMatrix   &constraints = ConstraintMatrix());
+                              const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                              const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Like the functions above, but for hp dof handlers, mappings, and
@@ -547,7 +606,8 @@ namespace MatrixCreator
                               const hp::QCollection<dim>    &q,
                               SparseMatrix<double>     &matrix,
                               const Function<spacedim> *const a = 0,
-                              const ConstraintMatrix   &constraints = ConstraintMatrix());
+                              const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                              const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Like the functions above, but for hp dof handlers, mappings, and
@@ -558,7 +618,8 @@ namespace MatrixCreator
                               const hp::QCollection<dim>    &q,
                               SparseMatrix<double>     &matrix,
                               const Function<spacedim> *const a = 0,
-                              const ConstraintMatrix   &constraints = ConstraintMatrix());
+                              const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                              const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Like the functions above, but for hp dof handlers, mappings, and
@@ -572,7 +633,8 @@ namespace MatrixCreator
                               const Function<spacedim>      &rhs,
                               Vector<double>           &rhs_vector,
                               const Function<spacedim> *const a = 0,
-                              const ConstraintMatrix   &constraints = ConstraintMatrix());
+                              const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                              const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Like the functions above, but for hp dof handlers, mappings, and
@@ -585,7 +647,8 @@ namespace MatrixCreator
                               const Function<spacedim>      &rhs,
                               Vector<double>           &rhs_vector,
                               const Function<spacedim> *const a = 0,
-                              const ConstraintMatrix   &constraints = ConstraintMatrix());
+                              const ConstraintMatrix   &constraints = ConstraintMatrix(),
+                              const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells = 0);
 
   /**
    * Exception
@@ -0,0 +1,641 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#include <deal.II/base/hardware_counters.h>
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/base/thread_local_storage.h>
+#include <deal.II/base/std_cxx11/shared_ptr.h>
+
+#ifdef DEAL_II_WITH_THREADS
+#  include <tbb/task.h>
+#  include <tbb/task_scheduler_observer.h>
+#endif
+
+#include <cstdlib>
+#include <vector>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef HAVE_SYS_TIME_H
+#  include <sys/time.h>
+#endif
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace internal
+{
+  namespace HardwareCounters
+  {
+    bool enabled = false;
+  }
+}
+
+
+
+namespace HardwareCounters
+{
+  namespace
+  {
+    // the size of a cache line used to convert cache misses into bytes
+    const unsigned int cache_line_size = 64;
+
+
+
+    double wall_clock_now ()
+    {
+#ifdef HAVE_SYS_TIME_H
+      struct timeval wall_timer;
+      gettimeofday (&wall_timer, NULL);
+      return wall_timer.tv_sec + 1.e-6 * wall_timer.tv_usec;
+#else
+      return static_cast<double>(std::time (NULL));
+#endif
+    }
+
+
+
+    // the code of the raw event to be used for counting floating point
+    // operations, or zero if none was given
+    unsigned long long flop_event_code ()
+    {
+      const char *code = std::getenv ("DEAL_II_PERF_FLOP_EVENT");
+      if (code == 0)
+        return 0;
+      return std::strtoull (code, 0, 16);
+    }
+
+
+
+    // a group of counters of the present thread. the counters are opened
+    // together so that the kernel schedules them at the same time, and are
+    // read with a single system call. events that the processor or the
+    // kernel does not support are left out of the group
+    class EventGroup
+    {
+    public:
+      EventGroup ();
+      ~EventGroup ();
+
+      bool available (const Event event) const;
+
+      void read (unsigned long long counts[n_events]) const;
+
+    private:
+      int          leader;
+      int          fds[n_events];
+      unsigned int position[n_events];
+      unsigned int n_open;
+    };
+
+
+
+    EventGroup::EventGroup ()
+      :
+      leader (-1),
+      n_open (0)
+    {
+      for (unsigned int e=0; e<n_events; ++e)
+        {
+          fds[e] = -1;
+          position[e] = numbers::invalid_unsigned_int;
+        }
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+      for (unsigned int e=0; e<n_events; ++e)
+        {
+          perf_event_attr attr;
+          std::memset (&attr, 0, sizeof(attr));
+          attr.size = sizeof(attr);
+          attr.read_format = PERF_FORMAT_GROUP;
+          attr.exclude_kernel = 1;
+          attr.exclude_hv = 1;
+          attr.disabled = (leader == -1 ? 1 : 0);
+
+          switch (e)
+            {
+            case cycles:
+              attr.type = PERF_TYPE_HARDWARE;
+              attr.config = PERF_COUNT_HW_CPU_CYCLES;
+              break;
+            case instructions:
+              attr.type = PERF_TYPE_HARDWARE;
+              attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+              break;
+            case cache_references:
+              attr.type = PERF_TYPE_HARDWARE;
+              attr.config = PERF_COUNT_HW_CACHE_REFERENCES;
+              break;
+            case cache_misses:
+              attr.type = PERF_TYPE_HARDWARE;
+              attr.config = PERF_COUNT_HW_CACHE_MISSES;
+              break;
+            case floating_point_operations:
+              attr.type = PERF_TYPE_RAW;
+              attr.config = flop_event_code();
+              if (attr.config == 0)
+                continue;
+              break;
+            }
+
+          // count the calling thread on whatever processor it runs
+          const long fd = syscall (__NR_perf_event_open, &attr, 0, -1, leader, 0);
+          if (fd < 0)
+            continue;
+
+          fds[e] = fd;
+          position[e] = n_open++;
+          if (leader == -1)
+            leader = fd;
+        }
+
+      if (leader != -1)
+        ioctl (leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+
+
+    EventGroup::~EventGroup ()
+    {
+#ifdef HAVE_LINUX_PERF_EVENT_H
+      for (unsigned int e=0; e<n_events; ++e)
+        if (fds[e] != -1)
+          close (fds[e]);
+#endif
+    }
+
+
+
+    bool
+    EventGroup::available (const Event event) const
+    {
+      return position[event] != numbers::invalid_unsigned_int;
+    }
+
+
+
+    void
+    EventGroup::read (unsigned long long counts[n_events]) const
+    {
+      for (unsigned int e=0; e<n_events; ++e)
+        counts[e] = 0;
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+      if (leader == -1)
+        return;
+
+      // with PERF_FORMAT_GROUP, the kernel writes the number of events
+      // followed by their values in the order they were opened
+      unsigned long long buffer[1+n_events];
+      if (::read (leader, buffer, sizeof(buffer)) < static_cast<long>(sizeof(buffer[0])))
+        return;
+      for (unsigned int e=0; e<n_events; ++e)
+        if (position[e] < buffer[0])
+          counts[e] = buffer[1+position[e]];
+#endif
+    }
+
+
+
+    // the counters of all threads that have opened them so far. the
+    // objects are owned by the thread local storage below, which keeps
+    // them until the end of the program even if their threads finish
+    Threads::Mutex            all_groups_mutex;
+    std::vector<EventGroup *> all_groups;
+
+
+
+    // the counters of the calling thread, opened the first time the thread
+    // asks for them
+    EventGroup &
+    thread_event_group ()
+    {
+      static Threads::ThreadLocalStorage<std_cxx11::shared_ptr<EventGroup> > groups;
+
+      std_cxx11::shared_ptr<EventGroup> &group = groups.get();
+      if (group.get() == 0)
+        {
+          group.reset (new EventGroup());
+
+          Threads::Mutex::ScopedLock lock (all_groups_mutex);
+          all_groups.push_back (group.get());
+        }
+      return *group;
+    }
+
+
+
+    // whether the task scheduler has been started on the calling thread
+    Threads::ThreadLocalStorage<bool> &
+    scheduler_started ()
+    {
+      static Threads::ThreadLocalStorage<bool> started (false);
+      return started;
+    }
+
+
+
+    // whether the calling thread executes a task of the task scheduler, as
+    // opposed to the code outside of all tasks that spawns them. this
+    // includes the tasks the main thread executes while it waits for
+    // others. the scheduler is not asked on threads on which it has not
+    // been started, since this would start it with default settings
+    bool
+    in_task ()
+    {
+#ifdef DEAL_II_WITH_THREADS
+      if (scheduler_started().get() == false)
+        return false;
+
+      // outside of all tasks, the scheduler runs a dummy task without
+      // parent, while the tasks of the library all have one
+      return (tbb::task::self().parent() != 0);
+#else
+      return false;
+#endif
+    }
+
+
+
+#ifdef DEAL_II_WITH_THREADS
+    // an observer that marks the threads on which the task scheduler runs,
+    // and opens the counters of its worker threads when they start working
+    // while the instrumentation is enabled, so that regions entered outside
+    // of tasks can add them up
+    class WorkerObserver : public tbb::task_scheduler_observer
+    {
+    public:
+      virtual void on_scheduler_entry (bool is_worker)
+      {
+        scheduler_started().get() = true;
+        if (is_worker && is_enabled())
+          thread_event_group();
+      }
+    };
+
+
+
+    // the observer is created on first use and never destroyed, since the
+    // task scheduler may already be shut down when static objects are
+    // destroyed at the end of the program
+    WorkerObserver &
+    worker_observer ()
+    {
+      static WorkerObserver *observer = new WorkerObserver();
+      return *observer;
+    }
+#endif
+
+
+
+    // the data of all regions and the settings of the summary. the summary
+    // is printed, if requested, when this object is destroyed at the end of
+    // the program. whether floating point operations and cache misses are
+    // counted is determined when the instrumentation is enabled, since the
+    // counters of the thread may already be gone at that point
+    struct Registry
+    {
+      Registry ();
+      ~Registry ();
+
+      Threads::Mutex                     mutex;
+      std::map<std::string, RegionData>  regions;
+      bool                               print_at_exit;
+      bool                               counted_flops;
+      bool                               counted_bytes;
+      double                             peak_gflops;
+      double                             peak_bandwidth;
+    };
+
+
+
+    Registry &
+    registry ()
+    {
+      static Registry registry;
+      return registry;
+    }
+
+
+
+    // format a value for the summary, or a dash if it is not known
+    std::string
+    format_value (const double       value,
+                  const bool         known,
+                  const unsigned int precision)
+    {
+      if (known == false)
+        return "-";
+      std::ostringstream s;
+      s << std::fixed << std::setprecision(precision) << value;
+      return s.str();
+    }
+
+
+
+    void
+    print_regions (const Registry &data,
+                   std::ostream   &out)
+    {
+      const bool   counted_flops = data.counted_flops;
+      const bool   counted_bytes = data.counted_bytes;
+      const double peak_gflops = data.peak_gflops;
+      const double peak_bandwidth = data.peak_bandwidth;
+      const bool   have_peaks = (peak_gflops > 0 && peak_bandwidth > 0);
+
+      std::ostringstream table;
+      table << std::endl
+            << "Hardware counter summary"
+            << " (floating point operations: "
+            << (counted_flops ? "counted" : "model")
+            << ", memory transfer: "
+            << (counted_bytes ? "last level cache misses" : "model")
+            << ")" << std::endl
+            << std::left << std::setw(32) << "Region" << std::right
+            << std::setw(9)  << "calls"
+            << std::setw(12) << "wall [s]"
+            << std::setw(7)  << "IPC"
+            << std::setw(10) << "GFlop/s"
+            << std::setw(9)  << "GB/s"
+            << std::setw(10) << "Flop/Byte"
+            << std::setw(9)  << "bound"
+            << std::setw(11) << "% roofline"
+            << std::endl;
+
+      for (std::map<std::string, RegionData>::const_iterator
+           p = data.regions.begin(); p != data.regions.end(); ++p)
+        {
+          const RegionData &region = p->second;
+          const double flops = (counted_flops ?
+                                static_cast<double>(region.counts[floating_point_operations]) :
+                                region.model_flops);
+          const double bytes = (counted_bytes ?
+                                static_cast<double>(region.counts[cache_misses]) * cache_line_size :
+                                region.model_bytes);
+          const bool   timed = (region.wall_time > 0);
+          const double gflops = (timed ? 1e-9 * flops / region.wall_time : 0.);
+          const double bandwidth = (timed ? 1e-9 * bytes / region.wall_time : 0.);
+
+          // classify the region by comparing its arithmetic intensity to
+          // the ridge point of the roofline, and compare the achieved
+          // performance to the roofline limit at that intensity
+          std::string bound = "-";
+          double      fraction = 0;
+          if (have_peaks && timed && bytes > 0)
+            {
+              const double intensity = flops / bytes;
+              if (intensity < peak_gflops / peak_bandwidth)
+                {
+                  bound = "memory";
+                  fraction = (flops > 0 ?
+                              gflops / (intensity * peak_bandwidth) :
+                              bandwidth / peak_bandwidth);
+                }
+              else
+                {
+                  bound = "compute";
+                  fraction = gflops / peak_gflops;
+                }
+            }
+          else if (have_peaks && timed && flops > 0)
+            {
+              bound = "compute";
+              fraction = gflops / peak_gflops;
+            }
+
+          table << std::left << std::setw(32) << p->first.substr(0, 31) << std::right
+                << std::setw(9) << region.n_calls
+                << std::setw(12) << format_value (region.wall_time, true, 4)
+                << std::setw(7) << format_value (region.counts[cycles] > 0 ?
+                                                 static_cast<double>(region.counts[instructions]) /
+                                                 region.counts[cycles] : 0.,
+                                                 region.counts[cycles] > 0, 2)
+                << std::setw(10) << format_value (gflops, timed && flops > 0, 3)
+                << std::setw(9) << format_value (bandwidth, timed && bytes > 0, 3)
+                << std::setw(10) << format_value (bytes > 0 ? flops / bytes : 0.,
+                                                  flops > 0 && bytes > 0, 3)
+                << std::setw(9) << bound
+                << std::setw(11) << format_value (100. * fraction, bound != "-", 1)
+                << std::endl;
+        }
+      table << std::endl;
+
+      out << table.str() << std::flush;
+    }
+
+
+
+    Registry::Registry ()
+      :
+      print_at_exit (false),
+      counted_flops (false),
+      counted_bytes (false),
+      peak_gflops (0),
+      peak_bandwidth (0)
+    {
+      const char *gflops = std::getenv ("DEAL_II_PEAK_GFLOPS");
+      if (gflops != 0)
+        peak_gflops = std::atof (gflops);
+      const char *bandwidth = std::getenv ("DEAL_II_PEAK_BANDWIDTH");
+      if (bandwidth != 0)
+        peak_bandwidth = std::atof (bandwidth);
+    }
+
+
+
+    Registry::~Registry ()
+    {
+      if (print_at_exit && regions.size() > 0)
+        print_regions (*this, std::cout);
+    }
+
+
+
+    // switch the instrumentation on when the program starts if requested
+    // through the environment
+    struct EnableFromEnvironment
+    {
+      EnableFromEnvironment ()
+      {
+        const char *value = std::getenv ("DEAL_II_HARDWARE_COUNTERS");
+        if (value != 0 && std::atoi (value) != 0)
+          enable (true);
+      }
+    } enable_from_environment;
+  }
+
+
+
+  RegionData::RegionData ()
+    :
+    n_calls (0),
+    wall_time (0),
+    model_flops (0),
+    model_bytes (0)
+  {
+    for (unsigned int e=0; e<n_events; ++e)
+      counts[e] = 0;
+  }
+
+
+
+  void
+  enable (const bool print_summary_at_exit)
+  {
+    Registry &data = registry();
+    const bool counted_flops = counter_available (floating_point_operations);
+    const bool counted_bytes = counter_available (cache_misses);
+
+    {
+      Threads::Mutex::ScopedLock lock (data.mutex);
+      data.print_at_exit = print_summary_at_exit;
+      data.counted_flops = counted_flops;
+      data.counted_bytes = counted_bytes;
+      internal::HardwareCounters::enabled = true;
+    }
+
+#ifdef DEAL_II_WITH_THREADS
+    worker_observer().observe (true);
+#endif
+  }
+
+
+
+  void
+  disable ()
+  {
+    internal::HardwareCounters::enabled = false;
+  }
+
+
+
+  bool
+  counter_available (const Event event)
+  {
+    Assert (event < n_events, ExcIndexRange (event, 0, n_events));
+    return thread_event_group().available (event);
+  }
+
+
+
+  Sample
+  read ()
+  {
+    Sample sample;
+    EventGroup &own_group = thread_event_group();
+    sample.all_threads = (in_task() == false);
+    if (sample.all_threads == false)
+      own_group.read (sample.counts);
+    else
+      {
+        for (unsigned int e=0; e<n_events; ++e)
+          sample.counts[e] = 0;
+
+        Threads::Mutex::ScopedLock lock (all_groups_mutex);
+        for (unsigned int g=0; g<all_groups.size(); ++g)
+          {
+            unsigned long long counts[n_events];
+            all_groups[g]->read (counts);
+            for (unsigned int e=0; e<n_events; ++e)
+              sample.counts[e] += counts[e];
+          }
+      }
+    sample.wall_time = wall_clock_now();
+    return sample;
+  }
+
+
+
+  void
+  add_sample (const std::string &region,
+              const Sample      &start,
+              const Sample      &end,
+              const double       model_flops,
+              const double       model_bytes)
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+
+    RegionData &region_data = data.regions[region];
+    ++region_data.n_calls;
+    region_data.wall_time += end.wall_time - start.wall_time;
+    if (start.all_threads == end.all_threads)
+      for (unsigned int e=0; e<n_events; ++e)
+        region_data.counts[e] += end.counts[e] - start.counts[e];
+    region_data.model_flops += model_flops;
+    region_data.model_bytes += model_bytes;
+  }
+
+
+
+  void
+  set_machine_peaks (const double peak_gflops,
+                     const double peak_bandwidth)
+  {
+    Assert (peak_gflops >= 0 && peak_bandwidth >= 0,
+            ExcMessage ("The peak performance numbers must not be negative."));
+
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    data.peak_gflops = peak_gflops;
+    data.peak_bandwidth = peak_bandwidth;
+  }
+
+
+
+  std::map<std::string, RegionData>
+  get_region_data ()
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    return data.regions;
+  }
+
+
+
+  void
+  print_summary (std::ostream &out)
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    print_regions (data, out);
+  }
+
+
+
+  void
+  reset ()
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    data.regions.clear();
+  }
+}
+
+
+DEAL_II_NAMESPACE_CLOSE
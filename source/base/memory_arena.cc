@@ -0,0 +1,101 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#include <deal.II/base/memory_arena.h>
+#include <deal.II/base/thread_local_storage.h>
+
+
+DEAL_II_NAMESPACE_OPEN
+
+
+MemoryArena::MemoryArena (const std::size_t initial_block_size)
+  :
+  initial_block_size (std::max (initial_block_size, std::size_t(4096))),
+  n_allocations (0)
+{
+  position.block = 0;
+  position.offset = 0;
+}
+
+
+
+MemoryArena::MemoryArena (const MemoryArena &arena)
+  :
+  initial_block_size (arena.initial_block_size),
+  n_allocations (0)
+{
+  position.block = 0;
+  position.offset = 0;
+}
+
+
+
+MemoryArena::~MemoryArena ()
+{
+  for (unsigned int b=0; b<blocks.size(); ++b)
+    ::operator delete (blocks[b].first);
+}
+
+
+
+void
+MemoryArena::merge_blocks ()
+{
+  Assert (position.block == 0 && position.offset == 0,
+          ExcInternalError());
+
+  std::size_t size = 0;
+  for (unsigned int b=0; b<blocks.size(); ++b)
+    {
+      size += blocks[b].second;
+      ::operator delete (blocks[b].first);
+    }
+  blocks.resize (1);
+  blocks[0] = std::make_pair (static_cast<char *>(::operator new (size)),
+                              size);
+  ++n_allocations;
+}
+
+
+
+std::size_t
+MemoryArena::memory_consumption () const
+{
+  std::size_t size = sizeof(*this) +
+                     blocks.capacity() * sizeof(std::pair<char *, std::size_t>);
+  for (unsigned int b=0; b<blocks.size(); ++b)
+    size += blocks[b].second;
+  return size;
+}
+
+
+
+std::size_t
+MemoryArena::n_heap_allocations () const
+{
+  return n_allocations;
+}
+
+
+
+MemoryArena &
+MemoryArena::thread_local_arena ()
+{
+  static Threads::ThreadLocalStorage<MemoryArena> arenas (MemoryArena (64*1024));
+  return arenas.get();
+}
+
+
+DEAL_II_NAMESPACE_CLOSE
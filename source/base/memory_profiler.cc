@@ -0,0 +1,451 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#include <deal.II/base/memory_profiler.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/thread_management.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace internal
+{
+  namespace MemoryProfiler
+  {
+    bool enabled = false;
+  }
+}
+
+
+
+namespace MemoryProfiler
+{
+  namespace
+  {
+    // the data of all phases and the registered objects, protected by a
+    // mutex. the report is printed, if requested, when this object is
+    // destroyed at the end of the program
+    struct Registry
+    {
+      Registry ();
+      ~Registry ();
+
+      Threads::Mutex                                                mutex;
+      std::map<std::string, PhaseData>                              phases;
+      std::map<std::string, std_cxx11::function<std::size_t ()> > objects;
+      bool                                                          print_at_exit;
+      bool                                                          sample_at_end_of_phase;
+    };
+
+
+
+    Registry &
+    registry ()
+    {
+      static Registry registry;
+      return registry;
+    }
+
+
+
+    // a number of the report, reduced over all processes if a communicator
+    // is given
+    struct ReducedValue
+    {
+      double       max;
+      double       sum;
+      unsigned int max_rank;
+    };
+
+
+
+    ReducedValue
+    reduce (const double    value,
+            const MPI_Comm *mpi_communicator)
+    {
+      ReducedValue result;
+      if (mpi_communicator == 0)
+        {
+          result.max = result.sum = value;
+          result.max_rank = 0;
+        }
+      else
+        {
+          const Utilities::MPI::MinMaxAvg min_max_avg
+            = Utilities::MPI::min_max_avg (value, *mpi_communicator);
+          result.max = min_max_avg.max;
+          result.sum = min_max_avg.sum;
+          result.max_rank = min_max_avg.max_index;
+        }
+      return result;
+    }
+
+
+
+    std::string
+    format_megabytes (const double megabytes)
+    {
+      std::ostringstream s;
+      s << std::fixed << std::setprecision(1) << megabytes;
+      return s.str();
+    }
+
+
+
+    // add the names of all processes of the communicator to the given set
+    // of names, so that all processes end up with the same set
+    void
+    add_names_of_all_processes (std::set<std::string> &names,
+                                const MPI_Comm        &mpi_communicator)
+    {
+#ifdef DEAL_II_WITH_MPI
+      std::string my_names;
+      for (std::set<std::string>::const_iterator
+           n = names.begin(); n != names.end(); ++n)
+        {
+          my_names += *n;
+          my_names += '\0';
+        }
+
+      const unsigned int n_procs = Utilities::MPI::n_mpi_processes (mpi_communicator);
+      int my_size = my_names.size();
+      std::vector<int> sizes (n_procs), offsets (n_procs+1, 0);
+      MPI_Allgather (&my_size, 1, MPI_INT, &sizes[0], 1, MPI_INT,
+                     mpi_communicator);
+      for (unsigned int p=0; p<n_procs; ++p)
+        offsets[p+1] = offsets[p] + sizes[p];
+
+      std::vector<char> all_names (std::max (offsets[n_procs], 1));
+      MPI_Allgatherv (const_cast<char *>(my_names.c_str()), my_size, MPI_CHAR,
+                      &all_names[0], &sizes[0], &offsets[0], MPI_CHAR,
+                      mpi_communicator);
+      for (int i=0; i<offsets[n_procs]; )
+        {
+          const std::string name (&all_names[i]);
+          i += name.size() + 1;
+          names.insert (name);
+        }
+#else
+      (void)names;
+      (void)mpi_communicator;
+#endif
+    }
+
+
+
+    // print the table of all phases. if a communicator is given, every
+    // number is reduced over its processes, which is a collective
+    // operation, and the table is only printed on the process with rank
+    // zero. in that case, the phases and objects of all processes are first
+    // added to the given ones with zero values, so that all processes call
+    // the reduction functions for the same numbers
+    void
+    print_phases (std::map<std::string, PhaseData> &phases,
+                  const MPI_Comm                   *mpi_communicator,
+                  std::ostream                     &out)
+    {
+      const bool parallel = (mpi_communicator != 0);
+      if (parallel)
+        {
+          std::set<std::string> phase_names;
+          for (std::map<std::string, PhaseData>::const_iterator
+               p = phases.begin(); p != phases.end(); ++p)
+            phase_names.insert (p->first);
+          add_names_of_all_processes (phase_names, *mpi_communicator);
+
+          for (std::set<std::string>::const_iterator
+               name = phase_names.begin(); name != phase_names.end(); ++name)
+            {
+              PhaseData &phase = phases[*name];
+              std::set<std::string> object_names;
+              for (std::map<std::string, std::size_t>::const_iterator
+                   o = phase.object_memory.begin(); o != phase.object_memory.end(); ++o)
+                object_names.insert (o->first);
+              add_names_of_all_processes (object_names, *mpi_communicator);
+              for (std::set<std::string>::const_iterator
+                   o = object_names.begin(); o != object_names.end(); ++o)
+                phase.object_memory[*o];
+            }
+        }
+
+      const double kilobyte = 1024., megabyte = 1024. * 1024.;
+
+      std::ostringstream table;
+      table << std::endl
+            << "Memory profile (sizes in MB"
+            << (parallel ? ", maximum over all processes" : "")
+            << ")" << std::endl
+            << std::left << std::setw(32) << "Phase" << std::right
+            << std::setw(9)  << "calls"
+            << std::setw(12) << "HWM growth";
+      if (parallel)
+        table << std::setw(8) << "on rank";
+      table << std::setw(11) << "VmHWM";
+      if (parallel)
+        table << std::setw(12) << "VmHWM sum";
+      table << std::setw(11) << "VmRSS"
+            << std::setw(11) << "objects"
+            << std::endl;
+
+      for (std::map<std::string, PhaseData>::const_iterator
+           p = phases.begin(); p != phases.end(); ++p)
+        {
+          const PhaseData &phase = p->second;
+          const ReducedValue n_calls = reduce (phase.n_calls, mpi_communicator);
+          const ReducedValue increase = reduce (phase.max_hwm_increase,
+                                                mpi_communicator);
+          const ReducedValue hwm = reduce (phase.hwm, mpi_communicator);
+          const ReducedValue rss = reduce (phase.max_rss, mpi_communicator);
+
+          std::size_t object_memory = 0;
+          for (std::map<std::string, std::size_t>::const_iterator
+               o = phase.object_memory.begin(); o != phase.object_memory.end(); ++o)
+            object_memory += o->second;
+          const ReducedValue objects = reduce (object_memory, mpi_communicator);
+
+          table << std::left << std::setw(32) << p->first.substr(0, 31) << std::right
+                << std::setw(9) << n_calls.max
+                << std::setw(12) << format_megabytes (increase.max / kilobyte);
+          if (parallel)
+            table << std::setw(8) << increase.max_rank;
+          table << std::setw(11) << format_megabytes (hwm.max / kilobyte);
+          if (parallel)
+            table << std::setw(12) << format_megabytes (hwm.sum / kilobyte);
+          table << std::setw(11) << format_megabytes (rss.max / kilobyte)
+                << std::setw(11) << format_megabytes (objects.max / megabyte)
+                << std::endl;
+
+          // then the registered objects, indented
+          for (std::map<std::string, std::size_t>::const_iterator
+               o = phase.object_memory.begin(); o != phase.object_memory.end(); ++o)
+            {
+              const ReducedValue memory = reduce (o->second, mpi_communicator);
+              table << "  " << std::left << std::setw(parallel ? 93 : 73)
+                    << o->first.substr(0, 60) << std::right
+                    << std::setw(11) << format_megabytes (memory.max / megabyte)
+                    << std::endl;
+            }
+        }
+      table << std::endl;
+
+      if (parallel == false ||
+          Utilities::MPI::this_mpi_process (*mpi_communicator) == 0)
+        out << table.str() << std::flush;
+    }
+
+
+
+    Registry::Registry ()
+      :
+      print_at_exit (false),
+      sample_at_end_of_phase (false)
+    {}
+
+
+
+    Registry::~Registry ()
+    {
+      if (print_at_exit && phases.size() > 0)
+        print_phases (phases, 0, std::cout);
+    }
+
+
+
+    // switch the profiling on when the program starts if requested through
+    // the environment
+    struct EnableFromEnvironment
+    {
+      EnableFromEnvironment ()
+      {
+        const char *value = std::getenv ("DEAL_II_MEMORY_PROFILE");
+        if (value != 0 && std::atoi (value) != 0)
+          enable (true);
+      }
+    } enable_from_environment;
+  }
+
+
+
+  PhaseData::PhaseData ()
+    :
+    n_calls (0),
+    max_hwm_increase (0),
+    hwm (0),
+    max_rss (0)
+  {}
+
+
+
+  void
+  enable (const bool print_report_at_exit,
+          const bool sample_objects_at_end_of_phase)
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    data.print_at_exit = print_report_at_exit;
+    data.sample_at_end_of_phase = sample_objects_at_end_of_phase;
+    internal::MemoryProfiler::enabled = true;
+  }
+
+
+
+  void
+  disable ()
+  {
+    internal::MemoryProfiler::enabled = false;
+  }
+
+
+
+  void
+  register_object (const std::string                            &name,
+                   const std_cxx11::function<std::size_t ()> &memory_consumption)
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    data.objects[name] = memory_consumption;
+  }
+
+
+
+  void
+  unregister_object (const std::string &name)
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    data.objects.erase (name);
+  }
+
+
+
+  Utilities::System::MemoryStats
+  read ()
+  {
+    Utilities::System::MemoryStats stats;
+    Utilities::System::get_memory_stats (stats);
+    return stats;
+  }
+
+
+
+  void
+  add_sample (const std::string                    &phase,
+              const Utilities::System::MemoryStats &start,
+              const Utilities::System::MemoryStats &end)
+  {
+    Registry &data = registry();
+    bool sample_at_end_of_phase;
+    {
+      Threads::Mutex::ScopedLock lock (data.mutex);
+
+      PhaseData &phase_data = data.phases[phase];
+      ++phase_data.n_calls;
+      if (end.VmHWM > start.VmHWM)
+        phase_data.max_hwm_increase = std::max (phase_data.max_hwm_increase,
+                                                end.VmHWM - start.VmHWM);
+      phase_data.hwm = end.VmHWM;
+      phase_data.max_rss = std::max (phase_data.max_rss, end.VmRSS);
+      sample_at_end_of_phase = data.sample_at_end_of_phase;
+    }
+
+    // sample_objects() takes the lock itself, but only while copying the
+    // registered objects and storing the result
+    if (sample_at_end_of_phase)
+      sample_objects (phase);
+  }
+
+
+
+  void
+  sample_objects (const std::string &phase)
+  {
+    Registry &data = registry();
+
+    // compute the memory consumption without holding the lock, since this
+    // may take a while and other threads may want to add their samples in
+    // the meantime
+    std::map<std::string, std_cxx11::function<std::size_t ()> > objects;
+    {
+      Threads::Mutex::ScopedLock lock (data.mutex);
+      objects = data.objects;
+    }
+    std::map<std::string, std::size_t> object_memory;
+    for (std::map<std::string, std_cxx11::function<std::size_t ()> >::const_iterator
+         o = objects.begin(); o != objects.end(); ++o)
+      object_memory[o->first] = o->second();
+
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    PhaseData &phase_data = data.phases[phase];
+    for (std::map<std::string, std::size_t>::const_iterator
+         o = object_memory.begin(); o != object_memory.end(); ++o)
+      {
+        std::size_t &memory = phase_data.object_memory[o->first];
+        memory = std::max (memory, o->second);
+      }
+  }
+
+
+
+  std::map<std::string, PhaseData>
+  get_phase_data ()
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    return data.phases;
+  }
+
+
+
+  void
+  print_report (std::ostream &out)
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    print_phases (data.phases, 0, out);
+  }
+
+
+
+  void
+  print_report (std::ostream   &out,
+                const MPI_Comm &mpi_communicator)
+  {
+    // copy the data so that no lock is held during the communication
+    std::map<std::string, PhaseData> phases = get_phase_data ();
+    print_phases (phases, &mpi_communicator, out);
+  }
+
+
+
+  void
+  reset ()
+  {
+    Registry &data = registry();
+    Threads::Mutex::ScopedLock lock (data.mutex);
+    data.phases.clear();
+  }
+}
+
+
+DEAL_II_NAMESPACE_CLOSE
@@ -32,8 +32,21 @@
 #ifdef DEAL_II_WITH_THREADS
 #  include <deal.II/base/thread_management.h>
 #  include <tbb/task_scheduler_init.h>
+#  include <tbb/task_scheduler_observer.h>
 #endif
 
+#if defined(DEAL_II_WITH_THREADS) && defined(__linux__)
+#  include <sched.h>
+#  include <pthread.h>
+#  include <fstream>
+#  include <map>
+#  include <sstream>
+#  include <vector>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+
 DEAL_II_NAMESPACE_OPEN
 
 #ifdef DEAL_II_WITH_THREADS
@@ -132,8 +145,156 @@ unsigned int MultithreadInfo::n_threads() const
 }
 
 
+
+#  if defined(__linux__)
+
+namespace
+{
+  // return the cores the process may run on, in the order in which threads
+  // are bound to them
+  std::vector<unsigned int>
+  ordered_cores (const MultithreadInfo::ThreadAffinity affinity)
+  {
+    std::vector<unsigned int> cores;
+    cpu_set_t allowed;
+    CPU_ZERO (&allowed);
+    if (sched_getaffinity (0, sizeof(allowed), &allowed) != 0)
+      return cores;
+    for (unsigned int core=0; core<CPU_SETSIZE; ++core)
+      if (CPU_ISSET (core, &allowed))
+        cores.push_back (core);
+
+    if (affinity == MultithreadInfo::scatter_thread_affinity)
+      {
+        // group the cores by socket and take one core from each socket in
+        // turn. if the topology can not be read, all cores are considered
+        // to be on one socket
+        std::map<int, std::vector<unsigned int> > sockets;
+        for (unsigned int i=0; i<cores.size(); ++i)
+          {
+            std::ostringstream file_name;
+            file_name << "/sys/devices/system/cpu/cpu" << cores[i]
+                      << "/topology/physical_package_id";
+            std::ifstream file (file_name.str().c_str());
+            int socket = 0;
+            if (!(file >> socket))
+              socket = 0;
+            sockets[socket].push_back (cores[i]);
+          }
+
+        const unsigned int n_cores = cores.size();
+        cores.clear ();
+        for (unsigned int i=0; cores.size()<n_cores; ++i)
+          for (std::map<int, std::vector<unsigned int> >::const_iterator
+               socket = sockets.begin(); socket != sockets.end(); ++socket)
+            if (i < socket->second.size())
+              cores.push_back (socket->second[i]);
+      }
+
+    return cores;
+  }
+
+
+
+  void
+  bind_thread_to_core (const unsigned int core)
+  {
+    cpu_set_t core_set;
+    CPU_ZERO (&core_set);
+    CPU_SET (core, &core_set);
+    pthread_setaffinity_np (pthread_self(), sizeof(core_set), &core_set);
+  }
+
+
+
+  // an observer that binds every worker thread of the task scheduler to
+  // the next core of a list when the thread starts working. the thread
+  // that sets the affinity takes the first core
+  class AffinityObserver : public tbb::task_scheduler_observer
+  {
+  public:
+    AffinityObserver ()
+      :
+      next_core (0)
+    {}
+
+    void set_cores (const std::vector<unsigned int> &new_cores)
+    {
+      Threads::Mutex::ScopedLock lock (mutex);
+      cores = new_cores;
+      next_core = 0;
+    }
+
+    void bind_next_thread ()
+    {
+      unsigned int core = numbers::invalid_unsigned_int;
+      {
+        Threads::Mutex::ScopedLock lock (mutex);
+        if (cores.size() > 0)
+          core = cores[next_core++ % cores.size()];
+      }
+      if (core != numbers::invalid_unsigned_int)
+        bind_thread_to_core (core);
+    }
+
+    virtual void on_scheduler_entry (bool is_worker)
+    {
+      if (is_worker)
+        bind_next_thread ();
+    }
+
+  private:
+    Threads::Mutex            mutex;
+    std::vector<unsigned int> cores;
+    unsigned int              next_core;
+  };
+
+
+
+  // the observer is created on first use and never destroyed, since the
+  // task scheduler may already be shut down when static objects are
+  // destroyed at the end of the program
+  AffinityObserver &
+  affinity_observer ()
+  {
+    static AffinityObserver *observer = new AffinityObserver();
+    return *observer;
+  }
+}
+
+
+
+void MultithreadInfo::set_thread_affinity (const ThreadAffinity affinity)
+{
+  thread_affinity = affinity;
+  if (affinity == no_thread_affinity)
+    {
+      affinity_observer().observe (false);
+      return;
+    }
+
+  affinity_observer().set_cores (ordered_cores (affinity));
+  affinity_observer().bind_next_thread ();
+  affinity_observer().observe (true);
+}
+
+#  else
+
+void MultithreadInfo::set_thread_affinity (const ThreadAffinity affinity)
+{
+  thread_affinity = affinity;
+}
+
+#  endif
+
+
 #else                            // not in MT mode
 
+void MultithreadInfo::set_thread_affinity (const ThreadAffinity affinity)
+{
+  thread_affinity = affinity;
+}
+
 unsigned int MultithreadInfo::get_n_cpus()
 {
   return 1;
@@ -157,12 +318,29 @@ bool MultithreadInfo::is_running_single_threaded()
 }
 
 
+MultithreadInfo::ThreadAffinity
+MultithreadInfo::get_thread_affinity () const
+{
+  return thread_affinity;
+}
+
+
 MultithreadInfo::MultithreadInfo ()
   :
   n_cpus (get_n_cpus()),
   n_default_threads (n_cpus),
-  n_max_threads (numbers::invalid_unsigned_int)
-{}
+  n_max_threads (numbers::invalid_unsigned_int),
+  thread_affinity (no_thread_affinity)
+{
+  const char *penv = getenv ("DEAL_II_THREAD_AFFINITY");
+  if (penv != NULL)
+    {
+      if (std::strcmp (penv, "compact") == 0)
+        set_thread_affinity (compact_thread_affinity);
+      else if (std::strcmp (penv, "scatter") == 0)
+        set_thread_affinity (scatter_thread_affinity);
+    }
+}
 
 
 
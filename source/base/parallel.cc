@@ -15,6 +15,14 @@
 
 
 #include <deal.II/base/parallel.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/base/std_cxx11/shared_ptr.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
 
 
 DEAL_II_NAMESPACE_OPEN
@@ -56,5 +64,159 @@ namespace internal
 
 
 
+namespace parallel
+{
+  namespace internal
+  {
+    namespace
+    {
+      PartitioningMode
+      initial_partitioning_mode ()
+      {
+        const char *mode = std::getenv ("DEAL_II_PARTITIONING");
+        if ((mode != 0) && (std::strcmp (mode, "static") == 0))
+          return static_partitioning;
+        else
+          return dynamic_partitioning;
+      }
+    }
+
+    PartitioningMode partitioning_mode = initial_partitioning_mode ();
+
+
+
+    unsigned int
+    n_static_chunks (const std::size_t size,
+                     const std::size_t grainsize)
+    {
+      const std::size_t max_chunks = (grainsize > 0 ? size / grainsize : size);
+      return std::max (static_cast<std::size_t>(1),
+                       std::min (static_cast<std::size_t>(multithread_info.n_threads()),
+                                 max_chunks));
+    }
+
+
+
+#ifdef DEAL_II_WITH_THREADS
+    namespace
+    {
+      // an affinity partitioner that records on which thread the chunks of
+      // a static partition have been executed, together with a flag that
+      // states whether a loop is presently using it. the partitioner may
+      // not be used by two loops at the same time
+      struct AffinityRecord
+      {
+        AffinityRecord ()
+          :
+          in_use (false)
+        {}
+
+        tbb::affinity_partitioner partitioner;
+        bool                      in_use;
+      };
+
+
+
+      Threads::Mutex &
+      affinity_mutex ()
+      {
+        static Threads::Mutex mutex;
+        return mutex;
+      }
+
+
+
+      // return the record for the given number of chunks and mark it as
+      // used, or a null pointer if it is in use by another loop
+      AffinityRecord *
+      acquire_affinity_record (const unsigned int n_chunks)
+      {
+        static std::map<unsigned int, std_cxx11::shared_ptr<AffinityRecord> > records;
+
+        Threads::Mutex::ScopedLock lock (affinity_mutex());
+        std_cxx11::shared_ptr<AffinityRecord> &record = records[n_chunks];
+        if (record.get() == 0)
+          record.reset (new AffinityRecord());
+        if (record->in_use)
+          return 0;
+        record->in_use = true;
+        return record.get();
+      }
+
+
+
+      // release the record when the loop is done, also if it ends with an
+      // exception
+      struct AffinityRecordRelease
+      {
+        AffinityRecordRelease (AffinityRecord *record)
+          :
+          record (record)
+        {}
+
+        ~AffinityRecordRelease ()
+        {
+          Threads::Mutex::ScopedLock lock (affinity_mutex());
+          record->in_use = false;
+        }
+
+        AffinityRecord *record;
+      };
+
+
+
+      struct StaticChunkBody
+      {
+        StaticChunkBody (const std_cxx11::function<void (const unsigned int)> &f)
+          :
+          f (f)
+        {}
+
+        void operator() (const tbb::blocked_range<unsigned int> &range) const
+        {
+          for (unsigned int chunk=range.begin(); chunk<range.end(); ++chunk)
+            f (chunk);
+        }
+
+        const std_cxx11::function<void (const unsigned int)> &f;
+      };
+    }
+
+
+
+    void
+    run_static_chunks (const unsigned int                                    n_chunks,
+                       const std_cxx11::function<void (const unsigned int)> &f)
+    {
+      if (n_chunks == 1)
+        {
+          f (0);
+          return;
+        }
+
+      const tbb::blocked_range<unsigned int> chunks (0, n_chunks, 1);
+      AffinityRecord *record = acquire_affinity_record (n_chunks);
+      if (record != 0)
+        {
+          AffinityRecordRelease release (record);
+          tbb::parallel_for (chunks, StaticChunkBody (f), record->partitioner);
+        }
+      else
+        tbb::parallel_for (chunks, StaticChunkBody (f), tbb::simple_partitioner());
+    }
+#endif
+  }
+
+
+
+  void
+  set_partitioning_mode (const PartitioningMode mode)
+  {
+    internal::partitioning_mode = mode;
+  }
+}
+
+
+
 
 DEAL_II_NAMESPACE_CLOSE
@@ -21,6 +21,31 @@ namespace Utilities
 {
   namespace MPI
   {
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+    namespace
+    {
+      /**
+       * Deleter for the shared memory communicator of the partitioner. The
+       * communicator can only be freed while MPI is still active, which is
+       * not the case for partitioners that are destroyed after
+       * MPI_Finalize, e.g. in static objects.
+       */
+      struct FreeCommunicator
+      {
+        void operator() (MPI_Comm *comm) const
+        {
+          int finalized = 0;
+          MPI_Finalized (&finalized);
+          if (finalized == 0 && *comm != MPI_COMM_NULL)
+            MPI_Comm_free (comm);
+          delete comm;
+        }
+      };
+    }
+#endif
+
+
+
     Partitioner::Partitioner ()
       :
       global_size (0),
@@ -29,7 +54,8 @@ namespace Utilities
       n_import_indices_data (0),
       my_pid (0),
       n_procs (1),
-      communicator (MPI_COMM_SELF)
+      communicator (MPI_COMM_SELF),
+      shared_memory_ghost_exchange (false)
     {}
 
 
@@ -44,7 +70,8 @@ namespace Utilities
       n_import_indices_data (0),
       my_pid (0),
       n_procs (1),
-      communicator (MPI_COMM_SELF)
+      communicator (MPI_COMM_SELF),
+      shared_memory_ghost_exchange (false)
     {
       locally_owned_range_data.add_range (0, size);
       locally_owned_range_data.compress ();
@@ -62,7 +89,27 @@ namespace Utilities
       n_import_indices_data (0),
       my_pid (0),
       n_procs (1),
-      communicator (communicator_in)
+      communicator (communicator_in),
+      shared_memory_ghost_exchange (false)
+    {
+      set_owned_indices (locally_owned_indices);
+      set_ghost_indices (ghost_indices_in);
+    }
+
+
+
+    Partitioner::Partitioner (const IndexSet &locally_owned_indices,
+                              const IndexSet &ghost_indices_in,
+                              const MPI_Comm  communicator_in,
+                              const bool      shared_memory_ghost_exchange)
+      :
+      global_size (static_cast<types::global_dof_index>(locally_owned_indices.size())),
+      n_ghost_indices_data (0),
+      n_import_indices_data (0),
+      my_pid (0),
+      n_procs (1),
+      communicator (communicator_in),
+      shared_memory_ghost_exchange (shared_memory_ghost_exchange)
     {
       set_owned_indices (locally_owned_indices);
       set_ghost_indices (ghost_indices_in);
@@ -78,7 +125,8 @@ namespace Utilities
       n_import_indices_data (0),
       my_pid (0),
       n_procs (1),
-      communicator (communicator_in)
+      communicator (communicator_in),
+      shared_memory_ghost_exchange (false)
     {
       set_owned_indices (locally_owned_indices);
     }
@@ -221,83 +269,124 @@ namespace Utilities
             n_ghost_indices_data - ghost_targets_temp[n_ghost_targets-1].second;
           ghost_targets_data = ghost_targets_temp;
         }
-      // find the processes that want to import to me
+      // The ghost indices are sorted, so the ones that belong to one target
+      // typically come in few contiguous runs. Describe them as ranges
+      // [begin,end) to keep the messages of the setup and the import indices
+      // stored below short
+      std::vector<std::pair<types::global_dof_index,types::global_dof_index> > ghost_ranges;
+      std::vector<unsigned int> n_ghost_ranges (n_ghost_targets, 0);
+      {
+        unsigned int current_index_start = 0;
+        for (unsigned int i=0; i<n_ghost_targets; i++)
+          {
+            const unsigned int current_index_end =
+              current_index_start + ghost_targets_data[i].second;
+            for (unsigned int j=current_index_start; j<current_index_end; ++j)
+              if (j == current_index_start ||
+                  expanded_ghost_indices[j] != ghost_ranges.back().second)
+                {
+                  ghost_ranges.push_back (std::make_pair(expanded_ghost_indices[j],
+                                                         expanded_ghost_indices[j]+1));
+                  ++n_ghost_ranges[i];
+                }
+              else
+                ++ghost_ranges.back().second;
+            current_index_start = current_index_end;
+          }
+        AssertDimension (current_index_start, n_ghost_indices_data);
+      }
+
+      // find the processes that want to import to me, along with the number
+      // of indices and ranges they import
+      std::vector<unsigned int> n_import_ranges;
       {
-        std::vector<int> send_buffer (n_procs, 0);
-        std::vector<int> receive_buffer (n_procs, 0);
+        std::vector<int> send_buffer (2*n_procs, 0);
+        std::vector<int> receive_buffer (2*n_procs, 0);
         for (unsigned int i=0; i<n_ghost_targets; i++)
-          send_buffer[ghost_targets_data[i].first] = ghost_targets_data[i].second;
+          {
+            send_buffer[2*ghost_targets_data[i].first] = ghost_targets_data[i].second;
+            send_buffer[2*ghost_targets_data[i].first+1] = n_ghost_ranges[i];
+          }
 
-        MPI_Alltoall (&send_buffer[0], 1, MPI_INT, &receive_buffer[0], 1,
+        MPI_Alltoall (&send_buffer[0], 2, MPI_INT, &receive_buffer[0], 2,
                       MPI_INT, communicator);
 
         // allocate memory for import data
         std::vector<std::pair<unsigned int,types::global_dof_index> > import_targets_temp;
         n_import_indices_data = 0;
         for (unsigned int i=0; i<n_procs; i++)
-          if (receive_buffer[i] > 0)
+          if (receive_buffer[2*i] > 0)
             {
-              n_import_indices_data += receive_buffer[i];
+              n_import_indices_data += receive_buffer[2*i];
               import_targets_temp.push_back(std::pair<unsigned int,
-                                            types::global_dof_index> (i, receive_buffer[i]));
+                                            types::global_dof_index> (i, receive_buffer[2*i]));
+              n_import_ranges.push_back (receive_buffer[2*i+1]);
             }
         import_targets_data = import_targets_temp;
       }
 
-      // send and receive indices for import data. non-blocking receives and
-      // blocking sends
-      std::vector<types::global_dof_index> expanded_import_indices (n_import_indices_data);
+      // send and receive the ranges of the import indices. non-blocking
+      // receives and blocking sends
       {
-        unsigned int current_index_start = 0;
+        unsigned int n_total_import_ranges = 0;
+        for (unsigned int i=0; i<n_import_ranges.size(); i++)
+          n_total_import_ranges += n_import_ranges[i];
+        std::vector<std::pair<types::global_dof_index,types::global_dof_index> >
+        import_ranges (n_total_import_ranges);
+
+        unsigned int current_range_start = 0;
         std::vector<MPI_Request> import_requests (import_targets_data.size());
         for (unsigned int i=0; i<import_targets_data.size(); i++)
           {
-            MPI_Irecv (&expanded_import_indices[current_index_start],
-                       import_targets_data[i].second*sizeof(types::global_dof_index),
+            MPI_Irecv (n_import_ranges[i] > 0 ? &import_ranges[current_range_start] : 0,
+                       n_import_ranges[i]*2*sizeof(types::global_dof_index),
                        MPI_BYTE,
                        import_targets_data[i].first, import_targets_data[i].first,
                        communicator, &import_requests[i]);
-            current_index_start += import_targets_data[i].second;
+            current_range_start += n_import_ranges[i];
           }
-        AssertDimension (current_index_start, n_import_indices_data);
 
         // use blocking send
-        current_index_start = 0;
+        current_range_start = 0;
         for (unsigned int i=0; i<n_ghost_targets; i++)
           {
-            MPI_Send (&expanded_ghost_indices[current_index_start],
-                      ghost_targets_data[i].second*sizeof(types::global_dof_index),
+            MPI_Send (&ghost_ranges[current_range_start],
+                      n_ghost_ranges[i]*2*sizeof(types::global_dof_index),
                       MPI_BYTE, ghost_targets_data[i].first, my_pid,
                       communicator);
-            current_index_start += ghost_targets_data[i].second;
+            current_range_start += n_ghost_ranges[i];
           }
-        AssertDimension (current_index_start, n_ghost_indices_data);
+        AssertDimension (current_range_start, ghost_ranges.size());
 
-        MPI_Waitall (import_requests.size(), &import_requests[0],
-                     MPI_STATUSES_IGNORE);
+        if (import_requests.size() > 0)
+          MPI_Waitall (import_requests.size(), &import_requests[0],
+                       MPI_STATUSES_IGNORE);
 
-        // transform import indices to local index space and compress
-        // contiguous indices in form of ranges
+        // transform import ranges to local index space and merge contiguous
+        // ranges of subsequent targets
         {
-          types::global_dof_index last_index = numbers::invalid_dof_index-1;
           std::vector<std::pair<types::global_dof_index,types::global_dof_index> > compressed_import_indices;
-          for (unsigned int i=0; i<n_import_indices_data; i++)
+          types::global_dof_index n_received_indices = 0;
+          for (unsigned int i=0; i<n_total_import_ranges; i++)
             {
-              Assert (expanded_import_indices[i] >= local_range_data.first &&
-                      expanded_import_indices[i] < local_range_data.second,
-                      ExcIndexRange(expanded_import_indices[i], local_range_data.first,
+              Assert (import_ranges[i].first >= local_range_data.first &&
+                      import_ranges[i].second <= local_range_data.second &&
+                      import_ranges[i].first < import_ranges[i].second,
+                      ExcIndexRange(import_ranges[i].first, local_range_data.first,
                                     local_range_data.second));
-              types::global_dof_index new_index = (expanded_import_indices[i] -
-                                                   local_range_data.first);
-              if (new_index == last_index+1)
-                compressed_import_indices.back().second++;
+              const types::global_dof_index new_begin = (import_ranges[i].first -
+                                                         local_range_data.first);
+              const types::global_dof_index new_end = (import_ranges[i].second -
+                                                       local_range_data.first);
+              n_received_indices += new_end - new_begin;
+              if (compressed_import_indices.size() > 0 &&
+                  compressed_import_indices.back().second == new_begin)
+                compressed_import_indices.back().second = new_end;
               else
-                {
-                  compressed_import_indices.push_back
-                  (std::pair<types::global_dof_index,types::global_dof_index>(new_index,new_index+1));
-                }
-              last_index = new_index;
+                compressed_import_indices.push_back
+                (std::pair<types::global_dof_index,types::global_dof_index>(new_begin,new_end));
             }
+          AssertDimension (n_received_indices, n_import_indices_data);
           import_indices_data = compressed_import_indices;
 
           // sanity check
@@ -311,6 +400,107 @@ namespace Utilities
 #endif
         }
       }
+
+      if (shared_memory_ghost_exchange == true)
+        setup_shared_memory_ghost_exchange ();
+#endif
+    }
+
+
+
+    void
+    Partitioner::setup_shared_memory_ghost_exchange ()
+    {
+      shared_memory_communicator.reset ();
+      ghost_targets_shared_ranks.clear ();
+      ghost_targets_shared_offsets.clear ();
+      import_targets_shared_ranks.clear ();
+
+#ifdef DEAL_II_MPI_WITH_SHARED_MEMORY
+      if (n_procs < 2)
+        return;
+
+      // split the communicator into the processors that can create a shared
+      // memory window, i.e., the ones on the same node
+      MPI_Comm node_comm;
+      int ierr = MPI_Comm_split_type (communicator, MPI_COMM_TYPE_SHARED,
+                                      my_pid, MPI_INFO_NULL, &node_comm);
+      AssertThrow (ierr == MPI_SUCCESS, ExcInternalError());
+      shared_memory_communicator.reset (new MPI_Comm(node_comm),
+                                        FreeCommunicator());
+
+      // translate the ranks of the ghost and import targets into the node
+      // communicator. processors on other nodes get MPI_UNDEFINED
+      MPI_Group global_group, node_group;
+      MPI_Comm_group (communicator, &global_group);
+      MPI_Comm_group (node_comm, &node_group);
+      {
+        std::vector<int> global_ranks (ghost_targets_data.size());
+        std::vector<int> node_ranks (ghost_targets_data.size());
+        for (unsigned int i=0; i<ghost_targets_data.size(); ++i)
+          global_ranks[i] = ghost_targets_data[i].first;
+        if (global_ranks.size() > 0)
+          MPI_Group_translate_ranks (global_group, global_ranks.size(),
+                                     &global_ranks[0], node_group,
+                                     &node_ranks[0]);
+        ghost_targets_shared_ranks.resize (ghost_targets_data.size());
+        for (unsigned int i=0; i<ghost_targets_data.size(); ++i)
+          ghost_targets_shared_ranks[i] = (node_ranks[i] == MPI_UNDEFINED ?
+                                           numbers::invalid_unsigned_int :
+                                           node_ranks[i]);
+      }
+      {
+        std::vector<int> global_ranks (import_targets_data.size());
+        std::vector<int> node_ranks (import_targets_data.size());
+        for (unsigned int i=0; i<import_targets_data.size(); ++i)
+          global_ranks[i] = import_targets_data[i].first;
+        if (global_ranks.size() > 0)
+          MPI_Group_translate_ranks (global_group, global_ranks.size(),
+                                     &global_ranks[0], node_group,
+                                     &node_ranks[0]);
+        import_targets_shared_ranks.resize (import_targets_data.size());
+        for (unsigned int i=0; i<import_targets_data.size(); ++i)
+          import_targets_shared_ranks[i] = (node_ranks[i] == MPI_UNDEFINED ?
+                                            numbers::invalid_unsigned_int :
+                                            node_ranks[i]);
+      }
+      MPI_Group_free (&node_group);
+      MPI_Group_free (&global_group);
+
+      // the ghost values of an importing processor are stored contiguously
+      // in the import data of the owner, in the order of the import
+      // targets. tell each importer on the same node where its part starts
+      std::vector<types::global_dof_index> import_offsets (import_targets_data.size());
+      std::vector<MPI_Request> requests;
+      requests.reserve (import_targets_data.size()+ghost_targets_data.size());
+      {
+        types::global_dof_index offset = 0;
+        for (unsigned int i=0; i<import_targets_data.size(); ++i)
+          {
+            import_offsets[i] = offset;
+            offset += import_targets_data[i].second;
+            if (import_targets_shared_ranks[i] != numbers::invalid_unsigned_int)
+              {
+                requests.push_back (MPI_Request());
+                MPI_Isend (&import_offsets[i], sizeof(types::global_dof_index),
+                           MPI_BYTE, import_targets_data[i].first, my_pid,
+                           communicator, &requests.back());
+              }
+          }
+      }
+      ghost_targets_shared_offsets.resize (ghost_targets_data.size(),
+                                           numbers::invalid_dof_index);
+      for (unsigned int i=0; i<ghost_targets_data.size(); ++i)
+        if (ghost_targets_shared_ranks[i] != numbers::invalid_unsigned_int)
+          {
+            requests.push_back (MPI_Request());
+            MPI_Irecv (&ghost_targets_shared_offsets[i],
+                       sizeof(types::global_dof_index), MPI_BYTE,
+                       ghost_targets_data[i].first, ghost_targets_data[i].first,
+                       communicator, &requests.back());
+          }
+      if (requests.size() > 0)
+        MPI_Waitall (requests.size(), &requests[0], MPI_STATUSES_IGNORE);
 #endif
     }
 
@@ -326,6 +516,9 @@ namespace Utilities
       memory += MemoryConsumption::memory_consumption(import_targets_data);
       memory += MemoryConsumption::memory_consumption(import_indices_data);
       memory += MemoryConsumption::memory_consumption(ghost_indices_data);
+      memory += MemoryConsumption::memory_consumption(ghost_targets_shared_ranks);
+      memory += MemoryConsumption::memory_consumption(ghost_targets_shared_offsets);
+      memory += MemoryConsumption::memory_consumption(import_targets_shared_ranks);
       return memory;
     }
 
@@ -15,6 +15,7 @@
 
 #include <deal.II/base/timer.h>
 #include <deal.II/base/exceptions.h>
+#include <deal.II/base/memory_profiler.h>
 #include <deal.II/base/utilities.h>
 #include <sstream>
 #include <iostream>
@@ -275,6 +276,7 @@ TimerOutput::TimerOutput (std::ostream &stream,
 #ifdef DEAL_II_WITH_MPI
   , mpi_communicator (MPI_COMM_SELF)
 #endif
+  , creator_thread (Threads::this_thread_id())
 {}
 
 
@@ -290,6 +292,7 @@ TimerOutput::TimerOutput (ConditionalOStream &stream,
 #ifdef DEAL_II_WITH_MPI
   , mpi_communicator (MPI_COMM_SELF)
 #endif
+  , creator_thread (Threads::this_thread_id())
 {}
 
 
@@ -304,7 +307,8 @@ TimerOutput::TimerOutput (MPI_Comm      mpi_communicator,
   output_type (output_type),
   out_stream (stream, true),
   output_is_enabled (true),
-  mpi_communicator (mpi_communicator)
+  mpi_communicator (mpi_communicator),
+  creator_thread (Threads::this_thread_id())
 {}
 
 
@@ -318,16 +322,292 @@ TimerOutput::TimerOutput (MPI_Comm      mpi_communicator,
   output_type (output_type),
   out_stream (stream),
   output_is_enabled (true),
-  mpi_communicator (mpi_communicator)
+  mpi_communicator (mpi_communicator),
+  creator_thread (Threads::this_thread_id())
 {}
 
 #endif
 
 
+namespace
+{
+  // the current wall time and CPU times, used to time the sections of
+  // TimerOutput. the CPU time of the whole process is used for the summary,
+  // and that of the calling thread for the call tree where the operating
+  // system provides it
+  double wall_clock_now ()
+  {
+#if defined(HAVE_SYS_TIME_H) && defined(HAVE_SYS_RESOURCE_H)
+    struct timeval wall_timer;
+    gettimeofday(&wall_timer, NULL);
+    return wall_timer.tv_sec + 1.e-6 * wall_timer.tv_usec;
+#elif defined(DEAL_II_MSVC)
+    return windows::wall_clock();
+#else
+#  error Unsupported platform. Porting not finished.
+#endif
+  }
+
+
+
+  double cpu_clock_now ()
+  {
+#if defined(HAVE_SYS_TIME_H) && defined(HAVE_SYS_RESOURCE_H)
+    rusage usage;
+    getrusage (RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + 1.e-6 * usage.ru_utime.tv_usec;
+#elif defined(DEAL_II_MSVC)
+    return windows::cpu_clock();
+#else
+#  error Unsupported platform. Porting not finished.
+#endif
+  }
+
+
+
+  double thread_cpu_clock_now ()
+  {
+#if defined(HAVE_SYS_TIME_H) && defined(HAVE_SYS_RESOURCE_H) && defined(RUSAGE_THREAD)
+    rusage usage;
+    getrusage (RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + 1.e-6 * usage.ru_utime.tv_usec;
+#else
+    return cpu_clock_now();
+#endif
+  }
+
+
+
+  // the character separating the names of the sections in the path of a
+  // node of the call tree. it sorts before all printable characters, so
+  // that sorting the paths yields a depth-first ordering of the tree in
+  // which every node is followed by its children
+  const char path_separator = '\001';
+
+
+
+  // the values of a node of the call tree: the number of calls and of
+  // threads that entered it, and the CPU and wall times. if requested,
+  // these are reduced over all MPI processes
+  struct CallTreeRow
+  {
+    std::string                name;
+    unsigned int               depth;
+    double                     n_calls;
+    double                     n_threads;
+    Utilities::MPI::MinMaxAvg  cpu_time;
+    Utilities::MPI::MinMaxAvg  wall_time;
+  };
+
+
+
+  Utilities::MPI::MinMaxAvg
+  compute_min_max_avg (const double    value,
+                       const MPI_Comm &mpi_communicator,
+                       const bool      reduce)
+  {
+    if (reduce)
+      return Utilities::MPI::min_max_avg (value, mpi_communicator);
+
+    Utilities::MPI::MinMaxAvg result;
+    result.sum = result.min = result.max = result.avg = value;
+    result.min_index = result.max_index = 0;
+    return result;
+  }
+
+
+
+  // convert the accumulated call tree, indexed by the paths of the nodes,
+  // into a list of rows in depth-first order. if the values are reduced
+  // over the processes of the communicator, first make sure that all
+  // processes know about the nodes of all other processes, so that all of
+  // them call the collective reduction functions for the same nodes
+  std::vector<CallTreeRow>
+  reduce_call_tree (std::map<std::string, std::vector<double> > &tree,
+                    const MPI_Comm                              &mpi_communicator,
+                    const bool                                   reduce)
+  {
+#ifdef DEAL_II_WITH_MPI
+    if (reduce)
+      {
+        std::string paths;
+        for (std::map<std::string, std::vector<double> >::const_iterator
+             p = tree.begin(); p != tree.end(); ++p)
+          {
+            paths += p->first;
+            paths += '\0';
+          }
+
+        const unsigned int n_procs = Utilities::MPI::n_mpi_processes (mpi_communicator);
+        int my_size = paths.size();
+        std::vector<int> sizes (n_procs), offsets (n_procs+1, 0);
+        MPI_Allgather (&my_size, 1, MPI_INT, &sizes[0], 1, MPI_INT,
+                       mpi_communicator);
+        for (unsigned int p=0; p<n_procs; ++p)
+          offsets[p+1] = offsets[p] + sizes[p];
+
+        std::vector<char> all_paths (std::max (offsets[n_procs], 1));
+        MPI_Allgatherv (const_cast<char *>(paths.c_str()), my_size, MPI_CHAR,
+                        &all_paths[0], &sizes[0], &offsets[0], MPI_CHAR,
+                        mpi_communicator);
+        for (int i=0; i<offsets[n_procs]; )
+          {
+            const std::string path (&all_paths[i]);
+            i += path.size() + 1;
+            if (tree.find (path) == tree.end())
+              tree[path] = std::vector<double> (4, 0.);
+          }
+      }
+#endif
+
+    std::vector<CallTreeRow> rows;
+    for (std::map<std::string, std::vector<double> >::const_iterator
+         p = tree.begin(); p != tree.end(); ++p)
+      {
+        CallTreeRow row;
+        const std::string::size_type last_separator = p->first.rfind (path_separator);
+        row.name = (last_separator == std::string::npos
+                    ?
+                    p->first
+                    :
+                    p->first.substr (last_separator+1));
+        row.depth = std::count (p->first.begin(), p->first.end(), path_separator);
+        row.n_calls = (reduce
+                       ?
+                       Utilities::MPI::max (p->second[0], mpi_communicator)
+                       :
+                       p->second[0]);
+        row.n_threads = (reduce
+                         ?
+                         Utilities::MPI::max (p->second[1], mpi_communicator)
+                         :
+                         p->second[1]);
+        row.cpu_time = compute_min_max_avg (p->second[2], mpi_communicator, reduce);
+        row.wall_time = compute_min_max_avg (p->second[3], mpi_communicator, reduce);
+        rows.push_back (row);
+      }
+    return rows;
+  }
+
+
+
+  // the times of a section added up over all nodes of the call tree that
+  // belong to it, as shown by TimerOutput::print_summary()
+  struct SectionSummary
+  {
+    SectionSummary ()
+      :
+      total_cpu_time (0.),
+      total_wall_time (0.),
+      n_calls (0)
+    {}
+
+    double total_cpu_time;
+    double total_wall_time;
+    unsigned int n_calls;
+  };
+
+
+
+  // escape the characters of a string that have a special meaning in JSON
+  std::string
+  json_string (const std::string &s)
+  {
+    std::ostringstream out;
+    out << '"';
+    for (unsigned int i=0; i<s.size(); ++i)
+      if (s[i] == '"' || s[i] == '\\')
+        out << '\\' << s[i];
+      else if (static_cast<unsigned char>(s[i]) < 0x20)
+        out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+            << static_cast<unsigned int>(s[i]) << std::dec << std::setfill(' ');
+      else
+        out << s[i];
+    out << '"';
+    return out.str();
+  }
+
+
+
+  std::string
+  json_min_max_avg (const Utilities::MPI::MinMaxAvg &data)
+  {
+    std::ostringstream out;
+    out << "{ \"min\": " << data.min
+        << ", \"avg\": " << data.avg
+        << ", \"max\": " << data.max << " }";
+    return out.str();
+  }
+
+
+
+  // write the nodes of the given depth starting at the given row, and
+  // recursively their children, as a JSON array. on return, row points to
+  // the first row after the subtree
+  void
+  write_json_nodes (std::ostream                   &out,
+                    const std::vector<CallTreeRow> &rows,
+                    unsigned int                   &row,
+                    const unsigned int              depth,
+                    const std::string              &indent)
+  {
+    out << '[';
+    bool first = true;
+    while (row < rows.size() && rows[row].depth == depth)
+      {
+        const CallTreeRow &node = rows[row];
+        ++row;
+
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << indent << "  {\n"
+            << indent << "    \"name\": " << json_string (node.name) << ",\n"
+            << indent << "    \"calls\": " << node.n_calls << ",\n"
+            << indent << "    \"threads\": " << node.n_threads << ",\n"
+            << indent << "    \"cpu time\": " << json_min_max_avg (node.cpu_time) << ",\n"
+            << indent << "    \"wall time\": " << json_min_max_avg (node.wall_time) << ",\n"
+            << indent << "    \"children\": ";
+        write_json_nodes (out, rows, row, depth+1, indent + "    ");
+        out << '\n' << indent << "  }";
+      }
+    if (!first)
+      out << '\n' << indent;
+    out << ']';
+  }
+}
+
+
+
+TimerOutput::TreeNode::TreeNode (const unsigned int section)
+  :
+  section (section),
+  n_calls (0),
+  cpu_time (0.),
+  wall_time (0.),
+  summary_cpu_time (0.),
+  summary_wall_time (0.)
+{}
+
+
+
+TimerOutput::ThreadData::ThreadData ()
+  :
+  nodes (1, TreeNode (numbers::invalid_unsigned_int)),
+  registered (false)
+{}
+
+
+
 TimerOutput::~TimerOutput()
 {
-  while (active_sections.size() > 0)
-    leave_subsection();
+  const ThreadData *const this_thread = &thread_data.get();
+  for (unsigned int t=0; t<threads.size(); ++t)
+    {
+      Threads::Mutex::ScopedLock lock (threads[t]->mutex);
+      while (threads[t]->active_sections.size() > 0)
+        leave_active_section (*threads[t], threads[t]->active_sections.size()-1,
+                              threads[t] == this_thread);
+    }
 
   if ( (output_frequency == summary || output_frequency == every_call_and_summary)
        && output_is_enabled == true)
@@ -336,84 +616,226 @@ TimerOutput::~TimerOutput()
 
 
 
+unsigned int
+TimerOutput::register_section (const std::string &section_name)
+{
+  Assert (section_name.empty() == false,
+          ExcMessage ("Section string is empty."));
+
+  Threads::Mutex::ScopedLock lock (mutex);
+
+  const std::map<std::string, unsigned int>::const_iterator
+  p = section_handles.find (section_name);
+  if (p != section_handles.end())
+    return p->second;
+
+  section_handles[section_name] = section_names.size();
+  section_names.push_back (section_name);
+  return section_names.size()-1;
+}
+
+
+
+TimerOutput::ThreadData &
+TimerOutput::get_thread_data ()
+{
+  ThreadData &data = thread_data.get();
+  if (data.registered == false)
+    {
+      Threads::Mutex::ScopedLock lock (mutex);
+      threads.push_back (&data);
+      data.registered = true;
+    }
+  return data;
+}
+
+
+
 void
 TimerOutput::enter_subsection (const std::string &section_name)
 {
-  Threads::Mutex::ScopedLock lock (mutex);
+  enter_subsection (register_section (section_name));
+}
 
-  Assert (section_name.empty() == false,
-          ExcMessage ("Section string is empty."));
 
-  Assert (std::find (active_sections.begin(), active_sections.end(),
-                     section_name) == active_sections.end(),
-          ExcMessage (std::string("Cannot enter the already active section <")
-                      + section_name + ">."));
 
-  if (sections.find (section_name) == sections.end())
+void
+TimerOutput::enter_subsection (const unsigned int section)
+{
+  ThreadData &data = get_thread_data();
+  Threads::Mutex::ScopedLock thread_lock (data.mutex);
+
+#ifdef DEBUG
+  for (unsigned int i=0; i<data.active_sections.size(); ++i)
+    if (data.nodes[data.active_sections[i].node].section == section)
+      {
+        // section_names may be written by other threads at the same time,
+        // so only read it under the lock
+        Threads::Mutex::ScopedLock lock (mutex);
+        Assert (false,
+                ExcMessage (std::string("Cannot enter the already active section <")
+                            + section_names[section] + ">."));
+      }
+#endif
+
+  // find the node of this section below the innermost active section, or
+  // create it if this is the first time the section is entered there
+  const unsigned int parent = (data.active_sections.empty()
+                               ?
+                               0
+                               :
+                               data.active_sections.back().node);
+  unsigned int node = numbers::invalid_unsigned_int;
+  for (unsigned int c=0; c<data.nodes[parent].children.size(); ++c)
+    if (data.nodes[parent].children[c].first == section)
+      {
+        node = data.nodes[parent].children[c].second;
+        break;
+      }
+  if (node == numbers::invalid_unsigned_int)
     {
+      node = data.nodes.size();
+      data.nodes.push_back (TreeNode (section));
+      data.nodes[parent].children.push_back (std::make_pair (section, node));
+    }
+  ++data.nodes[node].n_calls;
+
 #ifdef DEAL_II_WITH_MPI
-      if (mpi_communicator != MPI_COMM_SELF)
-        {
-          // create a new timer for this section. the second argument
-          // will ensure that we have an MPI barrier before starting
-          // and stopping a timer, and this ensures that we get the
-          // maximum run time for this section over all processors
-          sections[section_name].timer = Timer(mpi_communicator, true);
-        }
+  // as in the Timer class, place a barrier before starting the time for a
+  // section, so that we get the maximum run time for this section over all
+  // processors. worker threads enter sections independently of each other
+  // and of the other processes, so they cannot take part in collective
+  // operations
+  if (mpi_communicator != MPI_COMM_SELF &&
+      Utilities::System::job_supports_mpi() &&
+      Threads::this_thread_id() == creator_thread)
+    MPI_Barrier (mpi_communicator);
 #endif
 
+  ActiveSection active_section;
+  active_section.node = node;
+  active_section.record_counters = HardwareCounters::is_enabled();
+  if (active_section.record_counters)
+    active_section.counters_start = HardwareCounters::read();
+  active_section.record_memory = MemoryProfiler::is_enabled();
+  if (active_section.record_memory)
+    active_section.memory_start = MemoryProfiler::read();
+  active_section.cpu_start = cpu_clock_now();
+  active_section.thread_cpu_start = thread_cpu_clock_now();
+  active_section.wall_start = wall_clock_now();
+  data.active_sections.push_back (active_section);
+}
 
-      sections[section_name].total_cpu_time = 0;
-      sections[section_name].total_wall_time = 0;
-      sections[section_name].n_calls = 0;
+
+
+void
+TimerOutput::leave_subsection (const std::string &section_name)
+{
+  ThreadData &data = get_thread_data();
+
+  // if no string is given, exit the last
+  // active section.
+  if (section_name == "")
+    {
+      Threads::Mutex::ScopedLock thread_lock (data.mutex);
+      Assert (!data.active_sections.empty(),
+              ExcMessage("Cannot exit any section because none has been entered!"));
+      leave_active_section (data, data.active_sections.size()-1, true);
+      return;
     }
 
-  sections[section_name].timer.reset();
-  sections[section_name].timer.start();
-  sections[section_name].n_calls++;
+  unsigned int section;
+  std::vector<ThreadData *> all_threads;
+  {
+    Threads::Mutex::ScopedLock lock (mutex);
+    Assert (section_handles.find (section_name) != section_handles.end(),
+            ExcMessage ("Cannot delete a section that was never created."));
+    section = section_handles[section_name];
+    all_threads = threads;
+  }
 
-  active_sections.push_back (section_name);
+  // look for the section on the present thread first, then on all others
+  // since it may have been entered on another thread
+  for (unsigned int t=0; t<=all_threads.size(); ++t)
+    {
+      ThreadData &thread = (t == 0 ? data : *all_threads[t-1]);
+      if (t > 0 && &thread == &data)
+        continue;
+
+      Threads::Mutex::ScopedLock thread_lock (thread.mutex);
+      for (unsigned int i=thread.active_sections.size(); i>0; --i)
+        if (thread.nodes[thread.active_sections[i-1].node].section == section)
+          {
+            leave_active_section (thread, i-1, t == 0);
+            return;
+          }
+    }
+
+  Assert (false,
+          ExcMessage ("Cannot delete a section that has not been entered."));
 }
 
 
 
 void
-TimerOutput::leave_subsection (const std::string &section_name)
+TimerOutput::leave_active_section (ThreadData        &data,
+                                   const unsigned int position,
+                                   const bool         same_thread)
 {
-  Assert (!active_sections.empty(),
-          ExcMessage("Cannot exit any section because none has been entered!"));
-
-  Threads::Mutex::ScopedLock lock (mutex);
+  const double cpu_time = cpu_clock_now() - data.active_sections[position].cpu_start;
+  const double wall_time = wall_clock_now() - data.active_sections[position].wall_start;
+
+  // the CPU time of another thread is not available here, so use the one
+  // of the process if the section was entered on another thread
+  const double thread_cpu_time = (same_thread
+                                  ?
+                                  thread_cpu_clock_now()
+                                  - data.active_sections[position].thread_cpu_start
+                                  :
+                                  cpu_time);
+
+  const ActiveSection &active_section = data.active_sections[position];
+  if (active_section.record_counters || active_section.record_memory)
+    {
+      HardwareCounters::Sample counters_end;
+      if (active_section.record_counters)
+        counters_end = HardwareCounters::read();
+      std::string name;
+      {
+        Threads::Mutex::ScopedLock lock (mutex);
+        name = section_names[data.nodes[active_section.node].section];
+      }
+      if (active_section.record_counters)
+        HardwareCounters::add_sample (name, active_section.counters_start,
+                                      counters_end);
+      if (active_section.record_memory)
+        MemoryProfiler::add_sample (name, active_section.memory_start,
+                                    MemoryProfiler::read());
+    }
 
-  if (section_name != "")
+  // on MPI systems with synchronized timing, report the sum of the CPU
+  // times and the maximum of the wall times over all processes in the
+  // summary. as for the barrier in enter_subsection(), this is only done
+  // on the thread that created this object, other threads report the
+  // times of the present process
+  double summary_cpu_time = cpu_time;
+  double summary_wall_time = wall_time;
+#ifdef DEAL_II_WITH_MPI
+  if (mpi_communicator != MPI_COMM_SELF &&
+      Utilities::System::job_supports_mpi() &&
+      same_thread &&
+      Threads::this_thread_id() == creator_thread)
     {
-      Assert (sections.find (section_name) != sections.end(),
-              ExcMessage ("Cannot delete a section that was never created."));
-      Assert (std::find (active_sections.begin(), active_sections.end(),
-                         section_name) != active_sections.end(),
-              ExcMessage ("Cannot delete a section that has not been entered."));
+      summary_cpu_time = Utilities::MPI::sum (cpu_time, mpi_communicator);
+      summary_wall_time = Utilities::MPI::max (wall_time, mpi_communicator);
     }
+#endif
 
-  // if no string is given, exit the last
-  // active section.
-  const std::string actual_section_name = (section_name == "" ?
-                                           active_sections.back () :
-                                           section_name);
-
-  sections[actual_section_name].timer.stop();
-  sections[actual_section_name].total_wall_time
-  += sections[actual_section_name].timer.wall_time();
-
-  // get cpu time. on MPI systems, add the local contributions. we
-  // could do that also in the Timer class itself, but we didn't
-  // initialize the Timers here according to that
-  double cpu_time = sections[actual_section_name].timer();
-  sections[actual_section_name].total_cpu_time
-  += (Utilities::System::job_supports_mpi()
-      ?
-      Utilities::MPI::sum (cpu_time, mpi_communicator)
-      :
-      cpu_time);
+  TreeNode &node = data.nodes[data.active_sections[position].node];
+  node.cpu_time += thread_cpu_time;
+  node.wall_time += wall_time;
+  node.summary_cpu_time += summary_cpu_time;
+  node.summary_wall_time += summary_wall_time;
 
   // in case we have to print out something, do that here...
   if ((output_frequency == every_call || output_frequency == every_call_and_summary)
@@ -423,7 +845,7 @@ TimerOutput::leave_subsection (const std::string &section_name)
       std::ostringstream cpu;
       cpu << cpu_time << "s";
       std::ostringstream wall;
-      wall << sections[actual_section_name].timer.wall_time() << "s";
+      wall << summary_wall_time << "s";
       if (output_type == cpu_times)
         output_time = ", CPU time: " + cpu.str();
       else if (output_type == wall_times)
@@ -431,14 +853,70 @@ TimerOutput::leave_subsection (const std::string &section_name)
       else
         output_time = ", CPU/wall time: " + cpu.str() + " / " + wall.str() + ".";
 
-      out_stream << actual_section_name << output_time
+      Threads::Mutex::ScopedLock lock (mutex);
+      out_stream << section_names[node.section] << output_time
                  << std::endl;
     }
 
-  // delete the index from the list of
+  // delete the section from the list of
   // active ones
-  active_sections.erase (std::find (active_sections.begin(), active_sections.end(),
-                                    actual_section_name));
+  data.active_sections.erase (data.active_sections.begin() + position);
+}
+
+
+
+std::map<std::string, std::vector<double> >
+TimerOutput::collect_call_tree () const
+{
+  std::map<std::string, std::vector<double> > tree;
+
+  std::vector<ThreadData *> all_threads;
+  std::vector<std::string>  names;
+  {
+    Threads::Mutex::ScopedLock lock (mutex);
+    all_threads = threads;
+    names = section_names;
+  }
+
+  for (unsigned int t=0; t<all_threads.size(); ++t)
+    {
+      Threads::Mutex::ScopedLock thread_lock (all_threads[t]->mutex);
+
+      // walk the tree of this thread, keeping track of the path of each
+      // node
+      std::vector<std::pair<unsigned int, std::string> >
+      stack (1, std::make_pair (0U, std::string()));
+      while (stack.empty() == false)
+        {
+          const std::pair<unsigned int, std::string> parent = stack.back();
+          stack.pop_back();
+
+          const TreeNode &parent_node = all_threads[t]->nodes[parent.first];
+          for (unsigned int c=0; c<parent_node.children.size(); ++c)
+            {
+              const TreeNode &node = all_threads[t]->nodes[parent_node.children[c].second];
+              const std::string path = (parent.second.empty()
+                                        ?
+                                        names[node.section]
+                                        :
+                                        parent.second + path_separator
+                                        + names[node.section]);
+
+              std::vector<double> &values = tree[path];
+              if (values.empty())
+                values.resize (4, 0.);
+              values[0] += node.n_calls;
+              values[1] += 1;
+              values[2] += node.cpu_time;
+              values[3] += node.wall_time;
+
+              stack.push_back (std::make_pair (parent_node.children[c].second,
+                                               path));
+            }
+        }
+    }
+
+  return tree;
 }
 
 
@@ -454,6 +932,32 @@ TimerOutput::print_summary () const
   const std::streamsize    old_precision = out_stream.get_stream().precision ();
   const std::streamsize    old_width     = out_stream.get_stream().width ();
 
+  // add up the times of all nodes of the call trees of all threads that
+  // belong to the same section
+  std::map<std::string, SectionSummary> sections;
+  {
+    std::vector<ThreadData *> all_threads;
+    std::vector<std::string>  names;
+    {
+      Threads::Mutex::ScopedLock lock (mutex);
+      all_threads = threads;
+      names = section_names;
+    }
+
+    for (unsigned int t=0; t<all_threads.size(); ++t)
+      {
+        Threads::Mutex::ScopedLock thread_lock (all_threads[t]->mutex);
+        for (unsigned int n=1; n<all_threads[t]->nodes.size(); ++n)
+          {
+            const TreeNode &node = all_threads[t]->nodes[n];
+            SectionSummary &section = sections[names[node.section]];
+            section.total_cpu_time += node.summary_cpu_time;
+            section.total_wall_time += node.summary_wall_time;
+            section.n_calls += node.n_calls;
+          }
+      }
+  }
+
   // in case we want to write CPU times
   if (output_type != wall_times)
     {
@@ -470,7 +974,7 @@ TimerOutput::print_summary () const
       // generated a lot of overhead in this
       // function.
       double check_time = 0.;
-      for (std::map<std::string, Section>::const_iterator
+      for (std::map<std::string, SectionSummary>::const_iterator
            i = sections.begin(); i!=sections.end(); ++i)
         check_time += i->second.total_cpu_time;
 
@@ -492,7 +996,7 @@ TimerOutput::print_summary () const
       out_stream << "  CPU time "  << " | % of total |\n";
       out_stream << "+---------------------------------+-----------+------------"
                  << "+------------+";
-      for (std::map<std::string, Section>::const_iterator
+      for (std::map<std::string, SectionSummary>::const_iterator
            i = sections.begin(); i!=sections.end(); ++i)
         {
           std::string name_out = i->first;
@@ -549,7 +1053,7 @@ TimerOutput::print_summary () const
       out_stream << "  wall time | % of total |\n";
       out_stream << "+---------------------------------+-----------+------------"
                  << "+------------+";
-      for (std::map<std::string, Section>::const_iterator
+      for (std::map<std::string, SectionSummary>::const_iterator
            i = sections.begin(); i!=sections.end(); ++i)
         {
           std::string name_out = i->first;
@@ -603,11 +1107,127 @@ TimerOutput::enable_output ()
 }
 
 void
-TimerOutput::reset ()
+TimerOutput::print_tree () const
 {
+  bool reduce = false;
+#ifdef DEAL_II_WITH_MPI
+  reduce = (mpi_communicator != MPI_COMM_SELF &&
+            Utilities::System::job_supports_mpi());
+#endif
+
+  std::map<std::string, std::vector<double> > tree = collect_call_tree();
+  const std::vector<CallTreeRow> rows
+    = reduce_call_tree (tree, mpi_communicator, reduce);
+
+  // show CPU times if only these were requested, and wall times otherwise
+  const bool show_cpu_times = (output_type == cpu_times);
+  const double total_time
+    = compute_min_max_avg (show_cpu_times ? timer_all() : timer_all.wall_time(),
+                           mpi_communicator, reduce).avg;
+
+  const std::istream::fmtflags old_flags = out_stream.get_stream().flags();
+  const std::streamsize    old_precision = out_stream.get_stream().precision ();
+  const std::streamsize    old_width     = out_stream.get_stream().width ();
+
+  const std::string separator_line = "+" + std::string(45, '-')
+                                     + "+" + std::string(11, '-')
+                                     + "+" + std::string(12, '-')
+                                     + "+" + std::string(12, '-')
+                                     + "+" + std::string(12, '-')
+                                     + "+" + std::string(12, '-') + "+";
+  std::string header = "Section";
+  header.resize (43, ' ');
+
   Threads::Mutex::ScopedLock lock (mutex);
-  sections.clear();
-  active_sections.clear();
+  out_stream << "\n\n" << separator_line << "\n"
+             << "| " << header << " | no. calls |" << std::right
+             << std::setw(11) << (show_cpu_times ? "min CPU" : "min wall") << " |"
+             << std::setw(11) << (show_cpu_times ? "avg CPU" : "avg wall") << " |"
+             << std::setw(11) << (show_cpu_times ? "max CPU" : "max wall") << " |"
+             << " % of total |\n"
+             << separator_line;
+  for (unsigned int r=0; r<rows.size(); ++r)
+    {
+      const Utilities::MPI::MinMaxAvg &time = (show_cpu_times
+                                               ?
+                                               rows[r].cpu_time
+                                               :
+                                               rows[r].wall_time);
+      std::string name_out = std::string (2*rows[r].depth, ' ') + rows[r].name;
+      name_out.resize (43, ' ');
+
+      double percentage = time.avg / total_time * 100;
+      if (!numbers::is_finite(percentage))
+        percentage = 0.0;
+
+      out_stream << std::endl
+                 << "| " << name_out << " |"
+                 << std::setw(10) << rows[r].n_calls << " |"
+                 << std::setprecision(3)
+                 << std::setw(10) << time.min << "s |"
+                 << std::setw(10) << time.avg << "s |"
+                 << std::setw(10) << time.max << "s |"
+                 << std::setprecision(2)
+                 << std::setw(10) << percentage << "% |";
+    }
+  out_stream << std::endl << separator_line << "\n" << std::endl;
+
+  out_stream.get_stream().precision (old_precision);
+  out_stream.get_stream().width (old_width);
+  out_stream.get_stream().flags (old_flags);
+}
+
+
+
+void
+TimerOutput::write_json (std::ostream &stream) const
+{
+  bool reduce = false;
+  bool write = true;
+#ifdef DEAL_II_WITH_MPI
+  reduce = (mpi_communicator != MPI_COMM_SELF &&
+            Utilities::System::job_supports_mpi());
+  if (reduce)
+    write = (Utilities::MPI::this_mpi_process (mpi_communicator) == 0);
+#endif
+
+  std::map<std::string, std::vector<double> > tree = collect_call_tree();
+  const std::vector<CallTreeRow> rows
+    = reduce_call_tree (tree, mpi_communicator, reduce);
+  const Utilities::MPI::MinMaxAvg total_cpu_time
+    = compute_min_max_avg (timer_all(), mpi_communicator, reduce);
+  const Utilities::MPI::MinMaxAvg total_wall_time
+    = compute_min_max_avg (timer_all.wall_time(), mpi_communicator, reduce);
+
+  if (write == false)
+    return;
+
+  stream << "{\n"
+         << "  \"total cpu time\": " << json_min_max_avg (total_cpu_time) << ",\n"
+         << "  \"total wall time\": " << json_min_max_avg (total_wall_time) << ",\n"
+         << "  \"sections\": ";
+  unsigned int row = 0;
+  write_json_nodes (stream, rows, row, 0, "  ");
+  stream << "\n}" << std::endl;
+}
+
+
+
+void
+TimerOutput::reset ()
+{
+  std::vector<ThreadData *> all_threads;
+  {
+    Threads::Mutex::ScopedLock lock (mutex);
+    all_threads = threads;
+  }
+
+  for (unsigned int t=0; t<all_threads.size(); ++t)
+    {
+      Threads::Mutex::ScopedLock thread_lock (all_threads[t]->mutex);
+      all_threads[t]->nodes.assign (1, TreeNode (numbers::invalid_unsigned_int));
+      all_threads[t]->active_sections.clear();
+    }
   timer_all.restart();
 }
 
@@ -44,9 +44,11 @@ namespace parallel
   {
 
     template<int dim, typename VECTOR, class DH>
-    SolutionTransfer<dim, VECTOR, DH>::SolutionTransfer(const DH &dof)
+    SolutionTransfer<dim, VECTOR, DH>::SolutionTransfer(const DH   &dof,
+                                                        const bool  store_in_single_precision)
       :
-      dof_handler(&dof, typeid(*this).name())
+      dof_handler(&dof, typeid(*this).name()),
+      store_in_single_precision(store_in_single_precision)
     {}
 
 
@@ -201,7 +203,8 @@ namespace parallel
     SolutionTransfer<dim, VECTOR, DH>::
     get_data_size() const
     {
-      return sizeof(double)* DoFTools::max_dofs_per_cell(*dof_handler);
+      return (store_in_single_precision ? sizeof(float) : sizeof(double)) *
+             DoFTools::max_dofs_per_cell(*dof_handler);
     }
 
 
@@ -209,48 +212,128 @@ namespace parallel
     void
     SolutionTransfer<dim, VECTOR, DH>::
     pack_callback(const typename Triangulation<dim,dim>::cell_iterator &cell_,
-                  const typename Triangulation<dim,dim>::CellStatus /*status*/,
+                  const typename Triangulation<dim,dim>::CellStatus status,
                   void *data)
     {
-      double *data_store = reinterpret_cast<double *>(data);
-
       typename DH::cell_iterator cell(*cell_, dof_handler);
 
+      if (store_in_single_precision)
+        pack_values<float> (cell, status, data);
+      else
+        pack_values<double> (cell, status, data);
+    }
+
+
+
+    template<int dim, typename VECTOR, class DH>
+    template <typename Number>
+    void
+    SolutionTransfer<dim, VECTOR, DH>::
+    pack_values(const typename DH::cell_iterator &cell,
+                const typename Triangulation<dim,dim>::CellStatus status,
+                void *data) const
+    {
+      char *data_store = reinterpret_cast<char *>(data);
+
       const unsigned int dofs_per_cell=cell->get_fe().dofs_per_cell;
-      ::dealii::Vector<double> dofvalues(dofs_per_cell);
-      for (typename std::vector<const VECTOR *>::iterator it=input_vectors.begin();
-           it !=input_vectors.end();
-           ++it)
+      std::vector<Number> values(dofs_per_cell);
+
+      // the children of a cell that is coarsened hold the values, so they
+      // need to be interpolated for each vector. otherwise, the cell is
+      // active and we can look up the dof indices once for all vectors
+      if (status == parallel::distributed::Triangulation<dim>::CELL_COARSEN)
+        {
+          ::dealii::Vector<double> dofvalues(dofs_per_cell);
+          for (typename std::vector<const VECTOR *>::const_iterator it=input_vectors.begin();
+               it !=input_vectors.end();
+               ++it)
+            {
+              cell->get_interpolated_dof_values(*(*it), dofvalues);
+              std::copy (dofvalues.begin(), dofvalues.end(), values.begin());
+              std::memcpy(data_store, &values[0], sizeof(Number)*dofs_per_cell);
+              data_store += sizeof(Number)*dofs_per_cell;
+            }
+        }
+      else
         {
-          cell->get_interpolated_dof_values(*(*it), dofvalues);
-          std::memcpy(data_store, &dofvalues(0), sizeof(double)*dofs_per_cell);
-          data_store += dofs_per_cell;
+          std::vector<types::global_dof_index> dof_indices(dofs_per_cell);
+          cell->get_dof_indices(dof_indices);
+          for (typename std::vector<const VECTOR *>::const_iterator it=input_vectors.begin();
+               it !=input_vectors.end();
+               ++it)
+            {
+              (*it)->extract_subvector_to(dof_indices.begin(), dof_indices.end(),
+                                          values.begin());
+              std::memcpy(data_store, &values[0], sizeof(Number)*dofs_per_cell);
+              data_store += sizeof(Number)*dofs_per_cell;
+            }
         }
     }
 
 
+
     template<int dim, typename VECTOR, class DH>
     void
     SolutionTransfer<dim, VECTOR, DH>::
     unpack_callback(const typename Triangulation<dim,dim>::cell_iterator &cell_,
-                    const typename Triangulation<dim,dim>::CellStatus /*status*/,
+                    const typename Triangulation<dim,dim>::CellStatus status,
                     const void *data,
                     std::vector<VECTOR *> &all_out)
     {
       typename DH::cell_iterator
       cell(*cell_, dof_handler);
 
+      if (store_in_single_precision)
+        unpack_values<float> (cell, status, data, all_out);
+      else
+        unpack_values<double> (cell, status, data, all_out);
+    }
+
+
+
+    template<int dim, typename VECTOR, class DH>
+    template <typename Number>
+    void
+    SolutionTransfer<dim, VECTOR, DH>::
+    unpack_values(const typename DH::cell_iterator &cell,
+                  const typename Triangulation<dim,dim>::CellStatus status,
+                  const void *data,
+                  std::vector<VECTOR *> &all_out) const
+    {
+      const char *data_store = reinterpret_cast<const char *>(data);
+
       const unsigned int dofs_per_cell=cell->get_fe().dofs_per_cell;
-      ::dealii::Vector<double> dofvalues(dofs_per_cell);
-      const double *data_store = reinterpret_cast<const double *>(data);
+      std::vector<Number> values(dofs_per_cell);
 
-      for (typename std::vector<VECTOR *>::iterator it = all_out.begin();
-           it != all_out.end();
-           ++it)
+      // a refined cell passes the values on to its children by
+      // interpolation. otherwise, the cell is active and the values are
+      // written directly into the vectors
+      if (status == parallel::distributed::Triangulation<dim>::CELL_REFINE)
+        {
+          ::dealii::Vector<double> dofvalues(dofs_per_cell);
+          for (typename std::vector<VECTOR *>::iterator it = all_out.begin();
+               it != all_out.end();
+               ++it)
+            {
+              std::memcpy(&values[0], data_store, sizeof(Number)*dofs_per_cell);
+              std::copy (values.begin(), values.end(), dofvalues.begin());
+              cell->set_dof_values_by_interpolation(dofvalues, *(*it));
+              data_store += sizeof(Number)*dofs_per_cell;
+            }
+        }
+      else
         {
-          std::memcpy(&dofvalues(0), data_store, sizeof(double)*dofs_per_cell);
-          cell->set_dof_values_by_interpolation(dofvalues, *(*it));
-          data_store += dofs_per_cell;
+          std::vector<types::global_dof_index> dof_indices(dofs_per_cell);
+          cell->get_dof_indices(dof_indices);
+          for (typename std::vector<VECTOR *>::iterator it = all_out.begin();
+               it != all_out.end();
+               ++it)
+            {
+              std::memcpy(&values[0], data_store, sizeof(Number)*dofs_per_cell);
+              for (unsigned int i=0; i<dofs_per_cell; ++i)
+                (*(*it))(dof_indices[i]) = values[i];
+              data_store += sizeof(Number)*dofs_per_cell;
+            }
         }
     }
 
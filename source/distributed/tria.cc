@@ -1522,6 +1522,84 @@ namespace
   }
 
 
+  template <int dim, int spacedim>
+  void
+  get_cell_weights_recursively (const typename internal::p4est::types<dim>::tree &tree,
+                                const typename Triangulation<dim,spacedim>::cell_iterator &dealii_cell,
+                                const typename internal::p4est::types<dim>::quadrant &p4est_cell,
+                                const typename parallel::distributed::Triangulation<dim,spacedim>::PartitionSignals &signals,
+                                std::vector<unsigned int> &weight)
+  {
+    const int idx = sc_array_bsearch(const_cast<sc_array_t *>(&tree.quadrants),
+                                     &p4est_cell,
+                                     internal::p4est::functions<dim>::quadrant_compare);
+
+    if (idx == -1 && (internal::p4est::functions<dim>::
+                      quadrant_overlaps_tree (const_cast<typename internal::p4est::types<dim>::tree *>(&tree),
+                                              &p4est_cell)
+                      == false))
+      return; //this quadrant and none of its children belongs to us.
+
+    const bool p4est_has_children = (idx == -1);
+
+    if (p4est_has_children && dealii_cell->has_children())
+      {
+        //recurse further
+        typename internal::p4est::types<dim>::quadrant
+        p4est_child[GeometryInfo<dim>::max_children_per_cell];
+        for (unsigned int c=0; c<GeometryInfo<dim>::max_children_per_cell; ++c)
+          switch (dim)
+            {
+            case 2:
+              P4EST_QUADRANT_INIT(&p4est_child[c]);
+              break;
+            case 3:
+              P8EST_QUADRANT_INIT(&p4est_child[c]);
+              break;
+            default:
+              Assert (false, ExcNotImplemented());
+            }
+
+        internal::p4est::functions<dim>::
+        quadrant_childrenv (&p4est_cell, p4est_child);
+
+        for (unsigned int c=0;
+             c<GeometryInfo<dim>::max_children_per_cell; ++c)
+          get_cell_weights_recursively<dim,spacedim> (tree,
+                                                      dealii_cell->child(c),
+                                                      p4est_child[c],
+                                                      signals,
+                                                      weight);
+      }
+    else if (!p4est_has_children && !dealii_cell->has_children())
+      {
+        //this active cell didn't change
+        weight.push_back (1000);
+        weight.back() += signals.cell_weight (dealii_cell,
+                                              parallel::distributed::Triangulation<dim,spacedim>::CELL_PERSIST);
+      }
+    else if (p4est_has_children)
+      {
+        //this cell got refined. all of its children get the weight
+        //determined for the parent
+        unsigned int parent_weight = 1000;
+        parent_weight += signals.cell_weight (dealii_cell,
+                                              parallel::distributed::Triangulation<dim,spacedim>::CELL_REFINE);
+
+        for (unsigned int c=0; c<GeometryInfo<dim>::max_children_per_cell; ++c)
+          weight.push_back (parent_weight);
+      }
+    else
+      {
+        //its children got coarsened into this cell
+        weight.push_back (1000);
+        weight.back() += signals.cell_weight (dealii_cell,
+                                              parallel::distributed::Triangulation<dim,spacedim>::CELL_COARSEN);
+      }
+  }
+
+
+
   template <int dim, int spacedim>
   void
   post_mesh_data_recursively (const typename internal::p4est::types<dim>::tree &tree,
@@ -1929,6 +2007,72 @@ namespace
     // p4est cell is not in list
     return false;
   }
+
+
+
+  /**
+   * A list of the weights of the locally owned quadrants of a p4est forest,
+   * in the order in which p4est stores them, which is handed out one by one
+   * to p4est when it partitions the forest. Like for RefineAndCoarsenList,
+   * p4est communicates the object to the callback function through the
+   * user_pointer of the forest.
+   */
+  template <int dim, int spacedim>
+  class PartitionWeights
+  {
+  public:
+    PartitionWeights (const std::vector<unsigned int> &cell_weights);
+
+    /**
+     * A callback function that we pass to the p4est data structures when a
+     * forest is to be partitioned. p4est calls it for each of the locally
+     * owned quadrants in order, and the function returns the weight of the
+     * next cell in the list.
+     */
+    static
+    int
+    cell_weight (typename internal::p4est::types<dim>::forest *forest,
+                 typename internal::p4est::types<dim>::topidx  coarse_cell_index,
+                 typename internal::p4est::types<dim>::quadrant *quadrant);
+
+  private:
+    std::vector<unsigned int> cell_weights_list;
+    std::vector<unsigned int>::const_iterator current_pointer;
+  };
+
+
+
+  template <int dim, int spacedim>
+  PartitionWeights<dim,spacedim>::
+  PartitionWeights (const std::vector<unsigned int> &cell_weights)
+    :
+    cell_weights_list (cell_weights)
+  {
+    // set the current pointer to the first element of the list, given that
+    // we will walk through it sequentially
+    current_pointer = cell_weights_list.begin();
+  }
+
+
+
+  template <int dim, int spacedim>
+  int
+  PartitionWeights<dim,spacedim>::
+  cell_weight (typename internal::p4est::types<dim>::forest *forest,
+               typename internal::p4est::types<dim>::topidx,
+               typename internal::p4est::types<dim>::quadrant *)
+  {
+    PartitionWeights<dim,spacedim> *this_object
+      = reinterpret_cast<PartitionWeights<dim,spacedim>*>(forest->user_pointer);
+
+    Assert (this_object->current_pointer >= this_object->cell_weights_list.begin(),
+            ExcInternalError());
+    Assert (this_object->current_pointer < this_object->cell_weights_list.end(),
+            ExcInternalError());
+
+    // get the weight, increment the pointer, and return the weight
+    return *this_object->current_pointer++;
+  }
 }
 
 
@@ -2023,7 +2167,8 @@ namespace parallel
       refinement_in_progress (false),
       attached_data_size(0),
       n_attached_datas(0),
-      n_attached_deserialize(0)
+      n_attached_deserialize(0),
+      partition_statistics ()
     {
       // initialize p4est. do this in a separate function since it has to
       // happen only once, even if we have triangulation objects for several
@@ -3107,10 +3252,7 @@ namespace parallel
       attach_mesh_data();
 
       // partition the new mesh between all processors
-      dealii::internal::p4est::functions<dim>::
-      partition (parallel_forest,
-                 /* prepare coarsening */ 1,
-                 /* weight_callback */ NULL);
+      partition_forest ();
 
       // finally copy back from local part of tree to deal.II
       // triangulation. before doing so, make sure there are no refine or
@@ -3142,6 +3284,237 @@ namespace parallel
 
 
 
+    template <int dim, int spacedim>
+    void
+    Triangulation<dim,spacedim>::repartition ()
+    {
+#ifdef DEBUG
+      for (typename Triangulation<dim,spacedim>::active_cell_iterator
+           cell = this->begin_active();
+           cell != this->end(); ++cell)
+        if (cell->is_locally_owned())
+          Assert (!cell->refine_flag_set() && !cell->coarsen_flag_set(),
+                  ExcMessage ("Error: There shouldn't be any cells flagged for"
+                              " coarsening/refinement when calling repartition()."));
+#endif
+
+      refinement_in_progress = true;
+
+      if (parallel_ghost != 0)
+        {
+          dealii::internal::p4est::functions<dim>::ghost_destroy (parallel_ghost);
+          parallel_ghost = 0;
+        }
+
+      // let others attach mesh related info (such as SolutionTransfer data)
+      // to the p4est, then distribute the cells anew
+      attach_mesh_data();
+      partition_forest ();
+
+      try
+        {
+          copy_local_forest_to_triangulation ();
+        }
+      catch (const typename Triangulation<dim>::DistortedCellList &)
+        {
+          // the underlying triangulation should not be checking for distorted
+          // cells
+          AssertThrow (false, ExcInternalError());
+        }
+
+      refinement_in_progress = false;
+
+      update_number_cache ();
+    }
+
+
+
+    template <int dim, int spacedim>
+    const Utilities::MPI::MinMaxAvg &
+    Triangulation<dim,spacedim>::get_partition_statistics () const
+    {
+      return partition_statistics;
+    }
+
+
+
+    template <int dim, int spacedim>
+    std::vector<unsigned int>
+    Triangulation<dim,spacedim>::get_cell_weights () const
+    {
+      std::vector<unsigned int> weights;
+      weights.reserve (parallel_forest->local_num_quadrants);
+
+      // walk through the local trees in the order of p4est, since this is
+      // the order in which p4est asks for the weights of the quadrants
+      if (parallel_forest->local_num_quadrants > 0)
+        for (typename dealii::internal::p4est::types<dim>::topidx
+             tree_index = parallel_forest->first_local_tree;
+             tree_index <= parallel_forest->last_local_tree; ++tree_index)
+          {
+            const typename Triangulation<dim,spacedim>::cell_iterator
+            cell (this, 0, p4est_tree_to_coarse_cell_permutation[tree_index]);
+
+            typename dealii::internal::p4est::types<dim>::quadrant p4est_coarse_cell;
+            const typename dealii::internal::p4est::types<dim>::tree *tree =
+              init_tree (cell->index());
+
+            dealii::internal::p4est::init_coarse_quadrant<dim> (p4est_coarse_cell);
+
+            get_cell_weights_recursively<dim,spacedim> (*tree,
+                                                        cell,
+                                                        p4est_coarse_cell,
+                                                        partition_signals,
+                                                        weights);
+          }
+
+      Assert (weights.size() ==
+              static_cast<std::size_t>(parallel_forest->local_num_quadrants),
+              ExcInternalError());
+
+      return weights;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    Triangulation<dim,spacedim>::partition_forest ()
+    {
+      const unsigned int n_procs = Utilities::MPI::n_mpi_processes (mpi_communicator);
+
+      // the partition before partitioning is needed below to find out where
+      // the weights of the local quadrants go
+      const std::vector<p4est_gloidx_t>
+      old_first_quadrant (parallel_forest->global_first_quadrant,
+                          parallel_forest->global_first_quadrant + n_procs + 1);
+      const p4est_gloidx_t first_local_quadrant
+        = old_first_quadrant[my_subdomain];
+
+      const bool use_weights = (partition_signals.cell_weight.num_slots() > 0);
+      std::vector<unsigned int> weights;
+      if (use_weights)
+        {
+          weights = get_cell_weights ();
+
+          PartitionWeights<dim,spacedim> partition_weights (weights);
+
+          // p4est hands the object to the callback function through the
+          // user_pointer, so set and reset it around the call
+          Assert (parallel_forest->user_pointer == this,
+                  ExcInternalError());
+          parallel_forest->user_pointer = &partition_weights;
+
+          dealii::internal::p4est::functions<dim>::
+          partition (parallel_forest,
+                     /* prepare coarsening */ 1,
+                     &PartitionWeights<dim,spacedim>::cell_weight);
+
+          parallel_forest->user_pointer = this;
+        }
+      else
+        dealii::internal::p4est::functions<dim>::
+        partition (parallel_forest,
+                   /* prepare coarsening */ 1,
+                   /* weight_callback */ NULL);
+
+      // compute the load of each processor after partitioning. the weights
+      // are only known for the quadrants that were local before, so let
+      // each processor compute the accumulated weight of all quadrants up to
+      // the new partition boundaries that fall into its old range, and send
+      // them to the two processors bordering on that boundary. the prefix
+      // sum of the weights up to the first old local quadrant and the total
+      // weight are scalar reductions
+      const p4est_gloidx_t *global_first_quadrant
+        = parallel_forest->global_first_quadrant;
+      double my_load;
+      if (use_weights == false)
+        my_load = 1000. * (global_first_quadrant[my_subdomain+1] -
+                           global_first_quadrant[my_subdomain]);
+      else
+        {
+          double local_weight = 0;
+          for (unsigned int i=0; i<weights.size(); ++i)
+            local_weight += weights[i];
+
+          double weight_before = 0, total_weight = 0;
+          MPI_Exscan (&local_weight, &weight_before, 1, MPI_DOUBLE, MPI_SUM,
+                      mpi_communicator);
+          if (my_subdomain == 0)
+            weight_before = 0;
+          MPI_Allreduce (&local_weight, &total_weight, 1, MPI_DOUBLE, MPI_SUM,
+                         mpi_communicator);
+
+          const p4est_gloidx_t n_quadrants = global_first_quadrant[n_procs];
+          const p4est_gloidx_t end_local_quadrant
+            = old_first_quadrant[my_subdomain+1];
+
+          // the accumulated weight at the first quadrant of processor q is
+          // known to the last processor whose old range starts at or before
+          // it, skipping processors that had no quadrants
+          const std::vector<p4est_gloidx_t>::const_iterator
+          old_begin = old_first_quadrant.begin(),
+          old_end = old_first_quadrant.begin() + n_procs;
+
+          std::vector<std::pair<unsigned int,double> > boundary_values;
+          double accumulated = weight_before;
+          p4est_gloidx_t index = first_local_quadrant;
+          for (unsigned int q = std::lower_bound (global_first_quadrant+1,
+                                                  global_first_quadrant+n_procs,
+                                                  first_local_quadrant)
+                                - global_first_quadrant;
+               q<n_procs && global_first_quadrant[q]<end_local_quadrant; ++q)
+            {
+              const p4est_gloidx_t boundary = global_first_quadrant[q];
+              for ( ; index < boundary; ++index)
+                accumulated += weights[index-first_local_quadrant];
+              boundary_values.push_back (std::make_pair (q, accumulated));
+            }
+
+          // processor q-1 needs the value at boundary q as the end of its
+          // range (tag 1), processor q as the start of its range (tag 0)
+          std::vector<MPI_Request> requests (2*boundary_values.size());
+          for (unsigned int b=0; b<boundary_values.size(); ++b)
+            {
+              const unsigned int q = boundary_values[b].first;
+              MPI_Isend (&boundary_values[b].second, 1, MPI_DOUBLE,
+                         q-1, 1, mpi_communicator, &requests[2*b]);
+              MPI_Isend (&boundary_values[b].second, 1, MPI_DOUBLE,
+                         q, 0, mpi_communicator, &requests[2*b+1]);
+            }
+
+          // receive the accumulated weights at the start and end of the own
+          // range, unless they are the start or end of the whole forest
+          double range[2] = { 0., total_weight };
+          for (unsigned int end=0; end<2; ++end)
+            {
+              const unsigned int q = my_subdomain + end;
+              if (q == 0 || q == n_procs)
+                continue;
+              const p4est_gloidx_t boundary = global_first_quadrant[q];
+              if (boundary == n_quadrants)
+                range[end] = total_weight;
+              else
+                {
+                  const unsigned int source
+                    = (std::upper_bound (old_begin, old_end, boundary)
+                       - old_begin) - 1;
+                  MPI_Recv (&range[end], 1, MPI_DOUBLE, source, end,
+                            mpi_communicator, MPI_STATUS_IGNORE);
+                }
+            }
+          if (requests.size() > 0)
+            MPI_Waitall (requests.size(), &requests[0], MPI_STATUSES_IGNORE);
+
+          my_load = range[1] - range[0];
+        }
+
+      partition_statistics = Utilities::MPI::min_max_avg (my_load,
+                                                          mpi_communicator);
+    }
+
+
+
     template <int dim, int spacedim>
     void
     Triangulation<dim,spacedim>::update_number_cache ()
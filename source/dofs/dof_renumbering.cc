@@ -14,6 +14,8 @@
 // ---------------------------------------------------------------------
 
 #include <deal.II/base/thread_management.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/std_cxx11/bind.h>
 #include <deal.II/base/utilities.h>
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/types.h>
@@ -1865,6 +1867,176 @@ namespace DoFRenumbering
 
 
 
+  namespace internal
+  {
+    /**
+     * Return the position of the point with the given integer coordinates
+     * of @p n_bits bits each along a Hilbert curve. This follows
+     * J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707
+     * (2004): the coordinates are first transformed into the transposed
+     * form of the Hilbert index, whose bits are then interleaved.
+     */
+    template <int dim>
+    unsigned long long int
+    hilbert_index (const unsigned int (&coordinates)[dim],
+                   const unsigned int n_bits)
+    {
+      unsigned int x[dim];
+      for (unsigned int d=0; d<dim; ++d)
+        x[d] = coordinates[d];
+
+      if (dim > 1)
+        {
+          const unsigned int m = 1U << (n_bits-1);
+
+          // inverse undo of the excess work
+          for (unsigned int q=m; q>1; q>>=1)
+            {
+              const unsigned int p = q-1;
+              for (unsigned int i=0; i<dim; ++i)
+                if (x[i] & q)
+                  x[0] ^= p;
+                else
+                  {
+                    const unsigned int t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t;
+                    x[i] ^= t;
+                  }
+            }
+
+          // Gray encode
+          for (unsigned int i=1; i<dim; ++i)
+            x[i] ^= x[i-1];
+          unsigned int t = 0;
+          for (unsigned int q=m; q>1; q>>=1)
+            if (x[dim-1] & q)
+              t ^= q-1;
+          for (unsigned int i=0; i<dim; ++i)
+            x[i] ^= t;
+        }
+
+      // interleave the bits of the transposed index, most significant
+      // first
+      unsigned long long int index = 0;
+      for (int b=n_bits-1; b>=0; --b)
+        for (unsigned int i=0; i<dim; ++i)
+          index = (index << 1) | ((x[i] >> b) & 1U);
+      return index;
+    }
+
+
+
+    /**
+     * Compute the Hilbert keys of the cells <code>cells[begin...end)</code>,
+     * together with their position in @p cells.
+     */
+    template <class DH>
+    void
+    compute_hilbert_keys (const std::vector<typename DH::active_cell_iterator> &cells,
+                          const Point<DH::space_dimension>                     &lower_left,
+                          const double                                          scaling,
+                          const unsigned int                                    n_bits,
+                          const unsigned int                                    begin,
+                          const unsigned int                                    end,
+                          std::vector<std::pair<unsigned long long int,unsigned int> > &keys)
+    {
+      const unsigned int spacedim = DH::space_dimension;
+      const double max_coordinate = std::ldexp (1., n_bits) - 1.;
+      for (unsigned int c=begin; c<end; ++c)
+        {
+          const Point<spacedim> center = cells[c]->center();
+          unsigned int coordinates[spacedim];
+          for (unsigned int d=0; d<spacedim; ++d)
+            coordinates[d] = static_cast<unsigned int>
+                             (std::max (0., std::min (max_coordinate,
+                                                      (center[d]-lower_left[d]) * scaling)));
+          keys[c] = std::make_pair (hilbert_index<spacedim> (coordinates, n_bits), c);
+        }
+    }
+  }
+
+
+
+  template <class DH>
+  void
+  hilbert_curve (DH &dof_handler)
+  {
+    std::vector<types::global_dof_index> renumbering(dof_handler.n_dofs());
+    compute_hilbert_curve(renumbering, dof_handler);
+
+    dof_handler.renumber_dofs(renumbering);
+  }
+
+
+
+  template <class DH>
+  void
+  compute_hilbert_curve (std::vector<types::global_dof_index> &new_indices,
+                         const DH                             &dof_handler)
+  {
+    const unsigned int spacedim = DH::space_dimension;
+
+    std::vector<typename DH::active_cell_iterator> cells;
+    cells.reserve (dof_handler.get_tria().n_active_cells());
+    for (typename DH::active_cell_iterator cell = dof_handler.begin_active();
+         cell != dof_handler.end(); ++cell)
+      cells.push_back (cell);
+
+    // determine the bounding box of the mesh. use the same extent in all
+    // directions so that the curve does not get distorted on elongated
+    // domains
+    const std::vector<Point<spacedim> > &vertices = dof_handler.get_tria().get_vertices();
+    const std::vector<bool> &used_vertices = dof_handler.get_tria().get_used_vertices();
+    Point<spacedim> lower_left, upper_right;
+    bool first_vertex = true;
+    for (unsigned int v=0; v<vertices.size(); ++v)
+      if (used_vertices[v])
+        {
+          if (first_vertex)
+            {
+              lower_left = upper_right = vertices[v];
+              first_vertex = false;
+            }
+          for (unsigned int d=0; d<spacedim; ++d)
+            {
+              lower_left[d] = std::min (lower_left[d], vertices[v][d]);
+              upper_right[d] = std::max (upper_right[d], vertices[v][d]);
+            }
+        }
+    double extent = 0;
+    for (unsigned int d=0; d<spacedim; ++d)
+      extent = std::max (extent, upper_right[d]-lower_left[d]);
+
+    // use as many bits per coordinate as fit into the 64 bit key
+    const unsigned int n_bits = (spacedim == 3 ? 21 : 32);
+    const double scaling = (extent > 0 ?
+                            (std::ldexp (1., n_bits) - 1.) / extent :
+                            0.);
+
+    std::vector<std::pair<unsigned long long int,unsigned int> > keys (cells.size());
+    parallel::apply_to_subranges (0U, static_cast<unsigned int>(cells.size()),
+                                  std_cxx11::bind (&internal::compute_hilbert_keys<DH>,
+                                                   std_cxx11::cref(cells),
+                                                   std_cxx11::cref(lower_left),
+                                                   scaling, n_bits,
+                                                   std_cxx11::_1, std_cxx11::_2,
+                                                   std_cxx11::ref(keys)),
+                                  1024);
+
+    // the second entry makes the keys unique, so cells with the same key
+    // stay in their original order
+    std::sort (keys.begin(), keys.end());
+
+    std::vector<typename DH::active_cell_iterator> ordered_cells (cells.size());
+    for (unsigned int c=0; c<cells.size(); ++c)
+      ordered_cells[c] = cells[keys[c].second];
+
+    std::vector<types::global_dof_index> reverse(new_indices.size());
+    compute_cell_wise(new_indices, reverse, dof_handler, ordered_cells);
+  }
+
+
+
   template <class DH>
   void
   random (DH &dof_handler)
@@ -1136,6 +1136,22 @@ FE_Q_Base<POLY,dim,spacedim>
           this->dofs_per_cell)
         return this->prolongation[refinement_case-1][child];
 
+      // read the matrix from the cache of transfer matrices if it has been
+      // computed before, possibly in an earlier run of the program
+      FullMatrix<double> prolongate (this->dofs_per_cell, this->dofs_per_cell);
+      std::ostringstream cache_kind;
+      cache_kind << "prolongation matrix, refinement case "
+                 << static_cast<unsigned int>(refinement_case)
+                 << ", child " << child;
+      const std::vector<FullMatrix<double> *> cached_matrices (1, &prolongate);
+      if (FETools::load_cached_transfer_matrices (*this, cache_kind.str(),
+                                                  cached_matrices))
+        {
+          prolongate.swap(const_cast<FullMatrix<double> &>
+                          (this->prolongation[refinement_case-1][child]));
+          return this->prolongation[refinement_case-1][child];
+        }
+
       // distinguish q/q_dg0 case: only treat Q dofs first
       const unsigned int q_dofs_per_cell = Utilities::fixed_power<dim>(this->degree+1);
 
@@ -1185,8 +1201,6 @@ FE_Q_Base<POLY,dim,spacedim>
           }
       }
 
-      FullMatrix<double> prolongate (this->dofs_per_cell, this->dofs_per_cell);
-
       // go through the points in diagonal to capture variation in all
       // directions simultaneously
       for (unsigned int j=0; j<dofs1d; ++j)
@@ -1279,6 +1293,9 @@ FE_Q_Base<POLY,dim,spacedim>
         }
 #endif
 
+      FETools::store_cached_transfer_matrices (*this, cache_kind.str(),
+                                               cached_matrices);
+
       // swap matrices
       prolongate.swap(const_cast<FullMatrix<double> &>
                       (this->prolongation[refinement_case-1][child]));
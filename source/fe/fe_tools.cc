@@ -47,7 +47,11 @@
 
 #include <deal.II/base/index_set.h>
 
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
 
 DEAL_II_NAMESPACE_OPEN
@@ -694,6 +698,288 @@ namespace FETools
 
   */
 
+  namespace
+  {
+    // the directory of the cache for transfer matrices and the lock that
+    // protects it. both are function-local statics since elements may be
+    // created during static initialization in other files
+    Threads::Mutex &
+    transfer_matrix_cache_lock ()
+    {
+      static Threads::Mutex lock;
+      return lock;
+    }
+
+
+    std::string &
+    transfer_matrix_cache_directory ()
+    {
+      static std::string directory
+        = (std::getenv ("DEAL_II_FE_MATRIX_CACHE") != 0
+           ?
+           std::string (std::getenv ("DEAL_II_FE_MATRIX_CACHE"))
+           :
+           std::string());
+      return directory;
+    }
+
+
+
+    // the number of successful reads from the cache, protected by the lock
+    // above
+    unsigned int &
+    transfer_matrix_cache_hits ()
+    {
+      static unsigned int n_hits = 0;
+      return n_hits;
+    }
+
+
+
+    // 64 bit FNV-1a hash of a sequence of bytes, continuing from the given
+    // hash value
+    unsigned long long
+    hash_bytes (const char         *data,
+                const std::size_t   n_bytes,
+                unsigned long long  hash = 14695981039346656037ULL)
+    {
+      for (std::size_t i=0; i<n_bytes; ++i)
+        {
+          hash ^= static_cast<unsigned char>(data[i]);
+          hash *= 1099511628211ULL;
+        }
+      return hash;
+    }
+
+
+
+    // the name of an element does not always identify it uniquely (e.g.,
+    // FE_Q with arbitrary support points), so add a hash of the values of
+    // all shape functions in the points of a small Gauss formula to the key
+    template <int dim, int spacedim>
+    unsigned long long
+    shape_function_fingerprint (const FiniteElement<dim,spacedim> &fe)
+    {
+      const QGauss<dim> quadrature (2);
+      unsigned long long hash = hash_bytes (0, 0);
+      for (unsigned int i=0; i<fe.dofs_per_cell; ++i)
+        for (unsigned int q=0; q<quadrature.size(); ++q)
+          for (unsigned int c=0; c<fe.n_components(); ++c)
+            {
+              const double value = fe.shape_value_component (i, quadrature.point(q), c);
+              hash = hash_bytes (reinterpret_cast<const char *>(&value),
+                                 sizeof(value), hash);
+            }
+      return hash;
+    }
+
+
+
+    // the key under which the given kind of matrices of an element are
+    // stored in the cache, or an empty string if the cache is disabled
+    template <typename number, int dim, int spacedim>
+    std::string
+    transfer_matrix_cache_key (const FiniteElement<dim,spacedim> &fe,
+                               const std::string                 &kind)
+    {
+      if (get_transfer_matrix_cache_directory().empty())
+        return std::string();
+
+      std::ostringstream key;
+      key << "deal.II " << DEAL_II_PACKAGE_VERSION
+          << ", " << kind
+          << ", " << fe.get_name()
+          << ", dim=" << dim
+          << ", spacedim=" << spacedim
+          << ", sizeof(number)=" << sizeof(number)
+          << ", dofs_per_cell=" << fe.dofs_per_cell
+          << ", shape functions=" << std::hex << shape_function_fingerprint (fe);
+      return key.str();
+    }
+
+
+
+    std::string
+    transfer_matrix_cache_file (const std::string &key)
+    {
+      const std::string directory = get_transfer_matrix_cache_directory();
+      if (key.empty() || directory.empty())
+        return std::string();
+
+      std::ostringstream filename;
+      filename << directory << "/fe_matrices_"
+               << std::hex << hash_bytes (key.c_str(), key.size())
+               << ".bin";
+      return filename.str();
+    }
+
+
+
+    // collect pointers to the matrices of all refinement cases that
+    // compute_embedding_matrices() and compute_projection_matrices() fill
+    template <int dim, typename number>
+    std::vector<FullMatrix<number> *>
+    refinement_case_matrices (std::vector<std::vector<FullMatrix<number> > > &matrices,
+                              const bool isotropic_only)
+    {
+      std::vector<FullMatrix<number> *> pointers;
+      unsigned int ref_case = (isotropic_only)
+                              ? RefinementCase<dim>::isotropic_refinement
+                              : RefinementCase<dim>::cut_x;
+      for (; ref_case <= RefinementCase<dim>::isotropic_refinement; ++ref_case)
+        for (unsigned int c=0; c<matrices[ref_case-1].size(); ++c)
+          pointers.push_back (&matrices[ref_case-1][c]);
+      return pointers;
+    }
+
+
+
+    // read the matrices stored under the given key from the cache. the
+    // matrices must already have the right size. return false, leaving the
+    // matrices untouched, if there is no matching and complete file
+    template <typename number>
+    bool
+    load_transfer_matrices (const std::string                       &key,
+                            const std::vector<FullMatrix<number> *> &matrices)
+    {
+      const std::string filename = transfer_matrix_cache_file (key);
+      if (filename.empty())
+        return false;
+
+      std::ifstream in (filename.c_str(), std::ios::in | std::ios::binary);
+      if (!in)
+        return false;
+
+      std::string stored_key;
+      std::getline (in, stored_key, '\0');
+      unsigned int n_matrices = 0;
+      in.read (reinterpret_cast<char *>(&n_matrices), sizeof(n_matrices));
+      if (!in || stored_key != key || n_matrices != matrices.size())
+        return false;
+
+      std::vector<std::vector<number> > values (matrices.size());
+      for (unsigned int i=0; i<matrices.size(); ++i)
+        {
+          unsigned int size[2] = { 0, 0 };
+          in.read (reinterpret_cast<char *>(&size[0]), sizeof(size));
+          if (!in || size[0] != matrices[i]->m() || size[1] != matrices[i]->n())
+            return false;
+
+          values[i].resize (size[0] * size[1]);
+          if (values[i].size() > 0)
+            in.read (reinterpret_cast<char *>(&values[i][0]),
+                     values[i].size() * sizeof(number));
+          if (!in)
+            return false;
+        }
+
+      for (unsigned int i=0; i<matrices.size(); ++i)
+        if (values[i].size() > 0)
+          matrices[i]->fill (&values[i][0]);
+
+      Threads::Mutex::ScopedLock lock (transfer_matrix_cache_lock());
+      ++transfer_matrix_cache_hits();
+      return true;
+    }
+
+
+
+    // store the matrices under the given key in the cache. write to a
+    // temporary file first and rename it, so that other processes reading
+    // the same cache never see a partially written file. errors are
+    // ignored, the matrices will simply be computed again next time
+    template <typename number>
+    void
+    store_transfer_matrices (const std::string                       &key,
+                             const std::vector<FullMatrix<number> *> &matrices)
+    {
+      const std::string filename = transfer_matrix_cache_file (key);
+      if (filename.empty())
+        return;
+
+      std::ostringstream tmp_filename;
+      tmp_filename << filename << ".tmp" << Threads::this_thread_id();
+
+      bool success;
+      {
+        std::ofstream out (tmp_filename.str().c_str(),
+                           std::ios::out | std::ios::binary);
+        out.write (key.c_str(), key.size()+1);
+        const unsigned int n_matrices = matrices.size();
+        out.write (reinterpret_cast<const char *>(&n_matrices), sizeof(n_matrices));
+        for (unsigned int i=0; i<matrices.size(); ++i)
+          {
+            const unsigned int size[2] = { static_cast<unsigned int>(matrices[i]->m()),
+                                           static_cast<unsigned int>(matrices[i]->n())
+                                         };
+            out.write (reinterpret_cast<const char *>(&size[0]), sizeof(size));
+            if (size[0] * size[1] > 0)
+              out.write (reinterpret_cast<const char *>(&(*matrices[i])(0,0)),
+                         size[0] * size[1] * sizeof(number));
+          }
+        out.close ();
+        success = !out.fail();
+      }
+
+      if (!success ||
+          std::rename (tmp_filename.str().c_str(), filename.c_str()) != 0)
+        std::remove (tmp_filename.str().c_str());
+    }
+  }
+
+
+
+  void
+  set_transfer_matrix_cache_directory (const std::string &directory)
+  {
+    Threads::Mutex::ScopedLock lock (transfer_matrix_cache_lock());
+    transfer_matrix_cache_directory() = directory;
+  }
+
+
+
+  std::string
+  get_transfer_matrix_cache_directory ()
+  {
+    Threads::Mutex::ScopedLock lock (transfer_matrix_cache_lock());
+    return transfer_matrix_cache_directory();
+  }
+
+
+
+  unsigned int
+  n_transfer_matrix_cache_hits ()
+  {
+    Threads::Mutex::ScopedLock lock (transfer_matrix_cache_lock());
+    return transfer_matrix_cache_hits();
+  }
+
+
+
+  template <int dim, int spacedim>
+  bool
+  load_cached_transfer_matrices (const FiniteElement<dim,spacedim>       &fe,
+                                 const std::string                       &kind,
+                                 const std::vector<FullMatrix<double> *> &matrices)
+  {
+    return load_transfer_matrices (transfer_matrix_cache_key<double> (fe, kind),
+                                   matrices);
+  }
+
+
+
+  template <int dim, int spacedim>
+  void
+  store_cached_transfer_matrices (const FiniteElement<dim,spacedim>       &fe,
+                                  const std::string                       &kind,
+                                  const std::vector<FullMatrix<double> *> &matrices)
+  {
+    store_transfer_matrices (transfer_matrix_cache_key<double> (fe, kind),
+                             matrices);
+  }
+
+
+
   namespace
   {
     template<int dim, typename number, int spacedim>
@@ -878,6 +1164,15 @@ namespace FETools
                              std::vector<std::vector<FullMatrix<number> > > &matrices,
                              const bool isotropic_only)
   {
+    const std::vector<FullMatrix<number> *> all_matrices
+      = refinement_case_matrices<dim> (matrices, isotropic_only);
+    const std::string cache_key
+      = transfer_matrix_cache_key<number> (fe, (isotropic_only
+                                                ? "embedding matrices, isotropic refinement"
+                                                : "embedding matrices"));
+    if (load_transfer_matrices (cache_key, all_matrices))
+      return;
+
     Threads::TaskGroup<void> task_group;
 
     // loop over all possible refinement cases
@@ -890,6 +1185,8 @@ namespace FETools
                                        fe, matrices[ref_case-1], ref_case);
 
     task_group.join_all ();
+
+    store_transfer_matrices (cache_key, all_matrices);
   }
 
 
@@ -904,6 +1201,16 @@ namespace FETools
     Assert(face_coarse==0, ExcNotImplemented());
     Assert(face_fine==0, ExcNotImplemented());
 
+    std::vector<FullMatrix<number> *> all_matrices;
+    for (unsigned int i=0; i<GeometryInfo<dim>::max_children_per_face; ++i)
+      all_matrices.push_back (&matrices[i]);
+    std::ostringstream kind;
+    kind << "face embedding matrices, faces " << face_coarse << " and " << face_fine;
+    const std::string cache_key
+      = transfer_matrix_cache_key<number> (fe, kind.str());
+    if (load_transfer_matrices (cache_key, all_matrices))
+      return;
+
     const unsigned int nc = GeometryInfo<dim>::max_children_per_face;
     const unsigned int n  = fe.dofs_per_face;
     const unsigned int nd = fe.n_components();
@@ -1089,6 +1396,8 @@ namespace FETools
             if (std::fabs(this_matrix(i,j)) < 1e-12)
               this_matrix(i,j) = 0.;
       }
+
+    store_transfer_matrices (cache_key, all_matrices);
   }
 
 
@@ -1126,6 +1435,15 @@ namespace FETools
                               std::vector<std::vector<FullMatrix<number> > > &matrices,
                               const bool isotropic_only)
   {
+    const std::vector<FullMatrix<number> *> all_matrices
+      = refinement_case_matrices<dim> (matrices, isotropic_only);
+    const std::string cache_key
+      = transfer_matrix_cache_key<number> (fe, (isotropic_only
+                                                ? "projection matrices, isotropic refinement"
+                                                : "projection matrices"));
+    if (load_transfer_matrices (cache_key, all_matrices))
+      return;
+
     const unsigned int n  = fe.dofs_per_cell;
     const unsigned int nd = fe.n_components();
     const unsigned int degree = fe.degree;
@@ -1277,6 +1595,8 @@ namespace FETools
                   this_matrix(i,j) = 0.;
           }
       }
+
+    store_transfer_matrices (cache_key, all_matrices);
   }
 
 
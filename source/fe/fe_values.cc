@@ -13,6 +13,7 @@
 //
 // ---------------------------------------------------------------------
 
+#include <deal.II/base/memory_arena.h>
 #include <deal.II/base/memory_consumption.h>
 #include <deal.II/base/multithread_info.h>
 #include <deal.II/base/quadrature.h>
@@ -2156,6 +2157,7 @@ FEValuesBase<dim,spacedim>::FEValuesBase (const unsigned int n_q_points,
   fe(&fe, typeid(*this).name()),
   mapping_data(0, typeid(*this).name()),
   fe_data(0, typeid(*this).name()),
+  mapping_data_is_current (true),
   fe_values_views_cache (*this)
 {
   Assert (n_q_points > 0,
@@ -2624,7 +2626,8 @@ void FEValuesBase<dim,spacedim>::get_function_values (
   AssertDimension (fe->n_components(), 1);
   AssertDimension (indices.size(), dofs_per_cell);
 
-  // avoid allocation when the local size is small enough
+  // avoid allocation when the local size is small enough, and take the
+  // memory from the scratch arena of this thread otherwise
   if (dofs_per_cell <= 100)
     {
       double dof_values[100];
@@ -2634,7 +2637,7 @@ void FEValuesBase<dim,spacedim>::get_function_values (
     }
   else
     {
-      Vector<double> dof_values(dofs_per_cell);
+      ArenaArray<double> dof_values(dofs_per_cell);
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_values(dof_values.begin(), this->shape_values,
@@ -2685,7 +2688,7 @@ void FEValuesBase<dim,spacedim>::get_function_values (
   if (indices.size() <= 100)
     {
       double dof_values[100];
-      for (unsigned int i=0; i<dofs_per_cell; ++i)
+      for (unsigned int i=0; i<indices.size(); ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_values(&dof_values[0], this->shape_values, *fe,
                                    this->shape_function_to_row_table, val,
@@ -2693,8 +2696,8 @@ void FEValuesBase<dim,spacedim>::get_function_values (
     }
   else
     {
-      Vector<double> dof_values(100);
-      for (unsigned int i=0; i<dofs_per_cell; ++i)
+      ArenaArray<double> dof_values(indices.size());
+      for (unsigned int i=0; i<indices.size(); ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_values(dof_values.begin(), this->shape_values, *fe,
                                    this->shape_function_to_row_table, val,
@@ -2732,7 +2735,7 @@ void FEValuesBase<dim,spacedim>::get_function_values (
     }
   else
     {
-      Vector<double> dof_values(indices.size());
+      ArenaArray<double> dof_values(indices.size());
       for (unsigned int i=0; i<indices.size(); ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_values(dof_values.begin(), this->shape_values, *fe,
@@ -2788,7 +2791,7 @@ void FEValuesBase<dim,spacedim>::get_function_gradients (
     }
   else
     {
-      Vector<double> dof_values(dofs_per_cell);
+      ArenaArray<double> dof_values(dofs_per_cell);
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_derivatives(dof_values.begin(), this->shape_gradients,
@@ -2850,7 +2853,7 @@ void FEValuesBase<dim,spacedim>::get_function_gradients (
     }
   else
     {
-      Vector<double> dof_values(indices.size());
+      ArenaArray<double> dof_values(indices.size());
       for (unsigned int i=0; i<indices.size(); ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_derivatives(dof_values.begin(),this->shape_gradients,
@@ -2906,7 +2909,7 @@ void FEValuesBase<dim,spacedim>::get_function_hessians (
     }
   else
     {
-      Vector<double> dof_values(dofs_per_cell);
+      ArenaArray<double> dof_values(dofs_per_cell);
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_derivatives(dof_values.begin(), this->shape_hessians,
@@ -2966,7 +2969,7 @@ void FEValuesBase<dim, spacedim>::get_function_hessians (
     }
   else
     {
-      Vector<double> dof_values(indices.size());
+      ArenaArray<double> dof_values(indices.size());
       for (unsigned int i=0; i<indices.size(); ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_derivatives(dof_values.begin(),this->shape_hessians,
@@ -3021,7 +3024,7 @@ void FEValuesBase<dim,spacedim>::get_function_laplacians (
     }
   else
     {
-      Vector<double> dof_values(dofs_per_cell);
+      ArenaArray<double> dof_values(dofs_per_cell);
       for (unsigned int i=0; i<dofs_per_cell; ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_laplacians(dof_values.begin(), this->shape_hessians,
@@ -3078,7 +3081,7 @@ void FEValuesBase<dim,spacedim>::get_function_laplacians (
     }
   else
     {
-      Vector<double> dof_values(indices.size());
+      ArenaArray<double> dof_values(indices.size());
       for (unsigned int i=0; i<indices.size(); ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_laplacians(dof_values.begin(),this->shape_hessians,
@@ -3114,7 +3117,7 @@ void FEValuesBase<dim,spacedim>::get_function_laplacians (
     }
   else
     {
-      Vector<double> dof_values(indices.size());
+      ArenaArray<double> dof_values(indices.size());
       for (unsigned int i=0; i<indices.size(); ++i)
         dof_values[i] = get_vector_element (fe_function, indices[i]);
       internal::do_function_laplacians(dof_values.begin(),this->shape_hessians,
@@ -3162,6 +3165,11 @@ FEValuesBase<dim,spacedim>::transform (
   const std::vector<Tensor<1,dim> > &original,
   MappingType type) const
 {
+  Assert (mapping_data_is_current,
+          ExcMessage ("The mapping data of this object does not describe the "
+                      "present cell since it was taken from another FEValues "
+                      "object in the last call to reinit()."));
+
   VectorSlice<const std::vector<Tensor<1,dim> > > src(original);
   VectorSlice<std::vector<Tensor<1,spacedim> > > dst(transformed);
   mapping->transform(src, dst, *mapping_data, type);
@@ -3527,6 +3535,129 @@ void FEValues<dim,spacedim>::do_reinit ()
 
   this->fe_data->clear_first_cell ();
   this->mapping_data->clear_first_cell ();
+  this->mapping_data_is_current = true;
+}
+
+
+
+template <int dim, int spacedim>
+bool
+FEValues<dim,spacedim>::
+can_reuse_mapping_data (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
+                        const FEValues<dim,spacedim> &other) const
+{
+  if (&other == this
+      ||
+      other.present_cell.get() == 0
+      ||
+      other.mapping_data_is_current == false
+      ||
+      &*other.mapping != &*this->mapping)
+    return false;
+
+  if (static_cast<const typename Triangulation<dim,spacedim>::cell_iterator &>
+      (*other.present_cell) != cell)
+    return false;
+
+  // the data that the mapping computes for this object must be a subset of
+  // what it computes for the other one, both the output fields and the
+  // internal data the finite element uses to transform its shape functions
+  const UpdateFlags mapping_output = (update_quadrature_points |
+                                      update_JxW_values |
+                                      update_jacobians |
+                                      update_jacobian_grads |
+                                      update_inverse_jacobians |
+                                      update_normal_vectors);
+  if ((this->update_flags & mapping_output & ~other.update_flags) != 0
+      ||
+      (this->mapping_data->update_flags & ~other.mapping_data->update_flags) != 0)
+    return false;
+
+  return (quadrature == other.quadrature);
+}
+
+
+
+template <int dim, int spacedim>
+void
+FEValues<dim,spacedim>::reinit (const typename Triangulation<dim,spacedim>::cell_iterator &cell,
+                                const FEValues<dim,spacedim> &other)
+{
+  Assert (can_reuse_mapping_data (cell, other),
+          ExcMessage ("The given FEValues object can not provide the mapping "
+                      "data for this cell."));
+
+  this->maybe_invalidate_previous_present_cell (cell);
+  this->check_cell_similarity(cell);
+
+  reset_pointer_in_place_if_possible<typename FEValuesBase<dim,spacedim>::TriaCellIterator>
+  (this->present_cell, cell);
+
+  do_reinit (other);
+}
+
+
+
+template <int dim, int spacedim>
+template <class DH, bool lda>
+void
+FEValues<dim,spacedim>::reinit (const TriaIterator<DoFCellAccessor<DH, lda> > cell,
+                                const FEValues<dim,spacedim> &other)
+{
+  typedef FEValuesBase<dim,spacedim> FEVB;
+  Assert (static_cast<const FiniteElementData<dim>&>(*this->fe) ==
+          static_cast<const FiniteElementData<dim>&>(cell->get_fe()),
+          typename FEVB::ExcFEDontMatch());
+  Assert (can_reuse_mapping_data (cell, other),
+          ExcMessage ("The given FEValues object can not provide the mapping "
+                      "data for this cell."));
+
+  this->maybe_invalidate_previous_present_cell (cell);
+  this->check_cell_similarity(cell);
+
+  reset_pointer_in_place_if_possible<typename FEValuesBase<dim,spacedim>::template CellIterator<TriaIterator<DoFCellAccessor<DH, lda> > > >
+  (this->present_cell, cell);
+
+  do_reinit (other);
+}
+
+
+
+template <int dim, int spacedim>
+void FEValues<dim,spacedim>::do_reinit (const FEValues<dim,spacedim> &other)
+{
+  // copy the fields the mapping filled for the other object on the same
+  // cell
+  if (this->update_flags & update_quadrature_points)
+    this->quadrature_points = other.quadrature_points;
+  if (this->update_flags & update_JxW_values)
+    this->JxW_values = other.JxW_values;
+  if (this->update_flags & update_jacobians)
+    this->jacobians = other.jacobians;
+  if (this->update_flags & update_jacobian_grads)
+    this->jacobian_grads = other.jacobian_grads;
+  if (this->update_flags & update_inverse_jacobians)
+    this->inverse_jacobians = other.inverse_jacobians;
+  if (this->update_flags & update_normal_vectors)
+    this->normal_vectors = other.normal_vectors;
+
+  // the shape functions of this object were computed on the previous cell
+  // this object was reinitialized on, so the similarity to that cell
+  // determines what the finite element can keep
+  this->get_fe().fill_fe_values(this->get_mapping(),
+                                *this->present_cell,
+                                quadrature,
+                                *other.mapping_data,
+                                *this->fe_data,
+                                *this,
+                                this->cell_similarity);
+
+  this->fe_data->clear_first_cell ();
+
+  // the mapping data of this object still describes an earlier cell, so
+  // it must not be reused on the next cell
+  this->cell_similarity = CellSimilarity::invalid_next_cell;
+  this->mapping_data_is_current = false;
 }
 
 
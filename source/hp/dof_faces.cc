@@ -24,6 +24,111 @@ namespace internal
   {
 // ---------------------- DoFObjects ----------------------------
 
+    template <int structdim>
+    template <int dim, int spacedim>
+    void
+    DoFIndicesOnFacesOrEdges<structdim>::
+    compress_data (const dealii::hp::FECollection<dim,spacedim> &fe_collection)
+    {
+      if (dof_offsets.size() == 0 || dofs.size() == 0)
+        return;
+
+      // walk the lists of all objects and copy them into a new array,
+      // replacing consecutively numbered sets by their first index. the
+      // result can not be larger than the original array
+      std::vector<types::global_dof_index> new_dofs;
+      new_dofs.reserve (dofs.size());
+      std::vector<unsigned int> new_dof_offsets (dof_offsets.size(),
+                                                 numbers::invalid_unsigned_int);
+      for (unsigned int obj=0; obj<dof_offsets.size(); ++obj)
+        if (dof_offsets[obj] != numbers::invalid_unsigned_int)
+          {
+            new_dof_offsets[obj] = new_dofs.size();
+
+            const types::global_dof_index *pointer = &dofs[dof_offsets[obj]];
+            while (*pointer != numbers::invalid_dof_index)
+              {
+                const unsigned int fe_index = *pointer;
+                Assert (fe_index < fe_collection.size(),
+                        ExcMessage ("The dof indices have already been compressed"));
+                const unsigned int n_dofs
+                  = fe_collection[fe_index].template n_dofs_per_object<structdim>();
+
+                bool compressible = (n_dofs > 1);
+                for (unsigned int i=1; (i<n_dofs) && compressible; ++i)
+                  if (pointer[1+i] != pointer[i]+1)
+                    compressible = false;
+
+                if (compressible == true)
+                  {
+                    new_dofs.push_back (numbers::invalid_dof_index-1-fe_index);
+                    new_dofs.push_back (pointer[1]);
+                  }
+                else
+                  new_dofs.insert (new_dofs.end(), pointer, pointer+1+n_dofs);
+
+                pointer += n_dofs+1;
+              }
+            new_dofs.push_back (numbers::invalid_dof_index);
+          }
+
+      // release the memory of the old array rather than keeping the
+      // reserved capacity
+      std::vector<types::global_dof_index> (new_dofs.begin(),
+                                            new_dofs.end()).swap (dofs);
+      dof_offsets.swap (new_dof_offsets);
+    }
+
+
+
+    template <int structdim>
+    template <int dim, int spacedim>
+    void
+    DoFIndicesOnFacesOrEdges<structdim>::
+    uncompress_data (const dealii::hp::FECollection<dim,spacedim> &fe_collection)
+    {
+      if (dof_offsets.size() == 0 || dofs.size() == 0)
+        return;
+
+      std::vector<types::global_dof_index> new_dofs;
+      std::vector<unsigned int> new_dof_offsets (dof_offsets.size(),
+                                                 numbers::invalid_unsigned_int);
+      for (unsigned int obj=0; obj<dof_offsets.size(); ++obj)
+        if (dof_offsets[obj] != numbers::invalid_unsigned_int)
+          {
+            new_dof_offsets[obj] = new_dofs.size();
+
+            const types::global_dof_index *pointer = &dofs[dof_offsets[obj]];
+            while (*pointer != numbers::invalid_dof_index)
+              {
+                bool compressed;
+                const unsigned int fe_index
+                  = decode_fe_index (*pointer, fe_collection.size(), compressed);
+                const unsigned int n_dofs
+                  = fe_collection[fe_index].template n_dofs_per_object<structdim>();
+
+                new_dofs.push_back (fe_index);
+                if (compressed == true)
+                  {
+                    for (unsigned int i=0; i<n_dofs; ++i)
+                      new_dofs.push_back (pointer[1]+i);
+                    pointer += 2;
+                  }
+                else
+                  {
+                    new_dofs.insert (new_dofs.end(), pointer+1, pointer+1+n_dofs);
+                    pointer += n_dofs+1;
+                  }
+              }
+            new_dofs.push_back (numbers::invalid_dof_index);
+          }
+
+      dofs.swap (new_dofs);
+      dof_offsets.swap (new_dof_offsets);
+    }
+
+
+
     template <int structdim>
     std::size_t
     DoFIndicesOnFacesOrEdges<structdim>::memory_consumption () const
@@ -34,6 +139,32 @@ namespace internal
 
 
     // explicit instantiations
+    template
+    void
+    DoFIndicesOnFacesOrEdges<1>::compress_data (const dealii::hp::FECollection<2,2> &);
+    template
+    void
+    DoFIndicesOnFacesOrEdges<1>::compress_data (const dealii::hp::FECollection<2,3> &);
+    template
+    void
+    DoFIndicesOnFacesOrEdges<1>::compress_data (const dealii::hp::FECollection<3,3> &);
+    template
+    void
+    DoFIndicesOnFacesOrEdges<2>::compress_data (const dealii::hp::FECollection<3,3> &);
+
+    template
+    void
+    DoFIndicesOnFacesOrEdges<1>::uncompress_data (const dealii::hp::FECollection<2,2> &);
+    template
+    void
+    DoFIndicesOnFacesOrEdges<1>::uncompress_data (const dealii::hp::FECollection<2,3> &);
+    template
+    void
+    DoFIndicesOnFacesOrEdges<1>::uncompress_data (const dealii::hp::FECollection<3,3> &);
+    template
+    void
+    DoFIndicesOnFacesOrEdges<2>::uncompress_data (const dealii::hp::FECollection<3,3> &);
+
     template
     std::size_t
     DoFIndicesOnFacesOrEdges<1>::memory_consumption () const;
@@ -57,6 +188,24 @@ namespace internal
 
 
 
+    template <int spacedim>
+    void
+    DoFIndicesOnFaces<2>::compress_data (const dealii::hp::FECollection<2,spacedim> &fe_collection)
+    {
+      lines.compress_data (fe_collection);
+    }
+
+
+
+    template <int spacedim>
+    void
+    DoFIndicesOnFaces<2>::uncompress_data (const dealii::hp::FECollection<2,spacedim> &fe_collection)
+    {
+      lines.uncompress_data (fe_collection);
+    }
+
+
+
     std::size_t
     DoFIndicesOnFaces<2>::memory_consumption () const
     {
@@ -65,6 +214,26 @@ namespace internal
 
 
 
+    template <int spacedim>
+    void
+    DoFIndicesOnFaces<3>::compress_data (const dealii::hp::FECollection<3,spacedim> &fe_collection)
+    {
+      lines.compress_data (fe_collection);
+      quads.compress_data (fe_collection);
+    }
+
+
+
+    template <int spacedim>
+    void
+    DoFIndicesOnFaces<3>::uncompress_data (const dealii::hp::FECollection<3,spacedim> &fe_collection)
+    {
+      lines.uncompress_data (fe_collection);
+      quads.uncompress_data (fe_collection);
+    }
+
+
+
     std::size_t
     DoFIndicesOnFaces<3>::memory_consumption () const
     {
@@ -72,6 +241,28 @@ namespace internal
               MemoryConsumption::memory_consumption (quads) );
     }
 
+
+    // explicit instantiations
+    template
+    void
+    DoFIndicesOnFaces<2>::compress_data (const dealii::hp::FECollection<2,2> &);
+    template
+    void
+    DoFIndicesOnFaces<2>::compress_data (const dealii::hp::FECollection<2,3> &);
+    template
+    void
+    DoFIndicesOnFaces<3>::compress_data (const dealii::hp::FECollection<3,3> &);
+
+    template
+    void
+    DoFIndicesOnFaces<2>::uncompress_data (const dealii::hp::FECollection<2,2> &);
+    template
+    void
+    DoFIndicesOnFaces<2>::uncompress_data (const dealii::hp::FECollection<2,3> &);
+    template
+    void
+    DoFIndicesOnFaces<3>::uncompress_data (const dealii::hp::FECollection<3,3> &);
+
   }
 }
 
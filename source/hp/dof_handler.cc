@@ -541,8 +541,11 @@ namespace internal
             std::vector<std::vector<DoFLevel::active_fe_index_type> >
             active_fe_backup(dof_handler.levels.size ());
             for (unsigned int level = 0; level<dof_handler.levels.size (); ++level)
-              std::swap (dof_handler.levels[level]->active_fe_indices,
-                         active_fe_backup[level]);
+              {
+                dof_handler.levels[level]->normalize_active_fe_indices ();
+                std::swap (dof_handler.levels[level]->active_fe_indices,
+                           active_fe_backup[level]);
+              }
 
             // delete all levels and set them up
             // newly, since vectors are
@@ -667,8 +670,11 @@ namespace internal
             std::vector<std::vector<DoFLevel::active_fe_index_type> >
             active_fe_backup(dof_handler.levels.size ());
             for (unsigned int level = 0; level<dof_handler.levels.size (); ++level)
-              std::swap (dof_handler.levels[level]->active_fe_indices,
-                         active_fe_backup[level]);
+              {
+                dof_handler.levels[level]->normalize_active_fe_indices ();
+                std::swap (dof_handler.levels[level]->active_fe_indices,
+                           active_fe_backup[level]);
+              }
 
             // delete all levels and set them up
             // newly, since vectors are
@@ -1043,8 +1049,11 @@ namespace internal
             std::vector<std::vector<DoFLevel::active_fe_index_type> >
             active_fe_backup(dof_handler.levels.size ());
             for (unsigned int level = 0; level<dof_handler.levels.size (); ++level)
-              std::swap (dof_handler.levels[level]->active_fe_indices,
-                         active_fe_backup[level]);
+              {
+                dof_handler.levels[level]->normalize_active_fe_indices ();
+                std::swap (dof_handler.levels[level]->active_fe_indices,
+                           active_fe_backup[level]);
+              }
 
             // delete all levels and set them up
             // newly, since vectors are
@@ -2746,9 +2755,9 @@ namespace hp
       = std::vector<IndexSet> (1,
                                number_cache.locally_owned_dofs);
 
-    // update the cache used for cell dof indices and compress the data on the levels. do
-    // the latter on separate tasks to gain parallelism, starting with the highest
-    // level (there is most to do there, so start it first)
+    // update the cache used for cell dof indices and compress the data on the levels
+    // and on faces and edges. do the latter on separate tasks to gain parallelism,
+    // starting with the highest level (there is most to do there, so start it first)
     for (active_cell_iterator cell = begin_active();
          cell != end(); ++cell)
       cell->update_cell_dof_indices_cache ();
@@ -2758,6 +2767,9 @@ namespace hp
       for (int level=levels.size()-1; level>=0; --level)
         tg += Threads::new_task (&dealii::internal::hp::DoFLevel::compress_data<dim,spacedim>,
                                  *levels[level], *finite_elements);
+      if (faces != 0)
+        tg += Threads::new_task (&dealii::internal::hp::DoFIndicesOnFaces<dim>::template compress_data<spacedim>,
+                                 *faces, *finite_elements);
       tg.join_all ();
     }
 
@@ -2797,7 +2809,7 @@ namespace hp
       }
 #endif
 
-    // uncompress the internal storage scheme of dofs on cells
+    // uncompress the internal storage scheme of dofs on cells, faces and edges
     // so that we can access dofs in turns. uncompress in parallel, starting
     // with the most expensive levels (the highest ones)
     {
@@ -2805,6 +2817,9 @@ namespace hp
       for (int level=levels.size()-1; level>=0; --level)
         tg += Threads::new_task (&dealii::internal::hp::DoFLevel::uncompress_data<dim,spacedim>,
                                  *levels[level], *finite_elements);
+      if (faces != 0)
+        tg += Threads::new_task (&dealii::internal::hp::DoFIndicesOnFaces<dim>::template uncompress_data<spacedim>,
+                                 *faces, *finite_elements);
       tg.join_all ();
     }
 
@@ -2822,6 +2837,9 @@ namespace hp
       for (int level=levels.size()-1; level>=0; --level)
         tg += Threads::new_task (&dealii::internal::hp::DoFLevel::compress_data<dim,spacedim>,
                                  *levels[level], *finite_elements);
+      if (faces != 0)
+        tg += Threads::new_task (&dealii::internal::hp::DoFIndicesOnFaces<dim>::template compress_data<spacedim>,
+                                 *faces, *finite_elements);
       tg.join_all ();
     }
   }
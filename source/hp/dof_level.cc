@@ -28,8 +28,6 @@ namespace internal
     void
     DoFLevel::compress_data (const dealii::hp::FECollection<dim,spacedim> &fe_collection)
     {
-      return;
-
       if (dof_offsets.size() == 0 || dof_indices.size()==0)
         return;
 
@@ -77,9 +75,11 @@ namespace internal
         else
           ++cell;
 
-      // now allocate the new array and copy into it whatever we need
+      // now allocate the new array and copy into it whatever we need. the
+      // offsets of the cells change along the way
       std::vector<types::global_dof_index> new_dof_indices;
       new_dof_indices.reserve(new_size);
+      std::vector<offset_type> new_dof_offsets (dof_offsets.size(), (offset_type)(-1));
       for (unsigned int cell=0; cell<dof_offsets.size(); )
         // see if this cell is active on the current level
         if (dof_offsets[cell] != (offset_type)(-1))
@@ -97,6 +97,9 @@ namespace internal
             Assert (next_offset-dof_offsets[cell] == fe_collection[active_fe_indices[cell]].template n_dofs_per_object<dim>(),
                     ExcInternalError());
 
+            // set offset for this cell
+            new_dof_offsets[cell] = new_dof_indices.size();
+
             // see if the range of dofs for this cell can be compressed and if so
             // how many slots we have to store for them
             if (next_offset > dof_offsets[cell])
@@ -136,6 +139,7 @@ namespace internal
       // finally swap old and new content
       Assert (new_dof_indices.size() == new_size, ExcInternalError());
       dof_indices.swap (new_dof_indices);
+      dof_offsets.swap (new_dof_offsets);
     }
 
 
@@ -144,8 +148,6 @@ namespace internal
     void
     DoFLevel::uncompress_data(const dealii::hp::FECollection<dim,spacedim> &fe_collection)
     {
-      return;
-
       if (dof_offsets.size() == 0 || dof_indices.size()==0)
         return;
 
@@ -195,8 +197,11 @@ namespace internal
                 // apparently so. uncompress
                 Assert (next_offset-dof_offsets[cell] == 1,
                         ExcInternalError());
-                for (unsigned int i=0; i<fe_collection[active_fe_indices[cell]].template n_dofs_per_object<dim>(); ++i)
+                for (unsigned int i=0; i<fe_collection[active_fe_index(cell)].template n_dofs_per_object<dim>(); ++i)
                   new_dof_indices.push_back (dof_indices[dof_offsets[cell]]+i);
+
+                // then mark the uncompression
+                active_fe_indices[cell] = active_fe_index(cell);
               }
 
             // then move on to the next cell
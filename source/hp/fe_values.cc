@@ -66,6 +66,40 @@ namespace internal
 
 
 
+    template <int dim, int q_dim, class FEValues>
+    FEValuesBase<dim,q_dim,FEValues>::
+    FEValuesBase (const FEValuesBase<dim,q_dim,FEValues> &other)
+      :
+      fe_collection (other.fe_collection),
+      mapping_collection (other.mapping_collection),
+      q_collection (other.q_collection),
+      fe_values_table (other.fe_values_table.size(0),
+                       other.fe_values_table.size(1),
+                       other.fe_values_table.size(2)),
+      present_fe_values_index (numbers::invalid_unsigned_int,
+                               numbers::invalid_unsigned_int,
+                               numbers::invalid_unsigned_int),
+      update_flags (other.update_flags)
+    {}
+
+
+
+    template <int dim, int q_dim, class FEValues>
+    void
+    FEValuesBase<dim,q_dim,FEValues>::precalculate_fe_values ()
+    {
+      // use the same defaults as the reinit() functions of the derived
+      // classes when called for a cell with the given active_fe_index
+      const TableIndices<3> present_index = present_fe_values_index;
+      for (unsigned int fe_index=0; fe_index<fe_collection->size(); ++fe_index)
+        select_fe_values (fe_index,
+                          mapping_collection->size() > 1 ? fe_index : 0,
+                          q_collection.size() > 1 ? fe_index : 0);
+      present_fe_values_index = present_index;
+    }
+
+
+
     template <int dim, int q_dim, class FEValues>
     FEValues &
     FEValuesBase<dim,q_dim,FEValues>::
@@ -103,6 +137,18 @@ namespace internal
       // now there definitely is one!
       return *fe_values_table(present_fe_values_index);
     }
+
+
+
+    template <int dim, int q_dim, class FEValues>
+    const FEValues *
+    FEValuesBase<dim,q_dim,FEValues>::last_selected_fe_values () const
+    {
+      if (present_fe_values_index[0] == numbers::invalid_unsigned_int)
+        return 0;
+      else
+        return fe_values_table(present_fe_values_index).get();
+    }
   }
 }
 
@@ -181,10 +227,22 @@ namespace hp
 
     // now finally actually get the
     // corresponding object and
-    // initialize it
-    this->select_fe_values (real_fe_index,
-                            real_mapping_index,
-                            real_q_index).reinit (cell);
+    // initialize it. if the object
+    // used last was initialized on
+    // the same cell with the same
+    // mapping and quadrature, use
+    // what its mapping computed
+    // there
+    const dealii::FEValues<dim,spacedim> *previous
+      = this->last_selected_fe_values ();
+    dealii::FEValues<dim,spacedim> &fe_values
+      = this->select_fe_values (real_fe_index,
+                                real_mapping_index,
+                                real_q_index);
+    if ((previous != 0) && fe_values.can_reuse_mapping_data (cell, *previous))
+      fe_values.reinit (cell, *previous);
+    else
+      fe_values.reinit (cell);
   }
 
 
@@ -221,10 +279,22 @@ namespace hp
 
     // now finally actually get the
     // corresponding object and
-    // initialize it
-    this->select_fe_values (real_fe_index,
-                            real_mapping_index,
-                            real_q_index).reinit (cell);
+    // initialize it. if the object
+    // used last was initialized on
+    // the same cell with the same
+    // mapping and quadrature, use
+    // what its mapping computed
+    // there
+    const dealii::FEValues<dim,spacedim> *previous
+      = this->last_selected_fe_values ();
+    dealii::FEValues<dim,spacedim> &fe_values
+      = this->select_fe_values (real_fe_index,
+                                real_mapping_index,
+                                real_q_index);
+    if ((previous != 0) && fe_values.can_reuse_mapping_data (cell, *previous))
+      fe_values.reinit (cell, *previous);
+    else
+      fe_values.reinit (cell);
   }
 
 
@@ -15,6 +15,10 @@
 
 
 #include <deal.II/base/exceptions.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/std_cxx11/bind.h>
+#include <deal.II/base/thread_management.h>
 #include <deal.II/lac/exceptions.h>
 #include <deal.II/lac/sparsity_pattern.h>
 #include <deal.II/lac/sparsity_tools.h>
@@ -199,6 +203,60 @@ namespace SparsityTools
   }
 
 
+  namespace internal
+  {
+    /**
+     * Compute the number of entries of the rows in the half open range
+     * <code>[begin,end)</code> of the given sparsity pattern.
+     */
+    void
+    compute_coordination (const SparsityPattern                   &sparsity,
+                          const SparsityPattern::size_type         begin,
+                          const SparsityPattern::size_type         end,
+                          std::vector<SparsityPattern::size_type> &coordination)
+    {
+      for (SparsityPattern::size_type row=begin; row<end; ++row)
+        {
+          SparsityPattern::iterator j = sparsity.begin(row);
+          for ( ; j<sparsity.end(row); ++j)
+            if (j->is_valid_entry() == false)
+              break;
+          coordination[row] = j-sparsity.begin(row);
+        }
+    }
+
+
+
+    /**
+     * Collect the neighbors of the nodes <code>front[begin...end)</code>
+     * that have not been numbered yet into @p neighbors, sorted and without
+     * duplicates.
+     */
+    void
+    collect_unnumbered_neighbors (const SparsityPattern                         &sparsity,
+                                  const std::vector<SparsityPattern::size_type> &new_indices,
+                                  const std::vector<SparsityPattern::size_type> &front,
+                                  const SparsityPattern::size_type               begin,
+                                  const SparsityPattern::size_type               end,
+                                  std::vector<SparsityPattern::size_type>       &neighbors)
+    {
+      neighbors.clear ();
+      for (SparsityPattern::size_type i=begin; i<end; ++i)
+        for (SparsityPattern::iterator j=sparsity.begin(front[i]);
+             j<sparsity.end(front[i]); ++j)
+          if (j->is_valid_entry() == false)
+            break;
+          else if (new_indices[j->column()] == numbers::invalid_size_type)
+            neighbors.push_back (j->column());
+
+      std::sort (neighbors.begin(), neighbors.end());
+      neighbors.erase (std::unique (neighbors.begin(), neighbors.end()),
+                       neighbors.end());
+    }
+  }
+
+
+
   void
   reorder_Cuthill_McKee (const SparsityPattern                         &sparsity,
                          std::vector<SparsityPattern::size_type>       &new_indices,
@@ -228,9 +286,10 @@ namespace SparsityTools
           (last_round_dofs[i]>=sparsity.n_rows()))
         last_round_dofs[i] = numbers::invalid_size_type;
 
-    std::remove_if (last_round_dofs.begin(), last_round_dofs.end(),
-                    std::bind2nd(std::equal_to<SparsityPattern::size_type>(),
-                                 numbers::invalid_size_type));
+    last_round_dofs.erase (std::remove_if (last_round_dofs.begin(), last_round_dofs.end(),
+                                           std::bind2nd(std::equal_to<SparsityPattern::size_type>(),
+                                                        numbers::invalid_size_type)),
+                           last_round_dofs.end());
 
     // now if no valid points remain: find dof with lowest coordination number
     if (last_round_dofs.empty())
@@ -238,6 +297,18 @@ namespace SparsityTools
       .push_back (internal::find_unnumbered_starting_index (sparsity,
                                                             new_indices));
 
+    // the coordination number, i.e., the number of entries, of each row.
+    // compute it once up front, in parallel, rather than every time a dof
+    // is part of a front
+    std::vector<SparsityPattern::size_type> coordination (sparsity.n_rows());
+    parallel::apply_to_subranges (static_cast<SparsityPattern::size_type>(0),
+                                  sparsity.n_rows(),
+                                  std_cxx11::bind (&internal::compute_coordination,
+                                                   std_cxx11::cref(sparsity),
+                                                   std_cxx11::_1, std_cxx11::_2,
+                                                   std_cxx11::ref(coordination)),
+                                  4096);
+
     // store next free dof index
     SparsityPattern::size_type next_free_number = 0;
 
@@ -245,38 +316,57 @@ namespace SparsityTools
     for (SparsityPattern::size_type i=0; i!=last_round_dofs.size(); ++i)
       new_indices[last_round_dofs[i]] = next_free_number++;
 
+    // fronts with more than this many dofs are split into chunks whose
+    // neighbors are collected on separate tasks. this only reads
+    // new_indices, which is written only once all neighbors are known
+    const SparsityPattern::size_type min_chunk_size = 2048;
+    std::vector<std::vector<SparsityPattern::size_type> > chunk_neighbors;
+    std::vector<std::pair<SparsityPattern::size_type,SparsityPattern::size_type> >
+    dofs_by_coordination;
+
     // now do as many steps as needed to
     // renumber all dofs
     while (true)
       {
         // store the indices of the dofs to be
-        // renumbered in the next round
+        // renumbered in the next round, i.e., the
+        // as yet unnumbered neighbors of the dofs
+        // numbered in the last round, in
+        // ascending order
         std::vector<SparsityPattern::size_type> next_round_dofs;
 
-        // find all neighbors of the
-        // dofs numbered in the last
-        // round
-        for (SparsityPattern::size_type i=0; i<last_round_dofs.size(); ++i)
-          for (SparsityPattern::iterator j=sparsity.begin(last_round_dofs[i]);
-               j<sparsity.end(last_round_dofs[i]); ++j)
-            if (j->is_valid_entry() == false)
-              break;
-            else
-              next_round_dofs.push_back (j->column());
-
-        // sort dof numbers
-        std::sort (next_round_dofs.begin(), next_round_dofs.end());
-
-        // delete multiple entries
-        std::vector<SparsityPattern::size_type>::iterator end_sorted;
-        end_sorted = std::unique (next_round_dofs.begin(), next_round_dofs.end());
-        next_round_dofs.erase (end_sorted, next_round_dofs.end());
-
-        // eliminate dofs which are
-        // already numbered
-        for (int s=next_round_dofs.size()-1; s>=0; --s)
-          if (new_indices[next_round_dofs[s]] != numbers::invalid_size_type)
-            next_round_dofs.erase (next_round_dofs.begin() + s);
+        const unsigned int n_chunks
+          = std::max (std::min (static_cast<SparsityPattern::size_type>
+                                (multithread_info.n_threads()),
+                                static_cast<SparsityPattern::size_type>
+                                (last_round_dofs.size() / min_chunk_size)),
+                      static_cast<SparsityPattern::size_type>(1));
+        if (n_chunks == 1)
+          internal::collect_unnumbered_neighbors (sparsity, new_indices,
+                                                  last_round_dofs,
+                                                  0, last_round_dofs.size(),
+                                                  next_round_dofs);
+        else
+          {
+            chunk_neighbors.resize (n_chunks);
+            Threads::TaskGroup<> tasks;
+            for (unsigned int c=0; c<n_chunks; ++c)
+              tasks += Threads::new_task (&internal::collect_unnumbered_neighbors,
+                                          sparsity, new_indices, last_round_dofs,
+                                          last_round_dofs.size() * c / n_chunks,
+                                          last_round_dofs.size() * (c+1) / n_chunks,
+                                          chunk_neighbors[c]);
+            tasks.join_all ();
+
+            for (unsigned int c=0; c<n_chunks; ++c)
+              next_round_dofs.insert (next_round_dofs.end(),
+                                      chunk_neighbors[c].begin(),
+                                      chunk_neighbors[c].end());
+            std::sort (next_round_dofs.begin(), next_round_dofs.end());
+            next_round_dofs.erase (std::unique (next_round_dofs.begin(),
+                                                next_round_dofs.end()),
+                                   next_round_dofs.end());
+          }
 
         // check whether there are
         // any new dofs in the
@@ -291,10 +381,7 @@ namespace SparsityTools
         // do next
         if (next_round_dofs.empty())
           {
-            if (std::find (new_indices.begin(), new_indices.end(),
-                           numbers::invalid_size_type)
-                ==
-                new_indices.end())
+            if (next_free_number == sparsity.n_rows())
               // no unnumbered
               // indices, so we can
               // leave now
@@ -328,40 +415,25 @@ namespace SparsityTools
 
 
 
-        // store for each coordination
-        // number the dofs with these
-        // coordination number
-        std::multimap<SparsityPattern::size_type, int> dofs_by_coordination;
-
-        // find coordination number for
-        // each of these dofs
-        for (std::vector<SparsityPattern::size_type>::iterator s=next_round_dofs.begin();
-             s!=next_round_dofs.end(); ++s)
-          {
-            SparsityPattern::size_type coordination = 0;
-            for (SparsityPattern::iterator j=sparsity.begin(*s);
-                 j<sparsity.end(*s); ++j)
-              if (j->is_valid_entry() == false)
-                break;
-              else
-                ++coordination;
-
-            // insert this dof at its
-            // coordination number
-            const std::pair<const SparsityPattern::size_type, int> new_entry (coordination, *s);
-            dofs_by_coordination.insert (new_entry);
-          }
+        // sort the dofs of the present front by
+        // their coordination number. dofs with the
+        // same coordination number stay in
+        // ascending order
+        dofs_by_coordination.resize (next_round_dofs.size());
+        for (SparsityPattern::size_type s=0; s<next_round_dofs.size(); ++s)
+          dofs_by_coordination[s] = std::make_pair (coordination[next_round_dofs[s]],
+                                                    next_round_dofs[s]);
+        std::sort (dofs_by_coordination.begin(), dofs_by_coordination.end());
 
         // assign new DoF numbers to
         // the elements of the present
         // front:
-        std::multimap<SparsityPattern::size_type, int>::iterator i;
-        for (i = dofs_by_coordination.begin(); i!=dofs_by_coordination.end(); ++i)
-          new_indices[i->second] = next_free_number++;
+        for (SparsityPattern::size_type s=0; s<dofs_by_coordination.size(); ++s)
+          new_indices[dofs_by_coordination[s].second] = next_free_number++;
 
         // after that: copy this round's
         // dofs for the next round
-        last_round_dofs = next_round_dofs;
+        last_round_dofs.swap (next_round_dofs);
       }
 
     // test for all indices
@@ -25,6 +25,8 @@
 #include <deal.II/lac/trilinos_vector.h>
 #include <deal.II/lac/trilinos_block_vector.h>
 
+#include <algorithm>
+
 DEAL_II_NAMESPACE_OPEN
 
 
@@ -34,11 +36,41 @@ typename GrowingVectorMemory<VECTOR>::Pool GrowingVectorMemory<VECTOR>::pool;
 template <typename VECTOR>
 Threads::Mutex GrowingVectorMemory<VECTOR>::mutex;
 
+template <typename VECTOR>
+const unsigned int GrowingVectorMemory<VECTOR>::max_n_cached_vectors;
+
+template <typename VECTOR>
+inline
+GrowingVectorMemory<VECTOR>::Statistics::Statistics()
+  :
+  n_thread_local_hits(0),
+  n_shared_hits(0),
+  n_misses(0),
+  max_n_vectors(0)
+{}
+
+
+
+template <typename VECTOR>
+inline
+GrowingVectorMemory<VECTOR>::ThreadCache::ThreadCache()
+  :
+  generation(0)
+{
+  n_thread_local_hits = 0;
+  n_shared_hits = 0;
+  n_misses = 0;
+}
+
+
+
 template <typename VECTOR>
 inline
 GrowingVectorMemory<VECTOR>::Pool::Pool()
   :
-  data(0)
+  data(0),
+  generation(0),
+  max_n_vectors(0)
 {}
 
 
@@ -53,7 +85,9 @@ GrowingVectorMemory<VECTOR>::Pool::~Pool()
   // First, delete all remaining
   // vectors. Actually, there should
   // be none, if there is no memory
-  // leak
+  // leak. the vectors in the caches
+  // of the threads are part of the
+  // list as well
   for (typename std::vector<entry_type>::iterator i=data->begin();
        i != data->end();
        ++i)
@@ -80,20 +114,46 @@ GrowingVectorMemory<VECTOR>::Pool::initialize(const size_type size)
           i->first = false;
           i->second = new VECTOR;
         }
+      max_n_vectors = size;
     }
 }
 
 
+
+template <typename VECTOR>
+inline
+void
+GrowingVectorMemory<VECTOR>::Pool::release_thread_cache (ThreadCache &cache)
+{
+  cache.generation = generation;
+  if (cache.vectors.size() == 0)
+    return;
+
+  std::vector<entry_type> new_data;
+  for (typename std::vector<entry_type>::const_iterator
+       i = data->begin(); i != data->end(); ++i)
+    if (std::find (cache.vectors.begin(), cache.vectors.end(),
+                   i->second) != cache.vectors.end())
+      delete i->second;
+    else
+      new_data.push_back (*i);
+
+  data->swap (new_data);
+  cache.vectors.clear();
+}
+
+
 template <typename VECTOR>
 inline
 GrowingVectorMemory<VECTOR>::GrowingVectorMemory (const size_type initial_size,
                                                   const bool log_statistics)
 
   :
-  total_alloc(0),
-  current_alloc(0),
   log_statistics(log_statistics)
 {
+  total_alloc = 0;
+  current_alloc = 0;
+
   Threads::Mutex::ScopedLock lock(mutex);
   pool.initialize(initial_size);
 }
@@ -121,9 +181,26 @@ inline
 VECTOR *
 GrowingVectorMemory<VECTOR>::alloc ()
 {
-  Threads::Mutex::ScopedLock lock(mutex);
   ++total_alloc;
   ++current_alloc;
+
+  // first see if this thread has a
+  // free vector of its own, which
+  // needs no lock
+  ThreadCache &cache = pool.thread_caches.get();
+  if (cache.generation == pool.generation &&
+      cache.vectors.size() > 0)
+    {
+      VECTOR *const v = cache.vectors.back();
+      cache.vectors.pop_back();
+      ++cache.n_thread_local_hits;
+      return v;
+    }
+
+  Threads::Mutex::ScopedLock lock(mutex);
+  if (cache.generation != pool.generation)
+    pool.release_thread_cache (cache);
+
   // see if there is a free vector
   // available in our list
   for (typename std::vector<entry_type>::iterator i=pool.data->begin();
@@ -132,6 +209,7 @@ GrowingVectorMemory<VECTOR>::alloc ()
       if (i->first == false)
         {
           i->first = true;
+          ++cache.n_shared_hits;
           return (i->second);
         }
     }
@@ -140,6 +218,8 @@ GrowingVectorMemory<VECTOR>::alloc ()
   // just allocate a new one
   const entry_type t (true, new VECTOR);
   pool.data->push_back(t);
+  pool.max_n_vectors = std::max (pool.max_n_vectors, pool.data->size());
+  ++cache.n_misses;
 
   return t.second;
 }
@@ -151,18 +231,55 @@ inline
 void
 GrowingVectorMemory<VECTOR>::free(const VECTOR *const v)
 {
-  Threads::Mutex::ScopedLock lock(mutex);
-  for (typename std::vector<entry_type>::iterator i=pool.data->begin();
-       i != pool.data->end(); ++i)
-    {
-      if (v == (i->second))
+#ifdef DEBUG
+  {
+    Threads::Mutex::ScopedLock lock(mutex);
+    bool found = false;
+    for (typename std::vector<entry_type>::const_iterator i=pool.data->begin();
+         i != pool.data->end(); ++i)
+      if (v == i->second)
         {
-          i->first = false;
-          --current_alloc;
-          return;
+          Assert (i->first == true,
+                  typename VectorMemory<VECTOR>::ExcNotAllocatedHere());
+          found = true;
+          break;
         }
+    Assert (found, typename VectorMemory<VECTOR>::ExcNotAllocatedHere());
+  }
+#endif
+
+  --current_alloc;
+
+  // keep the vector in the cache of
+  // this thread, whose vectors are
+  // still marked as used in the
+  // shared pool
+  ThreadCache &cache = pool.thread_caches.get();
+  cache.vectors.push_back (const_cast<VECTOR *>(v));
+  if (cache.generation != pool.generation)
+    {
+      Threads::Mutex::ScopedLock lock(mutex);
+      pool.release_thread_cache (cache);
+    }
+  else if (cache.vectors.size() > max_n_cached_vectors)
+    {
+      // the cache is full. give the
+      // vector that has been in it
+      // longest back to the shared
+      // pool, where other threads can
+      // find it
+      VECTOR *const oldest = cache.vectors.front();
+      cache.vectors.erase (cache.vectors.begin());
+
+      Threads::Mutex::ScopedLock lock(mutex);
+      for (typename std::vector<entry_type>::iterator i=pool.data->begin();
+           i != pool.data->end(); ++i)
+        if (i->second == oldest)
+          {
+            i->first = false;
+            break;
+          }
     }
-  Assert(false, typename VectorMemory<VECTOR>::ExcNotAllocatedHere());
 }
 
 
@@ -188,7 +305,44 @@ GrowingVectorMemory<VECTOR>::release_unused_memory ()
           new_data.push_back (*i);
 
       *pool.data = new_data;
+
+      // the vectors in the caches of
+      // the threads are marked as used;
+      // release those of this thread
+      // right away and tell the other
+      // threads to release theirs
+      ++pool.generation;
+      pool.release_thread_cache (pool.thread_caches.get());
+    }
+}
+
+
+
+template<typename VECTOR>
+typename GrowingVectorMemory<VECTOR>::Statistics
+GrowingVectorMemory<VECTOR>::get_statistics ()
+{
+  Threads::Mutex::ScopedLock lock(mutex);
+
+  Statistics statistics;
+#ifdef DEAL_II_WITH_THREADS
+  typedef tbb::enumerable_thread_specific<ThreadCache> Caches;
+  Caches &caches = pool.thread_caches.get_implementation();
+  for (typename Caches::const_iterator c = caches.begin(); c != caches.end(); ++c)
+    {
+      statistics.n_thread_local_hits += c->n_thread_local_hits;
+      statistics.n_shared_hits += c->n_shared_hits;
+      statistics.n_misses += c->n_misses;
     }
+#else
+  const ThreadCache &cache = pool.thread_caches.get();
+  statistics.n_thread_local_hits = cache.n_thread_local_hits;
+  statistics.n_shared_hits = cache.n_shared_hits;
+  statistics.n_misses = cache.n_misses;
+#endif
+  statistics.max_n_vectors = pool.max_n_vectors;
+
+  return statistics;
 }
 
 
@@ -0,0 +1,864 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/thread_local_storage.h>
+#include <deal.II/base/memory_consumption.h>
+#include <deal.II/base/std_cxx11/bind.h>
+#include <deal.II/lac/vector_memory.h>
+#include <deal.II/lac/compressed_simple_sparsity_pattern.h>
+#include <deal.II/multigrid/mg_algebraic.h>
+
+#include <algorithm>
+#include <cmath>
+
+DEAL_II_NAMESPACE_OPEN
+
+
+namespace internal
+{
+  namespace AlgebraicMultigrid
+  {
+    typedef types::global_dof_index size_type;
+
+    /**
+     * Number of rows below which the loops over rows are not split further
+     * among threads.
+     */
+    const unsigned int minimum_parallel_grain_size = 512;
+
+    /**
+     * Marker for unknowns that are not (yet) part of an aggregate.
+     */
+    const unsigned int no_aggregate = numbers::invalid_unsigned_int;
+
+
+
+    /**
+     * Number of steps of the power iteration that estimates the largest
+     * eigenvalue of $D^{-1}A$.
+     */
+    const unsigned int n_power_iterations = 20;
+
+
+
+    /**
+     * Extract the diagonal of a matrix.
+     */
+    void
+    compute_diagonal_on_subrange (const size_type             begin,
+                                  const size_type             end,
+                                  const ::dealii::SparseMatrix<double> &matrix,
+                                  std::vector<double>        &diagonal)
+    {
+      for (size_type row=begin; row<end; ++row)
+        diagonal[row] = matrix.diag_element(row);
+    }
+
+
+
+    /**
+     * Estimate the largest eigenvalue of $D^{-1}A$ by the power iteration.
+     * The estimate is from below, but much closer to the eigenvalue than
+     * Gershgorin's bound, which overestimates it considerably on the coarse
+     * levels. A bound that is too large damps the prolongation too much,
+     * and the convergence then deteriorates with every additional level.
+     */
+    double
+    estimate_max_eigenvalue (const ::dealii::SparseMatrix<double> &matrix,
+                             const std::vector<double>  &diagonal,
+                             const unsigned int          n_iterations)
+    {
+      const size_type n = matrix.m();
+      ::dealii::Vector<double> inverse_diagonal (n), x (n), y (n);
+      for (size_type i=0; i<n; ++i)
+        {
+          inverse_diagonal(i) = (diagonal[i] != 0. ? 1./diagonal[i] : 0.);
+          // a start vector that is neither smooth nor oscillating, so that
+          // it has components in all eigenvectors
+          x(i) = 1. + (i*7919 % 13) / 13.;
+        }
+
+      double eigenvalue = 0;
+      for (unsigned int it=0; it<n_iterations; ++it)
+        {
+          x /= x.l2_norm();
+          matrix.vmult (y, x);
+          y.scale (inverse_diagonal);
+          eigenvalue = y.l2_norm();
+          if (eigenvalue == 0.)
+            break;
+          x.swap (y);
+        }
+      return eigenvalue;
+    }
+
+
+
+    /**
+     * Return whether the entry @p value in a row with diagonal @p d_i and
+     * column with diagonal @p d_j is a strong coupling.
+     */
+    inline
+    bool
+    is_strong (const double value,
+               const double d_i,
+               const double d_j,
+               const double threshold)
+    {
+      return (value != 0. &&
+              std::fabs(value) >= threshold * std::sqrt(std::fabs(d_i*d_j)));
+    }
+
+
+
+    /**
+     * Aggregate the unknowns of the blocks <tt>[begin,end)</tt> of
+     * @p block_size unknowns each, considering only couplings within
+     * the same block. The aggregates are numbered starting from zero within
+     * each block, and their number is written into @p n_aggregates.
+     */
+    void
+    aggregate_on_subrange (const size_type             begin_block,
+                           const size_type             end_block,
+                           const ::dealii::SparseMatrix<double> &matrix,
+                           const std::vector<double>  &diagonal,
+                           const double                threshold,
+                           const size_type             block_size,
+                           std::vector<unsigned int>  &aggregates,
+                           std::vector<unsigned int>  &n_aggregates)
+    {
+      const size_type n = matrix.m();
+      std::vector<unsigned int> phase_two;
+      for (size_type block=begin_block; block<end_block; ++block)
+        {
+          const size_type begin = block * block_size;
+          const size_type end = std::min (n, begin + block_size);
+          unsigned int n_local = 0;
+
+          // unknowns without any strong coupling are not aggregated; mark
+          // all others as candidates
+          std::vector<bool> has_strong (end-begin, false);
+          for (size_type i=begin; i<end; ++i)
+            for (::dealii::SparseMatrix<double>::const_iterator
+                 p = matrix.begin(i); p != matrix.end(i); ++p)
+              if (p->column() != i &&
+                  is_strong (p->value(), diagonal[i], diagonal[p->column()],
+                             threshold))
+                {
+                  has_strong[i-begin] = true;
+                  break;
+                }
+
+          // phase 1: form aggregates from unknowns all of whose strong
+          // neighbors are still free
+          for (size_type i=begin; i<end; ++i)
+            {
+              if (!has_strong[i-begin] || aggregates[i] != no_aggregate)
+                continue;
+              bool all_free = true;
+              bool any_neighbor = false;
+              for (::dealii::SparseMatrix<double>::const_iterator
+                   p = matrix.begin(i); p != matrix.end(i); ++p)
+                {
+                  const size_type j = p->column();
+                  if (j == i || j < begin || j >= end ||
+                      !is_strong (p->value(), diagonal[i], diagonal[j], threshold))
+                    continue;
+                  any_neighbor = true;
+                  if (aggregates[j] != no_aggregate)
+                    {
+                      all_free = false;
+                      break;
+                    }
+                }
+              if (!all_free || !any_neighbor)
+                continue;
+
+              aggregates[i] = n_local;
+              for (::dealii::SparseMatrix<double>::const_iterator
+                   p = matrix.begin(i); p != matrix.end(i); ++p)
+                {
+                  const size_type j = p->column();
+                  if (j != i && j >= begin && j < end &&
+                      is_strong (p->value(), diagonal[i], diagonal[j], threshold))
+                    aggregates[j] = n_local;
+                }
+              ++n_local;
+            }
+
+          // phase 2: attach the remaining unknowns to the aggregate of their
+          // strongest neighbor from phase 1
+          phase_two.assign (end-begin, no_aggregate);
+          for (size_type i=begin; i<end; ++i)
+            {
+              if (!has_strong[i-begin] || aggregates[i] != no_aggregate)
+                continue;
+              double strongest = 0;
+              for (::dealii::SparseMatrix<double>::const_iterator
+                   p = matrix.begin(i); p != matrix.end(i); ++p)
+                {
+                  const size_type j = p->column();
+                  if (j != i && j >= begin && j < end &&
+                      aggregates[j] != no_aggregate &&
+                      std::fabs(p->value()) > strongest &&
+                      is_strong (p->value(), diagonal[i], diagonal[j], threshold))
+                    {
+                      strongest = std::fabs(p->value());
+                      phase_two[i-begin] = aggregates[j];
+                    }
+                }
+            }
+          for (size_type i=begin; i<end; ++i)
+            if (phase_two[i-begin] != no_aggregate)
+              aggregates[i] = phase_two[i-begin];
+
+          // phase 3: form new aggregates from what is left, which are
+          // unknowns whose strong neighbors lie in other blocks or are
+          // isolated from the aggregates of phase 1
+          for (size_type i=begin; i<end; ++i)
+            {
+              if (!has_strong[i-begin] || aggregates[i] != no_aggregate)
+                continue;
+              aggregates[i] = n_local;
+              for (::dealii::SparseMatrix<double>::const_iterator
+                   p = matrix.begin(i); p != matrix.end(i); ++p)
+                {
+                  const size_type j = p->column();
+                  if (j != i && j >= begin && j < end &&
+                      aggregates[j] == no_aggregate && has_strong[j-begin] &&
+                      is_strong (p->value(), diagonal[i], diagonal[j], threshold))
+                    aggregates[j] = n_local;
+                }
+              ++n_local;
+            }
+
+          n_aggregates[block] = n_local;
+        }
+    }
+
+
+
+    /**
+     * Compute the rows <tt>[begin,end)</tt> of the prolongation matrix
+     * $P = (I-\omega D^{-1}A)\hat P$, where $\hat P$ is the piecewise
+     * constant interpolation from the aggregates, normalized column by
+     * column. The entries of each row are returned sorted by column.
+     */
+    void
+    smooth_prolongation_on_subrange (const size_type                  begin,
+                                     const size_type                  end,
+                                     const ::dealii::SparseMatrix<double>      &matrix,
+                                     const std::vector<double>       &diagonal,
+                                     const std::vector<unsigned int> &aggregates,
+                                     const std::vector<double>       &tentative,
+                                     const double                     omega,
+                                     std::vector<std::vector<std::pair<unsigned int,double> > > &rows)
+    {
+      std::vector<std::pair<unsigned int,double> > entries;
+      for (size_type i=begin; i<end; ++i)
+        {
+          entries.clear();
+          if (aggregates[i] != no_aggregate)
+            entries.push_back (std::make_pair (aggregates[i], tentative[i]));
+          if (diagonal[i] != 0.)
+            {
+              const double factor = -omega / diagonal[i];
+              for (::dealii::SparseMatrix<double>::const_iterator
+                   p = matrix.begin(i); p != matrix.end(i); ++p)
+                if (aggregates[p->column()] != no_aggregate)
+                  entries.push_back (std::make_pair (aggregates[p->column()],
+                                                     factor * p->value() *
+                                                     tentative[p->column()]));
+            }
+          std::sort (entries.begin(), entries.end());
+
+          rows[i].clear();
+          for (unsigned int e=0; e<entries.size(); ++e)
+            if (rows[i].size() > 0 && rows[i].back().first == entries[e].first)
+              rows[i].back().second += entries[e].second;
+            else
+              rows[i].push_back (entries[e]);
+        }
+    }
+
+
+
+    /**
+     * Write the rows <tt>[begin,end)</tt> of the matrix given by @p rows
+     * into @p matrix, whose sparsity pattern has been built from it.
+     */
+    void
+    fill_rows_on_subrange (const size_type begin,
+                           const size_type end,
+                           const std::vector<std::vector<std::pair<unsigned int,double> > > &rows,
+                           ::dealii::SparseMatrix<double> &matrix)
+    {
+      for (size_type i=begin; i<end; ++i)
+        for (unsigned int e=0; e<rows[i].size(); ++e)
+          matrix.set (i, rows[i][e].first, rows[i][e].second);
+    }
+
+
+
+    /**
+     * Scratch arrays for the product of sparse matrices, one per thread.
+     */
+    struct ProductScratch
+    {
+      std::vector<size_type> marker;
+      std::vector<double>    values;
+    };
+
+
+
+    /**
+     * Determine the sparsity pattern of the rows <tt>[begin,end)</tt> of the
+     * product $AB$.
+     */
+    void
+    multiply_symbolic_on_subrange (const size_type                         begin,
+                                   const size_type                         end,
+                                   const ::dealii::SparseMatrix<double>             &A,
+                                   const ::dealii::SparseMatrix<double>             &B,
+                                   Threads::ThreadLocalStorage<ProductScratch> &scratch,
+                                   CompressedSimpleSparsityPattern        &csp)
+    {
+      std::vector<size_type> &marker = scratch.get().marker;
+      if (marker.size() != B.n())
+        marker.assign (B.n(), numbers::invalid_size_type);
+
+      std::vector<size_type> columns;
+      for (size_type i=begin; i<end; ++i)
+        {
+          columns.clear();
+          for (::dealii::SparseMatrix<double>::const_iterator
+               a = A.begin(i); a != A.end(i); ++a)
+            for (::dealii::SparseMatrix<double>::const_iterator
+                 b = B.begin(a->column()); b != B.end(a->column()); ++b)
+              if (marker[b->column()] != i)
+                {
+                  marker[b->column()] = i;
+                  columns.push_back (b->column());
+                }
+          std::sort (columns.begin(), columns.end());
+          csp.add_entries (i, columns.begin(), columns.end(), true);
+        }
+    }
+
+
+
+    /**
+     * Compute the rows <tt>[begin,end)</tt> of the product $C=AB$, where the
+     * sparsity pattern of $C$ has already been set up.
+     */
+    void
+    multiply_numeric_on_subrange (const size_type                         begin,
+                                  const size_type                         end,
+                                  const ::dealii::SparseMatrix<double>             &A,
+                                  const ::dealii::SparseMatrix<double>             &B,
+                                  Threads::ThreadLocalStorage<ProductScratch> &scratch,
+                                  ::dealii::SparseMatrix<double>                   &C)
+    {
+      std::vector<double> &values = scratch.get().values;
+      if (values.size() != B.n())
+        values.assign (B.n(), 0.);
+
+      for (size_type i=begin; i<end; ++i)
+        {
+          for (::dealii::SparseMatrix<double>::const_iterator
+               a = A.begin(i); a != A.end(i); ++a)
+            for (::dealii::SparseMatrix<double>::const_iterator
+                 b = B.begin(a->column()); b != B.end(a->column()); ++b)
+              values[b->column()] += a->value() * b->value();
+          for (::dealii::SparseMatrix<double>::iterator
+               c = C.begin(i); c != C.end(i); ++c)
+            {
+              c->value() = values[c->column()];
+              values[c->column()] = 0.;
+            }
+        }
+    }
+
+
+
+    /**
+     * Compute the product $C=AB$ of two sparse matrices, including the
+     * sparsity pattern of $C$. The rows of the product are computed in
+     * parallel.
+     */
+    void
+    multiply (const ::dealii::SparseMatrix<double> &A,
+              const ::dealii::SparseMatrix<double> &B,
+              SparsityPattern            &sparsity,
+              ::dealii::SparseMatrix<double>       &C)
+    {
+      Assert (A.n() == B.m(), ExcDimensionMismatch (A.n(), B.m()));
+
+      Threads::ThreadLocalStorage<ProductScratch> scratch;
+      CompressedSimpleSparsityPattern csp (A.m(), B.n());
+      parallel::apply_to_subranges (0U, A.m(),
+                                    std_cxx11::bind (&multiply_symbolic_on_subrange,
+                                                     std_cxx11::_1, std_cxx11::_2,
+                                                     std_cxx11::cref(A),
+                                                     std_cxx11::cref(B),
+                                                     std_cxx11::ref(scratch),
+                                                     std_cxx11::ref(csp)),
+                                    minimum_parallel_grain_size);
+      sparsity.copy_from (csp);
+      C.reinit (sparsity);
+      parallel::apply_to_subranges (0U, A.m(),
+                                    std_cxx11::bind (&multiply_numeric_on_subrange,
+                                                     std_cxx11::_1, std_cxx11::_2,
+                                                     std_cxx11::cref(A),
+                                                     std_cxx11::cref(B),
+                                                     std_cxx11::ref(scratch),
+                                                     std_cxx11::ref(C)),
+                                    minimum_parallel_grain_size);
+    }
+
+
+
+    /**
+     * Compute the transpose of @p matrix, including its sparsity pattern.
+     */
+    void
+    transpose (const ::dealii::SparseMatrix<double> &matrix,
+               SparsityPattern            &sparsity,
+               ::dealii::SparseMatrix<double>       &transpose)
+    {
+      CompressedSimpleSparsityPattern csp (matrix.n(), matrix.m());
+      for (size_type i=0; i<matrix.m(); ++i)
+        for (::dealii::SparseMatrix<double>::const_iterator
+             p = matrix.begin(i); p != matrix.end(i); ++p)
+          csp.add (p->column(), i);
+      sparsity.copy_from (csp);
+      transpose.reinit (sparsity);
+      for (size_type i=0; i<matrix.m(); ++i)
+        for (::dealii::SparseMatrix<double>::const_iterator
+             p = matrix.begin(i); p != matrix.end(i); ++p)
+          transpose.set (p->column(), i, p->value());
+    }
+
+
+
+    /**
+     * Compute the prolongation matrix from the aggregates of the unknowns
+     * of @p matrix. Returns false if the matrix cannot be coarsened further.
+     */
+    bool
+    build_prolongation (const ::dealii::SparseMatrix<double>                 &matrix,
+                        const PreconditionAMG::AdditionalData      &data,
+                        SparsityPattern                            &sparsity,
+                        ::dealii::SparseMatrix<double>                       &prolongation)
+    {
+      const size_type n = matrix.m();
+      std::vector<double> diagonal (n);
+      parallel::apply_to_subranges (0U, n,
+                                    std_cxx11::bind (&compute_diagonal_on_subrange,
+                                                     std_cxx11::_1, std_cxx11::_2,
+                                                     std_cxx11::cref(matrix),
+                                                     std_cxx11::ref(diagonal)),
+                                    minimum_parallel_grain_size);
+
+      // aggregate the blocks independently, then number the aggregates
+      // consecutively
+      const size_type block_size = data.aggregation_block_size;
+      const size_type n_blocks = (n + block_size - 1) / block_size;
+      std::vector<unsigned int> aggregates (n, no_aggregate);
+      std::vector<unsigned int> n_aggregates (n_blocks);
+      parallel::apply_to_subranges (0U, n_blocks,
+                                    std_cxx11::bind (&aggregate_on_subrange,
+                                                     std_cxx11::_1, std_cxx11::_2,
+                                                     std_cxx11::cref(matrix),
+                                                     std_cxx11::cref(diagonal),
+                                                     data.aggregation_threshold,
+                                                     block_size,
+                                                     std_cxx11::ref(aggregates),
+                                                     std_cxx11::ref(n_aggregates)),
+                                    1);
+      std::vector<unsigned int> block_offset (n_blocks+1, 0);
+      for (size_type block=0; block<n_blocks; ++block)
+        block_offset[block+1] = block_offset[block] + n_aggregates[block];
+      const unsigned int n_coarse = block_offset[n_blocks];
+      if (n_coarse == 0 || n_coarse >= n)
+        return false;
+
+      std::vector<unsigned int> aggregate_sizes (n_coarse, 0);
+      for (size_type i=0; i<n; ++i)
+        if (aggregates[i] != no_aggregate)
+          {
+            aggregates[i] += block_offset[i/block_size];
+            ++aggregate_sizes[aggregates[i]];
+          }
+
+      // tentative prolongation with normalized columns, and damping
+      // parameter from the largest eigenvalue of D^{-1}A
+      std::vector<double> tentative (n, 0.);
+      for (size_type i=0; i<n; ++i)
+        if (aggregates[i] != no_aggregate)
+          tentative[i] = 1./std::sqrt(static_cast<double>(aggregate_sizes[aggregates[i]]));
+      const double max_eigenvalue
+        = estimate_max_eigenvalue (matrix, diagonal, n_power_iterations);
+      const double omega = (max_eigenvalue > 0 ?
+                            data.prolongation_damping / max_eigenvalue : 0.);
+
+      std::vector<std::vector<std::pair<unsigned int,double> > > rows (n);
+      parallel::apply_to_subranges (0U, n,
+                                    std_cxx11::bind (&smooth_prolongation_on_subrange,
+                                                     std_cxx11::_1, std_cxx11::_2,
+                                                     std_cxx11::cref(matrix),
+                                                     std_cxx11::cref(diagonal),
+                                                     std_cxx11::cref(aggregates),
+                                                     std_cxx11::cref(tentative),
+                                                     omega,
+                                                     std_cxx11::ref(rows)),
+                                    minimum_parallel_grain_size);
+
+      CompressedSimpleSparsityPattern csp (n, n_coarse);
+      for (size_type i=0; i<n; ++i)
+        for (unsigned int e=0; e<rows[i].size(); ++e)
+          csp.add (i, rows[i][e].first);
+      sparsity.copy_from (csp);
+      prolongation.reinit (sparsity);
+      parallel::apply_to_subranges (0U, n,
+                                    std_cxx11::bind (&fill_rows_on_subrange,
+                                                     std_cxx11::_1, std_cxx11::_2,
+                                                     std_cxx11::cref(rows),
+                                                     std_cxx11::ref(prolongation)),
+                                    minimum_parallel_grain_size);
+      return true;
+    }
+  }
+}
+
+
+
+/* ------------------------- MGTransferAlgebraic ------------------------- */
+
+
+MGTransferAlgebraic::~MGTransferAlgebraic ()
+{}
+
+
+
+void
+MGTransferAlgebraic::clear ()
+{
+  prolongation_matrices.clear();
+  prolongation_sparsities.clear();
+}
+
+
+
+void
+MGTransferAlgebraic::set_prolongation_matrix (const unsigned int                                to_level,
+                                              const std_cxx11::shared_ptr<SparsityPattern>      &sparsity,
+                                              const std_cxx11::shared_ptr<SparseMatrix<double> > &matrix)
+{
+  Assert (to_level > 0, ExcMessage ("There is no prolongation to level 0"));
+  Assert (&matrix->get_sparsity_pattern() == sparsity.get(),
+          ExcMessage ("The matrix must be based on the given sparsity pattern"));
+  if (prolongation_matrices.size() <= to_level)
+    {
+      prolongation_matrices.resize (to_level+1);
+      prolongation_sparsities.resize (to_level+1);
+    }
+  prolongation_matrices[to_level] = matrix;
+  prolongation_sparsities[to_level] = sparsity;
+}
+
+
+
+const SparseMatrix<double> &
+MGTransferAlgebraic::get_prolongation_matrix (const unsigned int to_level) const
+{
+  Assert (to_level < prolongation_matrices.size() &&
+          prolongation_matrices[to_level].get() != 0,
+          ExcMessage ("No prolongation matrix set for this level"));
+  return *prolongation_matrices[to_level];
+}
+
+
+
+void
+MGTransferAlgebraic::prolongate (const unsigned int    to_level,
+                                 Vector<double>       &dst,
+                                 const Vector<double> &src) const
+{
+  get_prolongation_matrix(to_level).vmult (dst, src);
+}
+
+
+
+void
+MGTransferAlgebraic::restrict_and_add (const unsigned int    from_level,
+                                       Vector<double>       &dst,
+                                       const Vector<double> &src) const
+{
+  get_prolongation_matrix(from_level).Tvmult_add (dst, src);
+}
+
+
+
+std::size_t
+MGTransferAlgebraic::memory_consumption () const
+{
+  std::size_t result = sizeof(*this);
+  for (unsigned int i=0; i<prolongation_matrices.size(); ++i)
+    if (prolongation_matrices[i].get() != 0)
+      result += prolongation_matrices[i]->memory_consumption()
+                + prolongation_sparsities[i]->memory_consumption();
+  return result;
+}
+
+
+
+/* --------------------------- PreconditionAMG --------------------------- */
+
+
+PreconditionAMG::AdditionalData::
+AdditionalData (const double       aggregation_threshold,
+                const unsigned int smoother_sweeps,
+                const unsigned int max_levels,
+                const unsigned int coarse_size,
+                const double       prolongation_damping,
+                const bool         w_cycle,
+                const unsigned int aggregation_block_size)
+  :
+  aggregation_threshold (aggregation_threshold),
+  smoother_sweeps (smoother_sweeps),
+  max_levels (max_levels),
+  coarse_size (coarse_size),
+  prolongation_damping (prolongation_damping),
+  w_cycle (w_cycle),
+  aggregation_block_size (aggregation_block_size)
+{}
+
+
+
+PreconditionAMG::PreconditionAMG ()
+  :
+  smoother_sweeps (0),
+  w_cycle (false)
+{}
+
+
+
+PreconditionAMG::~PreconditionAMG ()
+{
+  clear ();
+}
+
+
+
+void
+PreconditionAMG::clear ()
+{
+  fine_matrix = 0;
+  coarse_matrices.clear ();
+  coarse_sparsities.clear ();
+  mg_transfer.clear ();
+  coarse_solver.reset ();
+}
+
+
+
+void
+PreconditionAMG::initialize (const SparseMatrix<double> &matrix,
+                             const AdditionalData       &additional_data)
+{
+  Assert (matrix.m() == matrix.n(), ExcNotQuadratic());
+  Assert (additional_data.max_levels > 0,
+          ExcMessage ("At least one level is needed"));
+  Assert (additional_data.aggregation_block_size > 0,
+          ExcMessage ("The aggregation blocks must not be empty"));
+  clear ();
+
+  // build the hierarchy from fine to coarse. the coarse matrices are stored
+  // in the order they are computed, and are renumbered at the end so that
+  // level 0 is the coarsest one
+  std::vector<std_cxx11::shared_ptr<SparsityPattern> >       prolongation_sparsities;
+  std::vector<std_cxx11::shared_ptr<SparseMatrix<double> > > prolongations;
+
+  const SparseMatrix<double> *fine = &matrix;
+  while (coarse_matrices.size()+1 < additional_data.max_levels &&
+         fine->m() > additional_data.coarse_size)
+    {
+      std_cxx11::shared_ptr<SparsityPattern> p_sparsity (new SparsityPattern);
+      std_cxx11::shared_ptr<SparseMatrix<double> > p_matrix (new SparseMatrix<double>);
+      if (internal::AlgebraicMultigrid::build_prolongation (*fine, additional_data,
+                                                            *p_sparsity, *p_matrix)
+          == false)
+        break;
+
+      // Galerkin product P^T A P
+      SparsityPattern ap_sparsity, r_sparsity;
+      SparseMatrix<double> ap, restriction;
+      internal::AlgebraicMultigrid::multiply (*fine, *p_matrix, ap_sparsity, ap);
+      internal::AlgebraicMultigrid::transpose (*p_matrix, r_sparsity, restriction);
+
+      std_cxx11::shared_ptr<SparsityPattern> c_sparsity (new SparsityPattern);
+      std_cxx11::shared_ptr<SparseMatrix<double> > c_matrix (new SparseMatrix<double>);
+      internal::AlgebraicMultigrid::multiply (restriction, ap, *c_sparsity, *c_matrix);
+
+      prolongation_sparsities.push_back (p_sparsity);
+      prolongations.push_back (p_matrix);
+      coarse_sparsities.push_back (c_sparsity);
+      coarse_matrices.push_back (c_matrix);
+      fine = c_matrix.get();
+    }
+
+  std::reverse (coarse_sparsities.begin(), coarse_sparsities.end());
+  std::reverse (coarse_matrices.begin(), coarse_matrices.end());
+  const unsigned int max_level = coarse_matrices.size();
+  for (unsigned int l=0; l<max_level; ++l)
+    mg_transfer.set_prolongation_matrix (max_level-l, prolongation_sparsities[l],
+                                         prolongations[l]);
+
+  fine_matrix = &matrix;
+  FullMatrix<double> coarse_matrix;
+  coarse_matrix.copy_from (get_level_matrix (0));
+  coarse_solver.reset (new Householder<double> (coarse_matrix));
+  smoother_sweeps = additional_data.smoother_sweeps;
+  w_cycle = additional_data.w_cycle;
+}
+
+
+
+void
+PreconditionAMG::vmult (Vector<double>       &dst,
+                        const Vector<double> &src) const
+{
+  Assert (fine_matrix != 0, ExcNotInitialized());
+  AssertDimension (dst.size(), fine_matrix->m());
+  AssertDimension (src.size(), fine_matrix->m());
+
+  level_cycle (coarse_matrices.size(), dst, src);
+}
+
+
+
+void
+PreconditionAMG::Tvmult (Vector<double>       &dst,
+                         const Vector<double> &src) const
+{
+  vmult (dst, src);
+}
+
+
+
+void
+PreconditionAMG::level_cycle (const unsigned int    level,
+                              Vector<double>       &dst,
+                              const Vector<double> &src) const
+{
+  if (level == 0)
+    {
+      coarse_solver->least_squares (dst, src);
+      return;
+    }
+
+  const SparseMatrix<double> &matrix = get_level_matrix (level);
+  const SparseMatrix<double> &coarse_matrix = get_level_matrix (level-1);
+  const SparseMatrix<double> &prolongation = mg_transfer.get_prolongation_matrix (level);
+
+  // all temporary vectors are taken from a memory pool, so that several
+  // threads can apply the preconditioner at the same time
+  GrowingVectorMemory<Vector<double> > memory;
+  VectorMemory<Vector<double> >::Pointer residual (memory);
+  VectorMemory<Vector<double> >::Pointer coarse_src (memory);
+  VectorMemory<Vector<double> >::Pointer coarse_dst (memory);
+  residual->reinit (matrix.m(), true);
+  coarse_src->reinit (coarse_matrix.m(), true);
+  coarse_dst->reinit (coarse_matrix.m(), true);
+
+  // presmoothing, starting from zero
+  dst = 0;
+  for (unsigned int s=0; s<smoother_sweeps; ++s)
+    matrix.SSOR_step (dst, src);
+
+  // coarse grid correction, twice for the W-cycle
+  matrix.residual (*residual, dst, src);
+  prolongation.Tvmult (*coarse_src, *residual);
+  level_cycle (level-1, *coarse_dst, *coarse_src);
+  if (w_cycle && level > 1)
+    {
+      VectorMemory<Vector<double> >::Pointer coarse_update (memory);
+      coarse_update->reinit (coarse_matrix.m(), true);
+      coarse_matrix.residual (*coarse_update, *coarse_dst, *coarse_src);
+      coarse_src->swap (*coarse_update);
+      level_cycle (level-1, *coarse_update, *coarse_src);
+      *coarse_dst += *coarse_update;
+    }
+  prolongation.vmult_add (dst, *coarse_dst);
+
+  // postsmoothing
+  for (unsigned int s=0; s<smoother_sweeps; ++s)
+    matrix.SSOR_step (dst, src);
+}
+
+
+
+unsigned int
+PreconditionAMG::n_levels () const
+{
+  return fine_matrix != 0 ? coarse_matrices.size()+1 : 0;
+}
+
+
+
+const SparseMatrix<double> &
+PreconditionAMG::get_level_matrix (const unsigned int level) const
+{
+  Assert (fine_matrix != 0, ExcNotInitialized());
+  Assert (level < n_levels(), ExcIndexRange (level, 0, n_levels()));
+  return (level == coarse_matrices.size() ?
+          *fine_matrix : *coarse_matrices[level]);
+}
+
+
+
+double
+PreconditionAMG::operator_complexity () const
+{
+  Assert (fine_matrix != 0, ExcNotInitialized());
+  double nnz = fine_matrix->n_nonzero_elements();
+  for (unsigned int l=0; l<coarse_matrices.size(); ++l)
+    nnz += coarse_matrices[l]->n_nonzero_elements();
+  return nnz / fine_matrix->n_nonzero_elements();
+}
+
+
+
+std::size_t
+PreconditionAMG::memory_consumption () const
+{
+  std::size_t result = sizeof(*this) + mg_transfer.memory_consumption();
+  if (coarse_solver.get() != 0)
+    {
+      // the QR decomposition is stored as a full matrix plus its diagonal
+      const std::size_t n = get_level_matrix(0).m();
+      result += sizeof(Householder<double>) + (n*n + n) * sizeof(double);
+    }
+  for (unsigned int l=0; l<coarse_matrices.size(); ++l)
+    result += coarse_matrices[l]->memory_consumption()
+              + coarse_sparsities[l]->memory_consumption();
+  return result;
+}
+
+
+DEAL_II_NAMESPACE_CLOSE
@@ -13,6 +13,7 @@
 //
 // ---------------------------------------------------------------------
 
+#include <deal.II/base/hardware_counters.h>
 #include <deal.II/base/work_stream.h>
 #include <deal.II/numerics/data_out.h>
 #include <deal.II/grid/tria.h>
@@ -331,6 +332,8 @@ void DataOut<dim,DH>::build_patches (const Mapping<DH::dimension,DH::space_dimen
   Assert (n_subdivisions >= 1,
           ExcInvalidNumberOfSubdivisions(n_subdivisions));
 
+  HardwareCounters::Scope counter_scope ("DataOut::build_patches");
+
   // First count the cells we want to create patches of. Also fill the object
   // that maps the cell indices to the patch numbers, as this will be needed
   // for generation of neighborship information.
@@ -296,47 +296,69 @@ namespace internal
 
 
     /**
-     * Copy data from the local_face_integrals map of a single ParallelData
-     * object into a global such map. This is the copier stage of a WorkStream
-     * pipeline.
+     * Make sure that the ghost values of a solution vector can be read. This
+     * is a no-op for all vector types except parallel::distributed::Vector,
+     * for which we import the ghost values into the vector itself if this
+     * has not yet happened, rather than requiring the caller to create a
+     * ghosted copy of the vector. Return whether the ghost values had to be
+     * imported, so that restore_ghost_state() can later put the vector back
+     * into its original state.
      */
-    template <class DH>
-    void
-    copy_local_to_global (const std::map<typename DH::face_iterator,std::vector<double> > &local_face_integrals,
-                          std::map<typename DH::face_iterator,std::vector<double> > &face_integrals)
+    template <typename InputVector>
+    bool
+    import_ghost_values (const InputVector &)
     {
+      return false;
+    }
 
-      // now copy locally computed elements into the global map
-      for (typename std::map<typename DH::face_iterator,std::vector<double> >::const_iterator
-           p=local_face_integrals.begin();
-           p!=local_face_integrals.end();
-           ++p)
-        {
-          // double check that the element does not already exists in the
-          // global map
-          Assert (face_integrals.find (p->first) == face_integrals.end(),
-                  ExcInternalError());
 
-          for (unsigned int i=0; i<p->second.size(); ++i)
-            {
-              Assert (numbers::is_finite(p->second[i]), ExcInternalError());
-              Assert (p->second[i] >= 0, ExcInternalError());
-            }
 
-          face_integrals[p->first] = p->second;
-        }
+    template <typename Number>
+    bool
+    import_ghost_values (const dealii::parallel::distributed::Vector<Number> &solution)
+    {
+      if (solution.has_ghost_elements() == true)
+        return false;
+
+      solution.update_ghost_values ();
+      return true;
     }
 
 
+
+    /**
+     * Undo what import_ghost_values() did.
+     */
+    template <typename InputVector>
+    void
+    restore_ghost_state (const InputVector &)
+    {}
+
+
+
+    template <typename Number>
+    void
+    restore_ghost_state (const dealii::parallel::distributed::Vector<Number> &solution)
+    {
+      // the vector is logically unchanged: only the ghost entries that
+      // import_ghost_values() filled in are released again
+      const_cast<dealii::parallel::distributed::Vector<Number> &>(solution)
+      .zero_out_ghosts ();
+    }
+
+
+
     /**
      * Actually do the computation based on the evaluated gradients in
-     * ParallelData.
+     * ParallelData, and write the integrals for all solution vectors to the
+     * array starting at @p face_integral.
      */
     template <class DH>
-    std::vector<double>
+    void
     integrate_over_face (ParallelData<DH>                        &parallel_data,
                          const typename DH::face_iterator        &face,
-                         dealii::hp::FEFaceValues<DH::dimension, DH::space_dimension> &fe_face_values_cell)
+                         dealii::hp::FEFaceValues<DH::dimension, DH::space_dimension> &fe_face_values_cell,
+                         double                                  *face_integral)
     {
       const unsigned int n_q_points         = parallel_data.psi[0].size(),
                          n_components       = parallel_data.finite_element.n_components(),
@@ -453,15 +475,18 @@ namespace internal
         = fe_face_values_cell.get_present_fe_values().get_JxW_values();
 
       // take the square of the phi[i] for integration, and sum up
-      std::vector<double> face_integral (n_solution_vectors, 0);
       for (unsigned int n=0; n<n_solution_vectors; ++n)
-        for (unsigned int component=0; component<n_components; ++component)
-          if (parallel_data.component_mask[component] == true)
-            for (unsigned int p=0; p<n_q_points; ++p)
-              face_integral[n] += Utilities::fixed_power<2>(parallel_data.phi[n][p][component]) *
-                                  parallel_data.JxW_values[p];
+        {
+          double integral = 0;
+          for (unsigned int component=0; component<n_components; ++component)
+            if (parallel_data.component_mask[component] == true)
+              for (unsigned int p=0; p<n_q_points; ++p)
+                integral += Utilities::fixed_power<2>(parallel_data.phi[n][p][component]) *
+                            parallel_data.JxW_values[p];
 
-      return face_integral;
+          Assert (numbers::is_finite(integral), ExcInternalError());
+          face_integral[n] = integral;
+        }
     }
 
 
@@ -476,7 +501,7 @@ namespace internal
     void
     integrate_over_regular_face (const std::vector<const InputVector *>   &solutions,
                                  ParallelData<DH>                        &parallel_data,
-                                 std::map<typename DH::face_iterator,std::vector<double> > &local_face_integrals,
+                                 std::vector<double>                     &face_integrals,
                                  const typename DH::active_cell_iterator &cell,
                                  const unsigned int                       face_no,
                                  dealii::hp::FEFaceValues<DH::dimension, DH::space_dimension> &fe_face_values_cell,
@@ -531,8 +556,8 @@ namespace internal
         }
 
       // now go to the generic function that does all the other things
-      local_face_integrals[face] =
-        integrate_over_face (parallel_data, face, fe_face_values_cell);
+      integrate_over_face (parallel_data, face, fe_face_values_cell,
+                           &face_integrals[face->index()*n_solution_vectors]);
     }
 
 
@@ -552,7 +577,7 @@ namespace internal
     void
     integrate_over_irregular_face (const std::vector<const InputVector *>   &solutions,
                                    ParallelData<DH>                         &parallel_data,
-                                   std::map<typename DH::face_iterator,std::vector<double> > &local_face_integrals,
+                                   std::vector<double>                      &face_integrals,
                                    const typename DH::active_cell_iterator    &cell,
                                    const unsigned int                          face_no,
                                    dealii::hp::FEFaceValues<DH::dimension,DH::space_dimension>    &fe_face_values,
@@ -611,32 +636,37 @@ namespace internal
             .get_function_gradients (*solutions[n], parallel_data.neighbor_psi[n]);
 
           // call generic evaluate function
-          local_face_integrals[neighbor_child->face(neighbor_neighbor)] =
-            integrate_over_face (parallel_data, face, fe_face_values);
+          integrate_over_face (parallel_data, face, fe_face_values,
+                               &face_integrals[neighbor_child->face(neighbor_neighbor)->index()
+                                               *n_solution_vectors]);
         }
 
       // finally loop over all subfaces to collect the contributions of the
       // subfaces and store them with the mother face
-      std::vector<double> sum (n_solution_vectors, 0);
-      for (unsigned int subface_no=0; subface_no<face->n_children(); ++subface_no)
+      for (unsigned int n=0; n<n_solution_vectors; ++n)
         {
-          Assert (local_face_integrals.find(face->child(subface_no)) !=
-                  local_face_integrals.end(),
-                  ExcInternalError());
-          Assert (local_face_integrals[face->child(subface_no)][0] >= 0,
-                  ExcInternalError());
-
-          for (unsigned int n=0; n<n_solution_vectors; ++n)
-            sum[n] += local_face_integrals[face->child(subface_no)][n];
+          double sum = 0;
+          for (unsigned int subface_no=0; subface_no<face->n_children(); ++subface_no)
+            {
+              Assert (face_integrals[face->child(subface_no)->index()*n_solution_vectors+n]
+                      >= 0,
+                      ExcInternalError());
+              sum += face_integrals[face->child(subface_no)->index()*n_solution_vectors+n];
+            }
+          face_integrals[face->index()*n_solution_vectors+n] = sum;
         }
-
-      local_face_integrals[face] = sum;
     }
 
 
     /**
      * Computate the error on the faces of a single cell.
      *
+     * The integrals are written into @p face_integrals at the position given
+     * by the index of the face. Every face is integrated by exactly one of
+     * the cells adjacent to it (see below), so the threads working on
+     * different cells never write to the same entries and need not
+     * synchronise.
+     *
      * This function is only needed in two or three dimensions.  The error
      * estimator in one dimension is implemented separately.
      */
@@ -644,7 +674,7 @@ namespace internal
     void
     estimate_one_cell (const typename DH::active_cell_iterator &cell,
                        ParallelData<DH>                    &parallel_data,
-                       std::map<typename DH::face_iterator,std::vector<double> > &local_face_integrals,
+                       std::vector<double>                 &face_integrals,
                        const std::vector<const InputVector *> &solutions)
     {
       const unsigned int dim = DH::dimension;
@@ -653,9 +683,6 @@ namespace internal
       const types::subdomain_id subdomain_id = parallel_data.subdomain_id;
       const unsigned int material_id  = parallel_data.material_id;
 
-      // empty our own copy of the local face integrals
-      local_face_integrals.clear();
-
       // loop over all faces of this cell
       for (unsigned int face_no=0;
            face_no<GeometryInfo<dim>::faces_per_cell; ++face_no)
@@ -692,8 +719,8 @@ namespace internal
               (parallel_data.neumann_bc->find(face->boundary_indicator()) ==
                parallel_data.neumann_bc->end()))
             {
-              local_face_integrals[face]
-                = std::vector<double> (n_solution_vectors, 0.);
+              for (unsigned int n=0; n<n_solution_vectors; ++n)
+                face_integrals[face->index()*n_solution_vectors+n] = 0.;
               continue;
             }
 
@@ -763,7 +790,7 @@ namespace internal
             // the integration of these both cases together
             integrate_over_regular_face (solutions,
                                          parallel_data,
-                                         local_face_integrals,
+                                         face_integrals,
                                          cell, face_no,
                                          parallel_data.fe_face_values_cell,
                                          parallel_data.fe_face_values_neighbor);
@@ -773,7 +800,7 @@ namespace internal
             // fit into the framework of the above function
             integrate_over_irregular_face (solutions,
                                            parallel_data,
-                                           local_face_integrals,
+                                           face_integrals,
                                            cell, face_no,
                                            parallel_data.fe_face_values_cell,
                                            parallel_data.fe_subface_values);
@@ -952,11 +979,21 @@ estimate (const Mapping<dim, spacedim>                  &mapping,
 
   const unsigned int n_solution_vectors = solutions.size();
 
-  // Map of integrals indexed by the corresponding face. In this map we store
-  // the integrated jump of the gradient for each face.  At the end of the
-  // function, we again loop over the cells and collect the contributions of
-  // the different faces of the cell.
-  std::map<typename DH::face_iterator,std::vector<double> > face_integrals;
+  // Integrals of the jump of the gradient over each face, for all solution
+  // vectors, indexed by face->index()*n_solution_vectors+n. At the end of
+  // the function, we again loop over the cells and collect the contributions
+  // of the different faces of the cell. Entries that are never written keep
+  // a negative value, which lets us check that all faces of the cells we
+  // care for have been visited.
+  std::vector<double> face_integrals (dof_handler.get_tria().n_raw_faces() *
+                                      n_solution_vectors,
+                                      -1e20);
+
+  // parallel::distributed::Vector objects need not be passed with their
+  // ghost values imported; do that here instead of in a copy of the vector
+  std::vector<bool> ghosts_imported (n_solution_vectors);
+  for (unsigned int n=0; n<n_solution_vectors; ++n)
+    ghosts_imported[n] = internal::import_ghost_values (*solutions[n]);
 
   // all the data needed in the error estimator by each of the threads is
   // gathered in the following structures
@@ -972,17 +1009,23 @@ estimate (const Mapping<dim, spacedim>                  &mapping,
                  &neumann_bc,
                  component_mask,
                  coefficients);
-  std::map<typename DH::face_iterator,std::vector<double> > sample_local_face_integrals;
 
-  // now let's work on all those cells:
+  // now let's work on all those cells. the workers write their results
+  // directly into face_integrals, so there is nothing to copy and the cells
+  // are processed independently of each other
   WorkStream::run (dof_handler.begin_active(),
                    static_cast<typename DH::active_cell_iterator>(dof_handler.end()),
                    std_cxx11::bind (&internal::estimate_one_cell<InputVector,DH>,
-                                    std_cxx11::_1, std_cxx11::_2, std_cxx11::_3, std_cxx11::ref(solutions)),
-                   std_cxx11::bind (&internal::copy_local_to_global<DH>,
-                                    std_cxx11::_1, std_cxx11::ref(face_integrals)),
+                                    std_cxx11::_1, std_cxx11::_2,
+                                    std_cxx11::ref(face_integrals),
+                                    std_cxx11::ref(solutions)),
+                   std_cxx11::function<void (const unsigned int &)>(),
                    parallel_data,
-                   sample_local_face_integrals);
+                   0U);
+
+  for (unsigned int n=0; n<n_solution_vectors; ++n)
+    if (ghosts_imported[n] == true)
+      internal::restore_ghost_state (*solutions[n]);
 
   // finally add up the contributions of the faces for each cell
 
@@ -1008,24 +1051,23 @@ estimate (const Mapping<dim, spacedim>                  &mapping,
           ||
           (cell->material_id() == material_id)))
       {
+        const double factor = cell->diameter() / 24;
+
         // loop over all faces of this cell
         for (unsigned int face_no=0; face_no<GeometryInfo<dim>::faces_per_cell;
              ++face_no)
           {
-            Assert(face_integrals.find(cell->face(face_no))
-                   != face_integrals.end(),
-                   ExcInternalError());
-            const double factor = cell->diameter() / 24;
+            const double *face_integral
+              = &face_integrals[cell->face_index(face_no)*n_solution_vectors];
 
             for (unsigned int n=0; n<n_solution_vectors; ++n)
               {
                 // make sure that we have written a meaningful value into this
                 // slot
-                Assert (face_integrals[cell->face(face_no)][n] >= 0,
+                Assert (face_integral[n] >= 0,
                         ExcInternalError());
 
-                (*errors[n])(present_cell)
-                += (face_integrals[cell->face(face_no)][n] * factor);
+                (*errors[n])(present_cell) += (face_integral[n] * factor);
               }
           }
 
@@ -17,6 +17,8 @@
 #include <deal.II/base/quadrature.h>
 #include <deal.II/base/work_stream.h>
 #include <deal.II/base/geometry_info.h>
+#include <deal.II/base/graph_coloring.h>
+#include <deal.II/base/multithread_info.h>
 #include <deal.II/base/quadrature.h>
 #include <deal.II/dofs/dof_handler.h>
 #include <deal.II/dofs/dof_accessor.h>
@@ -603,6 +605,78 @@ namespace MatrixCreator
 
 
 
+    /**
+     * Return the indices of the rows of the global matrix that the copier
+     * writes to for the given cell: the degrees of freedom of the cell plus
+     * the ones they are constrained to.
+     */
+    template <typename CellIterator>
+    std::vector<types::global_dof_index>
+    get_conflict_indices (const CellIterator     &cell,
+                          const ConstraintMatrix &constraints)
+    {
+      std::vector<types::global_dof_index>
+      local_dof_indices (cell->get_fe().dofs_per_cell);
+      cell->get_dof_indices (local_dof_indices);
+      constraints.resolve_indices (local_dof_indices);
+      return local_dof_indices;
+    }
+
+
+
+    /**
+     * Run the worker and copier functions on all active cells of the
+     * given DoFHandler.
+     *
+     * With more than one thread, the cells are colored so that no two cells
+     * of the same color write to the same rows of the matrix or entries of
+     * the right hand side. WorkStream then runs the copier on the cells of
+     * one color in parallel, rather than funneling the results of all
+     * threads through a single copier that would limit the scaling of the
+     * assembly. The coloring given by the caller is used if there is one,
+     * otherwise it is computed here. With only one thread, we skip the
+     * coloring since it has nothing to gain.
+     */
+    template <class DH, typename Worker, typename Copier,
+              typename ScratchData, typename CopyData>
+    void run_on_active_cells (const DH               &dof,
+                              const ConstraintMatrix &constraints,
+                              const std::vector<std::vector<typename DH::active_cell_iterator> > *const colored_cells,
+                              Worker                  worker,
+                              Copier                  copier,
+                              const ScratchData      &sample_scratch_data,
+                              const CopyData         &sample_copy_data)
+    {
+      typedef typename DH::active_cell_iterator active_cell_iterator;
+      const active_cell_iterator begin = dof.begin_active();
+      const active_cell_iterator end (dof.end());
+
+      if ((multithread_info.n_threads() == 1) || (begin == end))
+        WorkStream::run (begin, end,
+                         worker, copier,
+                         sample_scratch_data, sample_copy_data);
+      else if (colored_cells != 0)
+        {
+#ifdef DEBUG
+          unsigned int n_colored_cells = 0;
+          for (unsigned int c=0; c<colored_cells->size(); ++c)
+            n_colored_cells += (*colored_cells)[c].size();
+          Assert (n_colored_cells == dof.get_tria().n_active_cells(),
+                  ExcMessage ("The coloring does not contain all active cells. "
+                              "Was it computed for a different mesh?"));
+#endif
+          WorkStream::run (*colored_cells,
+                           worker, copier,
+                           sample_scratch_data, sample_copy_data);
+        }
+      else
+        WorkStream::run (make_cell_coloring (dof, constraints),
+                         worker, copier,
+                         sample_scratch_data, sample_copy_data);
+    }
+
+
+
     namespace AssemblerBoundary
     {
       struct Scratch
@@ -642,13 +716,31 @@ namespace MatrixCreator
 namespace MatrixCreator
 {
 
+  template <class DH>
+  std::vector<std::vector<typename DH::active_cell_iterator> >
+  make_cell_coloring (const DH               &dof,
+                      const ConstraintMatrix &constraints)
+  {
+    typedef typename DH::active_cell_iterator active_cell_iterator;
+    return GraphColoring::make_graph_coloring
+           (dof.begin_active(), active_cell_iterator(dof.end()),
+            static_cast<std_cxx11::function<std::vector<types::global_dof_index>
+            (const active_cell_iterator &)> >
+            (std_cxx11::bind (&internal::get_conflict_indices<active_cell_iterator>,
+                              std_cxx11::_1,
+                              std_cxx11::cref(constraints))));
+  }
+
+
+
   template <int dim, typename number, int spacedim>
   void create_mass_matrix (const Mapping<dim,spacedim>       &mapping,
                            const DoFHandler<dim,spacedim>    &dof,
                            const Quadrature<dim>    &q,
                            SparseMatrix<number>     &matrix,
                            const Function<spacedim> *const coefficient,
-                           const ConstraintMatrix   &constraints)
+                           const ConstraintMatrix   &constraints,
+                           const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     Assert (matrix.m() == dof.n_dofs(),
             ExcDimensionMismatch (matrix.m(), dof.n_dofs()));
@@ -672,14 +764,13 @@ namespace MatrixCreator
     copy_data.dof_indices.resize (assembler_data.fe_collection.max_dofs_per_cell());
     copy_data.constraints = &constraints;
 
-    WorkStream::run (dof.begin_active(),
-                     static_cast<typename DoFHandler<dim,spacedim>::active_cell_iterator>(dof.end()),
-                     &MatrixCreator::internal::mass_assembler<dim, spacedim, typename DoFHandler<dim,spacedim>::active_cell_iterator>,
-                     std_cxx11::bind (&MatrixCreator::internal::
-                                      copy_local_to_global<SparseMatrix<number>, Vector<double> >,
-                                      std_cxx11::_1, &matrix, (Vector<double> *)0),
-                     assembler_data,
-                     copy_data);
+    internal::run_on_active_cells (dof, constraints, colored_cells,
+                                   &MatrixCreator::internal::mass_assembler<dim, spacedim, typename DoFHandler<dim,spacedim>::active_cell_iterator>,
+                                   std_cxx11::bind (&MatrixCreator::internal::
+                                                    copy_local_to_global<SparseMatrix<number>, Vector<double> >,
+                                                    std_cxx11::_1, &matrix, (Vector<double> *)0),
+                                   assembler_data,
+                                   copy_data);
   }
 
 
@@ -689,10 +780,11 @@ namespace MatrixCreator
                            const Quadrature<dim>    &q,
                            SparseMatrix<number>     &matrix,
                            const Function<spacedim> *const coefficient,
-                           const ConstraintMatrix   &constraints)
+                           const ConstraintMatrix   &constraints,
+                           const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     create_mass_matrix(StaticMappingQ1<dim,spacedim>::mapping, dof,
-                       q, matrix, coefficient, constraints);
+                       q, matrix, coefficient, constraints, colored_cells);
   }
 
 
@@ -705,7 +797,8 @@ namespace MatrixCreator
                            const Function<spacedim>      &rhs,
                            Vector<double>           &rhs_vector,
                            const Function<spacedim> *const coefficient,
-                           const ConstraintMatrix   &constraints)
+                           const ConstraintMatrix   &constraints,
+                           const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     Assert (matrix.m() == dof.n_dofs(),
             ExcDimensionMismatch (matrix.m(), dof.n_dofs()));
@@ -728,14 +821,13 @@ namespace MatrixCreator
     copy_data.dof_indices.resize (assembler_data.fe_collection.max_dofs_per_cell());
     copy_data.constraints = &constraints;
 
-    WorkStream::run (dof.begin_active(),
-                     static_cast<typename DoFHandler<dim,spacedim>::active_cell_iterator>(dof.end()),
-                     &MatrixCreator::internal::mass_assembler<dim, spacedim, typename DoFHandler<dim,spacedim>::active_cell_iterator>,
-                     std_cxx11::bind(&MatrixCreator::internal::
-                                     copy_local_to_global<SparseMatrix<number>, Vector<double> >,
-                                     std_cxx11::_1, &matrix, &rhs_vector),
-                     assembler_data,
-                     copy_data);
+    internal::run_on_active_cells (dof, constraints, colored_cells,
+                                   &MatrixCreator::internal::mass_assembler<dim, spacedim, typename DoFHandler<dim,spacedim>::active_cell_iterator>,
+                                   std_cxx11::bind(&MatrixCreator::internal::
+                                                   copy_local_to_global<SparseMatrix<number>, Vector<double> >,
+                                                   std_cxx11::_1, &matrix, &rhs_vector),
+                                   assembler_data,
+                                   copy_data);
   }
 
 
@@ -747,11 +839,12 @@ namespace MatrixCreator
                            const Function<spacedim>      &rhs,
                            Vector<double>           &rhs_vector,
                            const Function<spacedim> *const coefficient,
-                           const ConstraintMatrix   &constraints)
+                           const ConstraintMatrix   &constraints,
+                           const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     create_mass_matrix(StaticMappingQ1<dim,spacedim>::mapping,
                        dof, q, matrix, rhs, rhs_vector, coefficient,
-                       constraints);
+                       constraints, colored_cells);
   }
 
 
@@ -762,7 +855,8 @@ namespace MatrixCreator
                            const hp::QCollection<dim>    &q,
                            SparseMatrix<number>     &matrix,
                            const Function<spacedim> *const coefficient,
-                           const ConstraintMatrix   &constraints)
+                           const ConstraintMatrix   &constraints,
+                           const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     Assert (matrix.m() == dof.n_dofs(),
             ExcDimensionMismatch (matrix.m(), dof.n_dofs()));
@@ -782,14 +876,13 @@ namespace MatrixCreator
     copy_data.dof_indices.resize (assembler_data.fe_collection.max_dofs_per_cell());
     copy_data.constraints = &constraints;
 
-    WorkStream::run (dof.begin_active(),
-                     static_cast<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>(dof.end()),
-                     &MatrixCreator::internal::mass_assembler<dim, spacedim, typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>,
-                     std_cxx11::bind (&MatrixCreator::internal::
-                                      copy_local_to_global<SparseMatrix<number>, Vector<double> >,
-                                      std_cxx11::_1, &matrix, (Vector<double> *)0),
-                     assembler_data,
-                     copy_data);
+    internal::run_on_active_cells (dof, constraints, colored_cells,
+                                   &MatrixCreator::internal::mass_assembler<dim, spacedim, typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>,
+                                   std_cxx11::bind (&MatrixCreator::internal::
+                                                    copy_local_to_global<SparseMatrix<number>, Vector<double> >,
+                                                    std_cxx11::_1, &matrix, (Vector<double> *)0),
+                                   assembler_data,
+                                   copy_data);
   }
 
 
@@ -799,10 +892,11 @@ namespace MatrixCreator
                            const hp::QCollection<dim> &q,
                            SparseMatrix<number>     &matrix,
                            const Function<spacedim> *const coefficient,
-                           const ConstraintMatrix   &constraints)
+                           const ConstraintMatrix   &constraints,
+                           const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     create_mass_matrix(hp::StaticMappingQ1<dim,spacedim>::mapping_collection,
-                       dof, q, matrix, coefficient, constraints);
+                       dof, q, matrix, coefficient, constraints, colored_cells);
   }
 
 
@@ -815,7 +909,8 @@ namespace MatrixCreator
                            const Function<spacedim>      &rhs,
                            Vector<double>           &rhs_vector,
                            const Function<spacedim> *const coefficient,
-                           const ConstraintMatrix   &constraints)
+                           const ConstraintMatrix   &constraints,
+                           const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     Assert (matrix.m() == dof.n_dofs(),
             ExcDimensionMismatch (matrix.m(), dof.n_dofs()));
@@ -835,14 +930,13 @@ namespace MatrixCreator
     copy_data.dof_indices.resize (assembler_data.fe_collection.max_dofs_per_cell());
     copy_data.constraints = &constraints;
 
-    WorkStream::run (dof.begin_active(),
-                     static_cast<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>(dof.end()),
-                     &MatrixCreator::internal::mass_assembler<dim, spacedim, typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>,
-                     std_cxx11::bind (&MatrixCreator::internal::
-                                      copy_local_to_global<SparseMatrix<number>, Vector<double> >,
-                                      std_cxx11::_1, &matrix, &rhs_vector),
-                     assembler_data,
-                     copy_data);
+    internal::run_on_active_cells (dof, constraints, colored_cells,
+                                   &MatrixCreator::internal::mass_assembler<dim, spacedim, typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>,
+                                   std_cxx11::bind (&MatrixCreator::internal::
+                                                    copy_local_to_global<SparseMatrix<number>, Vector<double> >,
+                                                    std_cxx11::_1, &matrix, &rhs_vector),
+                                   assembler_data,
+                                   copy_data);
   }
 
 
@@ -854,10 +948,11 @@ namespace MatrixCreator
                            const Function<spacedim> &rhs,
                            Vector<double>           &rhs_vector,
                            const Function<spacedim> *const coefficient,
-                           const ConstraintMatrix   &constraints)
+                           const ConstraintMatrix   &constraints,
+                           const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     create_mass_matrix(hp::StaticMappingQ1<dim,spacedim>::mapping_collection, dof, q,
-                       matrix, rhs, rhs_vector, coefficient, constraints);
+                       matrix, rhs, rhs_vector, coefficient, constraints, colored_cells);
   }
 
 
@@ -1663,7 +1758,8 @@ namespace MatrixCreator
                               const Quadrature<dim>    &q,
                               SparseMatrix<double>     &matrix,
                               const Function<spacedim> *const coefficient,
-                              const ConstraintMatrix   &constraints)
+                              const ConstraintMatrix   &constraints,
+                              const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     Assert (matrix.m() == dof.n_dofs(),
             ExcDimensionMismatch (matrix.m(), dof.n_dofs()));
@@ -1686,16 +1782,15 @@ namespace MatrixCreator
     copy_data.dof_indices.resize (assembler_data.fe_collection.max_dofs_per_cell());
     copy_data.constraints = &constraints;
 
-    WorkStream::run (dof.begin_active(),
-                     static_cast<typename DoFHandler<dim,spacedim>::active_cell_iterator>(dof.end()),
-                     &MatrixCreator::internal::laplace_assembler<dim, spacedim, typename DoFHandler<dim,spacedim>::active_cell_iterator>,
-                     std_cxx11::bind (&MatrixCreator::internal::
-                                      copy_local_to_global<SparseMatrix<double>, Vector<double> >,
-                                      std_cxx11::_1,
-                                      &matrix,
-                                      (Vector<double> *)NULL),
-                     assembler_data,
-                     copy_data);
+    internal::run_on_active_cells (dof, constraints, colored_cells,
+                                   &MatrixCreator::internal::laplace_assembler<dim, spacedim, typename DoFHandler<dim,spacedim>::active_cell_iterator>,
+                                   std_cxx11::bind (&MatrixCreator::internal::
+                                                    copy_local_to_global<SparseMatrix<double>, Vector<double> >,
+                                                    std_cxx11::_1,
+                                                    &matrix,
+                                                    (Vector<double> *)NULL),
+                                   assembler_data,
+                                   copy_data);
   }
 
 
@@ -1705,9 +1800,10 @@ namespace MatrixCreator
                               const Quadrature<dim>    &q,
                               SparseMatrix<double>     &matrix,
                               const Function<spacedim> *const coefficient,
-                              const ConstraintMatrix   &constraints)
+                              const ConstraintMatrix   &constraints,
+                              const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
-    create_laplace_matrix(StaticMappingQ1<dim,spacedim>::mapping, dof, q, matrix, coefficient);
+    create_laplace_matrix(StaticMappingQ1<dim,spacedim>::mapping, dof, q, matrix, coefficient, constraints, colored_cells);
   }
 
 
@@ -1720,7 +1816,8 @@ namespace MatrixCreator
                               const Function<spacedim>      &rhs,
                               Vector<double>           &rhs_vector,
                               const Function<spacedim> *const coefficient,
-                              const ConstraintMatrix   &constraints)
+                              const ConstraintMatrix   &constraints,
+                              const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     Assert (matrix.m() == dof.n_dofs(),
             ExcDimensionMismatch (matrix.m(), dof.n_dofs()));
@@ -1743,16 +1840,15 @@ namespace MatrixCreator
     copy_data.dof_indices.resize (assembler_data.fe_collection.max_dofs_per_cell());
     copy_data.constraints = &constraints;
 
-    WorkStream::run (dof.begin_active(),
-                     static_cast<typename DoFHandler<dim,spacedim>::active_cell_iterator>(dof.end()),
-                     &MatrixCreator::internal::laplace_assembler<dim, spacedim, typename DoFHandler<dim,spacedim>::active_cell_iterator>,
-                     std_cxx11::bind (&MatrixCreator::internal::
-                                      copy_local_to_global<SparseMatrix<double>, Vector<double> >,
-                                      std_cxx11::_1,
-                                      &matrix,
-                                      &rhs_vector),
-                     assembler_data,
-                     copy_data);
+    internal::run_on_active_cells (dof, constraints, colored_cells,
+                                   &MatrixCreator::internal::laplace_assembler<dim, spacedim, typename DoFHandler<dim,spacedim>::active_cell_iterator>,
+                                   std_cxx11::bind (&MatrixCreator::internal::
+                                                    copy_local_to_global<SparseMatrix<double>, Vector<double> >,
+                                                    std_cxx11::_1,
+                                                    &matrix,
+                                                    &rhs_vector),
+                                   assembler_data,
+                                   copy_data);
   }
 
 
@@ -1764,10 +1860,11 @@ namespace MatrixCreator
                               const Function<spacedim>      &rhs,
                               Vector<double>           &rhs_vector,
                               const Function<spacedim> *const coefficient,
-                              const ConstraintMatrix   &constraints)
+                              const ConstraintMatrix   &constraints,
+                              const std::vector<std::vector<typename DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     create_laplace_matrix(StaticMappingQ1<dim,spacedim>::mapping, dof, q,
-                          matrix, rhs, rhs_vector, coefficient);
+                          matrix, rhs, rhs_vector, coefficient, constraints, colored_cells);
   }
 
 
@@ -1778,7 +1875,8 @@ namespace MatrixCreator
                               const hp::QCollection<dim>    &q,
                               SparseMatrix<double>     &matrix,
                               const Function<spacedim> *const coefficient,
-                              const ConstraintMatrix   &constraints)
+                              const ConstraintMatrix   &constraints,
+                              const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     Assert (matrix.m() == dof.n_dofs(),
             ExcDimensionMismatch (matrix.m(), dof.n_dofs()));
@@ -1798,16 +1896,15 @@ namespace MatrixCreator
     copy_data.dof_indices.resize (assembler_data.fe_collection.max_dofs_per_cell());
     copy_data.constraints = &constraints;
 
-    WorkStream::run (dof.begin_active(),
-                     static_cast<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>(dof.end()),
-                     &MatrixCreator::internal::laplace_assembler<dim, spacedim, typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>,
-                     std_cxx11::bind (&MatrixCreator::internal::
-                                      copy_local_to_global<SparseMatrix<double>, Vector<double> >,
-                                      std_cxx11::_1,
-                                      &matrix,
-                                      (Vector<double> *)0),
-                     assembler_data,
-                     copy_data);
+    internal::run_on_active_cells (dof, constraints, colored_cells,
+                                   &MatrixCreator::internal::laplace_assembler<dim, spacedim, typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>,
+                                   std_cxx11::bind (&MatrixCreator::internal::
+                                                    copy_local_to_global<SparseMatrix<double>, Vector<double> >,
+                                                    std_cxx11::_1,
+                                                    &matrix,
+                                                    (Vector<double> *)0),
+                                   assembler_data,
+                                   copy_data);
   }
 
 
@@ -1817,9 +1914,10 @@ namespace MatrixCreator
                               const hp::QCollection<dim>    &q,
                               SparseMatrix<double>     &matrix,
                               const Function<spacedim> *const coefficient,
-                              const ConstraintMatrix   &constraints)
+                              const ConstraintMatrix   &constraints,
+                              const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
-    create_laplace_matrix(hp::StaticMappingQ1<dim,spacedim>::mapping_collection, dof, q, matrix, coefficient);
+    create_laplace_matrix(hp::StaticMappingQ1<dim,spacedim>::mapping_collection, dof, q, matrix, coefficient, constraints, colored_cells);
   }
 
 
@@ -1832,7 +1930,8 @@ namespace MatrixCreator
                               const Function<spacedim>      &rhs,
                               Vector<double>           &rhs_vector,
                               const Function<spacedim> *const coefficient,
-                              const ConstraintMatrix   &constraints)
+                              const ConstraintMatrix   &constraints,
+                              const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     Assert (matrix.m() == dof.n_dofs(),
             ExcDimensionMismatch (matrix.m(), dof.n_dofs()));
@@ -1852,16 +1951,15 @@ namespace MatrixCreator
     copy_data.dof_indices.resize (assembler_data.fe_collection.max_dofs_per_cell());
     copy_data.constraints = &constraints;
 
-    WorkStream::run (dof.begin_active(),
-                     static_cast<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>(dof.end()),
-                     &MatrixCreator::internal::laplace_assembler<dim, spacedim, typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>,
-                     std_cxx11::bind (&MatrixCreator::internal::
-                                      copy_local_to_global<SparseMatrix<double>, Vector<double> >,
-                                      std_cxx11::_1,
-                                      &matrix,
-                                      &rhs_vector),
-                     assembler_data,
-                     copy_data);
+    internal::run_on_active_cells (dof, constraints, colored_cells,
+                                   &MatrixCreator::internal::laplace_assembler<dim, spacedim, typename hp::DoFHandler<dim,spacedim>::active_cell_iterator>,
+                                   std_cxx11::bind (&MatrixCreator::internal::
+                                                    copy_local_to_global<SparseMatrix<double>, Vector<double> >,
+                                                    std_cxx11::_1,
+                                                    &matrix,
+                                                    &rhs_vector),
+                                   assembler_data,
+                                   copy_data);
   }
 
 
@@ -1873,10 +1971,11 @@ namespace MatrixCreator
                               const Function<spacedim>      &rhs,
                               Vector<double>           &rhs_vector,
                               const Function<spacedim> *const coefficient,
-                              const ConstraintMatrix   &constraints)
+                              const ConstraintMatrix   &constraints,
+                              const std::vector<std::vector<typename hp::DoFHandler<dim,spacedim>::active_cell_iterator> > *const colored_cells)
   {
     create_laplace_matrix(hp::StaticMappingQ1<dim,spacedim>::mapping_collection, dof, q,
-                          matrix, rhs, rhs_vector, coefficient);
+                          matrix, rhs, rhs_vector, coefficient, constraints, colored_cells);
   }
 
 }  // namespace MatrixCreator
@@ -0,0 +1,102 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check that HardwareCounters records regions entered through Scope
+// objects, TimerOutput sections and SparseMatrix::vmult only while it is
+// enabled. the counters themselves depend on the machine and on whether
+// the kernel allows access to them, so only the number of calls and the
+// model numbers are printed
+
+#include "../tests.h"
+#include <deal.II/base/hardware_counters.h>
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <fstream>
+#include <sstream>
+
+
+void print_regions ()
+{
+  const std::map<std::string, HardwareCounters::RegionData> regions
+    = HardwareCounters::get_region_data();
+  for (std::map<std::string, HardwareCounters::RegionData>::const_iterator
+       p = regions.begin(); p != regions.end(); ++p)
+    deallog << p->first << ": calls " << p->second.n_calls
+            << ", flops " << p->second.model_flops
+            << ", time nonnegative " << (p->second.wall_time >= 0 ? "yes" : "no")
+            << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  deallog << "Enabled initially: "
+          << (HardwareCounters::is_enabled() ? "yes" : "no") << std::endl;
+  HardwareCounters::enable (false);
+
+  for (unsigned int i=0; i<3; ++i)
+    {
+      HardwareCounters::Scope scope ("Region A", 2., 16.);
+    }
+
+  std::ostringstream timer_stream;
+  TimerOutput timer (timer_stream, TimerOutput::never, TimerOutput::wall_times);
+  for (unsigned int i=0; i<2; ++i)
+    {
+      TimerOutput::Scope timer_scope (timer, "Section");
+    }
+
+  // a tridiagonal matrix with 28 entries
+  SparsityPattern sparsity (10, 10, 3);
+  for (unsigned int i=0; i<10; ++i)
+    for (unsigned int j=(i>0 ? i-1 : 0); j<std::min(i+2,10U); ++j)
+      sparsity.add (i, j);
+  sparsity.compress ();
+  SparseMatrix<double> matrix (sparsity);
+  Vector<double> src (10), dst (10);
+  matrix.vmult (dst, src);
+
+  print_regions ();
+
+  // regions are not recorded while disabled
+  HardwareCounters::disable ();
+  {
+    HardwareCounters::Scope scope ("Region B");
+    matrix.vmult (dst, src);
+  }
+  deallog << "Regions after disabling: "
+          << HardwareCounters::get_region_data().size() << std::endl;
+
+  std::ostringstream summary;
+  HardwareCounters::set_machine_peaks (10., 5.);
+  HardwareCounters::print_summary (summary);
+  deallog << "Summary lists Region A: "
+          << (summary.str().find ("Region A") != std::string::npos ? "yes" : "no")
+          << std::endl;
+
+  HardwareCounters::reset ();
+  deallog << "Regions after reset: "
+          << HardwareCounters::get_region_data().size() << std::endl;
+}
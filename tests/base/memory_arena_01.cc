@@ -0,0 +1,123 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check MemoryArena, ArenaAllocator and ArenaArray: memory is aligned,
+// released memory is handed out again, blocks are merged when the arena is
+// empty so that a loop with the same sizes in every iteration does not
+// allocate from the heap after the first one, and copies of an arena are
+// independent
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/memory_arena.h>
+#include <fstream>
+#include <vector>
+
+
+// the work on one item: a std::vector that grows, and nested arrays
+double work (MemoryArena &arena)
+{
+  arena.reset ();
+  std::vector<double, ArenaAllocator<double> > values ((ArenaAllocator<double> (arena)));
+  for (unsigned int i=0; i<1000; ++i)
+    values.push_back (i);
+
+  double sum = 0;
+  {
+    ArenaArray<double> a (3000, arena);
+    for (unsigned int i=0; i<a.size(); ++i)
+      a[i] = 1.;
+    {
+      ArenaArray<unsigned int> b (10000, arena);
+      for (unsigned int i=0; i<b.size(); ++i)
+        b[i] = 2;
+      for (unsigned int i=0; i<b.size(); ++i)
+        sum += b[i];
+    }
+    for (const double *p=a.begin(); p!=a.end(); ++p)
+      sum += *p;
+  }
+  for (unsigned int i=0; i<values.size(); ++i)
+    sum += values[i];
+  return sum;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  MemoryArena arena;
+
+  // alignment
+  bool aligned = true;
+  for (unsigned int i=0; i<10; ++i)
+    {
+      arena.allocate (i+1, 1);
+      const std::size_t alignment = 1 << (i%7);
+      if (reinterpret_cast<std::size_t>(arena.allocate (3, alignment)) % alignment != 0)
+        aligned = false;
+    }
+  deallog << "Aligned: " << (aligned ? "yes" : "no") << std::endl;
+
+  // release to a position hands out the same memory again
+  const MemoryArena::Position position = arena.get_position ();
+  void *p1 = arena.allocate (100);
+  arena.release (position);
+  void *p2 = arena.allocate (100);
+  deallog << "Same memory after release: " << (p1 == p2 ? "yes" : "no")
+          << std::endl;
+
+  // the first items need several blocks, but later ones none
+  for (unsigned int item=0; item<5; ++item)
+    {
+      const std::size_t n_allocations = arena.n_heap_allocations();
+      const double sum = work (arena);
+      deallog << "Item " << item << ": sum " << sum << ", new blocks: "
+              << (arena.n_heap_allocations() > n_allocations ? "yes" : "no")
+              << std::endl;
+    }
+  arena.reset ();
+  deallog << "Memory large enough for one item: "
+          << (arena.memory_consumption() > 3000*sizeof(double) +
+              10000*sizeof(unsigned int) ? "yes" : "no")
+          << std::endl;
+
+  // a copy starts empty
+  const MemoryArena copy (arena);
+  deallog << "Copy allocations: " << copy.n_heap_allocations() << std::endl;
+
+  // arrays on the arena of this thread
+  {
+    ArenaArray<double> a (5);
+    ArenaArray<double> b (200000);
+    deallog << "Thread local arrays: " << a.size() << ' ' << b.size()
+            << std::endl;
+  }
+  const std::size_t n_allocations
+    = MemoryArena::thread_local_arena().n_heap_allocations();
+  {
+    ArenaArray<double> b (200000);
+  }
+  deallog << "Thread local arena reused: "
+          << (MemoryArena::thread_local_arena().n_heap_allocations() ==
+              n_allocations ? "yes" : "no")
+          << std::endl;
+}
@@ -0,0 +1,129 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check that MemoryProfiler records the sections of a TimerOutput object
+// and Scope objects as phases while it is enabled, together with the memory
+// consumption of the registered objects when asked for it, either for a
+// single phase or at the end of every phase. the memory statistics of the
+// process depend on the machine, so only their consistency is checked
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/memory_profiler.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/lac/vector.h>
+#include <fstream>
+#include <sstream>
+
+
+void print_phases ()
+{
+  const std::map<std::string, MemoryProfiler::PhaseData> phases
+    = MemoryProfiler::get_phase_data();
+  for (std::map<std::string, MemoryProfiler::PhaseData>::const_iterator
+       p = phases.begin(); p != phases.end(); ++p)
+    {
+      deallog << p->first << ": calls " << p->second.n_calls
+              << ", peak memory at least resident memory "
+              << (p->second.hwm >= p->second.max_rss ? "yes" : "no")
+              << std::endl;
+      for (std::map<std::string, std::size_t>::const_iterator
+           o = p->second.object_memory.begin();
+           o != p->second.object_memory.end(); ++o)
+        deallog << "  " << o->first << ": " << o->second / 1000
+                << " kB" << std::endl;
+    }
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  deallog << "Enabled initially: "
+          << (MemoryProfiler::is_enabled() ? "yes" : "no") << std::endl;
+  MemoryProfiler::enable (false);
+
+  Vector<double> small (1000), large;
+  MemoryProfiler::register_object ("Small vector", small);
+  MemoryProfiler::register_object ("Large vector", large);
+
+  std::ostringstream timer_stream;
+  TimerOutput timer (timer_stream, TimerOutput::never, TimerOutput::wall_times);
+  {
+    TimerOutput::Scope timer_scope (timer, "Setup");
+    large.reinit (100000);
+    MemoryProfiler::sample_objects ("Setup");
+  }
+  for (unsigned int i=0; i<2; ++i)
+    {
+      TimerOutput::Scope timer_scope (timer, "Solve");
+      large.add (1., large);
+      MemoryProfiler::sample_objects ("Solve");
+    }
+
+  // the largest memory consumption of an object in a phase is kept
+  MemoryProfiler::unregister_object ("Small vector");
+  for (unsigned int i=0; i<3; ++i)
+    {
+      MemoryProfiler::Scope scope ("Postprocess");
+      if (i == 1)
+        large.reinit (50000);
+      MemoryProfiler::sample_objects ("Postprocess");
+    }
+
+  // objects are only sampled on request
+  {
+    TimerOutput::Scope timer_scope (timer, "Output");
+  }
+
+  print_phases ();
+
+  std::ostringstream report;
+  MemoryProfiler::print_report (report);
+  deallog << "Report lists Setup: "
+          << (report.str().find ("Setup") != std::string::npos ? "yes" : "no")
+          << std::endl;
+
+  // phases are not recorded while disabled
+  MemoryProfiler::disable ();
+  {
+    MemoryProfiler::Scope scope ("Disabled");
+  }
+  deallog << "Phases after disabling: "
+          << MemoryProfiler::get_phase_data().size() << std::endl;
+
+  MemoryProfiler::reset ();
+  deallog << "Phases after reset: "
+          << MemoryProfiler::get_phase_data().size() << std::endl;
+
+  // when requested, objects are sampled at the end of every phase
+  MemoryProfiler::enable (false, true);
+  {
+    TimerOutput::Scope timer_scope (timer, "Automatic");
+  }
+  {
+    MemoryProfiler::Scope scope ("Automatic scope");
+  }
+  print_phases ();
+
+  MemoryProfiler::unregister_object ("Large vector");
+}
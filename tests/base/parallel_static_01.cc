@@ -0,0 +1,122 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// test parallel::apply_to_static_subranges: the range must be covered
+// exactly once by the same chunks in every call, with not more chunks than
+// threads. also check that the containers that initialize newly allocated
+// memory with it are correctly initialized, with and without bound threads
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/base/aligned_vector.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <fstream>
+#include <set>
+#include <vector>
+
+
+Threads::Mutex mutex;
+
+
+void mark (const unsigned int                         begin,
+           const unsigned int                         end,
+           std::vector<unsigned int>                 &visits,
+           std::set<std::pair<unsigned int,unsigned int> > &chunks)
+{
+  for (unsigned int i=begin; i<end; ++i)
+    ++visits[i];
+
+  Threads::Mutex::ScopedLock lock (mutex);
+  chunks.insert (std::make_pair (begin, end));
+}
+
+
+
+void test ()
+{
+  const unsigned int N = 100000;
+  std::vector<unsigned int> visits (N, 0);
+  std::set<std::pair<unsigned int,unsigned int> > chunks[2];
+  for (unsigned int run=0; run<2; ++run)
+    parallel::apply_to_static_subranges (0U, N,
+                                         std_cxx11::bind (&mark,
+                                                          std_cxx11::_1,
+                                                          std_cxx11::_2,
+                                                          std_cxx11::ref(visits),
+                                                          std_cxx11::ref(chunks[run])),
+                                         1000);
+
+  bool covered_twice = true;
+  for (unsigned int i=0; i<N; ++i)
+    if (visits[i] != 2)
+      covered_twice = false;
+  deallog << "Every index visited once per call: "
+          << (covered_twice ? "yes" : "no") << std::endl;
+  deallog << "Same chunks in both calls: "
+          << (chunks[0] == chunks[1] ? "yes" : "no") << std::endl;
+  deallog << "Number of chunks matches: "
+          << (chunks[0].size() == parallel::internal::n_static_chunks (N, 1000) &&
+              chunks[0].size() <= multithread_info.n_threads() ? "yes" : "no")
+          << std::endl;
+
+  // newly allocated memory is set to zero also for fast reinit
+  Vector<double> vector;
+  vector.reinit (N, true);
+  deallog << "Vector zero: " << (vector.linfty_norm() == 0 ? "yes" : "no")
+          << std::endl;
+
+  SparsityPattern sparsity (N/10, N/10, 3);
+  for (unsigned int i=0; i<N/10; ++i)
+    sparsity.add (i, (i+1)%(N/10));
+  sparsity.compress ();
+  SparseMatrix<double> matrix (sparsity);
+  deallog << "Matrix zero: " << (matrix.linfty_norm() == 0 ? "yes" : "no")
+          << std::endl;
+
+  AlignedVector<double> aligned;
+  aligned.resize (N, 1.);
+  double sum = 0;
+  for (unsigned int i=0; i<N; ++i)
+    sum += aligned[i];
+  deallog << "AlignedVector sum: " << sum << std::endl;
+}
+
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  test ();
+
+  multithread_info.set_thread_affinity (MultithreadInfo::compact_thread_affinity);
+  deallog << "Compact affinity set: "
+          << (multithread_info.get_thread_affinity() ==
+              MultithreadInfo::compact_thread_affinity ? "yes" : "no")
+          << std::endl;
+  test ();
+
+  multithread_info.set_thread_affinity (MultithreadInfo::no_thread_affinity);
+}
@@ -0,0 +1,165 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check the static partitioning mode: parallel::apply_to_subranges must
+// still cover the range exactly once, parallel::accumulate_from_subranges
+// must give the same result in every call, and the norms and inner products
+// of vectors must be bitwise identical to those computed with dynamic
+// partitioning. the reductions of the sparse matrix must give the same
+// result in every call
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <fstream>
+#include <vector>
+
+
+void mark (const unsigned int         begin,
+           const unsigned int         end,
+           std::vector<unsigned int> &visits)
+{
+  for (unsigned int i=begin; i<end; ++i)
+    ++visits[i];
+}
+
+
+
+double sum (const unsigned int begin,
+            const unsigned int end)
+{
+  double s = 0;
+  for (unsigned int i=begin; i<end; ++i)
+    s += 1./(i+1);
+  return s;
+}
+
+
+
+std::vector<double> vector_reductions (const Vector<double> &v,
+                                       const Vector<double> &w)
+{
+  std::vector<double> results;
+  results.push_back (v.l2_norm());
+  results.push_back (v.l1_norm());
+  results.push_back (v.lp_norm(3.));
+  results.push_back (v * w);
+  results.push_back (v.mean_value());
+  return results;
+}
+
+
+
+std::vector<double> matrix_reductions (const Vector<double>       &v,
+                                       const Vector<double>       &w,
+                                       const SparseMatrix<double> &matrix)
+{
+  std::vector<double> results;
+  Vector<double> dst (v.size());
+  results.push_back (matrix.residual (dst, v, w));
+  results.push_back (matrix.matrix_norm_square (v));
+  return results;
+}
+
+
+
+void test ()
+{
+  const unsigned int N = 200000;
+
+  std::vector<unsigned int> visits (N, 0);
+  parallel::apply_to_subranges (0U, N,
+                                std_cxx11::bind (&mark,
+                                                 std_cxx11::_1,
+                                                 std_cxx11::_2,
+                                                 std_cxx11::ref(visits)),
+                                1000);
+  bool covered_once = true;
+  for (unsigned int i=0; i<N; ++i)
+    if (visits[i] != 1)
+      covered_once = false;
+  deallog << "Every index visited once: "
+          << (covered_once ? "yes" : "no") << std::endl;
+
+  const double sum_first = parallel::accumulate_from_subranges<double> (&sum, 0U, N, 1000);
+  bool same_sum = true;
+  for (unsigned int run=0; run<10; ++run)
+    if (parallel::accumulate_from_subranges<double> (&sum, 0U, N, 1000) != sum_first)
+      same_sum = false;
+  deallog << "Same sum in every call: " << (same_sum ? "yes" : "no") << std::endl;
+  deallog << "Sum: " << sum_first << std::endl;
+
+  Vector<double> v (N), w (N);
+  for (unsigned int i=0; i<N; ++i)
+    {
+      v(i) = std::sin (1.+i);
+      w(i) = std::cos (3.*i);
+    }
+
+  SparsityPattern sparsity (N, N, 3);
+  for (unsigned int i=0; i<N; ++i)
+    for (unsigned int j=(i>0 ? i-1 : 0); j<std::min(i+2,N); ++j)
+      sparsity.add (i, j);
+  sparsity.compress ();
+  SparseMatrix<double> matrix (sparsity);
+  for (unsigned int i=0; i<N; ++i)
+    for (unsigned int j=(i>0 ? i-1 : 0); j<std::min(i+2,N); ++j)
+      matrix.set (i, j, (i == j ? 2.+std::sin(1.*i) : -1.));
+
+  parallel::set_partitioning_mode (parallel::dynamic_partitioning);
+  const std::vector<double> dynamic_results = vector_reductions (v, w);
+  parallel::set_partitioning_mode (parallel::static_partitioning);
+  bool same_results = true;
+  for (unsigned int run=0; run<10; ++run)
+    if (vector_reductions (v, w) != dynamic_results)
+      same_results = false;
+  deallog << "Vector reductions identical to dynamic partitioning: "
+          << (same_results ? "yes" : "no") << std::endl;
+  for (unsigned int i=0; i<dynamic_results.size(); ++i)
+    deallog << dynamic_results[i] << std::endl;
+
+  const std::vector<double> matrix_results = matrix_reductions (v, w, matrix);
+  same_results = true;
+  for (unsigned int run=0; run<10; ++run)
+    if (matrix_reductions (v, w, matrix) != matrix_results)
+      same_results = false;
+  deallog << "Same matrix reductions in every call: "
+          << (same_results ? "yes" : "no") << std::endl;
+  for (unsigned int i=0; i<matrix_results.size(); ++i)
+    deallog << matrix_results[i] << std::endl;
+}
+
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  parallel::set_partitioning_mode (parallel::static_partitioning);
+  deallog << "Static partitioning set: "
+          << (parallel::get_partitioning_mode() == parallel::static_partitioning ?
+              "yes" : "no")
+          << std::endl;
+
+  test ();
+}
@@ -0,0 +1,94 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check the call tree of TimerOutput: nested sections entered by name and
+// through handles, sections entered on several tasks, a section left on
+// another thread than the one that entered it, and the JSON output.
+// lines with times and the number of threads are not printed since they
+// vary between runs and configurations
+
+#include "../tests.h"
+#include <deal.II/base/timer.h>
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/thread_management.h>
+#include <fstream>
+#include <sstream>
+
+
+void work (TimerOutput &timer, const unsigned int section)
+{
+  TimerOutput::Scope scope (timer, section);
+  TimerOutput::Scope inner_scope (timer, "Task inner");
+}
+
+
+
+void leave (TimerOutput &timer)
+{
+  timer.leave_subsection ("Handover");
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  std::ostringstream summary;
+  TimerOutput timer (summary, TimerOutput::never, TimerOutput::wall_times);
+
+  const unsigned int assemble = timer.register_section ("Assemble");
+  deallog << "Handle of \"Assemble\" is stable: "
+          << (timer.register_section ("Assemble") == assemble ? "yes" : "no")
+          << std::endl;
+
+  for (unsigned int i=0; i<2; ++i)
+    {
+      TimerOutput::Scope scope (timer, assemble);
+      {
+        TimerOutput::Scope inner_scope (timer, "Cell loop");
+      }
+      timer.enter_subsection ("Compress");
+      timer.leave_subsection ("Compress");
+    }
+
+  {
+    TimerOutput::Scope scope (timer, "Solve");
+    TimerOutput::Scope inner_scope (timer, "Compress");
+  }
+
+  const unsigned int task_section = timer.register_section ("Task");
+  Threads::TaskGroup<void> tasks;
+  for (unsigned int i=0; i<4; ++i)
+    tasks += Threads::new_task (&work, timer, task_section);
+  tasks.join_all ();
+
+  timer.enter_subsection ("Handover");
+  Threads::new_thread (&leave, timer).join ();
+
+  std::ostringstream json;
+  timer.write_json (json);
+
+  std::istringstream lines (json.str());
+  std::string line;
+  while (std::getline (lines, line))
+    if (line.find ("time") == std::string::npos &&
+        line.find ("threads") == std::string::npos)
+      deallog << line << std::endl;
+}
@@ -0,0 +1,167 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// like _05_graph, but with WorkStream::run_as_task_graph. in addition,
+// check that conflicting items are copied in the order of their colors,
+// and test the dependencies of the task graph directly
+
+#include "../tests.h"
+#include <fstream>
+
+#include <deal.II/base/work_stream.h>
+#include <deal.II/base/graph_coloring.h>
+#include <deal.II/lac/vector.h>
+
+
+Vector<double> result(100);
+
+// the order in which the copier was called for the elements
+std::vector<unsigned int> copy_order;
+Threads::Mutex mutex;
+
+
+struct ScratchData
+{};
+
+
+struct CopyData
+{
+  unsigned int element;
+  unsigned int computed;
+};
+
+
+void worker (const std::vector<unsigned int>::iterator &i,
+             ScratchData &,
+             CopyData &ad)
+{
+  ad.element = *i;
+  ad.computed = *i * 2;
+}
+
+void copier (const CopyData &ad)
+{
+  // write into the five elements of 'result' starting at ad.computed%result.size()
+  for (unsigned int j=0; j<5; ++j)
+    result((ad.computed+j) % result.size()) += ad.computed;
+
+  Threads::Mutex::ScopedLock lock (mutex);
+  copy_order.push_back (ad.element);
+}
+
+
+// the function that computes conflicts
+std::vector<types::global_dof_index>
+conflictor (const std::vector<unsigned int>::iterator &i)
+{
+  std::vector<types::global_dof_index> conflicts;
+  const unsigned int ad_computed = *i * 2;
+  for (unsigned int j=0; j<5; ++j)
+    conflicts.push_back ((ad_computed+j) % result.size());
+
+  return conflicts;
+}
+
+
+
+void test ()
+{
+  std::vector<unsigned int> v;
+  for (unsigned int i=0; i<200; ++i)
+    v.push_back (i);
+
+  const std::vector<std::vector<std::vector<unsigned int>::iterator> >
+  coloring = GraphColoring::make_graph_coloring (v.begin(), v.end(),
+                                                 std_cxx11::function<std::vector<types::global_dof_index>
+                                                 (const std::vector<unsigned int>::iterator &)>
+                                                 (&conflictor));
+
+  WorkStream::run_as_task_graph (coloring, &conflictor,
+                                 &worker, &copier,
+                                 ScratchData(),
+                                 CopyData());
+
+  // now simulate what we should have gotten
+  Vector<double> comp(result.size());
+  for (unsigned int i=0; i<v.size(); ++i)
+    {
+      const unsigned int ad_computed = v[i] * 2;
+      for (unsigned int j=0; j<5; ++j)
+        comp((ad_computed+j) % result.size()) += ad_computed;
+    }
+
+  // and compare
+  for (unsigned int i=0; i<result.size(); ++i)
+    Assert (result(i) == comp(i), ExcInternalError());
+
+  for (unsigned int i=0; i<result.size(); ++i)
+    deallog << result(i) << std::endl;
+
+  // every element was copied exactly once, and of two conflicting elements
+  // the one of the earlier color first
+  std::vector<unsigned int> color (v.size()), position (v.size());
+  for (unsigned int c=0; c<coloring.size(); ++c)
+    for (unsigned int i=0; i<coloring[c].size(); ++i)
+      color[*coloring[c][i]] = c;
+  Assert (copy_order.size() == v.size(), ExcInternalError());
+  for (unsigned int i=0; i<copy_order.size(); ++i)
+    position[copy_order[i]] = i;
+
+  bool in_order = true;
+  for (unsigned int i=0; i<v.size(); ++i)
+    for (unsigned int j=0; j<v.size(); ++j)
+      if (color[i] < color[j] &&
+          std::abs (int(2*i % result.size()) - int(2*j % result.size())) < 5 &&
+          position[i] > position[j])
+        in_order = false;
+  deallog << "Conflicting elements copied in order: "
+          << (in_order ? "yes" : "no") << std::endl;
+
+  // the items that wait for the first item of the first color: those of
+  // later colors that share an index with it and are the first to do so
+  std::vector<const std::vector<unsigned int>::iterator *> items;
+  std::vector<std::vector<unsigned int> > successors;
+  std::vector<unsigned int> n_predecessors;
+  WorkStream::internal::TaskGraph::make_dependencies
+  (coloring,
+   std_cxx11::function<std::vector<types::global_dof_index>
+   (const std::vector<unsigned int>::iterator &)> (&conflictor),
+   items, successors, n_predecessors);
+  unsigned int n_edges = 0, n_independent = 0;
+  for (unsigned int i=0; i<items.size(); ++i)
+    {
+      n_edges += successors[i].size();
+      if (n_predecessors[i] == 0)
+        ++n_independent;
+    }
+  deallog << "Items: " << items.size()
+          << ", edges: " << n_edges
+          << ", items without predecessors: " << n_independent
+          << ", size of first color: " << coloring[0].size() << std::endl;
+}
+
+
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  test ();
+}
@@ -0,0 +1,225 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __deal2__benchmarks_kernels_benchmark_h
+#define __deal2__benchmarks_kernels_benchmark_h
+
+// common infrastructure of the kernel benchmarks: timing of a kernel, and
+// output of the results along with some information about the machine and
+// the library in JSON format
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/std_cxx11/bind.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/base/utilities.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using namespace dealii;
+
+
+namespace Benchmark
+{
+  // the minimal time in seconds a kernel is run for. it can be changed by
+  // the environment variable DEAL_II_BENCHMARK_TIME
+  inline
+  double min_time ()
+  {
+    const char *time = std::getenv ("DEAL_II_BENCHMARK_TIME");
+    if (time != 0)
+      return std::atof (time);
+    else
+      return 0.2;
+  }
+
+
+
+  // run the given function once to warm up caches and allocate memory, then
+  // repeatedly for at least min_time() seconds, and at least three
+  // times. return the fastest time of one call, which is the measure least
+  // affected by other processes on the machine
+  template <typename Function>
+  double time_kernel (const Function &function)
+  {
+    function ();
+
+    const double minimal_time = min_time();
+    double best_time = std::numeric_limits<double>::max();
+    double total_time = 0;
+    unsigned int n_runs = 0;
+    Timer timer;
+    while (total_time < minimal_time || n_runs < 3)
+      {
+        timer.restart ();
+        function ();
+        const double time = timer.wall_time ();
+        best_time = std::min (best_time, time);
+        total_time += time;
+        ++n_runs;
+      }
+    return best_time;
+  }
+
+
+
+  inline
+  std::string escape (const std::string &text)
+  {
+    std::string result;
+    for (unsigned int i=0; i<text.size(); ++i)
+      {
+        if (text[i] == '"' || text[i] == '\\')
+          result += '\\';
+        result += text[i];
+      }
+    return result;
+  }
+
+
+
+  // the model name of the processor, if the system tells it
+  inline
+  std::string cpu_model ()
+  {
+    std::ifstream cpuinfo ("/proc/cpuinfo");
+    std::string line;
+    while (std::getline (cpuinfo, line))
+      if (line.find ("model name") == 0 &&
+          line.find (':') != std::string::npos)
+        return line.substr (line.find (':') + 2);
+    return "unknown";
+  }
+
+
+
+  // the results of one benchmark program: for every kernel, its name, the
+  // problem size (vector entries, matrix rows, or degrees of freedom), the
+  // time of one call, and the throughput in the given unit, usually GB/s
+  // for kernels that are limited by memory bandwidth and DoFs/s for the
+  // others
+  class Results
+  {
+  public:
+    Results (const std::string &suite)
+      :
+      suite (suite)
+    {}
+
+    void add (const std::string &kernel,
+              const std::size_t  size,
+              const double       time,
+              const double       throughput,
+              const std::string &unit)
+    {
+      Entry entry;
+      entry.kernel = kernel;
+      entry.size = size;
+      entry.time = time;
+      entry.throughput = throughput;
+      entry.unit = unit;
+      entries.push_back (entry);
+
+      std::cerr << suite << ": " << kernel << ", size " << size
+                << ": " << throughput << " " << unit << std::endl;
+    }
+
+    // add a kernel that moves the given number of bytes per call
+    void add_bandwidth (const std::string &kernel,
+                        const std::size_t  size,
+                        const double       time,
+                        const double       bytes)
+    {
+      add (kernel, size, time, bytes / time * 1e-9, "GB/s");
+    }
+
+    // add a kernel that works on the given number of degrees of freedom
+    // per call
+    void add_dof_rate (const std::string &kernel,
+                       const std::size_t  n_dofs,
+                       const double       time)
+    {
+      add (kernel, n_dofs, time, n_dofs / time, "DoFs/s");
+    }
+
+    void print (std::ostream &out) const
+    {
+      const std::time_t now = std::time (0);
+      char date[32];
+      std::strftime (date, sizeof(date), "%Y-%m-%d %H:%M:%S",
+                     std::localtime (&now));
+
+      out << "{" << std::endl
+          << "  \"suite\": \"" << escape(suite) << "\"," << std::endl
+          << "  \"machine\": {" << std::endl
+          << "    \"hostname\": \"" << escape(Utilities::System::get_hostname())
+          << "\"," << std::endl
+          << "    \"cpu\": \"" << escape(cpu_model()) << "\"," << std::endl
+          << "    \"n_cpus\": " << multithread_info.n_cpus << "," << std::endl
+          << "    \"n_threads\": " << multithread_info.n_threads() << ","
+          << std::endl
+          << "    \"date\": \"" << date << "\"" << std::endl
+          << "  }," << std::endl
+          << "  \"library\": {" << std::endl
+          << "    \"version\": \"" << DEAL_II_PACKAGE_VERSION << "\","
+          << std::endl
+#ifdef DEBUG
+          << "    \"build\": \"debug\"," << std::endl
+#else
+          << "    \"build\": \"release\"," << std::endl
+#endif
+#ifdef __VERSION__
+          << "    \"compiler\": \"" << escape(__VERSION__) << "\"," << std::endl
+#endif
+          << "    \"vectorization_level\": "
+          << DEAL_II_COMPILER_VECTORIZATION_LEVEL << std::endl
+          << "  }," << std::endl
+          << "  \"results\": [" << std::endl;
+      for (unsigned int i=0; i<entries.size(); ++i)
+        out << "    {\"kernel\": \"" << escape(entries[i].kernel)
+            << "\", \"size\": " << entries[i].size
+            << ", \"time\": " << entries[i].time
+            << ", \"throughput\": " << entries[i].throughput
+            << ", \"unit\": \"" << entries[i].unit << "\"}"
+            << (i+1 < entries.size() ? "," : "") << std::endl;
+      out << "  ]" << std::endl
+          << "}" << std::endl;
+    }
+
+  private:
+    struct Entry
+    {
+      std::string kernel;
+      std::size_t size;
+      double      time;
+      double      throughput;
+      std::string unit;
+    };
+
+    const std::string  suite;
+    std::vector<Entry> entries;
+  };
+}
+
+#endif
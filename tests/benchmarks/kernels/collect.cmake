@@ -0,0 +1,31 @@
+## ---------------------------------------------------------------------
+##
+## Copyright (C) 2014 by the deal.II authors
+##
+## This file is part of the deal.II library.
+##
+## The deal.II library is free software; you can use it, redistribute
+## it, and/or modify it under the terms of the GNU Lesser General
+## Public License as published by the Free Software Foundation; either
+## version 2.1 of the License, or (at your option) any later version.
+## The full text of the license can be found in the file LICENSE at
+## the top level of the deal.II distribution.
+##
+## ---------------------------------------------------------------------
+
+# This file is run by "make benchmarks" after all benchmark programs have
+# run. It collects the results of the programs (RESULTS) in a JSON array
+# written to OUTPUT.
+
+SEPARATE_ARGUMENTS(RESULTS)
+
+SET(_output "[\n")
+SET(_separator "")
+FOREACH(_file ${RESULTS})
+  FILE(READ ${_file} _content)
+  SET(_output "${_output}${_separator}${_content}")
+  SET(_separator ",\n")
+ENDFOREACH()
+FILE(WRITE ${OUTPUT} "${_output}]\n")
+
+MESSAGE("Benchmark results written to ${OUTPUT}")
@@ -0,0 +1,92 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// throughput of DataOut::build_patches and of the output writers for a
+// scalar field of continuous elements of degree two on a 3D mesh. the
+// writers are run on a string stream, and their bandwidth is the number of
+// bytes they produce per second
+
+#include "benchmark.h"
+
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/numerics/data_out.h>
+
+#include <sstream>
+
+
+void build_patches (DataOut<3> &data_out)
+{
+  data_out.build_patches (2);
+}
+
+
+
+void write_output (const DataOut<3>                &data_out,
+                   const DataOutBase::OutputFormat  format,
+                   std::size_t                     &size)
+{
+  std::ostringstream out;
+  data_out.write (out, format);
+  size = out.str().size();
+}
+
+
+
+int main ()
+{
+  Benchmark::Results results ("data_out");
+
+  Triangulation<3> triangulation;
+  GridGenerator::hyper_cube (triangulation);
+  triangulation.refine_global (4);
+
+  FE_Q<3> fe (2);
+  DoFHandler<3> dof_handler (triangulation);
+  dof_handler.distribute_dofs (fe);
+
+  Vector<double> solution (dof_handler.n_dofs());
+  for (unsigned int i=0; i<solution.size(); ++i)
+    solution(i) = 1. + 1e-3 * (i % 13);
+
+  DataOut<3> data_out;
+  data_out.attach_dof_handler (dof_handler);
+  data_out.add_data_vector (solution, "solution");
+  results.add_dof_rate ("DataOut::build_patches", dof_handler.n_dofs(),
+                        Benchmark::time_kernel (std_cxx11::bind (&build_patches,
+                                                                 std_cxx11::ref(data_out))));
+
+  const DataOutBase::OutputFormat formats[]
+    = { DataOutBase::vtu, DataOutBase::vtk, DataOutBase::gnuplot,
+        DataOutBase::ucd, DataOutBase::deal_II_intermediate
+      };
+  for (unsigned int f=0; f<sizeof(formats)/sizeof(formats[0]); ++f)
+    {
+      std::size_t size = 0;
+      const double time
+        = Benchmark::time_kernel (std_cxx11::bind (&write_output,
+                                                   std_cxx11::cref(data_out),
+                                                   formats[f],
+                                                   std_cxx11::ref(size)));
+      results.add_bandwidth ("DataOut::write " + DataOutBase::default_suffix(formats[f]),
+                             dof_handler.n_dofs(), time, size);
+    }
+
+  results.print (std::cout);
+}
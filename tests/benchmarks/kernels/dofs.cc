@@ -0,0 +1,135 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// throughput of the mesh and degree of freedom handling: adaptive
+// refinement and coarsening of a Triangulation, DoFHandler::distribute_dofs,
+// and ConstraintMatrix::distribute for the hanging node constraints on an
+// adaptively refined mesh
+
+#include "benchmark.h"
+
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/vector.h>
+
+
+// refine every third active cell and coarsen the new cells again, which
+// leaves the mesh as it was
+template <int dim>
+void refine_and_coarsen (Triangulation<dim> &triangulation)
+{
+  const unsigned int n_levels = triangulation.n_levels();
+  unsigned int index = 0;
+  for (typename Triangulation<dim>::active_cell_iterator
+       cell = triangulation.begin_active(); cell != triangulation.end();
+       ++cell, ++index)
+    if (index % 3 == 0)
+      cell->set_refine_flag ();
+  triangulation.execute_coarsening_and_refinement ();
+
+  for (typename Triangulation<dim>::active_cell_iterator
+       cell = triangulation.begin_active(n_levels); cell != triangulation.end();
+       ++cell)
+    cell->set_coarsen_flag ();
+  triangulation.execute_coarsening_and_refinement ();
+}
+
+
+
+template <int dim>
+void distribute_dofs (DoFHandler<dim>          &dof_handler,
+                      const FiniteElement<dim> &fe)
+{
+  dof_handler.distribute_dofs (fe);
+}
+
+
+
+void distribute_constraints (const ConstraintMatrix &constraints,
+                             Vector<double>         &vector)
+{
+  constraints.distribute (vector);
+}
+
+
+
+template <int dim>
+void run (Benchmark::Results &results,
+          const unsigned int  n_refinements)
+{
+  const std::string dimension = "dim=" + Utilities::int_to_string(dim);
+
+  Triangulation<dim> triangulation;
+  GridGenerator::hyper_cube (triangulation);
+  triangulation.refine_global (n_refinements);
+  const unsigned int n_cells = triangulation.n_active_cells();
+
+  const double time_refine
+    = Benchmark::time_kernel (std_cxx11::bind (&refine_and_coarsen<dim>,
+                                               std_cxx11::ref(triangulation)));
+  results.add ("Triangulation refine and coarsen, " + dimension, n_cells,
+               time_refine, n_cells / time_refine, "cells/s");
+
+  // refine the mesh adaptively for the hanging node constraints
+  {
+    unsigned int index = 0;
+    for (typename Triangulation<dim>::active_cell_iterator
+         cell = triangulation.begin_active(); cell != triangulation.end();
+         ++cell, ++index)
+      if (index % 3 == 0)
+        cell->set_refine_flag ();
+    triangulation.execute_coarsening_and_refinement ();
+  }
+
+  FE_Q<dim> fe (2);
+  DoFHandler<dim> dof_handler (triangulation);
+  const double time_distribute
+    = Benchmark::time_kernel (std_cxx11::bind (&distribute_dofs<dim>,
+                                               std_cxx11::ref(dof_handler),
+                                               std_cxx11::cref(fe)));
+  results.add_dof_rate ("DoFHandler::distribute_dofs, " + dimension + ", FE_Q(2)",
+                        dof_handler.n_dofs(), time_distribute);
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof_handler, constraints);
+  constraints.close ();
+  Vector<double> vector (dof_handler.n_dofs());
+  for (unsigned int i=0; i<vector.size(); ++i)
+    vector(i) = 1. + 1e-3 * (i % 7);
+  results.add_dof_rate ("ConstraintMatrix::distribute, " + dimension + ", FE_Q(2)",
+                        constraints.n_constraints(),
+                        Benchmark::time_kernel (std_cxx11::bind (&distribute_constraints,
+                                                                 std_cxx11::cref(constraints),
+                                                                 std_cxx11::ref(vector))));
+}
+
+
+
+int main ()
+{
+  Benchmark::Results results ("dofs");
+
+  run<2> (results, 8);
+  run<3> (results, 5);
+
+  results.print (std::cout);
+}
@@ -0,0 +1,82 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// throughput of FEValues::reinit for continuous elements of degrees one to
+// four with values, gradients and the Jacobian determinant, on a distorted
+// mesh so that the mapping has to be computed on every cell
+
+#include "benchmark.h"
+
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+
+
+template <int dim>
+void reinit_all (FEValues<dim>         &fe_values,
+                 const DoFHandler<dim> &dof_handler)
+{
+  for (typename DoFHandler<dim>::active_cell_iterator
+       cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+    fe_values.reinit (cell);
+}
+
+
+
+template <int dim>
+void run (Benchmark::Results &results,
+          const unsigned int  n_refinements)
+{
+  Triangulation<dim> triangulation;
+  GridGenerator::hyper_cube (triangulation);
+  triangulation.refine_global (n_refinements);
+  GridTools::distort_random (0.2, triangulation);
+
+  for (unsigned int degree=1; degree<=4; ++degree)
+    {
+      FE_Q<dim> fe (degree);
+      DoFHandler<dim> dof_handler (triangulation);
+      dof_handler.distribute_dofs (fe);
+
+      FEValues<dim> fe_values (fe, QGauss<dim>(degree+1),
+                               update_values | update_gradients |
+                               update_JxW_values);
+      const double time
+        = Benchmark::time_kernel (std_cxx11::bind (&reinit_all<dim>,
+                                                   std_cxx11::ref(fe_values),
+                                                   std_cxx11::cref(dof_handler)));
+      results.add_dof_rate ("FEValues::reinit, dim=" + Utilities::int_to_string(dim) +
+                            ", FE_Q(" + Utilities::int_to_string(degree) + ")",
+                            dof_handler.n_dofs(), time);
+    }
+}
+
+
+
+int main ()
+{
+  Benchmark::Results results ("fe_values");
+
+  run<2> (results, 7);
+  run<3> (results, 4);
+
+  results.print (std::cout);
+}
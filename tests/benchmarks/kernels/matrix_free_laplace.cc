@@ -0,0 +1,118 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// throughput of the matrix-free evaluation of the Laplace operator with
+// FEEvaluation for continuous elements of degrees one to eight in 3D on a
+// Cartesian mesh with roughly the same number of degrees of freedom for
+// all degrees
+
+#include "benchmark.h"
+
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/matrix_free/matrix_free.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+
+
+template <int dim, int fe_degree>
+void
+local_apply (const MatrixFree<dim,double>               &data,
+             Vector<double>                             &dst,
+             const Vector<double>                       &src,
+             const std::pair<unsigned int,unsigned int> &cell_range)
+{
+  FEEvaluation<dim,fe_degree,fe_degree+1,1,double> phi (data);
+  for (unsigned int cell=cell_range.first; cell<cell_range.second; ++cell)
+    {
+      phi.reinit (cell);
+      phi.read_dof_values (src);
+      phi.evaluate (false, true);
+      for (unsigned int q=0; q<phi.n_q_points; ++q)
+        phi.submit_gradient (phi.get_gradient(q), q);
+      phi.integrate (false, true);
+      phi.distribute_local_to_global (dst);
+    }
+}
+
+
+
+template <int dim, int fe_degree>
+void
+apply_laplace (const MatrixFree<dim,double> &data,
+               Vector<double>               &dst,
+               const Vector<double>         &src)
+{
+  dst = 0;
+  data.cell_loop (&local_apply<dim,fe_degree>, dst, src);
+}
+
+
+
+template <int dim, int fe_degree>
+void run (Benchmark::Results &results)
+{
+  // about 80 nodes per direction
+  Triangulation<dim> triangulation;
+  GridGenerator::subdivided_hyper_cube (triangulation, 80/fe_degree);
+
+  FE_Q<dim> fe (fe_degree);
+  DoFHandler<dim> dof_handler (triangulation);
+  dof_handler.distribute_dofs (fe);
+
+  ConstraintMatrix constraints;
+  constraints.close ();
+
+  MatrixFree<dim,double> data;
+  data.reinit (dof_handler, constraints, QGauss<1>(fe_degree+1));
+
+  Vector<double> src, dst;
+  data.initialize_dof_vector (src);
+  data.initialize_dof_vector (dst);
+  for (unsigned int i=0; i<src.size(); ++i)
+    src(i) = 1. + 1e-3 * (i % 17);
+
+  const double time
+    = Benchmark::time_kernel (std_cxx11::bind (&apply_laplace<dim,fe_degree>,
+                                               std_cxx11::cref(data),
+                                               std_cxx11::ref(dst),
+                                               std_cxx11::cref(src)));
+  results.add_dof_rate ("MatrixFree Laplace, dim=" + Utilities::int_to_string(dim) +
+                        ", FE_Q(" + Utilities::int_to_string(fe_degree) + ")",
+                        dof_handler.n_dofs(), time);
+}
+
+
+
+int main ()
+{
+  Benchmark::Results results ("matrix_free");
+
+  run<3,1> (results);
+  run<3,2> (results);
+  run<3,3> (results);
+  run<3,4> (results);
+  run<3,5> (results);
+  run<3,6> (results);
+  run<3,7> (results);
+  run<3,8> (results);
+
+  results.print (std::cout);
+}
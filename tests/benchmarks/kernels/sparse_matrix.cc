@@ -0,0 +1,189 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// memory bandwidth of the matrix-vector product of SparseMatrix<double>,
+// and of the application of the SparseILU and SSOR preconditioners, for
+// the five-point stencil of the Laplacian on a square grid. the bytes
+// transferred are counted as the matrix entries with their column indices
+// and the row starts, plus the vectors, read or written once per sweep
+// over the matrix. the product with several vectors is measured in vector
+// entries per second, once with a MultiVector and once vector by vector,
+// so that the two numbers can be compared directly
+
+#include "benchmark.h"
+
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparse_ilu.h>
+#include <deal.II/lac/precondition.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/multi_vector.h>
+
+
+void vmult (const SparseMatrix<double> &matrix,
+            Vector<double>             &dst,
+            const Vector<double>       &src)
+{
+  matrix.vmult (dst, src);
+}
+
+
+
+void vmult_vectors (const SparseMatrix<double>          &matrix,
+                    std::vector<Vector<double> >        &dst,
+                    const std::vector<Vector<double> >  &src)
+{
+  for (unsigned int v=0; v<src.size(); ++v)
+    matrix.vmult (dst[v], src[v]);
+}
+
+
+
+void vmult_multi (const SparseMatrix<double> &matrix,
+                  MultiVector<double>        &dst,
+                  const MultiVector<double>  &src)
+{
+  matrix.vmult (dst, src);
+}
+
+
+
+void ilu_vmult (const SparseILU<double> &ilu,
+                Vector<double>          &dst,
+                const Vector<double>    &src)
+{
+  ilu.vmult (dst, src);
+}
+
+
+
+void ssor_vmult (const PreconditionSSOR<SparseMatrix<double> > &ssor,
+                 Vector<double>                                &dst,
+                 const Vector<double>                          &src)
+{
+  ssor.vmult (dst, src);
+}
+
+
+
+void ilu_initialize (SparseILU<double>          &ilu,
+                     const SparseMatrix<double> &matrix)
+{
+  ilu.initialize (matrix);
+}
+
+
+
+int main ()
+{
+  Benchmark::Results results ("sparse_matrix");
+
+  const unsigned int sizes[] = { 100, 300, 1000 };
+  for (unsigned int s=0; s<sizeof(sizes)/sizeof(sizes[0]); ++s)
+    {
+      const unsigned int n_1d = sizes[s];
+      const unsigned int n = n_1d * n_1d;
+
+      SparsityPattern sparsity (n, n, 5);
+      for (unsigned int i=0; i<n_1d; ++i)
+        for (unsigned int j=0; j<n_1d; ++j)
+          {
+            const unsigned int row = i*n_1d + j;
+            if (i > 0)
+              sparsity.add (row, row-n_1d);
+            if (j > 0)
+              sparsity.add (row, row-1);
+            if (j < n_1d-1)
+              sparsity.add (row, row+1);
+            if (i < n_1d-1)
+              sparsity.add (row, row+n_1d);
+          }
+      sparsity.compress ();
+
+      SparseMatrix<double> matrix (sparsity);
+      for (unsigned int row=0; row<n; ++row)
+        for (SparseMatrix<double>::iterator entry = matrix.begin(row);
+             entry != matrix.end(row); ++entry)
+          entry->value() = (entry->column() == row ? 4. : -1.);
+
+      Vector<double> src (n), dst (n);
+      for (unsigned int i=0; i<n; ++i)
+        src(i) = 1. + 1e-3 * (i % 11);
+
+      const double nnz = matrix.n_nonzero_elements();
+      const double matrix_bytes
+        = nnz * (sizeof(double) + sizeof(unsigned int)) +
+          (n + 1.) * sizeof(std::size_t);
+      const double vector_bytes = n * sizeof(double);
+
+      results.add_bandwidth ("SparseMatrix::vmult", n,
+                             Benchmark::time_kernel (std_cxx11::bind (&vmult,
+                                                                      std_cxx11::cref(matrix),
+                                                                      std_cxx11::ref(dst),
+                                                                      std_cxx11::cref(src))),
+                             matrix_bytes + 2 * vector_bytes);
+
+      const unsigned int n_columns[] = { 4, 16 };
+      for (unsigned int c=0; c<sizeof(n_columns)/sizeof(n_columns[0]); ++c)
+        {
+          std::vector<Vector<double> > src_vectors (n_columns[c], src);
+          std::vector<Vector<double> > dst_vectors (n_columns[c], dst);
+          MultiVector<double> src_multi (n, n_columns[c]);
+          MultiVector<double> dst_multi (n, n_columns[c]);
+          for (unsigned int v=0; v<n_columns[c]; ++v)
+            src_multi.set_column (v, src);
+
+          const std::string columns = Utilities::int_to_string (n_columns[c]);
+          results.add_dof_rate ("SparseMatrix::vmult, " + columns +
+                                " vectors one by one", n * n_columns[c],
+                                Benchmark::time_kernel (std_cxx11::bind (&vmult_vectors,
+                                                                         std_cxx11::cref(matrix),
+                                                                         std_cxx11::ref(dst_vectors),
+                                                                         std_cxx11::cref(src_vectors))));
+          results.add_dof_rate ("SparseMatrix::vmult, MultiVector with " +
+                                columns + " columns", n * n_columns[c],
+                                Benchmark::time_kernel (std_cxx11::bind (&vmult_multi,
+                                                                         std_cxx11::cref(matrix),
+                                                                         std_cxx11::ref(dst_multi),
+                                                                         std_cxx11::cref(src_multi))));
+        }
+
+      SparseILU<double> ilu;
+      results.add_dof_rate ("SparseILU::initialize", n,
+                            Benchmark::time_kernel (std_cxx11::bind (&ilu_initialize,
+                                                                     std_cxx11::ref(ilu),
+                                                                     std_cxx11::cref(matrix))));
+      // the forward and the backward substitution each read the matrix and
+      // two vectors
+      results.add_bandwidth ("SparseILU::vmult", n,
+                             Benchmark::time_kernel (std_cxx11::bind (&ilu_vmult,
+                                                                      std_cxx11::cref(ilu),
+                                                                      std_cxx11::ref(dst),
+                                                                      std_cxx11::cref(src))),
+                             matrix_bytes + 4 * vector_bytes);
+
+      PreconditionSSOR<SparseMatrix<double> > ssor;
+      ssor.initialize (matrix, 1.2);
+      results.add_bandwidth ("PreconditionSSOR::vmult", n,
+                             Benchmark::time_kernel (std_cxx11::bind (&ssor_vmult,
+                                                                      std_cxx11::cref(ssor),
+                                                                      std_cxx11::ref(dst),
+                                                                      std_cxx11::cref(src))),
+                             2 * matrix_bytes + 4 * vector_bytes);
+    }
+
+  results.print (std::cout);
+}
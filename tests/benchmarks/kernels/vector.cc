@@ -0,0 +1,114 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// memory bandwidth of the basic operations of Vector<double> for vectors
+// that fit into the caches and for vectors that do not
+
+#include "benchmark.h"
+
+#include <deal.II/lac/vector.h>
+
+#include <string>
+
+
+void add (Vector<double> &x, const Vector<double> &y)
+{
+  x.add (1e-10, y);
+}
+
+
+
+void sadd (Vector<double> &x, const Vector<double> &y, const Vector<double> &z)
+{
+  x.sadd (0.5, 1e-10, y, 1e-10, z);
+}
+
+
+
+void scale (Vector<double> &x)
+{
+  x *= 1.;
+}
+
+
+
+void copy (Vector<double> &x, const Vector<double> &y)
+{
+  x = y;
+}
+
+
+
+double dot_result;
+
+void dot (const Vector<double> &x, const Vector<double> &y)
+{
+  dot_result = x * y;
+}
+
+
+
+void norm (const Vector<double> &x)
+{
+  dot_result = x.l2_norm ();
+}
+
+
+
+int main ()
+{
+  Benchmark::Results results ("vector");
+
+  const unsigned int sizes[] = { 10000, 1000000, 10000000 };
+  for (unsigned int s=0; s<sizeof(sizes)/sizeof(sizes[0]); ++s)
+    {
+      const unsigned int n = sizes[s];
+      const double bytes = n * sizeof(double);
+      Vector<double> x (n), y (n), z (n);
+      for (unsigned int i=0; i<n; ++i)
+        {
+          x(i) = 1. + 1e-3 * (i % 7);
+          y(i) = 2. - 1e-3 * (i % 13);
+          z(i) = 1e-3 * (i % 5);
+        }
+
+      results.add_bandwidth ("Vector::add", n,
+                             Benchmark::time_kernel (std_cxx11::bind (&add, std_cxx11::ref(x),
+                                                                      std_cxx11::cref(y))),
+                             3 * bytes);
+      results.add_bandwidth ("Vector::sadd", n,
+                             Benchmark::time_kernel (std_cxx11::bind (&sadd, std_cxx11::ref(x),
+                                                                      std_cxx11::cref(y),
+                                                                      std_cxx11::cref(z))),
+                             4 * bytes);
+      results.add_bandwidth ("Vector::operator*=", n,
+                             Benchmark::time_kernel (std_cxx11::bind (&scale, std_cxx11::ref(x))),
+                             2 * bytes);
+      results.add_bandwidth ("Vector::operator=", n,
+                             Benchmark::time_kernel (std_cxx11::bind (&copy, std_cxx11::ref(z),
+                                                                      std_cxx11::cref(y))),
+                             2 * bytes);
+      results.add_bandwidth ("Vector::operator* (inner product)", n,
+                             Benchmark::time_kernel (std_cxx11::bind (&dot, std_cxx11::cref(x),
+                                                                      std_cxx11::cref(y))),
+                             2 * bytes);
+      results.add_bandwidth ("Vector::l2_norm", n,
+                             Benchmark::time_kernel (std_cxx11::bind (&norm, std_cxx11::cref(x))),
+                             bytes);
+    }
+
+  results.print (std::cout);
+}
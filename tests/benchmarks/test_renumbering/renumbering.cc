@@ -0,0 +1,323 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// time the renumbering of the degrees of freedom and matrix-vector products
+// with the Laplace matrix in the resulting numbering, for a random
+// numbering, Cuthill-McKee and the numbering along a Hilbert curve. for
+// Cuthill-McKee, also time its two parts separately, building the sparsity
+// pattern and reordering it, and compare the reordering with the serial
+// algorithm SparsityTools::reorder_Cuthill_McKee used before it was
+// parallelized
+
+const unsigned int element_degree = 2;
+const unsigned int dimension = 3;
+
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/compressed_simple_sparsity_pattern.h>
+#include <deal.II/lac/sparsity_tools.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/dofs/dof_renumbering.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <string>
+
+
+using namespace dealii;
+
+
+
+// the serial version of SparsityTools::reorder_Cuthill_McKee() before it was
+// parallelized, without starting indices
+std::vector<SparsityPattern::size_type>
+serial_reorder_Cuthill_McKee (const SparsityPattern &sparsity)
+{
+  typedef SparsityPattern::size_type size_type;
+  const size_type invalid = numbers::invalid_size_type;
+  std::vector<size_type> new_indices (sparsity.n_rows(), invalid);
+  size_type next_free_number = 0;
+  std::vector<size_type> last_round_dofs;
+
+  while (next_free_number < sparsity.n_rows())
+    {
+      // start a new component of the graph at the unnumbered dof with the
+      // lowest coordination number
+      if (last_round_dofs.empty())
+        {
+          size_type starting_point = invalid, min_coordination = invalid;
+          for (size_type row=0; row<sparsity.n_rows(); ++row)
+            if (new_indices[row] == invalid &&
+                sparsity.row_length(row) < min_coordination)
+              {
+                min_coordination = sparsity.row_length(row);
+                starting_point = row;
+              }
+          new_indices[starting_point] = next_free_number++;
+          last_round_dofs.push_back (starting_point);
+          continue;
+        }
+
+      // find all unnumbered neighbors of the dofs numbered in the last round
+      std::vector<size_type> next_round_dofs;
+      for (size_type i=0; i<last_round_dofs.size(); ++i)
+        for (SparsityPattern::iterator j=sparsity.begin(last_round_dofs[i]);
+             j<sparsity.end(last_round_dofs[i]); ++j)
+          if (j->is_valid_entry() == false)
+            break;
+          else
+            next_round_dofs.push_back (j->column());
+      std::sort (next_round_dofs.begin(), next_round_dofs.end());
+      next_round_dofs.erase (std::unique (next_round_dofs.begin(),
+                                          next_round_dofs.end()),
+                             next_round_dofs.end());
+      for (int s=next_round_dofs.size()-1; s>=0; --s)
+        if (new_indices[next_round_dofs[s]] != invalid)
+          next_round_dofs.erase (next_round_dofs.begin() + s);
+
+      // number them by increasing coordination number
+      std::multimap<size_type, size_type> dofs_by_coordination;
+      for (size_type s=0; s<next_round_dofs.size(); ++s)
+        dofs_by_coordination.insert (std::make_pair (sparsity.row_length(next_round_dofs[s]),
+                                                     next_round_dofs[s]));
+      for (std::multimap<size_type, size_type>::iterator
+           i = dofs_by_coordination.begin(); i!=dofs_by_coordination.end(); ++i)
+        new_indices[i->second] = next_free_number++;
+
+      last_round_dofs.swap (next_round_dofs);
+    }
+  return new_indices;
+}
+
+
+template <int dim>
+class RenumberingBenchmark
+{
+public:
+  RenumberingBenchmark (const FiniteElement<dim> &fe);
+  void run ();
+
+private:
+  void renumber (const std::string &name);
+  void compare_Cuthill_McKee ();
+  void assemble_system ();
+  void vmult (const std::string &name);
+
+  Triangulation<dim>                      triangulation;
+  const FiniteElement<dim>               &fe;
+  DoFHandler<dim>                         dof_handler;
+
+  SparsityPattern                         sparsity_pattern;
+  SparseMatrix<double>                    system_matrix;
+  Vector<double>                          src, dst;
+  TimerOutput                             timer;
+};
+
+
+
+template <int dim>
+RenumberingBenchmark<dim>::RenumberingBenchmark (const FiniteElement<dim> &fe) :
+  fe (fe),
+  dof_handler (triangulation),
+  timer(std::cout, TimerOutput::summary, TimerOutput::wall_times)
+{}
+
+
+
+template <int dim>
+void RenumberingBenchmark<dim>::renumber (const std::string &name)
+{
+  // start from the same numbering for each method
+  dof_handler.distribute_dofs (fe);
+
+  timer.enter_subsection("renumber: " + name);
+  if (name == "random")
+    DoFRenumbering::random (dof_handler);
+  else if (name == "Cuthill-McKee")
+    DoFRenumbering::Cuthill_McKee (dof_handler);
+  else if (name == "Hilbert curve")
+    DoFRenumbering::hilbert_curve (dof_handler);
+
+  timer.leave_subsection();
+
+  CompressedSimpleSparsityPattern csp (dof_handler.n_dofs(),
+                                       dof_handler.n_dofs());
+  DoFTools::make_sparsity_pattern (dof_handler, csp);
+  sparsity_pattern.copy_from (csp);
+  system_matrix.reinit (sparsity_pattern);
+  src.reinit (dof_handler.n_dofs());
+  dst.reinit (dof_handler.n_dofs());
+}
+
+
+
+template <int dim>
+void RenumberingBenchmark<dim>::compare_Cuthill_McKee ()
+{
+  dof_handler.distribute_dofs (fe);
+
+  // the same steps as in DoFRenumbering::Cuthill_McKee
+  timer.enter_subsection("Cuthill-McKee: sparsity pattern");
+  CompressedSimpleSparsityPattern csp (dof_handler.n_dofs(),
+                                       dof_handler.n_dofs());
+  DoFTools::make_sparsity_pattern (dof_handler, csp);
+  SparsityPattern sparsity;
+  sparsity.copy_from (csp);
+  timer.leave_subsection();
+
+  timer.enter_subsection("Cuthill-McKee: serial reordering");
+  const std::vector<SparsityPattern::size_type> serial_indices
+    = serial_reorder_Cuthill_McKee (sparsity);
+  timer.leave_subsection();
+
+  timer.enter_subsection("Cuthill-McKee: parallel reordering");
+  std::vector<SparsityPattern::size_type> new_indices (sparsity.n_rows());
+  SparsityTools::reorder_Cuthill_McKee (sparsity, new_indices);
+  timer.leave_subsection();
+
+  std::cout << "Serial and parallel Cuthill-McKee agree: "
+            << (new_indices == serial_indices ? "yes" : "no") << std::endl;
+}
+
+
+
+template <int dim>
+void RenumberingBenchmark<dim>::assemble_system ()
+{
+  QGauss<dim>   quadrature_formula(fe.degree+1);
+
+  const unsigned int n_q_points    = quadrature_formula.size();
+  const unsigned int dofs_per_cell = fe.dofs_per_cell;
+
+  FullMatrix<double>   cell_matrix (dofs_per_cell, dofs_per_cell);
+  std::vector<types::global_dof_index> local_dof_indices (dofs_per_cell);
+
+  FEValues<dim>  fe_values (fe, quadrature_formula,
+                            update_gradients | update_JxW_values);
+
+  typename DoFHandler<dim>::active_cell_iterator
+  cell = dof_handler.begin_active(),
+  endc = dof_handler.end();
+  for (; cell!=endc; ++cell)
+    {
+      fe_values.reinit (cell);
+      cell_matrix = 0;
+      for (unsigned int q_point=0; q_point<n_q_points; ++q_point)
+        for (unsigned int i=0; i<dofs_per_cell; ++i)
+          for (unsigned int j=0; j<dofs_per_cell; ++j)
+            cell_matrix(i,j) += (fe_values.shape_grad(i,q_point) *
+                                 fe_values.shape_grad(j,q_point) *
+                                 fe_values.JxW(q_point));
+
+      cell->get_dof_indices (local_dof_indices);
+      system_matrix.add (local_dof_indices, cell_matrix);
+    }
+}
+
+
+
+template <int dim>
+void RenumberingBenchmark<dim>::vmult (const std::string &name)
+{
+  for (unsigned int i=0; i<src.size(); ++i)
+    src(i) = (double)std::rand()/RAND_MAX;
+
+  timer.enter_subsection("100 matrix-vector products: " + name);
+
+  for (unsigned int i=0; i<100; ++i)
+    system_matrix.vmult (dst, src);
+
+  timer.leave_subsection();
+}
+
+
+
+template <int dim>
+void RenumberingBenchmark<dim>::run ()
+{
+  GridGenerator::hyper_cube (triangulation, -1, 1);
+  triangulation.refine_global (5);
+
+  compare_Cuthill_McKee ();
+
+  const std::string names[] = { "random", "Cuthill-McKee", "Hilbert curve" };
+  for (unsigned int n=0; n<3; ++n)
+    {
+      renumber (names[n]);
+      if (n == 0)
+        std::cout << "Number of active cells:          "
+                  << triangulation.n_active_cells()
+                  << std::endl
+                  << "Number total degrees of freedom: "
+                  << dof_handler.n_dofs() << std::endl;
+      std::cout << "Bandwidth after " << names[n] << ": "
+                << sparsity_pattern.bandwidth() << std::endl;
+      assemble_system ();
+      vmult (names[n]);
+    }
+}
+
+int main (int argc, char **argv)
+{
+
+  try
+    {
+      Utilities::System::MPI_InitFinalize mpi_initialization(argc, argv);
+      deallog.depth_console (0);
+
+      FE_Q<dimension> fe(element_degree);
+      RenumberingBenchmark<dimension> problem(fe);
+      problem.run();
+    }
+  catch (std::exception &exc)
+    {
+      std::cerr << std::endl << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Exception on processing: " << std::endl
+                << exc.what() << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+  catch (...)
+    {
+      std::cerr << std::endl << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      std::cerr << "Unknown exception!" << std::endl
+                << "Aborting!" << std::endl
+                << "----------------------------------------------------"
+                << std::endl;
+      return 1;
+    }
+
+  return 0;
+}
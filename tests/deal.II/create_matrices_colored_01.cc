@@ -0,0 +1,243 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// with more than one thread, MatrixCreator::create_mass_matrix and
+// create_laplace_matrix run the copier on cells of the same color in
+// parallel, where the colors are computed from the degrees of freedom of a
+// cell and the ones they are constrained to. check that this gives the same
+// matrices and right hand side as a serial loop over all cells, on meshes
+// with hanging nodes and with hp::DoFHandler. tests.h sets the number of
+// threads to 5 independent of the number of cores, so the cells are
+// colored whenever the library is built with threads. the mass matrix
+// computes the coloring itself while the Laplace matrix is given one made
+// by MatrixCreator::make_cell_coloring, so this checks both ways
+
+#include "../tests.h"
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/function_lib.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/compressed_simple_sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/hp/dof_handler.h>
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/hp/q_collection.h>
+#include <deal.II/hp/fe_values.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/numerics/matrix_tools.h>
+
+#include <fstream>
+
+
+
+template <int dim>
+void
+create_matrices (const DoFHandler<dim>      &dof,
+                 const hp::QCollection<dim> &quadrature,
+                 const Function<dim>        &rhs_function,
+                 const ConstraintMatrix     &constraints,
+                 SparseMatrix<double>       &mass_matrix,
+                 SparseMatrix<double>       &laplace_matrix,
+                 Vector<double>             &rhs)
+{
+  MatrixCreator::create_mass_matrix (dof, quadrature[0], mass_matrix,
+                                     rhs_function, rhs,
+                                     static_cast<const Function<dim> *>(0),
+                                     constraints);
+  const std::vector<std::vector<typename DoFHandler<dim>::active_cell_iterator> >
+  colored_cells = MatrixCreator::make_cell_coloring (dof, constraints);
+  MatrixCreator::create_laplace_matrix (dof, quadrature[0], laplace_matrix,
+                                        static_cast<const Function<dim> *>(0),
+                                        constraints, &colored_cells);
+}
+
+
+
+template <int dim>
+void
+create_matrices (const hp::DoFHandler<dim>  &dof,
+                 const hp::QCollection<dim> &quadrature,
+                 const Function<dim>        &rhs_function,
+                 const ConstraintMatrix     &constraints,
+                 SparseMatrix<double>       &mass_matrix,
+                 SparseMatrix<double>       &laplace_matrix,
+                 Vector<double>             &rhs)
+{
+  MatrixCreator::create_mass_matrix (dof, quadrature, mass_matrix,
+                                     rhs_function, rhs,
+                                     static_cast<const Function<dim> *>(0),
+                                     constraints);
+  const std::vector<std::vector<typename hp::DoFHandler<dim>::active_cell_iterator> >
+  colored_cells = MatrixCreator::make_cell_coloring (dof, constraints);
+  MatrixCreator::create_laplace_matrix (dof, quadrature, laplace_matrix,
+                                        static_cast<const Function<dim> *>(0),
+                                        constraints, &colored_cells);
+}
+
+
+
+double
+relative_difference (const SparseMatrix<double> &matrix,
+                     SparseMatrix<double>       &reference)
+{
+  const double norm = reference.frobenius_norm();
+  reference.add (-1., matrix);
+  return reference.frobenius_norm() / norm;
+}
+
+
+
+template <int dim, class DH>
+void
+check (DH                               &dof,
+       const hp::FECollection<dim>      &fe_collection,
+       const std::string                &name)
+{
+  const hp::QCollection<dim> quadrature (QGauss<dim>(4));
+  const Functions::CosineFunction<dim> rhs_function;
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof, constraints);
+  constraints.close ();
+
+  CompressedSimpleSparsityPattern csp (dof.n_dofs());
+  DoFTools::make_sparsity_pattern (dof, csp, constraints, false);
+  SparsityPattern sparsity;
+  sparsity.copy_from (csp);
+
+  SparseMatrix<double> mass_matrix (sparsity), laplace_matrix (sparsity);
+  Vector<double> rhs (dof.n_dofs());
+  create_matrices (dof, quadrature, rhs_function, constraints,
+                   mass_matrix, laplace_matrix, rhs);
+
+  // assemble the same matrices and right hand side in a serial loop
+  SparseMatrix<double> mass_reference (sparsity), laplace_reference (sparsity);
+  Vector<double> rhs_reference (dof.n_dofs());
+  hp::FEValues<dim> hp_fe_values (fe_collection, quadrature,
+                                  update_values | update_gradients |
+                                  update_quadrature_points | update_JxW_values);
+  std::vector<types::global_dof_index> dof_indices;
+  for (typename DH::active_cell_iterator cell = dof.begin_active();
+       cell != dof.end(); ++cell)
+    {
+      hp_fe_values.reinit (cell);
+      const FEValues<dim> &fe_values = hp_fe_values.get_present_fe_values();
+      const unsigned int dofs_per_cell = fe_values.dofs_per_cell;
+
+      FullMatrix<double> cell_mass (dofs_per_cell, dofs_per_cell);
+      FullMatrix<double> cell_laplace (dofs_per_cell, dofs_per_cell);
+      Vector<double> cell_rhs (dofs_per_cell);
+      for (unsigned int q=0; q<fe_values.n_quadrature_points; ++q)
+        for (unsigned int i=0; i<dofs_per_cell; ++i)
+          {
+            for (unsigned int j=0; j<dofs_per_cell; ++j)
+              {
+                cell_mass(i,j) += (fe_values.shape_value(i,q) *
+                                   fe_values.shape_value(j,q) *
+                                   fe_values.JxW(q));
+                cell_laplace(i,j) += (fe_values.shape_grad(i,q) *
+                                      fe_values.shape_grad(j,q) *
+                                      fe_values.JxW(q));
+              }
+            cell_rhs(i) += (fe_values.shape_value(i,q) *
+                            rhs_function.value (fe_values.quadrature_point(q)) *
+                            fe_values.JxW(q));
+          }
+
+      dof_indices.resize (dofs_per_cell);
+      cell->get_dof_indices (dof_indices);
+      constraints.distribute_local_to_global (cell_mass, cell_rhs, dof_indices,
+                                              mass_reference, rhs_reference);
+      constraints.distribute_local_to_global (cell_laplace, dof_indices,
+                                              laplace_reference);
+    }
+
+  const double rhs_norm = rhs_reference.l2_norm();
+  rhs_reference -= rhs;
+  deallog << name << ", " << dof.n_dofs() << " dofs, "
+          << constraints.n_constraints() << " constraints: "
+          << "mass matrix "
+          << (relative_difference (mass_matrix, mass_reference) < 1e-12 ?
+              "ok" : "wrong")
+          << ", Laplace matrix "
+          << (relative_difference (laplace_matrix, laplace_reference) < 1e-12 ?
+              "ok" : "wrong")
+          << ", right hand side "
+          << (rhs_reference.l2_norm() / rhs_norm < 1e-12 ? "ok" : "wrong")
+          << std::endl;
+}
+
+
+
+template <int dim>
+void
+test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  tria.refine_global (2);
+  tria.begin_active()->set_refine_flag ();
+  tria.execute_coarsening_and_refinement ();
+  (++tria.begin_active(2))->set_refine_flag ();
+  tria.execute_coarsening_and_refinement ();
+
+  {
+    hp::FECollection<dim> fe_collection (FE_Q<dim>(2));
+    DoFHandler<dim> dof (tria);
+    dof.distribute_dofs (fe_collection[0]);
+    check (dof, fe_collection, "DoFHandler");
+  }
+
+  {
+    hp::FECollection<dim> fe_collection;
+    for (unsigned int degree=1; degree<=3; ++degree)
+      fe_collection.push_back (FE_Q<dim>(degree));
+    hp::DoFHandler<dim> dof (tria);
+    unsigned int index = 0;
+    for (typename hp::DoFHandler<dim>::active_cell_iterator
+         cell = dof.begin_active(); cell != dof.end(); ++cell, ++index)
+      cell->set_active_fe_index (index % fe_collection.size());
+    dof.distribute_dofs (fe_collection);
+    check (dof, fe_collection, "hp::DoFHandler");
+  }
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile ("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  deallog.push ("2d");
+  test<2> ();
+  deallog.pop ();
+
+  deallog.push ("3d");
+  test<3> ();
+  deallog.pop ();
+}
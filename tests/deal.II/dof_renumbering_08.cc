@@ -0,0 +1,91 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// Check DoFRenumbering::hilbert_curve: with one degree of freedom per
+// cell, the cells must be numbered along a Hilbert curve, i.e., cells with
+// consecutive numbers are face neighbors on a uniformly refined mesh
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_renumbering.h>
+#include <deal.II/fe/fe_dgq.h>
+
+#include <fstream>
+
+
+template <int dim>
+void
+check (const unsigned int n_refinements,
+       const bool         print_centers)
+{
+  Triangulation<dim> tr;
+  GridGenerator::hyper_cube(tr);
+  tr.refine_global (n_refinements);
+
+  FE_DGQ<dim> fe(0);
+  DoFHandler<dim> dof(tr);
+  dof.distribute_dofs(fe);
+
+  DoFRenumbering::hilbert_curve(dof);
+
+  std::vector<Point<dim> > centers (dof.n_dofs());
+  std::vector<types::global_dof_index> v (fe.dofs_per_cell);
+  for (typename DoFHandler<dim>::active_cell_iterator cell=dof.begin_active();
+       cell != dof.end(); ++cell)
+    {
+      cell->get_dof_indices (v);
+      centers[v[0]] = cell->center();
+    }
+
+  if (print_centers)
+    for (unsigned int i=0; i<centers.size(); ++i)
+      deallog << i << ": " << centers[i] << std::endl;
+
+  const double h = 1./(1<<n_refinements);
+  bool neighbors = true;
+  for (unsigned int i=1; i<centers.size(); ++i)
+    if (std::fabs (centers[i].distance(centers[i-1]) - h) > 1e-12)
+      neighbors = false;
+  deallog << "Consecutive cells are neighbors: "
+          << (neighbors ? "yes" : "no") << std::endl;
+}
+
+
+int main ()
+{
+  std::ofstream logfile ("output");
+  deallog << std::setprecision (3);
+  deallog << std::fixed;
+  deallog.attach(logfile);
+  deallog.depth_console (0);
+
+  deallog.push ("1d");
+  check<1> (3, true);
+  deallog.pop ();
+  deallog.push ("2d");
+  check<2> (2, true);
+  check<2> (5, false);
+  deallog.pop ();
+  deallog.push ("3d");
+  check<3> (3, false);
+  deallog.pop ();
+}
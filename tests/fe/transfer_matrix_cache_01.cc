@@ -0,0 +1,134 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check the on-disk cache of FETools::compute_embedding_matrices,
+// compute_face_embedding_matrices and compute_projection_matrices, and of
+// the prolongation matrices of FE_Q: elements created with an empty cache
+// (which writes it) and with a filled one (which reads it) must have
+// exactly the same prolongation, restriction and interface constraint
+// matrices as elements created without the cache, and the second run must
+// actually read the matrices from the cache
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/fe/fe_tools.h>
+#include <deal.II/fe/fe_dgp.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_raviart_thomas.h>
+
+#include <cstdlib>
+#include <fstream>
+
+
+template <int dim>
+bool
+same_matrices (const FiniteElement<dim> &fe1,
+               const FiniteElement<dim> &fe2,
+               const bool                check_restriction)
+{
+  const RefinementCase<dim> ref_case = RefinementCase<dim>::isotropic_refinement;
+  for (unsigned int c=0; c<GeometryInfo<dim>::max_children_per_cell; ++c)
+    {
+      const FullMatrix<double> &p1 = fe1.get_prolongation_matrix (c, ref_case);
+      const FullMatrix<double> &p2 = fe2.get_prolongation_matrix (c, ref_case);
+      for (unsigned int i=0; i<p1.m(); ++i)
+        for (unsigned int j=0; j<p1.n(); ++j)
+          if (p1(i,j) != p2(i,j))
+            return false;
+
+      if (check_restriction)
+        {
+          const FullMatrix<double> &r1 = fe1.get_restriction_matrix (c, ref_case);
+          const FullMatrix<double> &r2 = fe2.get_restriction_matrix (c, ref_case);
+          for (unsigned int i=0; i<r1.m(); ++i)
+            for (unsigned int j=0; j<r1.n(); ++j)
+              if (r1(i,j) != r2(i,j))
+                return false;
+        }
+    }
+
+  if (fe1.constraints_are_implemented())
+    {
+      const FullMatrix<double> &c1 = fe1.constraints();
+      const FullMatrix<double> &c2 = fe2.constraints();
+      for (unsigned int i=0; i<c1.m(); ++i)
+        for (unsigned int j=0; j<c1.n(); ++j)
+          if (c1(i,j) != c2(i,j))
+            return false;
+    }
+
+  return true;
+}
+
+
+
+template <int dim>
+void test (const std::string &cache_directory)
+{
+  FETools::set_transfer_matrix_cache_directory ("");
+  const FE_DGP<dim> dgp_reference (2);
+  const FE_RaviartThomas<dim> rt_reference (dim == 2 ? 1 : 0);
+  const FE_Q<dim> q_reference (dim == 2 ? 6 : 4);
+  // FE_Q only computes its prolongation matrices when they are first
+  // requested, so do that before the cache is enabled
+  same_matrices (q_reference, q_reference, false);
+
+  FETools::set_transfer_matrix_cache_directory (cache_directory);
+  for (unsigned int run=0; run<2; ++run)
+    {
+      const unsigned int n_hits = FETools::n_transfer_matrix_cache_hits();
+      const FE_DGP<dim> dgp (2);
+      const FE_RaviartThomas<dim> rt (dim == 2 ? 1 : 0);
+      const FE_Q<dim> q (dim == 2 ? 6 : 4);
+      deallog << "Run " << run << ": "
+              << dgp.get_name() << " identical: "
+              << (same_matrices (dgp, dgp_reference, true) ? "yes" : "no")
+              << ", "
+              << rt.get_name() << " identical: "
+              << (same_matrices (rt, rt_reference, false) ? "yes" : "no")
+              << ", "
+              << q.get_name() << " identical: "
+              << (same_matrices (q, q_reference, false) ? "yes" : "no")
+              << ", cache hits: " << FETools::n_transfer_matrix_cache_hits() - n_hits
+              << std::endl;
+    }
+  FETools::set_transfer_matrix_cache_directory ("");
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  deallog << "Cache directory: \""
+          << FETools::get_transfer_matrix_cache_directory() << "\"" << std::endl;
+
+  // keep the cache in a fresh temporary directory, not in the directory in
+  // which the test runs
+  char cache_directory[] = "/tmp/deal.II_transfer_matrix_cache_XXXXXX";
+  const char *created = mkdtemp (cache_directory);
+  AssertThrow (created != 0, ExcInternalError());
+
+  test<2> (cache_directory);
+  test<3> (cache_directory);
+
+  const int error = std::system ((std::string ("rm -rf ") + cache_directory).c_str());
+  AssertThrow (error == 0, ExcInternalError());
+}
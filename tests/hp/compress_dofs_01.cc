@@ -0,0 +1,140 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// hp::DoFHandler compresses the dof indices on cells, faces and edges with
+// run length encoding. check that the indices read back are the same as
+// before renumbering them in reverse order, which makes them
+// incompressible, and back, and compare the memory consumption of the
+// compressed and the uncompressed form
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/hp/dof_handler.h>
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/fe/fe_q.h>
+
+#include <fstream>
+#include <vector>
+
+
+// collect the dof indices of the lines, quads and interiors of all cells
+// through the accessors, which read the compressed data
+template <int dim>
+std::vector<types::global_dof_index>
+get_object_dofs (const hp::DoFHandler<dim> &dof_handler)
+{
+  std::vector<types::global_dof_index> indices;
+  for (typename hp::DoFHandler<dim>::active_cell_iterator
+       cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+    {
+      for (unsigned int l=0; l<GeometryInfo<dim>::lines_per_cell; ++l)
+        for (unsigned int f=0; f<cell->line(l)->n_active_fe_indices(); ++f)
+          {
+            const unsigned int fe_index = cell->line(l)->nth_active_fe_index(f);
+            for (unsigned int i=0; i<dof_handler.get_fe()[fe_index].dofs_per_line; ++i)
+              indices.push_back (cell->line(l)->dof_index(i, fe_index));
+          }
+      if (dim == 3)
+        for (unsigned int q=0; q<GeometryInfo<dim>::quads_per_cell; ++q)
+          for (unsigned int f=0; f<cell->quad(q)->n_active_fe_indices(); ++f)
+            {
+              const unsigned int fe_index = cell->quad(q)->nth_active_fe_index(f);
+              for (unsigned int i=0; i<dof_handler.get_fe()[fe_index].dofs_per_quad; ++i)
+                indices.push_back (cell->quad(q)->dof_index(i, fe_index));
+            }
+
+      const unsigned int dofs_per_object
+        = (dim == 2 ? cell->get_fe().dofs_per_quad : cell->get_fe().dofs_per_hex);
+      for (unsigned int i=0; i<dofs_per_object; ++i)
+        indices.push_back (cell->dof_index(i, cell->active_fe_index()));
+    }
+  return indices;
+}
+
+
+
+template <int dim>
+void test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  tria.refine_global (2);
+
+  hp::FECollection<dim> fe_collection;
+  for (unsigned int degree=2; degree<=4; ++degree)
+    fe_collection.push_back (FE_Q<dim>(degree));
+
+  hp::DoFHandler<dim> dof_handler (tria);
+  unsigned int index = 0;
+  for (typename hp::DoFHandler<dim>::active_cell_iterator
+       cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell, ++index)
+    cell->set_active_fe_index (index % fe_collection.size());
+  dof_handler.distribute_dofs (fe_collection);
+  deallog << "n_dofs: " << dof_handler.n_dofs() << std::endl;
+
+  const std::vector<types::global_dof_index> indices = get_object_dofs (dof_handler);
+  const std::size_t compressed_memory = dof_handler.memory_consumption();
+
+  // reverse the numbering. the indices on each object are then numbered
+  // in decreasing order and can not be compressed
+  std::vector<types::global_dof_index> new_numbers (dof_handler.n_dofs());
+  for (unsigned int i=0; i<new_numbers.size(); ++i)
+    new_numbers[i] = dof_handler.n_dofs()-1-i;
+  dof_handler.renumber_dofs (new_numbers);
+
+  const std::vector<types::global_dof_index> reversed = get_object_dofs (dof_handler);
+  bool correct = (reversed.size() == indices.size());
+  for (unsigned int i=0; i<indices.size() && correct; ++i)
+    if (reversed[i] != dof_handler.n_dofs()-1-indices[i])
+      correct = false;
+  deallog << "Indices correct after reverse renumbering: "
+          << (correct ? "yes" : "no") << std::endl;
+  const std::size_t uncompressed_memory = dof_handler.memory_consumption();
+  deallog << "Memory compressed: " << compressed_memory
+          << " bytes, uncompressed: " << uncompressed_memory
+          << " bytes" << std::endl;
+
+  // and back to the original numbering
+  dof_handler.renumber_dofs (new_numbers);
+  deallog << "Indices correct after renumbering back: "
+          << (get_object_dofs (dof_handler) == indices ? "yes" : "no")
+          << std::endl;
+  deallog << "Memory restored: "
+          << (dof_handler.memory_consumption() == compressed_memory ? "yes" : "no")
+          << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  deallog.push("2d");
+  test<2> ();
+  deallog.pop();
+  deallog.push("3d");
+  test<3> ();
+  deallog.pop();
+}
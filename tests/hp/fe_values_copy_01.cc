@@ -0,0 +1,122 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// copies of hp::FEValues must not share the underlying FEValues objects,
+// so that they can be used as independent scratch objects on different
+// threads. also test precalculate_fe_values()
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/hp/dof_handler.h>
+#include <deal.II/hp/fe_values.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/fe/fe_q.h>
+
+#include <fstream>
+
+
+template <int dim>
+void test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  tria.refine_global (1);
+  tria.begin_active()->set_refine_flag ();
+  tria.execute_coarsening_and_refinement ();
+
+  hp::FECollection<dim> fe_collection;
+  hp::QCollection<dim> q_collection;
+  for (unsigned int degree=1; degree<=3; ++degree)
+    {
+      fe_collection.push_back (FE_Q<dim>(degree));
+      q_collection.push_back (QGauss<dim>(degree+1));
+    }
+
+  hp::DoFHandler<dim> dof_handler (tria);
+  unsigned int index = 0;
+  for (typename hp::DoFHandler<dim>::active_cell_iterator
+       cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell, ++index)
+    cell->set_active_fe_index (index % fe_collection.size());
+  dof_handler.distribute_dofs (fe_collection);
+
+  hp::FEValues<dim> fe_values (fe_collection, q_collection,
+                               update_values | update_gradients |
+                               update_JxW_values);
+  fe_values.precalculate_fe_values ();
+
+  hp::FEValues<dim> fe_values_copy (fe_values);
+
+  typename hp::DoFHandler<dim>::active_cell_iterator
+  cell = dof_handler.begin_active();
+  for (; cell != dof_handler.end(); ++cell)
+    {
+      // reinit the copy on the next cell, which must not affect the
+      // original object
+      typename hp::DoFHandler<dim>::active_cell_iterator next_cell = cell;
+      ++next_cell;
+      fe_values.reinit (cell);
+      const FEValues<dim> &present = fe_values.get_present_fe_values();
+      std::vector<double> values (present.dofs_per_cell *
+                                  present.n_quadrature_points);
+      double measure = 0;
+      for (unsigned int q=0; q<present.n_quadrature_points; ++q)
+        {
+          measure += present.JxW(q);
+          for (unsigned int i=0; i<present.dofs_per_cell; ++i)
+            values[q*present.dofs_per_cell+i] = present.shape_grad(i,q).norm();
+        }
+
+      if (next_cell != dof_handler.end())
+        fe_values_copy.reinit (next_cell);
+
+      bool same = (&fe_values.get_present_fe_values() == &present);
+      double new_measure = 0;
+      for (unsigned int q=0; q<present.n_quadrature_points; ++q)
+        {
+          new_measure += present.JxW(q);
+          for (unsigned int i=0; i<present.dofs_per_cell; ++i)
+            if (values[q*present.dofs_per_cell+i] != present.shape_grad(i,q).norm())
+              same = false;
+        }
+      if (new_measure != measure)
+        same = false;
+
+      deallog << "fe_index " << cell->active_fe_index()
+              << ", dofs " << present.dofs_per_cell
+              << ", measure " << measure
+              << ", unchanged by copy: " << (same ? "yes" : "no")
+              << std::endl;
+    }
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog << std::setprecision (3);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  test<2> ();
+  test<3> ();
+}
@@ -0,0 +1,129 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// when a cell is visited with several elements of the collection in turn,
+// hp::FEValues reuses the data the mapping computed for the first of them.
+// check that this gives the same values as separate FEValues objects, on
+// a uniform mesh where cells are translations of each other and on a
+// distorted one
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/hp/fe_values.h>
+#include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+
+#include <fstream>
+
+
+template <int dim>
+void test (const bool distort)
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  tria.refine_global (dim == 2 ? 2 : 1);
+  if (distort)
+    GridTools::distort_random (0.2, tria, false);
+
+  hp::FECollection<dim> fe_collection;
+  fe_collection.push_back (FE_Q<dim>(1));
+  fe_collection.push_back (FE_Q<dim>(3));
+  fe_collection.push_back (FE_DGQ<dim>(2));
+  const hp::QCollection<dim> q_collection (QGauss<dim>(4));
+
+  const UpdateFlags update_flags = (update_values | update_gradients |
+                                    update_hessians |
+                                    update_quadrature_points |
+                                    update_JxW_values);
+  hp::FEValues<dim> hp_fe_values (fe_collection, q_collection, update_flags);
+  hp_fe_values.precalculate_fe_values ();
+
+  double difference = 0;
+  unsigned int index = 0;
+  for (typename Triangulation<dim>::active_cell_iterator
+       cell = tria.begin_active(); cell != tria.end(); ++cell, ++index)
+    // start with a different element on each cell, so that each of them is
+    // sometimes initialized with its own mapping data and sometimes with
+    // that of another element
+    for (unsigned int i=0; i<fe_collection.size(); ++i)
+      {
+        const unsigned int fe_index = (index + i) % fe_collection.size();
+        hp_fe_values.reinit (cell, 0, 0, fe_index);
+        const FEValues<dim> &fe_values = hp_fe_values.get_present_fe_values ();
+
+        FEValues<dim> reference (fe_collection[fe_index], q_collection[0],
+                                 update_flags);
+        reference.reinit (cell);
+
+        for (unsigned int q=0; q<reference.n_quadrature_points; ++q)
+          {
+            difference = std::max (difference,
+                                   (fe_values.quadrature_point(q) -
+                                    reference.quadrature_point(q)).norm());
+            difference = std::max (difference,
+                                   std::fabs (fe_values.JxW(q) -
+                                              reference.JxW(q)));
+            for (unsigned int k=0; k<reference.dofs_per_cell; ++k)
+              for (unsigned int c=0; c<fe_collection[fe_index].n_components(); ++c)
+                {
+                  difference = std::max (difference,
+                                         std::fabs (fe_values.shape_value_component(k,q,c) -
+                                                    reference.shape_value_component(k,q,c)));
+                  // on the uniform mesh, derivatives are taken from
+                  // other cells, so compare them relative to their size and allow
+                  // for roundoff
+                  const Tensor<1,dim> grad = reference.shape_grad_component(k,q,c);
+                  difference = std::max (difference,
+                                         (fe_values.shape_grad_component(k,q,c) -
+                                          grad).norm() / (1. + grad.norm()));
+                  const Tensor<2,dim> hessian = reference.shape_hessian_component(k,q,c);
+                  difference = std::max (difference,
+                                         (fe_values.shape_hessian_component(k,q,c) -
+                                          hessian).norm() / (1. + hessian.norm()));
+                }
+          }
+      }
+
+  deallog << (distort ? "Distorted" : "Uniform") << " mesh, same values: "
+          << (difference < 1e-8 ? "yes" : "no") << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  deallog.push ("2d");
+  test<2> (false);
+  test<2> (true);
+  deallog.pop ();
+
+  deallog.push ("3d");
+  test<3> (false);
+  test<3> (true);
+  deallog.pop ();
+}
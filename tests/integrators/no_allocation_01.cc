@@ -0,0 +1,365 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check that the worker function of an assembly loop run through
+// WorkStream::run on an hp::DoFHandler does not allocate memory on the heap
+// once its ScratchData and CopyData objects have seen a cell with the same
+// finite element, and that neither does the reinitialization of
+// MeshWorker::DoFInfo. the scratch object keeps its temporary arrays in a
+// MemoryArena, and one of the elements has more than 100 degrees of
+// freedom per cell in 3d, for which FEValuesBase::get_function_values()
+// takes its temporary array from the arena of the present thread.
+//
+// the allocations are counted by replacing the global operator new. since
+// worker functions run on several threads at the same time, every thread
+// counts in a slot of its own, indexed by its id. the copy objects are
+// sized for the largest element up front, but the first visit of every
+// finite element by a scratch object is not counted since it creates the
+// FEValues object of the element. WorkStream creates new scratch objects
+// for every call, so the thread-local arena is also first used during
+// such a visit
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/memory_arena.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/base/work_stream.h>
+#include <deal.II/base/std_cxx11/bind.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/hp/dof_handler.h>
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/hp/q_collection.h>
+#include <deal.II/hp/fe_values.h>
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/compressed_simple_sparsity_pattern.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/meshworker/dof_info.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+
+// the number of allocations of every thread, indexed by its id. a slot is
+// only written by the thread it belongs to
+const unsigned int n_slots = 4096;
+unsigned long long n_allocations[n_slots];
+
+unsigned long long &
+allocations_of_this_thread ()
+{
+  return n_allocations[Threads::this_thread_id() % n_slots];
+}
+
+
+
+void *operator new (std::size_t size)
+{
+  ++allocations_of_this_thread();
+  void *p = std::malloc (size > 0 ? size : 1);
+  if (p == 0)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[] (std::size_t size)
+{
+  return operator new (size);
+}
+
+void operator delete (void *p)
+{
+  std::free (p);
+}
+
+void operator delete[] (void *p)
+{
+  std::free (p);
+}
+
+
+
+template <int dim>
+struct ScratchData
+{
+  ScratchData (const hp::FECollection<dim> &fe_collection,
+               const hp::QCollection<dim>  &quadrature)
+    :
+    fe_values (fe_collection, quadrature,
+               update_values | update_gradients |
+               update_quadrature_points | update_JxW_values),
+    arena (64*1024),
+    visited (fe_collection.size(), false)
+  {}
+
+  ScratchData (const ScratchData &scratch)
+    :
+    fe_values (scratch.fe_values.get_fe_collection(),
+               scratch.fe_values.get_quadrature_collection(),
+               update_values | update_gradients |
+               update_quadrature_points | update_JxW_values),
+    arena (scratch.arena),
+    visited (scratch.visited.size(), false)
+  {}
+
+  hp::FEValues<dim>   fe_values;
+  std::vector<double> solution_values;
+  MemoryArena         arena;
+  std::vector<bool>   visited;
+};
+
+
+
+template <int dim>
+struct CopyData
+{
+  CopyData (const unsigned int max_dofs_per_cell)
+    :
+    cell_matrix (max_dofs_per_cell, max_dofs_per_cell),
+    cell_rhs (max_dofs_per_cell),
+    local_dof_indices (max_dofs_per_cell),
+    n_allocations (0)
+  {}
+
+  FullMatrix<double>                   cell_matrix;
+  Vector<double>                       cell_rhs;
+  std::vector<types::global_dof_index> local_dof_indices;
+  unsigned long long                   n_allocations;
+};
+
+
+
+template <int dim>
+void
+local_assemble (const typename hp::DoFHandler<dim>::active_cell_iterator &cell,
+                const Vector<double>                                     &solution,
+                ScratchData<dim>                                         &scratch,
+                CopyData<dim>                                            &copy)
+{
+  const unsigned long long n_allocations_before = allocations_of_this_thread();
+
+  scratch.arena.reset ();
+  scratch.fe_values.reinit (cell);
+  const FEValues<dim> &fe_values = scratch.fe_values.get_present_fe_values();
+  const unsigned int dofs_per_cell = fe_values.dofs_per_cell;
+  const unsigned int n_q_points = fe_values.n_quadrature_points;
+
+  copy.cell_matrix.reinit (dofs_per_cell, dofs_per_cell);
+  copy.cell_rhs.reinit (dofs_per_cell);
+  copy.local_dof_indices.resize (dofs_per_cell);
+  cell->get_dof_indices (copy.local_dof_indices);
+
+  scratch.solution_values.resize (n_q_points);
+  fe_values.get_function_values (solution, copy.local_dof_indices,
+                                 scratch.solution_values);
+
+  ArenaArray<double> coefficient (n_q_points, scratch.arena);
+  for (unsigned int q=0; q<n_q_points; ++q)
+    coefficient[q] = 1. + fe_values.quadrature_point(q).square();
+
+  for (unsigned int q=0; q<n_q_points; ++q)
+    for (unsigned int i=0; i<dofs_per_cell; ++i)
+      {
+        for (unsigned int j=0; j<dofs_per_cell; ++j)
+          copy.cell_matrix(i,j) += (coefficient[q] *
+                                    fe_values.shape_grad(i,q) *
+                                    fe_values.shape_grad(j,q) *
+                                    fe_values.JxW(q));
+        copy.cell_rhs(i) += (fe_values.shape_value(i,q) *
+                             (1. + scratch.solution_values[q]) *
+                             fe_values.JxW(q));
+      }
+
+  const unsigned int fe_index = cell->active_fe_index();
+  copy.n_allocations = (scratch.visited[fe_index]
+                        ?
+                        allocations_of_this_thread() - n_allocations_before
+                        :
+                        0);
+  scratch.visited[fe_index] = true;
+}
+
+
+
+template <int dim>
+void
+copy_local_to_global (const CopyData<dim>    &copy,
+                      const ConstraintMatrix &constraints,
+                      SparseMatrix<double>   &matrix,
+                      Vector<double>         &rhs,
+                      unsigned long long     &n_worker_allocations)
+{
+  constraints.distribute_local_to_global (copy.cell_matrix, copy.cell_rhs,
+                                          copy.local_dof_indices,
+                                          matrix, rhs);
+  n_worker_allocations += copy.n_allocations;
+}
+
+
+
+// one pass over all cells through WorkStream. return the number of heap
+// allocations of the worker functions after the first visits
+template <int dim>
+unsigned long long
+assemble (const hp::DoFHandler<dim>   &dof_handler,
+          const ConstraintMatrix      &constraints,
+          const Vector<double>        &solution,
+          const ScratchData<dim>      &sample_scratch,
+          const CopyData<dim>         &sample_copy,
+          SparseMatrix<double>        &matrix,
+          Vector<double>              &rhs)
+{
+  unsigned long long n_worker_allocations = 0;
+  WorkStream::run (dof_handler.begin_active(), dof_handler.end(),
+                   std_cxx11::bind (&local_assemble<dim>,
+                                    std_cxx11::_1,
+                                    std_cxx11::cref (solution),
+                                    std_cxx11::_2,
+                                    std_cxx11::_3),
+                   std_cxx11::bind (&copy_local_to_global<dim>,
+                                    std_cxx11::_1,
+                                    std_cxx11::cref (constraints),
+                                    std_cxx11::ref (matrix),
+                                    std_cxx11::ref (rhs),
+                                    std_cxx11::ref (n_worker_allocations)),
+                   sample_scratch, sample_copy);
+  return n_worker_allocations;
+}
+
+
+
+// one pass of MeshWorker::DoFInfo over all cells
+template <int dim>
+unsigned long long
+reinit_dof_info (const DoFHandler<dim>    &dof_handler,
+                 MeshWorker::DoFInfo<dim> &dof_info)
+{
+  const unsigned long long n_allocations_before = allocations_of_this_thread();
+  for (typename DoFHandler<dim>::active_cell_iterator
+       cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+    {
+      dof_info.reinit (cell);
+      dof_info.matrix(0,false).matrix(0,0) += 1.;
+    }
+  return allocations_of_this_thread() - n_allocations_before;
+}
+
+
+
+template <int dim>
+void test ()
+{
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria);
+  tria.refine_global (dim == 2 ? 3 : 2);
+  tria.begin_active()->set_refine_flag();
+  tria.execute_coarsening_and_refinement ();
+
+  // elements of mixed degrees, the last one with 125 degrees of freedom
+  // per cell in 3d
+  hp::FECollection<dim> fe_collection;
+  hp::QCollection<dim> quadrature;
+  const unsigned int degrees[] = { 1, 2, 4 };
+  for (unsigned int i=0; i<3; ++i)
+    {
+      fe_collection.push_back (FE_Q<dim>(degrees[i]));
+      quadrature.push_back (QGauss<dim>(degrees[i]+1));
+    }
+
+  hp::DoFHandler<dim> dof_handler (tria);
+  unsigned int index = 0;
+  for (typename hp::DoFHandler<dim>::active_cell_iterator
+       cell = dof_handler.begin_active(); cell != dof_handler.end();
+       ++cell, ++index)
+    cell->set_active_fe_index (index % fe_collection.size());
+  dof_handler.distribute_dofs (fe_collection);
+  deallog << "Maximal number of dofs per cell: "
+          << fe_collection.max_dofs_per_cell() << std::endl;
+
+  ConstraintMatrix constraints;
+  DoFTools::make_hanging_node_constraints (dof_handler, constraints);
+  constraints.close ();
+
+  CompressedSimpleSparsityPattern csp (dof_handler.n_dofs());
+  DoFTools::make_sparsity_pattern (dof_handler, csp, constraints, false);
+  SparsityPattern sparsity;
+  sparsity.copy_from (csp);
+  SparseMatrix<double> matrix (sparsity);
+  Vector<double> rhs (dof_handler.n_dofs());
+  Vector<double> solution (dof_handler.n_dofs());
+  for (unsigned int i=0; i<solution.size(); ++i)
+    solution(i) = 1. * i / solution.size();
+
+  const ScratchData<dim> sample_scratch (fe_collection, quadrature);
+  const CopyData<dim> sample_copy (fe_collection.max_dofs_per_cell());
+
+  // WorkStream creates new scratch and copy objects for every call, so
+  // both passes count the allocations after the first visits
+  unsigned long long n_worker_allocations
+    = assemble (dof_handler, constraints, solution, sample_scratch,
+                sample_copy, matrix, rhs);
+  const double frobenius_norm = matrix.frobenius_norm();
+  matrix = 0;
+  rhs = 0;
+  n_worker_allocations += assemble (dof_handler, constraints, solution,
+                                    sample_scratch, sample_copy, matrix, rhs);
+  deallog << "Worker allocations after first visits: "
+          << n_worker_allocations << std::endl;
+  deallog << "Same matrix: "
+          << (std::fabs (matrix.frobenius_norm() - frobenius_norm) <
+              1e-12 * frobenius_norm ? "yes" : "no")
+          << std::endl;
+
+  FE_Q<dim> fe (2);
+  DoFHandler<dim> dof_handler_q2 (tria);
+  dof_handler_q2.distribute_dofs (fe);
+  MeshWorker::DoFInfo<dim> dof_info (dof_handler_q2);
+  dof_info.initialize_matrices (1, false);
+  reinit_dof_info (dof_handler_q2, dof_info);
+  deallog << "DoFInfo allocations after first pass: "
+          << reinit_dof_info (dof_handler_q2, dof_info)
+          << std::endl;
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  deallog.push ("2d");
+  test<2> ();
+  deallog.pop ();
+
+  deallog.push ("3d");
+  test<3> ();
+  deallog.pop ();
+}
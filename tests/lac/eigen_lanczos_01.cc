@@ -0,0 +1,101 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// compute the smallest and largest eigenvalues of the 5-point stencil with
+// the thick-restart EigenLanczos solver and compare with the exact values
+
+
+#include "../tests.h"
+#include "testmatrix.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/vector_memory.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/eigen.h>
+
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+
+
+std::vector<double>
+exact_eigenvalues (const unsigned int nx, const unsigned int ny)
+{
+  std::vector<double> values;
+  for (unsigned int k=1; k<nx; ++k)
+    for (unsigned int l=1; l<ny; ++l)
+      values.push_back (4.*std::pow(std::sin(numbers::PI*k/(2.*nx)),2) +
+                        4.*std::pow(std::sin(numbers::PI*l/(2.*ny)),2));
+  std::sort (values.begin(), values.end());
+  return values;
+}
+
+
+
+void
+check (const SparseMatrix<double>  &A,
+       const std::vector<double>   &exact,
+       const bool                   largest)
+{
+  const unsigned int n_eigenpairs = 3;
+  const unsigned int dim = A.m();
+  std::vector<Vector<double> > eigenvectors (n_eigenpairs, Vector<double>(dim));
+  for (unsigned int j=0; j<dim; ++j)
+    eigenvectors[0](j) = (double)Testing::rand()/RAND_MAX;
+  std::vector<double> eigenvalues;
+
+  GrowingVectorMemory<> mem;
+  SolverControl control (100, 1e-8);
+  EigenLanczos<> solver (control, mem,
+                         EigenLanczos<>::AdditionalData(12, largest));
+  solver.solve (A, eigenvalues, eigenvectors);
+
+  Vector<double> residual (dim);
+  for (unsigned int i=0; i<n_eigenpairs; ++i)
+    {
+      A.vmult (residual, eigenvectors[i]);
+      residual.add (-eigenvalues[i], eigenvectors[i]);
+      deallog << "Eigenvalue " << eigenvalues[i] << " Error "
+              << eigenvalues[i]-exact[largest ? dim-1-i : i]
+              << " Residual " << residual.l2_norm() << std::endl;
+    }
+}
+
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::fixed;
+  deallog << std::setprecision(4);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-7);
+
+  const unsigned int nx = 12, ny = 9;
+  const unsigned int dim = (nx-1)*(ny-1);
+  FDMatrix testproblem(nx, ny);
+  SparsityPattern structure(dim, dim, 5);
+  testproblem.five_point_structure(structure);
+  structure.compress();
+  SparseMatrix<double> A(structure);
+  testproblem.five_point(A);
+
+  check (A, exact_eigenvalues (nx, ny), false);
+  check (A, exact_eigenvalues (nx, ny), true);
+}
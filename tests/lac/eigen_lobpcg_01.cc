@@ -0,0 +1,129 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// compute the smallest and largest eigenvalues of the 5-point stencil with
+// EigenLOBPCG, for the standard and a generalized eigenvalue problem, and
+// compare with the exact values
+
+
+#include "../tests.h"
+#include "testmatrix.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/vector_memory.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/eigen.h>
+#include <deal.II/lac/precondition.h>
+
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+
+
+std::vector<double>
+exact_eigenvalues (const unsigned int nx, const unsigned int ny)
+{
+  std::vector<double> values;
+  for (unsigned int k=1; k<nx; ++k)
+    for (unsigned int l=1; l<ny; ++l)
+      values.push_back (4.*std::pow(std::sin(numbers::PI*k/(2.*nx)),2) +
+                        4.*std::pow(std::sin(numbers::PI*l/(2.*ny)),2));
+  std::sort (values.begin(), values.end());
+  return values;
+}
+
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::fixed;
+  deallog << std::setprecision(4);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  const unsigned int nx = 12, ny = 9;
+  const unsigned int dim = (nx-1)*(ny-1);
+  FDMatrix testproblem(nx, ny);
+  SparsityPattern structure(dim, dim, 5);
+  testproblem.five_point_structure(structure);
+  structure.compress();
+  SparseMatrix<double> A(structure);
+  testproblem.five_point(A);
+
+  const std::vector<double> exact = exact_eigenvalues (nx, ny);
+
+  GrowingVectorMemory<> mem;
+  const unsigned int n_eigenpairs = 4;
+  std::vector<Vector<double> > eigenvectors (n_eigenpairs, Vector<double>(dim));
+  std::vector<double> eigenvalues;
+
+  // smallest eigenvalues, preconditioned with Jacobi
+  {
+    for (unsigned int i=0; i<n_eigenpairs; ++i)
+      for (unsigned int j=0; j<dim; ++j)
+        eigenvectors[i](j) = (double)Testing::rand()/RAND_MAX;
+    PreconditionJacobi<> jacobi;
+    jacobi.initialize (A);
+    SolverControl control (200, 1e-8);
+    EigenLOBPCG<> solver (control, mem);
+    solver.solve (A, jacobi, eigenvalues, eigenvectors);
+    for (unsigned int i=0; i<n_eigenpairs; ++i)
+      deallog << "Eigenvalue " << eigenvalues[i] << " Error "
+              << eigenvalues[i]-exact[i] << std::endl;
+  }
+
+  // largest eigenvalues
+  {
+    for (unsigned int i=0; i<n_eigenpairs; ++i)
+      for (unsigned int j=0; j<dim; ++j)
+        eigenvectors[i](j) = (double)Testing::rand()/RAND_MAX;
+    SolverControl control (200, 1e-8);
+    EigenLOBPCG<> solver (control, mem,
+                          EigenLOBPCG<>::AdditionalData(true));
+    solver.solve (A, PreconditionIdentity(), eigenvalues, eigenvectors);
+    for (unsigned int i=0; i<n_eigenpairs; ++i)
+      deallog << "Eigenvalue " << eigenvalues[i] << " Error "
+              << eigenvalues[i]-exact[dim-1-i] << std::endl;
+  }
+
+  // generalized problem with a diagonal mass matrix. B x = A x / 2 must give
+  // twice the eigenvalues of A
+  {
+    SparseMatrix<double> B(structure);
+    for (unsigned int i=0; i<dim; ++i)
+      B.set (i, i, 0.5);
+    for (unsigned int i=0; i<n_eigenpairs; ++i)
+      for (unsigned int j=0; j<dim; ++j)
+        eigenvectors[i](j) = (double)Testing::rand()/RAND_MAX;
+    PreconditionJacobi<> jacobi;
+    jacobi.initialize (A);
+    SolverControl control (200, 1e-8);
+    EigenLOBPCG<> solver (control, mem);
+    solver.solve (A, B, jacobi, eigenvalues, eigenvectors);
+    Vector<double> tmp (dim);
+    for (unsigned int i=0; i<n_eigenpairs; ++i)
+      {
+        B.vmult (tmp, eigenvectors[i]);
+        deallog << "Eigenvalue " << eigenvalues[i] << " Error "
+                << eigenvalues[i]-2.*exact[i]
+                << " B-norm " << eigenvectors[i]*tmp << std::endl;
+      }
+  }
+}
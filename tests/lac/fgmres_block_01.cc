@@ -0,0 +1,92 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// solve for several right hand sides at once with the block version of
+// SolverFGMRES, including a case where the right hand sides are linearly
+// dependent
+
+#include "../tests.h"
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/solver_gmres.h>
+#include <deal.II/lac/precondition.h>
+
+
+
+void test (const unsigned int n_rhs,
+           const bool         dependent)
+{
+  const unsigned int n = 64;
+  FullMatrix<double> matrix(n, n);
+  for (unsigned int i=0; i<n; ++i)
+    for (unsigned int j=0; j<n; ++j)
+      matrix(i,j) = -0.1 + 0.2 * Testing::rand()/RAND_MAX;
+  for (unsigned int i=0; i<n; ++i)
+    matrix(i,i) = (i+1);
+
+  std::vector<Vector<double> > rhs(n_rhs, Vector<double>(n)),
+      sol(n_rhs, Vector<double>(n));
+  for (unsigned int r=0; r<n_rhs; ++r)
+    for (unsigned int i=0; i<n; ++i)
+      rhs[r](i) = std::cos(0.1*(r+1)*i);
+  if (dependent)
+    {
+      rhs[n_rhs-1] = rhs[0];
+      rhs[n_rhs-1] *= 2.;
+    }
+
+  deallog.push(Utilities::int_to_string(n_rhs,1));
+
+  SolverControl control(1000, 1e-10);
+  SolverFGMRES<Vector<double> >::AdditionalData data;
+  data.max_basis_size = 90;
+  SolverFGMRES<Vector<double> > solver(control, data);
+  solver.solve(matrix, sol, rhs, PreconditionIdentity());
+
+  Vector<double> residual(n);
+  for (unsigned int r=0; r<n_rhs; ++r)
+    {
+      matrix.vmult(residual, sol[r]);
+      residual -= rhs[r];
+      deallog << "Residual " << r << ": " << residual.l2_norm() << std::endl;
+    }
+
+  // compare to the solution of the individual systems
+  Vector<double> single(n);
+  for (unsigned int r=0; r<n_rhs; ++r)
+    {
+      single = 0;
+      solver.solve(matrix, single, rhs[r], PreconditionIdentity());
+      single -= sol[r];
+      deallog << "Difference to single solve " << r << ": "
+              << single.l2_norm() << std::endl;
+    }
+
+  deallog.pop();
+}
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::setprecision(3);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-8);
+
+  test(1, false);
+  test(3, false);
+  test(3, true);
+}
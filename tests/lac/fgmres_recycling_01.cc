@@ -0,0 +1,76 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// solve a sequence of linear systems with slowly changing right hand side
+// by SolverFGMRES with and without a recycled subspace
+
+#include "../tests.h"
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/solver_gmres.h>
+#include <deal.II/lac/precondition.h>
+
+
+
+void test (const FullMatrix<double> &matrix,
+           const unsigned int        n_recycled)
+{
+  const unsigned int n = matrix.m();
+  deallog.push(Utilities::int_to_string(n_recycled,1));
+
+  SolverControl control(1000, 1e-10);
+  SolverFGMRES<Vector<double> >::AdditionalData data;
+  data.max_basis_size = 10;
+  data.max_n_recycled_vectors = n_recycled;
+  SolverFGMRES<Vector<double> > solver(control, data);
+
+  Vector<double> rhs(n), sol(n), residual(n);
+  for (unsigned int step=0; step<5; ++step)
+    {
+      for (unsigned int i=0; i<n; ++i)
+        rhs(i) = 1. + 0.1 * step * std::sin(0.3*i);
+      sol = 0;
+      solver.solve(matrix, sol, rhs, PreconditionIdentity());
+
+      matrix.vmult(residual, sol);
+      residual -= rhs;
+      deallog << "Residual: " << residual.l2_norm()
+              << ", recycled vectors: " << solver.n_recycled_vectors()
+              << std::endl;
+    }
+
+  deallog.pop();
+}
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::setprecision(3);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-8);
+
+  const unsigned int n = 64;
+  FullMatrix<double> matrix(n, n);
+  for (unsigned int i=0; i<n; ++i)
+    for (unsigned int j=0; j<n; ++j)
+      matrix(i,j) = -0.1 + 0.2 * Testing::rand()/RAND_MAX;
+  for (unsigned int i=0; i<n; ++i)
+    matrix(i,i) = (i+1);
+
+  test(matrix, 0);
+  test(matrix, 4);
+}
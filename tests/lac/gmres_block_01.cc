@@ -0,0 +1,105 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// solve for several right hand sides at once with the block version of
+// SolverGMRES, with left and right preconditioning. the matrix is a
+// SparseMatrix, for which the products with all vectors of a block are
+// computed at once through MultiVector. compare with the solution of the
+// same systems given as FullMatrix, which multiplies one vector after the
+// other, and with the individual solution of each system
+
+#include "../tests.h"
+#include "testmatrix.h"
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/solver_gmres.h>
+#include <deal.II/lac/precondition.h>
+
+
+
+void test (const unsigned int n_rhs,
+           const bool         right_preconditioning)
+{
+  const unsigned int size = 16;
+  const unsigned int n = (size-1)*(size-1);
+  FDMatrix testproblem(size, size);
+  SparsityPattern structure(n, n, 5);
+  testproblem.five_point_structure(structure);
+  structure.compress();
+  SparseMatrix<double> matrix(structure);
+  testproblem.five_point(matrix, true);
+  FullMatrix<double> full_matrix(n, n);
+  full_matrix.copy_from(matrix);
+
+  std::vector<Vector<double> > rhs(n_rhs, Vector<double>(n)),
+      sol(n_rhs, Vector<double>(n)), full_sol(n_rhs, Vector<double>(n));
+  for (unsigned int r=0; r<n_rhs; ++r)
+    for (unsigned int i=0; i<n; ++i)
+      rhs[r](i) = std::cos(0.1*(r+1)*i);
+
+  deallog.push(Utilities::int_to_string(n_rhs,1));
+  deallog.push(right_preconditioning ? "right" : "left");
+
+  SolverControl control(1000, 1e-10);
+  SolverGMRES<Vector<double> >::AdditionalData data;
+  data.max_n_tmp_vectors = 62;
+  data.right_preconditioning = right_preconditioning;
+  SolverGMRES<Vector<double> > solver(control, data);
+  PreconditionJacobi<SparseMatrix<double> > preconditioner;
+  preconditioner.initialize(matrix);
+  solver.solve(matrix, sol, rhs, preconditioner);
+  solver.solve(full_matrix, full_sol, rhs, preconditioner);
+
+  Vector<double> residual(n);
+  for (unsigned int r=0; r<n_rhs; ++r)
+    {
+      matrix.vmult(residual, sol[r]);
+      residual -= rhs[r];
+      deallog << "Residual " << r << ": " << residual.l2_norm()/rhs[r].l2_norm()
+              << std::endl;
+      full_sol[r] -= sol[r];
+      deallog << "Difference to FullMatrix " << r << ": "
+              << full_sol[r].l2_norm()/sol[r].l2_norm() << std::endl;
+    }
+
+  // compare to the solution of the individual systems
+  Vector<double> single(n);
+  for (unsigned int r=0; r<n_rhs; ++r)
+    {
+      single = 0;
+      solver.solve(matrix, single, rhs[r], preconditioner);
+      single -= sol[r];
+      deallog << "Difference to single solve " << r << ": "
+              << single.l2_norm()/sol[r].l2_norm() << std::endl;
+    }
+
+  deallog.pop();
+  deallog.pop();
+}
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::setprecision(3);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-8);
+
+  test(1, false);
+  test(4, false);
+  test(4, true);
+}
@@ -0,0 +1,87 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// solve a sequence of linear systems with slowly changing right hand side
+// by SolverGMRES with and without a recycled subspace, with left and right
+// preconditioning
+
+#include "../tests.h"
+#include "testmatrix.h"
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/solver_gmres.h>
+#include <deal.II/lac/precondition.h>
+
+
+
+void test (const SparseMatrix<double> &matrix,
+           const unsigned int          n_recycled,
+           const bool                  right_preconditioning)
+{
+  const unsigned int n = matrix.m();
+  deallog.push(Utilities::int_to_string(n_recycled,1));
+  deallog.push(right_preconditioning ? "right" : "left");
+
+  SolverControl control(1000, 1e-10);
+  SolverGMRES<Vector<double> >::AdditionalData data;
+  data.max_n_tmp_vectors = 12;
+  data.right_preconditioning = right_preconditioning;
+  data.max_n_recycled_vectors = n_recycled;
+  SolverGMRES<Vector<double> > solver(control, data);
+  PreconditionJacobi<SparseMatrix<double> > preconditioner;
+  preconditioner.initialize(matrix);
+
+  Vector<double> rhs(n), sol(n), residual(n);
+  for (unsigned int step=0; step<5; ++step)
+    {
+      for (unsigned int i=0; i<n; ++i)
+        rhs(i) = 1. + 0.1 * step * std::sin(0.3*i);
+      sol = 0;
+      solver.solve(matrix, sol, rhs, preconditioner);
+
+      matrix.vmult(residual, sol);
+      residual -= rhs;
+      deallog << "Residual: " << residual.l2_norm()/rhs.l2_norm()
+              << ", recycled vectors: " << solver.n_recycled_vectors()
+              << std::endl;
+    }
+
+  deallog.pop();
+  deallog.pop();
+}
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::setprecision(3);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-8);
+
+  const unsigned int size = 16;
+  const unsigned int n = (size-1)*(size-1);
+  FDMatrix testproblem(size, size);
+  SparsityPattern structure(n, n, 5);
+  testproblem.five_point_structure(structure);
+  structure.compress();
+  SparseMatrix<double> matrix(structure);
+  testproblem.five_point(matrix, true);
+
+  test(matrix, 0, false);
+  test(matrix, 4, false);
+  test(matrix, 0, true);
+  test(matrix, 4, true);
+}
@@ -0,0 +1,192 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Tests PreconditionChebyshev on a SparseMatrix where the matrix-vector
+// product is fused with the vector updates, against a generic matrix, and
+// the reuse of eigenvalue estimates from a previous initialization
+
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/lac/precondition.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+
+
+// a matrix that forwards to a SparseMatrix but is not recognized as one by
+// PreconditionChebyshev
+class MatrixWrapper : public Subscriptor
+{
+public:
+  MatrixWrapper (const SparseMatrix<double> &matrix)
+    :
+    matrix (matrix)
+  {}
+
+  unsigned int m () const
+  {
+    return matrix.m();
+  }
+
+  double el (const unsigned int i, const unsigned int j) const
+  {
+    return matrix.el(i,j);
+  }
+
+  void vmult (Vector<double> &dst, const Vector<double> &src) const
+  {
+    matrix.vmult (dst, src);
+  }
+
+private:
+  const SparseMatrix<double> &matrix;
+};
+
+
+void
+check()
+{
+  const unsigned int size = 100;
+  SparsityPattern sparsity (size, size, 3);
+  for (unsigned int i=0; i<size; ++i)
+    {
+      if (i>0)
+        sparsity.add (i, i-1);
+      if (i<size-1)
+        sparsity.add (i, i+1);
+    }
+  sparsity.compress ();
+  SparseMatrix<double> matrix (sparsity);
+  for (unsigned int i=0; i<size; ++i)
+    {
+      // 1D Laplacian with a variable coefficient
+      matrix.set (i, i, 2.+ 0.01*i);
+      if (i>0)
+        matrix.set (i, i-1, -1.);
+      if (i<size-1)
+        matrix.set (i, i+1, -1.);
+    }
+  MatrixWrapper wrapper (matrix);
+
+  Vector<double> in (size), out1 (size), out2 (size);
+  for (unsigned int i=0; i<size; ++i)
+    in(i) = (double)Testing::rand()/RAND_MAX;
+
+  // the fused steps alternate between two vectors, but must leave the
+  // result in the memory of the destination vector
+  const double *const out1_memory = out1.begin();
+  bool same_memory = true;
+  for (unsigned int degree=1; degree<5; ++degree)
+    {
+      PreconditionChebyshev<SparseMatrix<double>,Vector<double> > prec1;
+      PreconditionChebyshev<MatrixWrapper,Vector<double> > prec2;
+      PreconditionChebyshev<SparseMatrix<double>,Vector<double> >::AdditionalData
+      data1;
+      data1.smoothing_range = 10;
+      data1.degree = degree;
+      PreconditionChebyshev<MatrixWrapper,Vector<double> >::AdditionalData
+      data2;
+      data2.smoothing_range = 10;
+      data2.degree = degree;
+      prec1.initialize (matrix, data1);
+      prec2.initialize (wrapper, data2);
+
+      prec1.vmult (out1, in);
+      prec2.vmult (out2, in);
+      deallog << "Degree " << degree << ": norm " << out1.l2_norm();
+      out2 -= out1;
+      deallog << ", difference fused and generic: " << out2.l2_norm()
+              << std::endl;
+
+      // apply again with nonzero starting vector
+      data1.nonzero_starting = true;
+      data2.nonzero_starting = true;
+      prec1.initialize (matrix, data1);
+      prec2.initialize (wrapper, data2);
+      out2 = out1;
+      prec1.vmult (out1, in);
+      prec2.vmult (out2, in);
+      deallog << "Degree " << degree << ": norm " << out1.l2_norm();
+      out2 -= out1;
+      deallog << ", difference fused and generic: " << out2.l2_norm()
+              << std::endl;
+      same_memory = same_memory && (out1.begin() == out1_memory);
+    }
+  deallog << "Result in the memory of the destination: "
+          << (same_memory ? "yes" : "no") << std::endl;
+
+  // compute the eigenvalues once and reuse them
+  PreconditionChebyshev<SparseMatrix<double>,Vector<double> > prec;
+  PreconditionChebyshev<SparseMatrix<double>,Vector<double> >::AdditionalData
+  data;
+  data.smoothing_range = 10;
+  data.degree = 3;
+  data.eig_cg_n_iterations = 20;
+  prec.initialize (matrix, data);
+  PreconditionChebyshev<SparseMatrix<double>,Vector<double> >::EigenvalueInformation
+  info = prec.get_eigenvalue_information();
+  deallog << "Eigenvalue estimate: " << info.min_eigenvalue_estimate
+          << " " << info.max_eigenvalue_estimate
+          << " using " << info.n_iterations << " iterations" << std::endl;
+  prec.vmult (out1, in);
+
+  data.set_eigenvalue_information (info);
+  prec.initialize (matrix, data);
+  deallog << "Eigenvalue estimate: "
+          << prec.get_eigenvalue_information().max_eigenvalue_estimate
+          << " using " << prec.get_eigenvalue_information().n_iterations
+          << " iterations" << std::endl;
+  prec.vmult (out2, in);
+  out2 -= out1;
+  deallog << "Difference with reused eigenvalues: " << out2.l2_norm()
+          << std::endl;
+
+  // terminate the Lanczos iteration once the estimate has settled
+  data.eig_cg_n_iterations = 20;
+  data.eig_tolerance = 1e-2;
+  prec.initialize (matrix, data);
+  info = prec.get_eigenvalue_information();
+  deallog << "Eigenvalue estimate: " << info.max_eigenvalue_estimate
+          << " using " << info.n_iterations << " iterations" << std::endl;
+
+  // without any tolerance, all iterations are performed
+  data.eig_tolerance = 0;
+  data.eig_cg_residual = 0;
+  prec.initialize (matrix, data);
+  info = prec.get_eigenvalue_information();
+  deallog << "Eigenvalue estimate: " << info.max_eigenvalue_estimate
+          << " using " << info.n_iterations << " iterations" << std::endl;
+}
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::fixed;
+  deallog << std::setprecision(4);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  check();
+
+  return 0;
+}
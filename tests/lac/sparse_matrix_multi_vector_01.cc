@@ -0,0 +1,94 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check SparseMatrix::vmult and SparseMatrix::vmult_add with MultiVector
+// arguments against column-by-column products, for numbers of columns that
+// exercise all the different column groups of the kernel
+
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/lac/multi_vector.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+#include "testmatrix.h"
+
+#include <fstream>
+#include <iomanip>
+
+
+void
+check (const SparseMatrix<double> &A,
+       const unsigned int          n_columns)
+{
+  MultiVector<double> src (A.n(), n_columns), dst (A.m(), n_columns);
+  for (unsigned int i=0; i<A.n(); ++i)
+    for (unsigned int c=0; c<n_columns; ++c)
+      src(i,c) = (double)Testing::rand()/RAND_MAX;
+
+  A.vmult (dst, src);
+
+  Vector<double> in (A.n()), out (A.m()), result (A.m());
+  double error = 0;
+  for (unsigned int c=0; c<n_columns; ++c)
+    {
+      src.extract_column (c, in);
+      A.vmult (out, in);
+      dst.extract_column (c, result);
+      result -= out;
+      error += result.l2_norm();
+    }
+  deallog << "vmult with " << n_columns << " columns, error: " << error
+          << std::endl;
+
+  A.vmult_add (dst, src);
+  error = 0;
+  for (unsigned int c=0; c<n_columns; ++c)
+    {
+      src.extract_column (c, in);
+      A.vmult (out, in);
+      out *= 2.;
+      dst.extract_column (c, result);
+      result -= out;
+      error += result.l2_norm();
+    }
+  deallog << "vmult_add with " << n_columns << " columns, error: " << error
+          << std::endl;
+}
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::fixed;
+  deallog << std::setprecision(4);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  const unsigned int size = 33;
+  FDMatrix testproblem(size, size);
+  SparsityPattern structure(size*size, size*size, 5);
+  testproblem.five_point_structure(structure);
+  structure.compress();
+  SparseMatrix<double> A(structure);
+  testproblem.five_point(A, true);
+
+  const unsigned int n_columns[] = { 1, 2, 3, 4, 7, 8, 12, 16, 31 };
+  for (unsigned int i=0; i<sizeof(n_columns)/sizeof(n_columns[0]); ++i)
+    check (A, n_columns[i]);
+}
@@ -0,0 +1,153 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check the thread-local caches of GrowingVectorMemory: vectors freed by a
+// thread are given to it again without going through the shared pool,
+// release_unused_memory() also releases cached vectors, vectors that do not
+// fit into the cache go back to the shared pool, and many tasks can use the
+// pool at the same time
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/vector_memory.h>
+
+#include <fstream>
+
+
+typedef GrowingVectorMemory<Vector<float> > Memory;
+
+
+void print_statistics (const Memory::Statistics &before)
+{
+  const Memory::Statistics statistics = Memory::get_statistics();
+  deallog << "thread local hits: "
+          << statistics.n_thread_local_hits - before.n_thread_local_hits
+          << ", shared hits: "
+          << statistics.n_shared_hits - before.n_shared_hits
+          << ", misses: " << statistics.n_misses - before.n_misses
+          << ", max vectors: " << statistics.max_n_vectors
+          << std::endl;
+}
+
+
+
+// a small solver-like function that needs a few temporary vectors
+void local_solve (bool &correct)
+{
+  Memory memory;
+  for (unsigned int iteration=0; iteration<100; ++iteration)
+    {
+      VectorMemory<Vector<float> >::Pointer v1 (memory);
+      VectorMemory<Vector<float> >::Pointer v2 (memory);
+      v1->reinit (10);
+      v2->reinit (10);
+      *v1 = 1.;
+      *v2 = 2.;
+      v1->add (*v2);
+      if (v1->l1_norm() != 30.)
+        correct = false;
+    }
+}
+
+
+
+int main ()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  const Memory::Statistics start = Memory::get_statistics();
+  {
+    Memory memory (2);
+    Vector<float> *v[3];
+    for (unsigned int i=0; i<3; ++i)
+      v[i] = memory.alloc();
+    for (unsigned int i=0; i<3; ++i)
+      memory.free (v[i]);
+    for (unsigned int run=0; run<4; ++run)
+      memory.free (memory.alloc());
+  }
+  print_statistics (start);
+
+  Memory::release_unused_memory ();
+  const Memory::Statistics before_release = Memory::get_statistics();
+  {
+    Memory memory;
+    memory.free (memory.alloc());
+  }
+  deallog << "After release: ";
+  print_statistics (before_release);
+
+  // now many tasks at the same time
+  const unsigned int n_tasks = 16;
+  bool correct[n_tasks];
+  Threads::TaskGroup<> tasks;
+  for (unsigned int t=0; t<n_tasks; ++t)
+    {
+      correct[t] = true;
+      tasks += Threads::new_task (&local_solve, correct[t]);
+    }
+  tasks.join_all ();
+
+  bool all_correct = true;
+  for (unsigned int t=0; t<n_tasks; ++t)
+    all_correct = all_correct && correct[t];
+  const Memory::Statistics statistics = Memory::get_statistics();
+  deallog << "Concurrent results correct: " << (all_correct ? "yes" : "no")
+          << std::endl;
+  deallog << "All allocations counted: "
+          << (statistics.n_thread_local_hits + statistics.n_shared_hits +
+              statistics.n_misses - start.n_thread_local_hits -
+              start.n_shared_hits - start.n_misses == 7 + 1 + n_tasks*200 ?
+              "yes" : "no")
+          << std::endl;
+  deallog << "At most two vectors per thread: "
+          << (statistics.max_n_vectors <=
+              2*(multithread_info.n_cpus+1) + 3 ? "yes" : "no")
+          << std::endl;
+
+  // free more vectors than fit into the cache. the first ones go back to
+  // the shared pool
+  Memory::release_unused_memory ();
+  const Memory::Statistics before_overflow = Memory::get_statistics();
+  {
+    const unsigned int n_vectors = Memory::max_n_cached_vectors + 4;
+    Memory memory;
+    std::vector<Vector<float> *> v (n_vectors);
+    for (unsigned int run=0; run<2; ++run)
+      {
+        for (unsigned int i=0; i<n_vectors; ++i)
+          v[i] = memory.alloc();
+        for (unsigned int i=0; i<n_vectors; ++i)
+          memory.free (v[i]);
+      }
+  }
+  // the largest number of vectors depends on the number of threads used
+  // above, so do not print it
+  const Memory::Statistics after_overflow = Memory::get_statistics();
+  deallog << "Cache overflow: thread local hits: "
+          << after_overflow.n_thread_local_hits - before_overflow.n_thread_local_hits
+          << ", shared hits: "
+          << after_overflow.n_shared_hits - before_overflow.n_shared_hits
+          << ", misses: "
+          << after_overflow.n_misses - before_overflow.n_misses
+          << std::endl;
+}
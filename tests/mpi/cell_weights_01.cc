@@ -0,0 +1,115 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// test that parallel::distributed::Triangulation::repartition() respects the
+// weights returned by the cell_weight signal: cells in the left half of the
+// domain are four times as expensive as the ones in the right half
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/std_cxx11/bind.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/grid_generator.h>
+
+#include <fstream>
+
+
+template <int dim>
+unsigned int
+cell_weight (const typename parallel::distributed::Triangulation<dim>::cell_iterator &cell,
+             const typename parallel::distributed::Triangulation<dim>::CellStatus)
+{
+  return (cell->center()[0] < 0.5 ? 3000 : 0);
+}
+
+
+
+template<int dim>
+void test()
+{
+  const unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+
+  parallel::distributed::Triangulation<dim> tr(MPI_COMM_WORLD);
+  GridGenerator::hyper_cube(tr);
+  tr.refine_global(5);
+
+  Utilities::MPI::MinMaxAvg statistics = tr.get_partition_statistics();
+  if (myid == 0)
+    deallog << "Uniform: cells " << tr.n_global_active_cells()
+            << ", total load " << static_cast<unsigned int>(statistics.sum)
+            << ", max load " << static_cast<unsigned int>(statistics.max)
+            << ", average load " << static_cast<unsigned int>(statistics.avg)
+            << std::endl;
+
+  tr.partition_signals.cell_weight.connect (&cell_weight<dim>);
+  tr.repartition ();
+
+  // compute the load of the locally owned cells independently and compare
+  // with the statistics of the triangulation
+  double my_load = 0;
+  for (typename Triangulation<dim>::active_cell_iterator
+       cell = tr.begin_active(); cell != tr.end(); ++cell)
+    if (cell->is_locally_owned())
+      my_load += 1000 + cell_weight<dim> (cell, parallel::distributed::Triangulation<dim>::CELL_PERSIST);
+  const double max_load = Utilities::MPI::max (my_load, MPI_COMM_WORLD);
+
+  statistics = tr.get_partition_statistics();
+  if (myid == 0)
+    {
+      deallog << "Weighted: cells " << tr.n_global_active_cells()
+              << ", total load " << static_cast<unsigned int>(statistics.sum)
+              << std::endl;
+      deallog << "Weighted: min load " << static_cast<unsigned int>(statistics.min)
+              << " on process " << statistics.min_index
+              << ", max load " << static_cast<unsigned int>(statistics.max)
+              << " on process " << statistics.max_index
+              << ", average load " << static_cast<unsigned int>(statistics.avg)
+              << std::endl;
+      deallog << "Statistics consistent: "
+              << (max_load == statistics.max ? "yes" : "no")
+              << std::endl;
+      deallog << "Balanced: "
+              << (statistics.max < 1.05 * statistics.avg ? "yes" : "no")
+              << std::endl;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+
+  unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+
+  if (myid == 0)
+    {
+      std::ofstream logfile("output");
+      deallog.attach(logfile);
+      deallog.depth_console(0);
+      deallog.threshold_double(1.e-10);
+
+      deallog.push("2d");
+      test<2>();
+      deallog.pop();
+    }
+  else
+    test<2>();
+}
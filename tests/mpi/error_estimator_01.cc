@@ -0,0 +1,191 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// KellyErrorEstimator with a parallel::distributed::Vector whose ghost
+// values have not been imported: the estimator must import them itself,
+// give the same result as for a vector with up to date ghost values and as
+// for a serial vector, and leave the vector in its original state. Every
+// process holds the whole mesh and estimates on its own subdomain, so that
+// this does not require p4est
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/function.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/numerics/vector_tools.h>
+#include <deal.II/numerics/error_estimator.h>
+#include <deal.II/grid/tria.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/dofs/dof_renumbering.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/parallel_vector.h>
+#include <deal.II/fe/fe_q.h>
+
+#include <fstream>
+
+
+template <int dim>
+class QuadraticFunction : public Function<dim>
+{
+public:
+  virtual double value (const Point<dim> &p,
+                        const unsigned int) const
+  {
+    double value = 1.;
+    for (unsigned int d=0; d<dim; ++d)
+      value += (d+1) * p[d] * p[d];
+    return value;
+  }
+};
+
+
+
+template<int dim>
+void test()
+{
+  const unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  const unsigned int n_procs = Utilities::MPI::n_mpi_processes (MPI_COMM_WORLD);
+
+  Triangulation<dim> tria;
+  GridGenerator::hyper_cube (tria,-1.0,1.0);
+  tria.refine_global(2);
+  for (typename Triangulation<dim>::active_cell_iterator
+       cell = tria.begin_active(); cell != tria.end(); ++cell)
+    if (cell->center()[0] < 0)
+      cell->set_refine_flag();
+  tria.execute_coarsening_and_refinement();
+
+  // split the active cells into contiguous chunks, one per process
+  unsigned int index = 0;
+  for (typename Triangulation<dim>::active_cell_iterator
+       cell = tria.begin_active(); cell != tria.end(); ++cell, ++index)
+    cell->set_subdomain_id (index * n_procs / tria.n_active_cells());
+
+  FE_Q<dim> fe(1);
+  DoFHandler<dim> dh(tria);
+  dh.distribute_dofs(fe);
+  DoFRenumbering::subdomain_wise (dh);
+
+  // after the renumbering, the dofs of each subdomain are contiguous. let
+  // every process have all other dofs as ghosts
+  std::vector<types::global_dof_index> n_dofs_before (n_procs+1, 0);
+  for (unsigned int p=0; p<n_procs; ++p)
+    n_dofs_before[p+1] = n_dofs_before[p] +
+                         DoFTools::count_dofs_with_subdomain_association (dh, p);
+  IndexSet locally_owned_dofs (dh.n_dofs());
+  locally_owned_dofs.add_range (n_dofs_before[myid], n_dofs_before[myid+1]);
+
+  Vector<double> serial_solution (dh.n_dofs());
+  VectorTools::interpolate (dh, QuadraticFunction<dim>(), serial_solution);
+
+  parallel::distributed::Vector<double> solution (locally_owned_dofs,
+                                                  complete_index_set (dh.n_dofs()),
+                                                  MPI_COMM_WORLD);
+  for (types::global_dof_index i=n_dofs_before[myid]; i<n_dofs_before[myid+1]; ++i)
+    solution(i) = serial_solution(i);
+
+  // first with the serial vector
+  Vector<float> serial (tria.n_active_cells());
+  KellyErrorEstimator<dim>::estimate (dh, QGauss<dim-1>(2),
+                                      typename FunctionMap<dim>::type(),
+                                      serial_solution, serial,
+                                      ComponentMask(), 0,
+                                      numbers::invalid_unsigned_int, myid);
+
+  // then with the ghost values imported
+  solution.update_ghost_values();
+  Vector<float> reference (tria.n_active_cells());
+  KellyErrorEstimator<dim>::estimate (dh, QGauss<dim-1>(2),
+                                      typename FunctionMap<dim>::type(),
+                                      solution, reference,
+                                      ComponentMask(), 0,
+                                      numbers::invalid_unsigned_int, myid);
+
+  // and finally without
+  solution.zero_out_ghosts();
+  Vector<float> indicators (tria.n_active_cells());
+  KellyErrorEstimator<dim>::estimate (dh, QGauss<dim-1>(2),
+                                      typename FunctionMap<dim>::type(),
+                                      solution, indicators,
+                                      ComponentMask(), 0,
+                                      numbers::invalid_unsigned_int, myid);
+
+  // count the differences on all processes
+  unsigned int n_different_from_serial = 0, n_different_from_ghosted = 0;
+  for (unsigned int i=0; i<indicators.size(); ++i)
+    {
+      if (reference(i) != serial(i))
+        ++n_different_from_serial;
+      if (indicators(i) != reference(i))
+        ++n_different_from_ghosted;
+    }
+  n_different_from_serial = Utilities::MPI::sum (n_different_from_serial,
+                                                 MPI_COMM_WORLD);
+  n_different_from_ghosted = Utilities::MPI::sum (n_different_from_ghosted,
+                                                  MPI_COMM_WORLD);
+  const unsigned int n_still_ghosted
+    = Utilities::MPI::sum (solution.has_ghost_elements() ? 1U : 0U,
+                           MPI_COMM_WORLD);
+  const double norm
+    = std::sqrt (Utilities::MPI::sum (static_cast<double>(indicators.norm_sqr()),
+                                      MPI_COMM_WORLD));
+
+  if (myid == 0)
+    {
+      deallog << "Norm of indicators: " << norm << std::endl;
+      deallog << "Same indicators as for serial vector: "
+              << (n_different_from_serial == 0 ? "yes" : "no") << std::endl;
+      deallog << "Same indicators without ghost values: "
+              << (n_different_from_ghosted == 0 ? "yes" : "no") << std::endl;
+      deallog << "Ghost values released again: "
+              << (n_still_ghosted == 0 ? "yes" : "no") << std::endl;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+
+  unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  deallog.push(Utilities::int_to_string(myid));
+
+  if (myid == 0)
+    {
+      std::ofstream logfile("output");
+      deallog.attach(logfile);
+      deallog.depth_console(0);
+      deallog.threshold_double(1.e-10);
+
+      deallog.push("2d");
+      test<2>();
+      deallog.pop();
+      deallog.push("3d");
+      test<3>();
+      deallog.pop();
+    }
+  else
+    {
+      test<2>();
+      test<3>();
+    }
+}
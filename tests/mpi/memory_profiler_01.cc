@@ -0,0 +1,91 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check that MemoryProfiler::print_report() with a communicator works if
+// the processes have recorded different phases and objects: all phases of
+// all processes must be listed, and the function must not hang
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/memory_profiler.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/lac/vector.h>
+#include <fstream>
+#include <sstream>
+
+
+void test()
+{
+  const unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+
+  MemoryProfiler::enable (false);
+
+  Vector<double> vector (1000 * (myid+1));
+  MemoryProfiler::register_object ("Vector on rank " +
+                                   Utilities::int_to_string (myid),
+                                   vector);
+  {
+    MemoryProfiler::Scope scope ("Common");
+    MemoryProfiler::sample_objects ("Common");
+  }
+  {
+    const std::string phase = "Only on rank " + Utilities::int_to_string (myid);
+    MemoryProfiler::Scope scope (phase.c_str());
+  }
+
+  std::ostringstream report;
+  MemoryProfiler::print_report (report, MPI_COMM_WORLD);
+
+  if (myid == 0)
+    {
+      const unsigned int n_procs = Utilities::MPI::n_mpi_processes (MPI_COMM_WORLD);
+      for (unsigned int p=0; p<n_procs; ++p)
+        deallog << "Report lists phase and vector of rank " << p << ": "
+                << ((report.str().find ("Only on rank " +
+                                        Utilities::int_to_string (p))
+                     != std::string::npos)
+                    &&
+                    (report.str().find ("Vector on rank " +
+                                        Utilities::int_to_string (p))
+                     != std::string::npos)
+                    ? "yes" : "no")
+                << std::endl;
+    }
+
+  MemoryProfiler::unregister_object ("Vector on rank " +
+                                     Utilities::int_to_string (myid));
+}
+
+
+int main(int argc, char *argv[])
+{
+  Utilities::MPI::MPI_InitFinalize mpi (argc, argv);
+
+  if (Utilities::MPI::this_mpi_process (MPI_COMM_WORLD) == 0)
+    {
+      std::ofstream logfile("output");
+      deallog.attach(logfile);
+      deallog.depth_console(0);
+      deallog.threshold_double(1.e-10);
+
+      deallog.push("mpi");
+      test();
+      deallog.pop();
+    }
+  else
+    test();
+}
@@ -0,0 +1,108 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check that poll_communication() can be called at any point between the
+// _start and _finish calls of update_ghost_values and compress, as well as
+// without any communication in flight, without changing the result
+
+#include "../tests.h"
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/index_set.h>
+#include <deal.II/lac/parallel_vector.h>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+
+void test ()
+{
+  unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  unsigned int numproc = Utilities::MPI::n_mpi_processes (MPI_COMM_WORLD);
+
+  if (myid==0) deallog << "numproc=" << numproc << std::endl;
+
+  // each processor owns 2 indices and all are ghosting element 1 (the
+  // second)
+  IndexSet local_owned(numproc*2);
+  local_owned.add_range(myid*2,myid*2+2);
+  IndexSet local_relevant(numproc*2);
+  local_relevant = local_owned;
+  local_relevant.add_range(1,2);
+
+  parallel::distributed::Vector<double> v(local_owned, local_relevant, MPI_COMM_WORLD);
+
+  // nothing started yet
+  v.poll_communication();
+
+  // set local values
+  v(myid*2)=myid*2.0;
+  v(myid*2+1)=myid*2.0+1.0;
+  v.compress(VectorOperation::insert);
+  v*=2.0;
+
+  for (unsigned int run=0; run<3; ++run)
+    {
+      v.update_ghost_values_start();
+      for (unsigned int i=0; i<run; ++i)
+        v.poll_communication();
+      v.update_ghost_values_finish();
+
+      Assert(v(1) == 2.0, ExcInternalError());
+      v.zero_out_ghosts();
+    }
+
+  // add into the ghost entry on all processors and compress with polling
+  // in between
+  v(1) += 1.0;
+  v.compress_start(0, VectorOperation::add);
+  v.poll_communication();
+  v.poll_communication();
+  v.compress_finish(VectorOperation::add);
+  v.poll_communication();
+
+  if (myid == 0)
+    {
+      deallog << "v(1) after compress: " << v(1) << std::endl;
+      Assert(v(1) == 2.0+numproc, ExcInternalError());
+    }
+
+  if (myid == 0)
+    deallog << "OK" << std::endl;
+}
+
+
+
+int main (int argc, char **argv)
+{
+  Utilities::System::MPI_InitFinalize mpi_initialization(argc, argv);
+
+  unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  deallog.push(Utilities::int_to_string(myid));
+
+  if (myid == 0)
+    {
+      std::ofstream logfile("output");
+      deallog.attach(logfile);
+      deallog << std::setprecision(4);
+      deallog.depth_console(0);
+      deallog.threshold_double(1.e-10);
+
+      test();
+    }
+  else
+    test();
+
+}
@@ -0,0 +1,139 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check the exchange of ghost values through shared memory windows with a
+// partitioner that has this option enabled: repeated ghost updates with
+// changing values, compress(), and copies and swaps of vectors
+
+#include "../tests.h"
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/index_set.h>
+#include <deal.II/base/partitioner.h>
+#include <deal.II/lac/parallel_vector.h>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+
+void check_ghosts (const parallel::distributed::Vector<double> &v,
+                   const unsigned int                          myid,
+                   const unsigned int                          numproc,
+                   const double                                offset)
+{
+  // each processor ghosts the first element of the next processor and the
+  // last element of the previous one, as well as element 0
+  if (myid > 0)
+    {
+      Assert (v(0) == offset, ExcInternalError());
+      Assert (v(3*myid-1) == 3*myid-1+offset, ExcInternalError());
+    }
+  if (myid < numproc-1)
+    Assert (v(3*myid+3) == 3*myid+3+offset, ExcInternalError());
+}
+
+
+
+void test ()
+{
+  unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  unsigned int numproc = Utilities::MPI::n_mpi_processes (MPI_COMM_WORLD);
+
+  if (myid==0) deallog << "numproc=" << numproc << std::endl;
+
+  IndexSet local_owned(numproc*3);
+  local_owned.add_range(myid*3,myid*3+3);
+  IndexSet local_relevant(numproc*3);
+  local_relevant = local_owned;
+  local_relevant.add_index(0);
+  if (myid > 0)
+    local_relevant.add_index(3*myid-1);
+  if (myid < numproc-1)
+    local_relevant.add_index(3*myid+3);
+
+  std_cxx11::shared_ptr<const Utilities::MPI::Partitioner> partitioner
+  (new Utilities::MPI::Partitioner (local_owned, local_relevant,
+                                    MPI_COMM_WORLD, true));
+  if (myid == 0)
+    deallog << "shared memory exchange: "
+            << partitioner->use_shared_memory_ghost_exchange() << std::endl;
+
+  parallel::distributed::Vector<double> v(partitioner);
+  for (unsigned int run=0; run<3; ++run)
+    {
+      for (unsigned int i=3*myid; i<3*myid+3; ++i)
+        v(i) = i + run;
+      v.update_ghost_values();
+      check_ghosts (v, myid, numproc, run);
+      v.zero_out_ghosts();
+    }
+
+  // use two channels at the same time
+  parallel::distributed::Vector<double> w(v);
+  for (unsigned int i=3*myid; i<3*myid+3; ++i)
+    w(i) = i + 10;
+  v.update_ghost_values_start(0);
+  w.update_ghost_values_start(1);
+  w.update_ghost_values_finish();
+  v.update_ghost_values_finish();
+  check_ghosts (v, myid, numproc, 2);
+  check_ghosts (w, myid, numproc, 10);
+
+  // the windows must follow the vectors in a swap
+  v.zero_out_ghosts();
+  w.zero_out_ghosts();
+  v.swap(w);
+  v.update_ghost_values();
+  check_ghosts (v, myid, numproc, 10);
+
+  // compress is done through MPI messages, but uses the import data that
+  // lives in the window
+  v.zero_out_ghosts();
+  v = 0;
+  v(0) += 1.;
+  v.compress(VectorOperation::add);
+  v.update_ghost_values();
+  const double expected = numproc;
+  Assert (v(0) == expected, ExcInternalError());
+  if (myid == 0)
+    deallog << "v(0) after compress: " << v(0) << std::endl;
+
+  if (myid == 0)
+    deallog << "OK" << std::endl;
+}
+
+
+
+int main (int argc, char **argv)
+{
+  Utilities::System::MPI_InitFinalize mpi_initialization(argc, argv);
+
+  unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  deallog.push(Utilities::int_to_string(myid));
+
+  if (myid == 0)
+    {
+      std::ofstream logfile("output");
+      deallog.attach(logfile);
+      deallog << std::setprecision(4);
+      deallog.depth_console(0);
+      deallog.threshold_double(1.e-10);
+
+      test();
+    }
+  else
+    test();
+
+}
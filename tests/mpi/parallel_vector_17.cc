@@ -0,0 +1,156 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// check update_ghost_values() and compress() of parallel vectors for ghost
+// sets that consist of several separate runs of indices on each owner, and
+// where the processors request different runs from the same owner, so that
+// the import indices of an owner are merged from ranges of different
+// lengths. the results are compared with values computed element by element
+
+#include "../tests.h"
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/index_set.h>
+#include <deal.II/lac/parallel_vector.h>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+
+const unsigned int n_local = 10;
+
+
+// the ghost indices that processor q requests from the (different)
+// processor p: some runs that all processors share, and one index that
+// depends on q
+std::vector<unsigned int>
+ghosts_of (const unsigned int q,
+           const unsigned int p)
+{
+  std::vector<unsigned int> ghosts;
+  if (p == q)
+    return ghosts;
+  const unsigned int local[] = { 1, 2, 3, 5, 8, 9 };
+  for (unsigned int i=0; i<sizeof(local)/sizeof(local[0]); ++i)
+    ghosts.push_back (p*n_local + local[i]);
+  if (q % n_local != 1 && q % n_local != 2 && q % n_local != 3 &&
+      q % n_local != 5 && q % n_local != 8 && q % n_local != 9)
+    ghosts.push_back (p*n_local + q % n_local);
+  return ghosts;
+}
+
+
+
+void test ()
+{
+  const unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  const unsigned int numproc = Utilities::MPI::n_mpi_processes (MPI_COMM_WORLD);
+
+  if (myid==0) deallog << "numproc=" << numproc << std::endl;
+
+  IndexSet locally_owned (numproc*n_local);
+  locally_owned.add_range (myid*n_local, (myid+1)*n_local);
+  IndexSet ghost_set (numproc*n_local);
+  for (unsigned int p=0; p<numproc; ++p)
+    {
+      const std::vector<unsigned int> ghosts = ghosts_of (myid, p);
+      ghost_set.add_indices (ghosts.begin(), ghosts.end());
+    }
+  ghost_set.compress ();
+  if (myid==0)
+    deallog << "Ranges of ghost indices on processor 0: "
+            << ghost_set.n_intervals() << std::endl;
+
+  parallel::distributed::Vector<double> v (locally_owned, ghost_set,
+                                           MPI_COMM_WORLD);
+
+  // update_ghost_values() must give the values of the owners
+  for (unsigned int i=myid*n_local; i<(myid+1)*n_local; ++i)
+    v(i) = i+1.;
+  v.update_ghost_values ();
+  unsigned int n_errors = 0;
+  for (unsigned int i=0; i<ghost_set.n_elements(); ++i)
+    if (v(ghost_set.nth_index_in_set(i)) != ghost_set.nth_index_in_set(i)+1.)
+      ++n_errors;
+  n_errors = Utilities::MPI::sum (n_errors, MPI_COMM_WORLD);
+  if (myid==0)
+    deallog << "update_ghost_values() errors: " << n_errors << std::endl;
+
+  // compress(add) must add the contributions of all processors that ghost
+  // an index to the value of its owner, processor q contributing (q+1)
+  // times the index
+  v.zero_out_ghosts ();
+  for (unsigned int i=0; i<ghost_set.n_elements(); ++i)
+    v(ghost_set.nth_index_in_set(i)) = (myid+1.) * ghost_set.nth_index_in_set(i);
+  v.compress (VectorOperation::add);
+  std::vector<double> expected (n_local);
+  for (unsigned int i=0; i<n_local; ++i)
+    expected[i] = myid*n_local+i+1.;
+  for (unsigned int q=0; q<numproc; ++q)
+    {
+      const std::vector<unsigned int> ghosts = ghosts_of (q, myid);
+      for (unsigned int i=0; i<ghosts.size(); ++i)
+        expected[ghosts[i]-myid*n_local] += (q+1.) * ghosts[i];
+    }
+  n_errors = 0;
+  for (unsigned int i=0; i<n_local; ++i)
+    if (v(myid*n_local+i) != expected[i])
+      ++n_errors;
+  n_errors = Utilities::MPI::sum (n_errors, MPI_COMM_WORLD);
+  if (myid==0)
+    deallog << "compress(add) errors: " << n_errors << std::endl;
+
+  // compress(insert) must keep the values of the owners when all
+  // processors set the values the owners have
+  v.update_ghost_values ();
+  std::vector<double> ghost_values (ghost_set.n_elements());
+  for (unsigned int i=0; i<ghost_set.n_elements(); ++i)
+    ghost_values[i] = v(ghost_set.nth_index_in_set(i));
+  v.zero_out_ghosts ();
+  for (unsigned int i=0; i<ghost_set.n_elements(); ++i)
+    v(ghost_set.nth_index_in_set(i)) = ghost_values[i];
+  v.compress (VectorOperation::insert);
+  n_errors = 0;
+  for (unsigned int i=0; i<n_local; ++i)
+    if (v(myid*n_local+i) != expected[i])
+      ++n_errors;
+  n_errors = Utilities::MPI::sum (n_errors, MPI_COMM_WORLD);
+  if (myid==0)
+    deallog << "compress(insert) errors: " << n_errors << std::endl;
+}
+
+
+
+int main (int argc, char **argv)
+{
+  Utilities::System::MPI_InitFinalize mpi_initialization(argc, argv);
+
+  unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  deallog.push(Utilities::int_to_string(myid));
+
+  if (myid == 0)
+    {
+      std::ofstream logfile("output");
+      deallog.attach(logfile);
+      deallog << std::setprecision(4);
+      deallog.depth_console(0);
+      deallog.threshold_double(1.e-10);
+
+      test();
+    }
+  else
+    test();
+
+}
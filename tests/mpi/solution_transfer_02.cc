@@ -0,0 +1,223 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// transfer several vectors at once through refinement and coarsening, with
+// the values stored in double and in single precision. the vectors hold
+// linear functions that are transferred exactly up to roundoff. also check
+// that the data attached to each cell grows exactly linearly with the
+// number of vectors, so that the amount of data moved around, and thus the
+// cost of the transfer per vector, does not depend on the number of vectors
+
+#include "../tests.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/function.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/numerics/vector_tools.h>
+#include <deal.II/distributed/tria.h>
+#include <deal.II/distributed/solution_transfer.h>
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria_accessor.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/lac/parallel_vector.h>
+#include <deal.II/fe/fe_q.h>
+
+#include <fstream>
+
+
+template <int dim>
+class LinearFunction : public Function<dim>
+{
+public:
+  LinearFunction (const double factor)
+    :
+    factor (factor)
+  {}
+
+  virtual double value (const Point<dim> &p,
+                        const unsigned int) const
+  {
+    double value = 1.;
+    for (unsigned int d=0; d<dim; ++d)
+      value += (d+1) * p[d];
+    return factor * value;
+  }
+
+private:
+  const double factor;
+};
+
+
+
+template <int dim>
+void pack_nothing (const typename parallel::distributed::Triangulation<dim>::cell_iterator &,
+                   const typename parallel::distributed::Triangulation<dim>::CellStatus,
+                   void *)
+{}
+
+
+
+template <int dim>
+void unpack_nothing (const typename parallel::distributed::Triangulation<dim>::cell_iterator &,
+                     const typename parallel::distributed::Triangulation<dim>::CellStatus,
+                     const void *)
+{}
+
+
+
+// transfer the given number of vectors, and return the number of bytes
+// attached to each cell for them
+template<int dim>
+unsigned int transfer (const unsigned int n_vectors,
+                       const bool         single_precision,
+                       double            &max_error)
+{
+  parallel::distributed::Triangulation<dim> tria(MPI_COMM_WORLD);
+  GridGenerator::hyper_cube (tria,-1.0,1.0);
+  tria.refine_global(2);
+
+  FE_Q<dim> fe(2);
+  DoFHandler<dim> dh(tria);
+  dh.distribute_dofs(fe);
+
+  IndexSet locally_relevant_dofs;
+  DoFTools::extract_locally_relevant_dofs (dh,locally_relevant_dofs);
+
+  std::vector<parallel::distributed::Vector<double> > vectors(n_vectors);
+  std::vector<const parallel::distributed::Vector<double> *> in(n_vectors);
+  for (unsigned int v=0; v<n_vectors; ++v)
+    {
+      vectors[v].reinit (dh.locally_owned_dofs(), locally_relevant_dofs,
+                         MPI_COMM_WORLD);
+      VectorTools::interpolate (dh, LinearFunction<dim>(v+1.), vectors[v]);
+      vectors[v].update_ghost_values();
+      in[v] = &vectors[v];
+    }
+
+  // refine the cells on the left and coarsen the ones on the right
+  for (typename Triangulation<dim>::active_cell_iterator
+       cell = tria.begin_active(); cell != tria.end(); ++cell)
+    if (cell->is_locally_owned())
+      {
+        if (cell->center()[0] < 0)
+          cell->set_refine_flag();
+        else
+          cell->set_coarsen_flag();
+      }
+
+  parallel::distributed::SolutionTransfer<dim,parallel::distributed::Vector<double> >
+  soltrans(dh, single_precision);
+  tria.prepare_coarsening_and_refinement();
+  soltrans.prepare_for_coarsening_and_refinement (in);
+
+  // the offset of data attached after the one of soltrans tells how much
+  // soltrans attached to each cell
+  const unsigned int probe_offset
+    = tria.register_data_attach (1, &pack_nothing<dim>);
+  const unsigned int bytes_per_cell
+    = probe_offset - sizeof(typename parallel::distributed::Triangulation<dim>::CellStatus);
+
+  tria.execute_coarsening_and_refinement();
+  tria.notify_ready_to_unpack (probe_offset, &unpack_nothing<dim>);
+
+  dh.distribute_dofs (fe);
+  DoFTools::extract_locally_relevant_dofs (dh,locally_relevant_dofs);
+  std::vector<parallel::distributed::Vector<double> > new_vectors(n_vectors);
+  std::vector<parallel::distributed::Vector<double> *> out(n_vectors);
+  for (unsigned int v=0; v<n_vectors; ++v)
+    {
+      new_vectors[v].reinit (dh.locally_owned_dofs(), locally_relevant_dofs,
+                             MPI_COMM_WORLD);
+      out[v] = &new_vectors[v];
+    }
+  soltrans.interpolate (out);
+
+  max_error = 0;
+  parallel::distributed::Vector<double> reference (dh.locally_owned_dofs(),
+                                                   locally_relevant_dofs,
+                                                   MPI_COMM_WORLD);
+  for (unsigned int v=0; v<n_vectors; ++v)
+    {
+      VectorTools::interpolate (dh, LinearFunction<dim>(v+1.), reference);
+      reference -= new_vectors[v];
+      max_error = std::max (max_error, reference.linfty_norm() /
+                            new_vectors[v].linfty_norm());
+    }
+
+  max_error = Utilities::MPI::max (max_error, MPI_COMM_WORLD);
+  return bytes_per_cell;
+}
+
+
+
+template<int dim>
+void test(const bool single_precision)
+{
+  const unsigned int n_vectors = 5;
+
+  double error_one = 0, error_many = 0;
+  const unsigned int bytes_one = transfer<dim> (1, single_precision, error_one);
+  const unsigned int bytes_many = transfer<dim> (n_vectors, single_precision, error_many);
+
+  if (Utilities::MPI::this_mpi_process (MPI_COMM_WORLD) == 0)
+    {
+      deallog << "Bytes per cell for 1 and " << n_vectors << " vectors: "
+              << bytes_one << ' ' << bytes_many << std::endl;
+      deallog << "Bytes per cell proportional to number of vectors: "
+              << (bytes_many == n_vectors * bytes_one ? "yes" : "no")
+              << std::endl;
+      deallog << "Relative error below "
+              << (single_precision ? "1e-6: " : "1e-13: ")
+              << (std::max (error_one, error_many) <
+                  (single_precision ? 1e-6 : 1e-13) ? "yes" : "no")
+              << std::endl;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+
+  unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  deallog.push(Utilities::int_to_string(myid));
+
+  if (myid == 0)
+    {
+      std::ofstream logfile("output");
+      deallog.attach(logfile);
+      deallog.depth_console(0);
+      deallog.threshold_double(1.e-10);
+
+      deallog.push("2d");
+      test<2>(false);
+      test<2>(true);
+      deallog.pop();
+      deallog.push("3d");
+      test<3>(false);
+      test<3>(true);
+      deallog.pop();
+    }
+  else
+    {
+      test<2>(false);
+      test<2>(true);
+      test<3>(false);
+      test<3>(true);
+    }
+}
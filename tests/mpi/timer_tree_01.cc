@@ -0,0 +1,153 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// check the call tree of a TimerOutput with an MPI communicator: every
+// process spends a different wall time in one section, for which minimum,
+// average and maximum over all processes are checked. with threads, some
+// sections are only entered on some of the processes, and a different
+// number of times on each of them, on threads other than the one that
+// created the object. these must not take part in the collective operations
+// of entering and leaving a section, and the call tree must still contain
+// all of them
+
+#include "../tests.h"
+#include <deal.II/base/timer.h>
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/thread_management.h>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+
+
+void spin (const double seconds)
+{
+  Timer timer;
+  while (timer.wall_time() < seconds)
+    ;
+}
+
+
+
+void work (TimerOutput &timer,
+           const bool   only_on_first,
+           const bool   only_on_odd)
+{
+  TimerOutput::Scope scope (timer, "Worker");
+  if (only_on_first)
+    {
+      TimerOutput::Scope inner_scope (timer, "Only on first");
+    }
+  if (only_on_odd)
+    {
+      TimerOutput::Scope inner_scope (timer, "Only on odd");
+    }
+}
+
+
+
+void test ()
+{
+  const unsigned int myid = Utilities::MPI::this_mpi_process (MPI_COMM_WORLD);
+  const unsigned int n_procs = Utilities::MPI::n_mpi_processes (MPI_COMM_WORLD);
+
+  std::ostringstream summary;
+  TimerOutput timer (MPI_COMM_WORLD, summary, TimerOutput::never,
+                     TimerOutput::wall_times);
+
+  {
+    TimerOutput::Scope scope (timer, "Spin");
+    spin (0.1 * (myid+1));
+  }
+
+  {
+    TimerOutput::Scope scope (timer, "Outer");
+    TimerOutput::Scope inner_scope (timer, "Inner");
+  }
+
+  // without threads, new_thread() runs the function on the calling
+  // thread, whose sections are collective. enter the sections the same
+  // number of times on all processes then, with the same maximal number of
+  // calls as with threads, so that the output is the same
+#ifdef DEAL_II_WITH_THREADS
+  const unsigned int n_workers = myid + 1;
+  const bool only_on_first = (myid == 0);
+  const bool only_on_odd = (myid % 2 == 1);
+#else
+  const unsigned int n_workers = n_procs;
+  const bool only_on_first = true;
+  const bool only_on_odd = true;
+#endif
+  for (unsigned int i=0; i<n_workers; ++i)
+    Threads::new_thread (&work, timer,
+                         only_on_first && (i == 0),
+                         only_on_odd && (i == 0)).join ();
+
+  std::ostringstream json;
+  timer.write_json (json);
+
+  if (myid == 0)
+    {
+      std::istringstream lines (json.str());
+      std::string line;
+      bool spin_section = false;
+      while (std::getline (lines, line))
+        {
+          if (line.find ("\"Spin\"") != std::string::npos)
+            spin_section = true;
+
+          if (spin_section && line.find ("wall time") != std::string::npos)
+            {
+              double min = 0, avg = 0, max = 0;
+              std::sscanf (line.substr (line.find ('{')).c_str(),
+                           "{ \"min\": %lf, \"avg\": %lf, \"max\": %lf }",
+                           &min, &avg, &max);
+              deallog << "Spin wall time: min "
+                      << (std::fabs (min - 0.1) < 0.05 ? "ok" : "wrong")
+                      << ", avg "
+                      << (std::fabs (avg - 0.05*(n_procs+1)) < 0.05 ? "ok" : "wrong")
+                      << ", max "
+                      << (std::fabs (max - 0.1*n_procs) < 0.05 ? "ok" : "wrong")
+                      << std::endl;
+              spin_section = false;
+            }
+
+          if (line.find ("time") == std::string::npos &&
+              line.find ("threads") == std::string::npos)
+            deallog << line << std::endl;
+        }
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+  Utilities::MPI::MPI_InitFinalize mpi (argc, argv);
+
+  if (Utilities::MPI::this_mpi_process (MPI_COMM_WORLD) == 0)
+    {
+      std::ofstream logfile("output");
+      deallog.attach(logfile);
+      deallog.depth_console(0);
+      deallog.threshold_double(1.e-10);
+
+      test();
+    }
+  else
+    test();
+}
@@ -0,0 +1,82 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// solve the 5-point stencil with CG preconditioned by the native
+// smoothed-aggregation PreconditionAMG on grids of increasing size and check
+// that the number of iterations stays bounded
+
+
+#include "../tests.h"
+#include "../lac/testmatrix.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/vector_memory.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/solver_cg.h>
+#include <deal.II/multigrid/mg_algebraic.h>
+
+#include <fstream>
+#include <iomanip>
+
+
+void
+check (const unsigned int size)
+{
+  const unsigned int dim = (size-1)*(size-1);
+  FDMatrix testproblem(size, size);
+  SparsityPattern structure(dim, dim, 5);
+  testproblem.five_point_structure(structure);
+  structure.compress();
+  SparseMatrix<double> A(structure);
+  testproblem.five_point(A);
+
+  PreconditionAMG amg;
+  amg.initialize (A);
+  deallog << "Size " << dim << ", levels " << amg.n_levels()
+          << ", coarse size " << amg.get_level_matrix(0).m()
+          << ", operator complexity " << amg.operator_complexity()
+          << std::endl;
+
+  Vector<double> u (dim), f (dim);
+  f = 1.;
+  SolverControl control (100, 1e-10*f.l2_norm());
+  SolverCG<> solver (control);
+  solver.solve (A, u, f, amg);
+
+  Vector<double> residual (dim);
+  A.residual (residual, u, f);
+  deallog << "Residual " << residual.l2_norm()/f.l2_norm() << std::endl;
+}
+
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog << std::fixed;
+  deallog << std::setprecision(3);
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  check (16);
+  check (32);
+  check (64);
+  check (128);
+  check (256);
+  check (512);
+}
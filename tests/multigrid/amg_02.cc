@@ -0,0 +1,86 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2014 by the deal.II authors
+//
+// This file is part of the deal.II library.
+//
+// The deal.II library is free software; you can use it, redistribute
+// it, and/or modify it under the terms of the GNU Lesser General
+// Public License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+// The full text of the license can be found in the file LICENSE at
+// the top level of the deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// apply PreconditionAMG to several vectors from concurrent tasks, and check
+// that the results are the same as when applying it to one vector after the
+// other
+
+
+#include "../tests.h"
+#include "../lac/testmatrix.h"
+#include <deal.II/base/logstream.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/multigrid/mg_algebraic.h>
+
+#include <fstream>
+
+
+void
+apply (const PreconditionAMG &amg,
+       Vector<double>        &dst,
+       const Vector<double>  &src)
+{
+  amg.vmult (dst, src);
+}
+
+
+
+int main()
+{
+  std::ofstream logfile("output");
+  deallog.attach(logfile);
+  deallog.depth_console(0);
+  deallog.threshold_double(1.e-10);
+
+  const unsigned int size = 64;
+  const unsigned int dim = (size-1)*(size-1);
+  FDMatrix testproblem(size, size);
+  SparsityPattern structure(dim, dim, 5);
+  testproblem.five_point_structure(structure);
+  structure.compress();
+  SparseMatrix<double> A(structure);
+  testproblem.five_point(A);
+
+  PreconditionAMG amg;
+  amg.initialize (A);
+
+  const unsigned int n_vectors = 8;
+  std::vector<Vector<double> > src (n_vectors, Vector<double>(dim));
+  std::vector<Vector<double> > reference (n_vectors, Vector<double>(dim));
+  std::vector<Vector<double> > result (n_vectors, Vector<double>(dim));
+  for (unsigned int v=0; v<n_vectors; ++v)
+    {
+      for (unsigned int i=0; i<dim; ++i)
+        src[v](i) = 1. + (i*(v+3)) % 17;
+      amg.vmult (reference[v], src[v]);
+    }
+
+  Threads::TaskGroup<> tasks;
+  for (unsigned int v=0; v<n_vectors; ++v)
+    tasks += Threads::new_task (&apply, amg, result[v], src[v]);
+  tasks.join_all ();
+
+  for (unsigned int v=0; v<n_vectors; ++v)
+    {
+      result[v] -= reference[v];
+      deallog << "Vector " << v << ": difference "
+              << result[v].linfty_norm() / reference[v].linfty_norm()
+              << std::endl;
+    }
+}